@@ -0,0 +1,125 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include "JobSystem.h"
+#include "MathUtils.h"
+#include "Shader.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Clustered forward shading: iluminacion con miles de luces sin listas de
+ * luces por objeto ni G-buffer.
+ *
+ * El frustum de la camara se divide en GRID_X x GRID_Y tiles de pantalla y
+ * GRID_Z rebanadas de profundidad exponenciales (mas finas cerca de la
+ * camara). Cada frame update() asigna las luces (esferas; las spot usan la
+ * esfera de su alcance) a los clusters que tocan y deja en buffers:
+ *   - gridBuffer: por cluster, (offset, cantidad) en la lista de indices
+ *   - indexBuffer: los indices de las luces de cada cluster, seguidos
+ *   - lightBuffer: las luces, LIGHT_TEXELS vec4 cada una
+ * clustered.frag calcula su cluster con gl_FragCoord y la profundidad, y
+ * recorre solo esas luces: el costo por pixel depende de cuantas luces hay
+ * cerca, no del total.
+ *
+ * La asignacion corre en un compute shader (cluster.comp) si hay GL 4.3,
+ * con un workgroup por cluster. En GL 3.3 se hace en la CPU, repartida por
+ * rebanadas entre los hilos de JobSystem, y se sube con glBufferSubData. En
+ * los dos casos el fragment shader lee los buffers como texture buffers
+ * (samplerBuffer, GL 3.1), asi hay un solo shader. Un cluster guarda a lo
+ * sumo MAX_LIGHTS_PER_CLUSTER luces: en la CPU las de menor indice, en el
+ * compute shader las que lleguen primero. */
+
+// Mirrors `struct Light` in cluster.comp and the texels of clustered.frag
+struct ClusterLight {
+  float position[3]; // world space
+  float range;       // the light does not reach past this distance
+  float color[3];    // already multiplied by the intensity
+  float spotInner;   // cos of the inner cone angle (spot lights)
+  float direction[3];
+  float spotOuter;   // cos of the outer cone angle; <= -1 for point lights
+};
+
+// Texture units that clustered.frag samples the buffers from
+const GLint CLUSTER_LIGHTS_UNIT = 4;
+const GLint CLUSTER_GRID_UNIT = 5;
+const GLint CLUSTER_INDICES_UNIT = 6;
+
+const GLuint CLUSTER_LIGHTS_BINDING = 0;
+const GLuint CLUSTER_GRID_BINDING = 1;
+const GLuint CLUSTER_INDICES_BINDING = 2;
+const GLuint CLUSTER_COUNT_BINDING = 3;
+
+class ClusteredLighting {
+public:
+  static const int GRID_X = 16;
+  static const int GRID_Y = 9;
+  static const int GRID_Z = 24;
+  static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+  static const int MAX_LIGHTS_PER_CLUSTER = 128;
+  static const int LIGHT_TEXELS = sizeof(ClusterLight) / (4 * sizeof(float));
+
+  bool isValid = false;
+  // True when update() runs cluster.comp
+  bool useCompute = false;
+  size_t maxLights;
+  size_t lightCount = 0;
+  // Capacity of the index list, shared by all clusters
+  size_t maxIndices;
+
+  // Last CPU update (the compute path leaves them at 0)
+  size_t assignedIndices = 0;
+  size_t overflowedClusters = 0;
+
+  // `allowCompute` false forces the CPU path even on GL 4.3
+  explicit ClusteredLighting(
+      size_t maxLights, size_t averageLightsPerCluster = 32,
+      bool allowCompute = true,
+      const char *clusterShaderPath = "shaders/cluster.comp",
+      JobSystem &jobs = JobSystem::shared());
+  ~ClusteredLighting();
+
+  ClusteredLighting(const ClusteredLighting &) = delete;
+  ClusteredLighting &operator=(const ClusteredLighting &) = delete;
+
+  void setLights(const ClusterLight *lights, size_t count);
+
+  // Bins the lights for this camera. The projection is
+  // Mat4::perspective(fovY, aspect, zNear, zFar)
+  void update(const Mat4 &view, float fovY, float aspect, float zNear,
+              float zFar);
+  // Binds the buffers to their units (directly, not through GLStateCache)
+  // and sets the cluster uniforms of clustered.frag; `program` must be in
+  // use
+  void bind(const Shader &program, int viewportWidth,
+            int viewportHeight) const;
+
+private:
+  JobSystem &jobs;
+  std::unique_ptr<Shader> clusterShader;
+  unsigned int lightBuffer = 0, gridBuffer = 0, indexBuffer = 0;
+  unsigned int countBuffer = 0;
+  unsigned int lightTexture = 0, gridTexture = 0, indexTexture = 0;
+
+  std::vector<ClusterLight> lights;
+  Mat4 view;
+  float zNear = 0.1f, zFar = 100.0f;
+
+  // CPU path: lights in view space and the cluster range each one touches
+  struct ViewLight {
+    float x, y, z, range;
+    int minX, maxX, minY, maxY, minZ, maxZ;
+  };
+  std::vector<ViewLight> viewLights;
+  std::vector<uint32_t> grid;   // offset, count per cluster
+  std::vector<uint32_t> binned; // MAX_LIGHTS_PER_CLUSTER slots per cluster
+  std::vector<uint32_t> indices;
+
+  void updateCPU(float tanHalfX, float tanHalfY);
+  void binSlice(int slice, const float *tileX, const float *tileY);
+  void updateCompute(float tanHalfX, float tanHalfY);
+};
+
+#endif // !CLUSTERED_LIGHTING_H
@@ -0,0 +1,67 @@
+#ifndef COMMAND_LIST_H
+#define COMMAND_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Lista de comandos de render independiente de la API. Se puede grabar desde
+ * cualquier hilo porque no llama a OpenGL: solo guarda que hay que hacer.
+ * Los recursos se nombran con handles de 32 bits; el backend que reproduce
+ * la lista decide que significan (en GL son los nombres de los objetos). */
+
+enum class CommandType : uint8_t {
+  SetPipeline,    // a = program, b = flags (PIPELINE_*)
+  BindTexture,    // unit, a = texture
+  BindMesh,       // a = vertex array
+  SetUniform1f,   // a = location, values[0]
+  SetUniform4f,   // a = location, values[0..3]
+  SetUniform1i,   // a = location, b = value
+  SetUniformMat4, // a = location, b = offset in payload
+  DrawIndexed,    // a = index count, b = first index, c = base vertex
+  MultiDrawIndexed // a = range count, b = offset in ranges
+};
+
+// SRC_ALPHA, ONE_MINUS_SRC_ALPHA; blended draws don't write depth
+const uint32_t PIPELINE_BLEND = 1u << 0;
+// GL_LESS
+const uint32_t PIPELINE_DEPTH_TEST = 1u << 1;
+
+struct Command {
+  CommandType type;
+  uint8_t unit;
+  uint32_t a;
+  uint32_t b;
+  int32_t c;
+  float values[4];
+};
+
+class CommandList {
+public:
+  std::vector<Command> commands;
+  // Datos grandes (matrices) que no entran en un Command
+  std::vector<float> payload;
+  // (first index, index count) pairs of the MultiDrawIndexed commands
+  std::vector<uint32_t> ranges;
+
+  void setPipeline(uint32_t program, uint32_t flags = 0);
+  void bindTexture(uint8_t unit, uint32_t texture);
+  void bindMesh(uint32_t vertexArray);
+  void setUniform(uint32_t location, float x);
+  void setUniform(uint32_t location, float x, float y, float z, float w);
+  void setUniform(uint32_t location, int value);
+  void setUniformMat4(uint32_t location, const float *matrix);
+  void drawIndexed(uint32_t indexCount, uint32_t firstIndex = 0,
+                   int32_t baseVertex = 0);
+  // Several index ranges of the bound mesh in one draw (glMultiDrawElements)
+  void multiDrawIndexed(const uint32_t *firstAndCount, uint32_t rangeCount);
+
+  void clear() {
+    commands.clear();
+    payload.clear();
+    ranges.clear();
+  }
+  bool empty() const { return commands.empty(); }
+};
+
+#endif // !COMMAND_LIST_H
@@ -0,0 +1,36 @@
+#ifndef COMMAND_RECORDER_H
+#define COMMAND_RECORDER_H
+
+#include "CommandList.h"
+#include "JobSystem.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/* Graba una CommandList por particion de la escena en varios hilos a la vez.
+ * Cada particion es un job del JobSystem, asi que comparte los hilos con el
+ * resto del motor. El hilo que llama a record() tambien graba particiones y
+ * no vuelve hasta que estan todas listas; despues el hilo de GL las
+ * reproduce en orden con executeCommandLists(). */
+class ParallelCommandRecorder {
+public:
+  using RecordFunction = std::function<void(size_t partition, CommandList &)>;
+
+  // One list per partition
+  explicit ParallelCommandRecorder(size_t partitions,
+                                   JobSystem &jobs = JobSystem::shared());
+
+  ParallelCommandRecorder(const ParallelCommandRecorder &) = delete;
+  ParallelCommandRecorder &operator=(const ParallelCommandRecorder &) = delete;
+
+  // Clears every list and records them all; returns when all are done
+  void record(const RecordFunction &recordPartition);
+
+  const std::vector<CommandList> &lists() const { return partitionLists; }
+
+private:
+  std::vector<CommandList> partitionLists;
+  JobSystem &jobs;
+};
+
+#endif // !COMMAND_RECORDER_H
@@ -0,0 +1,76 @@
+#ifndef DEBUG_OUTPUT_H
+#define DEBUG_OUTPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Recolector de mensajes de KHR_debug (glDebugMessageCallback, GL 4.3).
+ *
+ * install() pide salida sincronica, asi el driver llama al callback dentro
+ * de la llamada GL que genero el mensaje y en el mismo hilo. Eso permite
+ * saber desde donde vino: el codigo marca sus zonas con GL_DEBUG_SITE("...")
+ * y cada mensaje se cuenta en el balde (zona, tipo, id) de la zona activa en
+ * ese hilo. Los avisos de rendimiento (syncs implicitos, recompilaciones de
+ * shaders, subidas por el camino lento) son los que mas interesan; los
+ * errores ademas se imprimen la primera vez que aparecen.
+ *
+ * Conviene crear el contexto con GLFW_OPENGL_DEBUG_CONTEXT (o el flag de
+ * debug de HeadlessContext): sin eso muchos drivers no generan avisos.
+ * El callback es estado del contexto, asi que solo reportan los contextos en
+ * los que se llamo a install(); los contextos compartidos (UploadThread) lo
+ * instalan tambien y reportan a los mismos baldes. */
+class DebugOutput {
+public:
+  struct Bucket {
+    const char *site;
+    unsigned int source;
+    unsigned int type;
+    unsigned int id;
+    unsigned int severity;
+    std::string message; // el primero que llego
+    double perFrame = 0.0;
+    uint64_t maxPerFrame = 0;
+    uint64_t total = 0;
+  };
+
+  // Installs on the current context, which needs GL 4.3 or KHR_debug;
+  // call it once on every context that should report
+  static bool install();
+  static bool installed();
+
+  static void endFrame();
+
+  // Buckets since the last collect()/report(), most frequent first
+  static std::vector<Bucket> collect(uint64_t *frames = nullptr);
+  static std::string report(size_t top = 10);
+
+  static const char *sourceName(unsigned int source);
+  static const char *typeName(unsigned int type);
+  static const char *severityName(unsigned int severity);
+};
+
+// Marca la zona activa del hilo mientras vive; se pueden anidar
+class DebugSite {
+public:
+  explicit DebugSite(const char *name);
+  ~DebugSite();
+
+  DebugSite(const DebugSite &) = delete;
+  DebugSite &operator=(const DebugSite &) = delete;
+
+private:
+  const char *previous;
+};
+
+#define GL_DEBUG_STRING(x) #x
+#define GL_DEBUG_LINE(line) GL_DEBUG_STRING(line)
+#define GL_DEBUG_JOIN2(a, b) a##b
+#define GL_DEBUG_JOIN(a, b) GL_DEBUG_JOIN2(a, b)
+// GL_DEBUG_SITE("upload") -> zona "upload (src/textures.cc:120)"
+#define GL_DEBUG_SITE(name)                                                   \
+  DebugSite GL_DEBUG_JOIN(debugSite, __LINE__)(                               \
+      name " (" __FILE__ ":" GL_DEBUG_LINE(__LINE__) ")")
+
+#endif // !DEBUG_OUTPUT_H
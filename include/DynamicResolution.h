@@ -0,0 +1,90 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "Shader.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+enum class UpscaleFilter { Bilinear, EdgeAware };
+
+/* Resolucion dinamica: la escena se dibuja en un FBO propio a una fraccion
+ * (scale) del tamaño de salida y present() la escala a la salida con un
+ * triangulo de pantalla completa.
+ *
+ * El FBO se reserva una vez al tamaño de salida * maxScale y cada frame se
+ * dibuja solo en la esquina inferior izquierda de renderWidth x
+ * renderHeight, asi cambiar la escala no reserva memoria. beginScene() y
+ * endScene() ponen dos glQueryCounter(GL_TIMESTAMP) alrededor de la escena;
+ * los resultados se leen frames despues, solo si ya estan disponibles, y
+ * alimentan al controlador: el costo es proporcional a los pixeles
+ * (scale^2), asi que la escala se corrige con la raiz de presupuesto /
+ * tiempo medido, con una banda muerta y pasos limitados para no oscilar.
+ *
+ * EdgeAware es un filtro bilineal mas un realce adaptativo al contraste
+ * local (estilo CAS): afila los bordes que pierde el escalado sin
+ * sobrepasarse en zonas de alto contraste. Crear, usar y destruir desde el
+ * hilo que tiene el contexto. */
+class DynamicResolution {
+public:
+  bool isValid = false;
+  // GPU budget for the scene pass
+  double targetMs;
+  float minScale = 0.5f;
+  float maxScale = 1.0f;
+  UpscaleFilter filter = UpscaleFilter::Bilinear;
+  float sharpness = 0.5f; // EdgeAware only, 0-1
+
+  float scale = 1.0f;
+  int outputWidth = 0, outputHeight = 0;
+  int renderWidth = 0, renderHeight = 0;
+  // Smoothed GPU time of the scene pass, 0 until the first result arrives
+  double gpuMs = 0.0;
+  uint64_t scaleChanges = 0;
+
+  DynamicResolution(int outputWidth, int outputHeight, double targetMs);
+  ~DynamicResolution();
+
+  DynamicResolution(const DynamicResolution &) = delete;
+  DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+  // Reallocates the target when the output size changed
+  void resize(int width, int height);
+
+  // Binds the offscreen target with a viewport of the current render size
+  void beginScene();
+  void endScene();
+  // Upscales into `framebuffer` (0 = default) and restores the output
+  // viewport. Touches program, VAO and texture unit 0 bindings
+  void present(GLuint framebuffer);
+
+  // "scale 0.75 (600x450 of 800x600) | scene gpu 7.10 ms of 8.00 ms | ..."
+  std::string summary() const;
+
+private:
+  static const int QUERY_RING = 4;
+
+  Shader shader;
+  GLuint framebuffer = 0;
+  GLuint colorTexture = 0;
+  GLuint depthBuffer = 0;
+  GLuint emptyVAO = 0;
+  int textureWidth = 0, textureHeight = 0;
+
+  GLuint queries[QUERY_RING][2] = {};
+  bool queryPending[QUERY_RING] = {};
+  uint64_t frameIndex = 0;
+  int framesSinceChange = 0;
+
+  int sourceLocation = -1, uvScaleLocation = -1, uvClampLocation = -1,
+      texelSizeLocation = -1, edgeAwareLocation = -1,
+      sharpnessLocation = -1;
+
+  bool createTarget();
+  void destroyTarget();
+  void readQueries();
+  void updateScale(double frameGpuMs);
+  void applyScale();
+};
+
+#endif // !DYNAMIC_RESOLUTION_H
@@ -0,0 +1,98 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat { PPM, PNG, Y4M };
+
+/* Captura de frames a disco sin frenar el render. capture() copia el
+ * framebuffer de lectura actual (el back buffer, o el FBO en modo headless) a
+ * uno de varios pixel pack buffers con glReadPixels, que vuelve enseguida, y
+ * pone una fence. Recien cuando la fence de un slot esta señalada se mapea y
+ * se copia a memoria; un hilo aparte codifica y escribe los archivos.
+ *
+ * PPM y PNG escriben una imagen por frame, con `output` como patron printf
+ * ("frames/frame_%05d.png"); sin numero en el patron se agrega "_%05d"
+ * antes de la extension. Y4M escribe todos en un solo archivo.
+ * Se lee siempre una region fija de width x height desde la esquina inferior
+ * izquierda. Crear, usar y destruir desde el hilo que tiene el contexto. */
+class FrameCapture {
+public:
+  bool isValid = false;
+  int width, height;
+  CaptureFormat format;
+
+  uint64_t framesCaptured = 0;
+  uint64_t framesWritten = 0;
+  // capture() had to wait for the GPU because every PBO was still in flight
+  uint64_t readbackStalls = 0;
+  // capture() had to wait because the encoder fell behind
+  uint64_t encoderStalls = 0;
+
+  FrameCapture(int width, int height, const std::string &output,
+               CaptureFormat format, size_t ringSize = 3,
+               int framesPerSecond = 60);
+  ~FrameCapture();
+
+  FrameCapture(const FrameCapture &) = delete;
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+  // Guess the format from the extension of `output` (.png, .ppm, .y4m)
+  static bool formatFromPath(const std::string &output, CaptureFormat &format);
+  // Checks that `output` has at most one integer conversion (%d, %05d) and
+  // nothing else printf would read; without one, "_%05d" goes before the
+  // extension. The result is safe to pass to snprintf with a frame number
+  static bool framePattern(const std::string &output, std::string &pattern);
+
+  // Queues a readback of the current read framebuffer; call before swapping
+  void capture();
+  // Waits for every pending frame to be written and stops the encoder
+  void finish();
+
+private:
+  struct Slot {
+    GLuint buffer = 0;
+    GLsync fence = nullptr;
+    uint64_t frame = 0;
+  };
+  struct Frame {
+    uint64_t index;
+    std::vector<unsigned char> pixels; // RGBA, bottom row first
+  };
+
+  std::string output;
+  int framesPerSecond;
+  std::vector<Slot> ring;
+  size_t nextSlot = 0;
+  bool finished = false;
+
+  std::thread encoder;
+  std::mutex mutex;
+  std::condition_variable queueChanged;
+  std::deque<Frame> queue;
+  std::vector<std::vector<unsigned char>> freeBuffers;
+  bool stopping = false;
+  static const size_t MAX_QUEUED_FRAMES = 8;
+
+  FILE *stream = nullptr; // Y4M only
+
+  void readSlot(Slot &slot, bool wait);
+  void encoderLoop();
+  bool encode(const Frame &frame);
+};
+
+// RGBA8 rows, bottom row first as glReadPixels returns them
+bool writePPM(const char *path, int width, int height,
+              const unsigned char *rgba);
+bool writePNG(const char *path, int width, int height,
+              const unsigned char *rgba);
+
+#endif // !FRAME_CAPTURE_H
@@ -0,0 +1,54 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <cstdint>
+
+/* Reloj de frame con paso fijo. La simulacion siempre avanza de a fixedStep
+ * segundos, sin importar cuanto tarde cada frame; el render corre a la
+ * velocidad que pueda y usa alpha() para interpolar entre los dos ultimos
+ * estados simulados. Asi el comportamiento no cambia con el frame rate.
+ *
+ *   int steps = clock.advance(glfwGetTime());
+ *   for (int i = 0; i < steps; i++) {
+ *     previous = current;
+ *     simulate(current, clock.fixedStep);
+ *   }
+ *   draw(lerp(previous, current, clock.alpha()));
+ */
+class FrameClock {
+public:
+  double fixedStep;
+  // Frames mas largos que esto se recortan para no entrar en espiral
+  // (por ejemplo al volver de un breakpoint o al mover la ventana)
+  double maxFrameTime;
+
+  // Seconds of the last frame, after clamping
+  double frameTime = 0.0;
+  double simulationTime = 0.0;
+  uint64_t frameCount = 0;
+  uint64_t stepCount = 0;
+
+  explicit FrameClock(double fixedStep = 1.0 / 60.0,
+                      double maxFrameTime = 0.25);
+
+  // Call once per frame with the current time in seconds; returns how many
+  // fixed steps the simulation has to run this frame
+  int advance(double now);
+
+  // Fraction of a step left over, in [0, 1)
+  double alpha() const { return accumulator / fixedStep; }
+
+  void reset();
+
+private:
+  double lastTime = 0.0;
+  double accumulator = 0.0;
+  bool started = false;
+};
+
+template <typename T> T interpolate(const T &previous, const T &current,
+                                    double alpha) {
+  return previous + (current - previous) * (float)alpha;
+}
+
+#endif // !FRAME_CLOCK_H
@@ -0,0 +1,55 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include "MathUtils.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Frustum culling de muchos objetos en CPU.
+ *
+ * Cada objeto tiene una AABB (centro + semiejes) y una esfera con el mismo
+ * centro, guardadas en formato SoA: un arreglo por componente, asi 8 objetos
+ * consecutivos se cargan con una sola instruccion por componente. Un objeto
+ * es visible si la esfera y la AABB cortan o estan dentro de los 6 planos;
+ * la esfera sirve cuando es mas ajustada que la caja (objetos redondos), la
+ * caja en el resto.
+ *
+ * cull() usa AVX2 + FMA si la CPU los tiene (se elige en runtime, el
+ * binario no necesita -mavx2), si no SSE2, y un loop escalar fuera de x86.
+ * Los objetos se reparten en bloques entre los hilos de JobSystem: una
+ * primera pasada escribe un byte de mascara por cada 8 objetos y cuenta los
+ * visibles por bloque, y la segunda expande las mascaras a indices en su
+ * lugar de la lista final, que queda compacta y en orden. */
+class FrustumCuller {
+public:
+  // Centro y semiejes de la AABB, y radio de la esfera
+  std::vector<float> centerX, centerY, centerZ;
+  std::vector<float> extentX, extentY, extentZ;
+  std::vector<float> radius;
+
+  // Indices de los objetos visibles en el ultimo cull(), en orden
+  std::vector<uint32_t> visible;
+
+  // Returns the object index. A negative radius uses the half diagonal
+  uint32_t add(const Vec3 &boundsMin, const Vec3 &boundsMax,
+               float sphereRadius = -1.0f);
+  void update(uint32_t index, const Vec3 &boundsMin, const Vec3 &boundsMax,
+              float sphereRadius = -1.0f);
+  void reserve(size_t count);
+  void clear();
+  size_t size() const { return count; }
+
+  // Fills `visible` and returns how many objects passed
+  size_t cull(const Frustum &frustum);
+
+  // "avx2", "sse2" or "scalar", whichever cull() runs on this CPU
+  static const char *implementation();
+
+private:
+  size_t count = 0;
+  std::vector<uint8_t> masks;
+  std::vector<uint32_t> blockVisible;
+};
+
+#endif // !FRUSTUM_CULLER_H
@@ -0,0 +1,16 @@
+#ifndef GL_COMMAND_EXECUTOR_H
+#define GL_COMMAND_EXECUTOR_H
+
+#include "CommandList.h"
+#include "GLStateCache.h"
+#include <vector>
+
+// Replays a command list with OpenGL; call only from the thread that owns
+// the context. Handles are interpreted as GL object names.
+void executeCommandList(const CommandList &list, GLStateCache &state);
+
+// Replays several lists back to back, in the order given
+void executeCommandLists(const std::vector<CommandList> &lists,
+                         GLStateCache &state);
+
+#endif // !GL_COMMAND_EXECUTOR_H
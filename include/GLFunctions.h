@@ -0,0 +1,134 @@
+#ifndef GL_FUNCTIONS_H
+#define GL_FUNCTIONS_H
+
+/* Lista X-macro de los entry points GL que usa el motor, compartida por
+ * GLIntercept (estadisticas) y GLTrace (grabar y reproducir). Agregar una
+ * funcion es agregar una linea; el tipo sale de decltype(glad_gl<nombre>).
+ * Mientras GLTrace graba, las funciones que no estan aca no llegan al
+ * driver (ver GLTrace.h): todo lo que llama el motor tiene que estar.
+ *
+ * X(nombre, tipos, objeto). `tipos` tiene un caracter para el valor de
+ * retorno y uno por argumento, que GLTrace usa para serializar y para
+ * traducir nombres de objetos al reproducir:
+ *
+ *   -  retorno ignorado          v  valor tal cual
+ *   b  buffer    t  textura      a  vertex array   f  framebuffer
+ *   r  renderbuffer  q  query    p  programa       s  shader
+ *   y  GLsync    l  uniform location del programa activo
+ *   m  puntero de glMapBufferRange
+ *   o  puntero que es un offset dentro de un buffer enlazado
+ *   d  datos de entrada (se guardan en la traza)
+ *   D  como d, pero es un offset si hay un GL_PIXEL_UNPACK_BUFFER
+ *   w  salida (al reproducir apunta a memoria temporal)
+ *   W  como w, pero es un offset si hay un GL_PIXEL_PACK_BUFFER
+ *   c  puntero del proceso que graba (callback, user param): la llamada
+ *      no se reproduce
+ *   S  arreglo de strings, tantos como el argumento anterior
+ *   x  largos de los strings (se reproducen terminados en cero)
+ *   G  nombres generados, N  nombres a borrar; de tipo `objeto`, tantos
+ *      como el argumento anterior */
+#define GL_FUNCTIONS(X)                                                       \
+  X(ActiveTexture, "-v", 0)                                                   \
+  X(AttachShader, "-ps", 0)                                                   \
+  X(BindBuffer, "-vb", 0)                                                     \
+  X(BindBufferBase, "-vvb", 0)                                                \
+  X(BindFramebuffer, "-vf", 0)                                                \
+  X(BindRenderbuffer, "-vr", 0)                                               \
+  X(BindTexture, "-vt", 0)                                                    \
+  X(BindVertexArray, "-a", 0)                                                 \
+  X(BlendFunc, "-vv", 0)                                                      \
+  X(BlitFramebuffer, "-vvvvvvvvvv", 0)                                        \
+  X(BufferData, "-vvdv", 0)                                                   \
+  X(BufferSubData, "-vvvd", 0)                                                \
+  X(CheckFramebufferStatus, "-v", 0)                                          \
+  X(Clear, "-v", 0)                                                           \
+  X(ClearBufferData, "-vvvvd", 0)                                             \
+  X(ClearColor, "-vvvv", 0)                                                   \
+  X(ClientWaitSync, "-yvv", 0)                                                \
+  X(CompileShader, "-s", 0)                                                   \
+  X(CreateProgram, "p", 0)                                                    \
+  X(CreateShader, "sv", 0)                                                    \
+  X(DebugMessageCallback, "-cc", 0)                                           \
+  X(DebugMessageControl, "-vvvvdv", 0)                                        \
+  X(DeleteBuffers, "-vN", 'b')                                                \
+  X(DeleteFramebuffers, "-vN", 'f')                                           \
+  X(DeleteProgram, "-p", 0)                                                   \
+  X(DeleteQueries, "-vN", 'q')                                                \
+  X(DeleteRenderbuffers, "-vN", 'r')                                          \
+  X(DeleteShader, "-s", 0)                                                    \
+  X(DeleteSync, "-y", 0)                                                      \
+  X(DeleteTextures, "-vN", 't')                                               \
+  X(DeleteVertexArrays, "-vN", 'a')                                           \
+  X(DepthMask, "-v", 0)                                                       \
+  X(Disable, "-v", 0)                                                         \
+  X(DispatchCompute, "-vvv", 0)                                               \
+  X(DrawArrays, "-vvv", 0)                                                    \
+  X(DrawElements, "-vvvo", 0)                                                 \
+  X(DrawElementsBaseVertex, "-vvvov", 0)                                      \
+  X(DrawElementsInstanced, "-vvvov", 0)                                       \
+  X(Enable, "-v", 0)                                                          \
+  X(EnableVertexAttribArray, "-v", 0)                                         \
+  X(FenceSync, "yvv", 0)                                                      \
+  X(Finish, "-", 0)                                                           \
+  X(Flush, "-", 0)                                                            \
+  X(FramebufferRenderbuffer, "-vvvr", 0)                                      \
+  X(FramebufferTexture2D, "-vvvtv", 0)                                        \
+  X(GenBuffers, "-vG", 'b')                                                   \
+  X(GenFramebuffers, "-vG", 'f')                                              \
+  X(GenQueries, "-vG", 'q')                                                   \
+  X(GenRenderbuffers, "-vG", 'r')                                             \
+  X(GenTextures, "-vG", 't')                                                  \
+  X(GenVertexArrays, "-vG", 'a')                                              \
+  X(GenerateMipmap, "-v", 0)                                                  \
+  X(GetIntegerv, "-vw", 0)                                                    \
+  X(GetInteger64v, "-vw", 0)                                                  \
+  X(GetProgramInfoLog, "-pvww", 0)                                            \
+  X(GetProgramiv, "-pvw", 0)                                                  \
+  X(GetQueryObjectiv, "-qvw", 0)                                              \
+  X(GetQueryObjectui64v, "-qvw", 0)                                           \
+  X(GetShaderInfoLog, "-svww", 0)                                             \
+  X(GetShaderiv, "-svw", 0)                                                   \
+  X(GetString, "-v", 0)                                                       \
+  X(GetStringi, "-vv", 0)                                                     \
+  X(GetUniformLocation, "lpd", 0)                                             \
+  X(IsEnabled, "-v", 0)                                                       \
+  X(LinkProgram, "-p", 0)                                                     \
+  X(MapBufferRange, "mvvvv", 0)                                               \
+  X(MemoryBarrier, "-v", 0)                                                   \
+  X(MultiDrawElements, "-vdvdv", 0)                                           \
+  X(MultiDrawElementsIndirect, "-vvovv", 0)                                   \
+  X(MultiDrawElementsIndirectCount, "-vvovvv", 0)                             \
+  X(PixelStorei, "-vv", 0)                                                    \
+  X(PolygonMode, "-vv", 0)                                                    \
+  X(QueryCounter, "-qv", 0)                                                   \
+  X(ReadPixels, "-vvvvvvW", 0)                                                \
+  X(RenderbufferStorage, "-vvvv", 0)                                          \
+  X(ShaderSource, "-svSx", 0)                                                 \
+  X(TexBuffer, "-vvb", 0)                                                     \
+  X(TexImage2D, "-vvvvvvvvD", 0)                                              \
+  X(TexImage3D, "-vvvvvvvvvD", 0)                                             \
+  X(TexSubImage2D, "-vvvvvvvvD", 0)                                           \
+  X(TexParameteri, "-vvv", 0)                                                 \
+  X(Uniform1f, "-lv", 0)                                                      \
+  X(Uniform1i, "-lv", 0)                                                      \
+  X(Uniform1ui, "-lv", 0)                                                     \
+  X(Uniform2f, "-lvv", 0)                                                     \
+  X(Uniform3f, "-lvvv", 0)                                                    \
+  X(Uniform3i, "-lvvv", 0)                                                    \
+  X(Uniform4f, "-lvvvv", 0)                                                   \
+  X(Uniform4fv, "-lvd", 0)                                                    \
+  X(UniformMatrix4fv, "-lvvd", 0)                                             \
+  X(UnmapBuffer, "-v", 0)                                                     \
+  X(UseProgram, "-p", 0)                                                      \
+  X(VertexAttribDivisor, "-vv", 0)                                            \
+  X(VertexAttribPointer, "-vvvvvo", 0)                                        \
+  X(Viewport, "-vvvv", 0)
+
+enum GLFunction {
+#define GL_FUNCTION_ENUM(name, kinds, object) GL_FN_##name,
+  GL_FUNCTIONS(GL_FUNCTION_ENUM)
+#undef GL_FUNCTION_ENUM
+  GL_FN_COUNT
+};
+
+#endif // !GL_FUNCTIONS_H
@@ -0,0 +1,46 @@
+#ifndef GL_INTERCEPT_H
+#define GL_INTERCEPT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Capa opcional de instrumentacion sobre los punteros glad_gl* de glad.
+ *
+ * install() reemplaza cada puntero de la lista (ver GLFunctions.h) por un
+ * envoltorio que cuenta la llamada, mide el tiempo de CPU que pasa dentro
+ * del driver y marca las llamadas redundantes: glUseProgram del programa ya
+ * activo, glBindTexture de la textura ya enlazada, glEnable de algo ya
+ * habilitado, etc. Si nunca se llama a install() los punteros quedan como
+ * los dejo glad y el costo es cero.
+ *
+ * Se llama despues de gladLoadGLLoader (que vuelve a escribir los punteros)
+ * y antes de crear otros hilos que usen GL. El estado para detectar
+ * redundancias es por hilo, o sea se asume un contexto por hilo; los
+ * contadores son globales y suman todos los hilos.
+ *
+ * endFrame() cierra el frame actual; report() devuelve promedios por frame
+ * desde el ultimo report(). */
+class GLIntercept {
+public:
+  struct EntryStats {
+    const char *name;
+    double calls = 0.0;     // por frame
+    double redundant = 0.0; // por frame
+    double cpuUs = 0.0;     // por frame
+    uint64_t maxCalls = 0;  // el peor frame
+  };
+
+  static bool install();
+  static void uninstall();
+  static bool installed();
+
+  static void endFrame();
+
+  // Entry points used since the last report, most expensive first
+  static std::vector<EntryStats> collect(uint64_t *frames = nullptr);
+  static std::string report(size_t top = 12);
+};
+
+#endif // !GL_INTERCEPT_H
@@ -0,0 +1,51 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+/* Copia en CPU del estado de OpenGL que mas cambia entre draws. Cada setter
+ * compara con el valor guardado y solo llama al driver si cambio, asi un
+ * recorrido ordenado de draws no repite binds. Si otro codigo toca el estado
+ * por fuera hay que llamar a invalidate(). */
+class GLStateCache {
+public:
+  static const int MAX_TEXTURE_UNITS = 16;
+
+  // Llamadas al driver hechas y evitadas desde el ultimo resetStats()
+  size_t changes = 0;
+  size_t redundant = 0;
+
+  GLStateCache() { invalidate(); }
+
+  void useProgram(unsigned int program);
+  void bindVertexArray(unsigned int VAO);
+  void bindTexture(int unit, GLenum target, unsigned int texture);
+  void setBlend(bool enabled);
+  void setDepthTest(bool enabled);
+  void setDepthWrite(bool enabled);
+  void setCullFace(bool enabled);
+
+  // Forget everything; the next call of each setter always reaches GL
+  void invalidate();
+  void resetStats() {
+    changes = 0;
+    redundant = 0;
+  }
+
+private:
+  unsigned int program;
+  unsigned int vertexArray;
+  int activeUnit;
+  unsigned int textures[MAX_TEXTURE_UNITS];
+  GLenum textureTargets[MAX_TEXTURE_UNITS];
+  // -1 = desconocido, 0 = apagado, 1 = encendido
+  int blend;
+  int depthTest;
+  int depthWrite;
+  int cullFace;
+
+  void setCapability(GLenum capability, int &current, bool enabled);
+};
+
+#endif // !GL_STATE_CACHE_H
@@ -0,0 +1,88 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* Grabacion de llamadas GL a un archivo binario y reproduccion sin la app.
+ *
+ * GLTrace::start() envuelve los punteros glad_gl* de GLFunctions.h, igual
+ * que GLIntercept, y escribe cada llamada con sus argumentos y los datos a
+ * los que apuntan (vertices, pixeles de texturas, fuentes de shaders,
+ * uniforms). endFrame() marca el fin de un frame con su tiempo.
+ *
+ * Se graba desde que se llama a start(): los objetos creados antes no
+ * estan en la traza, asi que conviene llamarlo justo despues de cargar
+ * glad. Las llamadas de todos los hilos van en orden a la misma traza y se
+ * reproducen en un solo contexto, por eso el hilo de subidas tiene que estar
+ * apagado mientras se graba. Lo que se escribe en un mapeo de
+ * glMapBufferRange se guarda al hacer glUnmapBuffer; los mapeos persistentes
+ * que nunca se desmapean no quedan en la traza.
+ *
+ * Lo que no esta en GLFunctions.h no se podria reproducir: mientras se graba
+ * start() recarga glad con `load` y esos entry points apuntan a una trampa
+ * que imprime ERROR::GL_TRACE::UNTRACED con el nombre y no llama al driver.
+ * stop() los devuelve al driver.
+ *
+ * GLTracePlayer lee la traza (mapeada con MappedFile) y la vuelve a ejecutar
+ * frame por frame, traduciendo los nombres de objetos grabados a los que
+ * genera el driver al reproducir. */
+class GLTrace {
+public:
+  // Size of the default framebuffer, stored in the header for the player.
+  // `load` is the loader glad was loaded with
+  static bool start(const char *path, int width, int height,
+                    void *(*load)(const char *));
+  static void endFrame();
+  static void stop();
+  static bool recording();
+};
+
+class GLTracePlayer {
+public:
+  bool isValid = false;
+  int width = 0, height = 0;
+  uint64_t frameIndex = 0;
+  // Framebuffer that stands in for the recorded default framebuffer (and for
+  // framebuffers created before recording started)
+  unsigned int defaultFramebuffer = 0;
+
+  explicit GLTracePlayer(const char *path);
+
+  GLTracePlayer(const GLTracePlayer &) = delete;
+  GLTracePlayer &operator=(const GLTracePlayer &) = delete;
+
+  /* Ejecuta las llamadas hasta el proximo fin de frame. Devuelve false al
+   * llegar al final de la traza; recordedTimeNs es el momento en que termino
+   * ese frame al grabar, contado desde start() */
+  bool playFrame(uint64_t *recordedTimeNs = nullptr);
+  bool finished() const { return cursor >= end; }
+
+private:
+  struct Mapping {
+    uint32_t target;
+    void *pointer;
+    size_t length;
+  };
+
+  MappedFile file;
+  const uint8_t *cursor = nullptr;
+  const uint8_t *end = nullptr;
+
+  // Nombre grabado -> nombre al reproducir, uno por tipo de objeto
+  std::unordered_map<uint32_t, uint32_t> names[8];
+  std::unordered_map<uint64_t, void *> syncs;
+  // (programa, location grabada) -> location al reproducir
+  std::unordered_map<uint64_t, int32_t> locations;
+  uint32_t currentProgram = 0;
+  uint32_t packBuffer = 0;
+  std::vector<Mapping> mappings;
+  std::vector<uint8_t> scratch;
+
+  uint32_t translate(char kind, uint32_t name);
+};
+
+#endif // !GL_TRACE_H
@@ -0,0 +1,106 @@
+#ifndef GLTF_LOADER_H
+#define GLTF_LOADER_H
+
+#include "MappedFile.h"
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+/* Cargador de glTF 2.0 binario (.glb). El archivo se mapea en memoria y los
+ * bufferViews se suben a la GPU directamente desde el chunk BIN mapeado, sin
+ * copias intermedias. Los meshes se parsean y las imagenes se decodifican en
+ * paralelo; la subida a OpenGL se hace en el hilo que tiene el contexto.
+ *
+ * Los atributos usan las mismas locations que texture.vert:
+ *   0 = POSITION, 1 = COLOR_0, 2 = TEXCOORD_0, 3 = NORMAL */
+
+struct GltfBufferView {
+  uint32_t byteOffset = 0;
+  uint32_t byteLength = 0;
+  uint32_t byteStride = 0;
+  GLenum target = 0;
+  unsigned int buffer = 0; // GL buffer object, 0 if never referenced
+};
+
+struct GltfAccessor {
+  int bufferView = -1;
+  uint32_t byteOffset = 0;
+  GLenum componentType = GL_FLOAT;
+  uint32_t count = 0;
+  int components = 1;
+  bool normalized = false;
+};
+
+struct GltfPrimitive {
+  int position = -1;
+  int normal = -1;
+  int texcoord = -1;
+  int color = -1;
+  int indices = -1;
+  int material = -1;
+  GLenum mode = GL_TRIANGLES;
+  unsigned int VAO = 0;
+};
+
+struct GltfMesh {
+  std::string name;
+  std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfMaterial {
+  int baseColorImage = -1;
+  float baseColorFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+};
+
+struct GltfImage {
+  int bufferView = -1;
+  int width = 0;
+  int height = 0;
+  unsigned char *pixels = nullptr; // RGBA8, freed after the upload
+  unsigned int texture = 0;
+};
+
+class GltfModel {
+public:
+  bool isValid = false;
+
+  std::vector<GltfBufferView> bufferViews;
+  std::vector<GltfAccessor> accessors;
+  std::vector<GltfMesh> meshes;
+  std::vector<GltfMaterial> materials;
+  std::vector<GltfImage> images;
+
+  // Tiempos de la ultima carga en milisegundos. decodeMs es tiempo de reloj
+  // de la decodificacion de imagenes, que corre en paralelo
+  double parseMs = 0.0;
+  double decodeMs = 0.0;
+  double uploadMs = 0.0;
+  double totalMs = 0.0;
+
+  // Loads and uploads the file, needs a current GL context
+  explicit GltfModel(const char *path);
+  ~GltfModel();
+
+  GltfModel(const GltfModel &) = delete;
+  GltfModel &operator=(const GltfModel &) = delete;
+
+  // Draws every primitive, binding the base color texture on unit 0
+  void draw() const;
+  void drawMesh(size_t index) const;
+
+private:
+  MappedFile file;
+  const char *json = nullptr;
+  uint32_t jsonLength = 0;
+  const uint8_t *bin = nullptr;
+  uint32_t binLength = 0;
+
+  bool readChunks(const char *path);
+  bool parse();
+  // Accessors with data in range and indices below the vertex count
+  bool validPrimitive(const GltfPrimitive &primitive) const;
+  void upload();
+  void release();
+};
+
+#endif // !GLTF_LOADER_H
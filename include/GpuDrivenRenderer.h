@@ -0,0 +1,81 @@
+#ifndef GPU_DRIVEN_RENDERER_H
+#define GPU_DRIVEN_RENDERER_H
+
+#include "MathUtils.h"
+#include "Shader.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <memory>
+
+/* Camino de dibujo dirigido por la GPU (GL 4.3+). Todos los objetos viven en
+ * un SSBO con su esfera envolvente y los parametros de su draw. Un compute
+ * shader (cull.comp) hace frustum culling y compacta los comandos
+ * DrawElementsIndirectCommand de los visibles; despues un unico
+ * glMultiDrawElementsIndirect dibuja todo. En el vertex shader gl_DrawID
+ * indexa la lista de visibles para leer los datos del objeto.
+ *
+ * Todos los meshes tienen que compartir un VAO (un VBO y un EBO grandes),
+ * cada objeto apunta a su rango con firstIndex/baseVertex.
+ *
+ * Ademas de GL 4.3 necesita GL_ARB_shader_draw_parameters (gl_DrawIDARB en
+ * gpu_driven.vert). Sin eso el constructor no crea nada y deja isValid en
+ * false; supported() permite decidirlo antes. */
+
+// Mirrors `struct Object` in cull.comp and gpu_driven.vert (std430)
+struct GpuObject {
+  float center[3];
+  float radius;
+  unsigned int indexCount;
+  unsigned int firstIndex;
+  int baseVertex;
+  unsigned int padding;
+  float model[16];
+};
+
+// Layout fijo que espera glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+  unsigned int count;
+  unsigned int instanceCount;
+  unsigned int firstIndex;
+  int baseVertex;
+  unsigned int baseInstance;
+};
+
+const GLuint GPU_DRIVEN_OBJECTS_BINDING = 0;
+const GLuint GPU_DRIVEN_COMMANDS_BINDING = 1;
+const GLuint GPU_DRIVEN_VISIBLE_BINDING = 2;
+const GLuint GPU_DRIVEN_COUNT_BINDING = 3;
+
+class GpuDrivenRenderer {
+public:
+  bool isValid = false;
+  size_t maxObjects;
+  size_t objectCount = 0;
+
+  explicit GpuDrivenRenderer(size_t maxObjects,
+                             const char *cullShaderPath = "shaders/cull.comp");
+  ~GpuDrivenRenderer();
+
+  GpuDrivenRenderer(const GpuDrivenRenderer &) = delete;
+  GpuDrivenRenderer &operator=(const GpuDrivenRenderer &) = delete;
+
+  // GL 4.3 and GL_ARB_shader_draw_parameters on the current context
+  static bool supported();
+
+  void setObjects(const GpuObject *objects, size_t count);
+  void updateObject(size_t index, const GpuObject &object);
+
+  // Compute pass: culls every object and writes the indirect commands
+  void cull(const Frustum &frustum);
+  // One multi-draw for all visible objects; the draw program must be in use
+  void draw(unsigned int VAO, GLenum indexType = GL_UNSIGNED_INT) const;
+
+private:
+  std::unique_ptr<Shader> cullShader;
+  unsigned int objectBuffer = 0;
+  unsigned int commandBuffer = 0;
+  unsigned int visibleBuffer = 0;
+  unsigned int countBuffer = 0;
+};
+
+#endif // !GPU_DRIVEN_RENDERER_H
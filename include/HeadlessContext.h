@@ -0,0 +1,67 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <functional>
+#include <vector>
+
+/* Contexto GL sin ventana para CI y maquinas sin display ni GPU. Usa EGL
+ * surfaceless (Mesa llvmpipe) si se compilo con HAVE_EGL, y si no OSMesa con
+ * HAVE_OSMESA. Como no hay framebuffer por defecto se dibuja en un FBO del
+ * tamaño pedido; bindFramebuffer() lo deja activo junto con el viewport.
+ *
+ * El constructor tambien carga glad con el loader del backend, asi que
+ * despues se puede usar el resto del codigo GL igual que con GLFW. */
+class HeadlessContext {
+public:
+  bool isValid = false;
+  const char *backend = "none";
+  int width, height;
+
+  unsigned int framebuffer = 0;
+  unsigned int colorBuffer = 0;
+  unsigned int depthBuffer = 0;
+  // The backend's loader, the one glad was loaded with
+  void *(*procAddress)(const char *) = nullptr;
+
+  // Requests a core profile context of at least major.minor; `debug` asks
+  // for a debug context (EGL only) for DebugOutput
+  HeadlessContext(int width, int height, int major = 3, int minor = 3,
+                  bool debug = false);
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext &) = delete;
+  HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+  bool makeCurrent();
+  void release();
+
+  void bindFramebuffer();
+  // Tightly packed RGBA8 rows, bottom row first (as glReadPixels returns)
+  void readPixels(std::vector<unsigned char> &pixels);
+
+private:
+  void *display = nullptr;
+  void *context = nullptr;
+  std::vector<unsigned char> osmesaBuffer;
+
+  bool createEGL(int major, int minor, bool debug);
+  bool createOSMesa(int major, int minor);
+  bool createFramebuffer();
+};
+
+struct HeadlessStats {
+  int frames = 0;
+  double totalMs = 0.0;
+  double minFrameMs = 0.0;
+  double maxFrameMs = 0.0;
+  double averageFrameMs = 0.0;
+  double framesPerSecond = 0.0;
+};
+
+/* Dibuja `frames` frames en el FBO con renderFrame(frame) y espera a la GPU
+ * con glFinish al final de cada uno, para que los tiempos sean reales.
+ * Imprime las estadisticas al terminar. */
+HeadlessStats runHeadless(HeadlessContext &context, int frames,
+                          const std::function<void(int frame)> &renderFrame);
+
+#endif // !HEADLESS_CONTEXT_H
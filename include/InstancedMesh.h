@@ -0,0 +1,55 @@
+#ifndef INSTANCED_MESH_H
+#define INSTANCED_MESH_H
+
+#include "StreamBuffer.h"
+#include <glad/glad.h>
+#include <cstddef>
+
+/* Atributos por instancia, uno por copia dibujada. Van intercalados en un
+ * StreamBuffer y se leen con glVertexAttribDivisor(location, 1):
+ *   3-6 = transform (mat4, columnas), 7 = uvRect, 8 = tint, 9 = layer
+ * Las locations 0-2 siguen siendo las del mesh (posicion, color, uv). */
+struct InstanceData {
+  float transform[16]; // column-major model matrix
+  float uvRect[4];     // offset.xy, scale.zw applied to the mesh UVs
+  float tint[4];       // multiplies the sampled color
+  float layer;         // texture array layer
+  float padding[3];
+};
+
+const GLuint INSTANCE_ATTRIBUTE_TRANSFORM = 3;
+const GLuint INSTANCE_ATTRIBUTE_UV_RECT = 7;
+const GLuint INSTANCE_ATTRIBUTE_TINT = 8;
+const GLuint INSTANCE_ATTRIBUTE_LAYER = 9;
+
+/* Dibuja muchas copias de un mesh con un solo glDrawElementsInstanced. El
+ * VAO es el del mesh (por ejemplo el quad de textures.cc); la clase le agrega
+ * los atributos por instancia apuntando al stream buffer. */
+class InstancedMesh {
+public:
+  unsigned int VAO;
+  GLsizei indexCount;
+  GLenum indexType;
+
+  InstancedMesh(unsigned int VAO, GLsizei indexCount, size_t maxInstances,
+                GLenum indexType = GL_UNSIGNED_INT);
+
+  // Uploads this frame's instances and draws them all in one call. Only
+  // the first maxInstances are drawn; the first overflow is reported
+  void draw(const InstanceData *instances, size_t count);
+
+  // Two-step variant: write straight into mapped memory, then draw.
+  // Returns nullptr if the buffer could not be mapped; endInstances() then
+  // draws nothing
+  InstanceData *beginInstances(size_t count);
+  void endInstances(size_t count);
+
+private:
+  StreamBuffer instanceBuffer;
+  size_t maxInstances;
+  bool reportedOverflow = false;
+
+  void pointAttributes(size_t byteOffset);
+};
+
+#endif // !INSTANCED_MESH_H
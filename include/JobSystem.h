@@ -0,0 +1,131 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Planificador de tareas compartido por todo el motor (decodificar texturas,
+ * procesar meshes, culling, animacion). Hay un pool fijo de hilos; cada hilo
+ * tiene su propia cola Chase-Lev y cuando se queda sin trabajo le roba a los
+ * demas. Las dependencias se expresan con JobCounter: un contador atomico que
+ * sube al encolar un job y baja cuando termina.
+ *
+ * El hilo principal es el que tiene el contexto GL: al principio el que crea
+ * el JobSystem, y cuando el contexto pasa a otro hilo (ver RenderThread) ese
+ * hilo lo reclama con setMainThread(). Los jobs encolados con
+ * runOnMainThread() solo corren ahi, dentro de runMainThreadJobs() o
+ * mientras ese hilo espera con wait().
+ *
+ * wait() no bloquea el hilo: mientras el contador no llega a cero ejecuta
+ * otros jobs, que cumple el mismo rol que esperar con fibras sin necesitar
+ * cambiar de stack. */
+
+struct Job;
+
+// Solo se puede destruir despues de que wait() sobre el haya vuelto
+class JobCounter {
+public:
+  JobCounter() = default;
+  JobCounter(const JobCounter &) = delete;
+  JobCounter &operator=(const JobCounter &) = delete;
+
+  bool done() const { return count.load(std::memory_order_acquire) == 0; }
+  int pending() const { return count.load(std::memory_order_acquire); }
+
+private:
+  friend class JobSystem;
+  std::atomic<int> count{0};
+  // Jobs encolados con runAfter() que esperan a que count llegue a cero
+  std::mutex mutex;
+  std::vector<Job *> waiting;
+};
+
+// Single-producer multi-consumer work-stealing deque (Chase-Lev)
+class WorkStealingDeque {
+public:
+  static const int64_t CAPACITY = 4096;
+
+  WorkStealingDeque();
+
+  bool push(Job *job); // owner thread only
+  Job *pop();          // owner thread only, LIFO
+  Job *steal();        // any thread, FIFO
+
+private:
+  std::atomic<int64_t> top{0};
+  std::atomic<int64_t> bottom{0};
+  std::unique_ptr<std::atomic<Job *>[]> buffer;
+};
+
+class JobSystem {
+public:
+  using JobFunction = std::function<void()>;
+  using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+  // workers = 0 uses hardware_concurrency - 1 (the main thread also works)
+  explicit JobSystem(size_t workers = 0);
+  ~JobSystem();
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // Instancia compartida, creada en el primer uso desde el hilo principal
+  static JobSystem &shared();
+
+  void run(JobFunction function, JobCounter *counter = nullptr);
+  // Starts `function` only once `dependency` reaches zero
+  void runAfter(JobCounter &dependency, JobFunction function,
+                JobCounter *counter = nullptr);
+  // Jobs that must run on the main thread (GL uploads, window calls)
+  void runOnMainThread(JobFunction function, JobCounter *counter = nullptr);
+
+  // Runs other jobs until `counter` reaches zero
+  void wait(JobCounter &counter);
+
+  // Splits [begin, end) in chunks of at least `grain` and waits for all
+  void parallelFor(size_t begin, size_t end, size_t grain,
+                   const RangeFunction &body);
+
+  // Drains the main-thread queue; call once per frame from the main loop
+  void runMainThreadJobs();
+
+  size_t workerCount() const { return workers.size(); }
+  bool isMainThread() const;
+  // The calling thread takes over the main-thread jobs; call it from the
+  // thread that just made the GL context current
+  void setMainThread();
+
+private:
+  std::vector<std::thread> workers;
+  // Cola 0 es del hilo principal, 1..N de cada worker
+  std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+  std::atomic<std::thread::id> mainThread;
+
+  // Jobs encolados desde hilos que no tienen cola propia, o con la cola llena
+  std::mutex injectMutex;
+  std::vector<Job *> injected;
+
+  std::mutex mainMutex;
+  std::vector<Job *> mainJobs;
+
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+  std::atomic<int> queuedJobs{0};
+  std::atomic<int> sleepingWorkers{0};
+  std::atomic<bool> stopping{false};
+
+  void schedule(Job *job);
+  Job *findJob(size_t self);
+  void execute(Job *job);
+  void workerLoop(size_t index);
+  int currentQueue() const;
+};
+
+#endif // !JOB_SYSTEM_H
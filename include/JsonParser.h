@@ -0,0 +1,68 @@
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/* Tokenizador JSON sin asignaciones de memoria, al estilo de jsmn. No copia
+ * ni decodifica nada: cada token apunta a un rango [start, end) del texto
+ * original, asi que el texto tiene que vivir mientras se usen los tokens.
+ *
+ * Las claves de un objeto son tokens String cuyo padre es el objeto, y el
+ * valor de cada clave es el token que sigue a la clave. */
+enum class JsonType : uint8_t { Undefined, Object, Array, String, Primitive };
+
+struct JsonToken {
+  JsonType type;
+  uint32_t start;
+  uint32_t end;
+  // Objects: number of keys. Arrays: number of elements. Keys: 1.
+  uint32_t size;
+  // Index of the first token after this token's subtree
+  uint32_t next;
+  int32_t parent;
+};
+
+enum JsonError {
+  JSON_ERROR_NOMEM = -1,   // not enough tokens were provided
+  JSON_ERROR_INVALID = -2, // invalid character or structure
+  JSON_ERROR_PARTIAL = -3  // text ended before the document was complete
+};
+
+// Tokenizes `json` into `tokens`. Returns the number of tokens used or a
+// negative JsonError. With tokens == nullptr it only counts how many tokens
+// the document needs, so callers can size the array once.
+int jsonTokenize(const char *json, size_t length, JsonToken *tokens,
+                 unsigned int maxTokens);
+
+// Read-only view over a tokenized document with small lookup helpers.
+struct JsonDocument {
+  const char *json = nullptr;
+  const JsonToken *tokens = nullptr;
+  int count = 0;
+
+  // Value token for `key` inside `object`, or -1
+  int find(int object, const char *key) const;
+  // i-th element of `array`, or -1
+  int element(int array, uint32_t i) const;
+  // First child (first key or first element), then walk with nextSibling()
+  int firstChild(int container) const;
+  int nextSibling(int token) const;
+
+  bool equals(int token, const char *text) const;
+  std::string_view asString(int token) const;
+  long long asInt(int token, long long fallback = 0) const;
+  double asNumber(int token, double fallback = 0.0) const;
+  bool asBool(int token, bool fallback = false) const;
+
+  // Shortcuts for the common "object.key" lookups
+  long long intField(int object, const char *key, long long fallback) const {
+    return asInt(find(object, key), fallback);
+  }
+  double numberField(int object, const char *key, double fallback) const {
+    return asNumber(find(object, key), fallback);
+  }
+};
+
+#endif // !JSON_PARSER_H
@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object, so pointers into data() can be handed straight to glBufferData.
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const char *path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  bool open(const char *path);
+  void close();
+
+  const uint8_t *data() const { return bytes; }
+  size_t size() const { return length; }
+  bool isValid() const { return bytes != nullptr; }
+
+private:
+  const uint8_t *bytes = nullptr;
+  size_t length = 0;
+};
+
+#endif // !MAPPED_FILE_H
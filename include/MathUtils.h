@@ -0,0 +1,149 @@
+#ifndef MATH_UTILS_H
+#define MATH_UTILS_H
+
+#include <cmath>
+
+/* Matematica minima para camara y culling. Las matrices son column-major
+ * como las espera OpenGL (glUniformMatrix4fv con transpose = GL_FALSE). */
+
+struct Vec3 {
+  float x = 0.0f, y = 0.0f, z = 0.0f;
+
+  Vec3() = default;
+  Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+  Vec3 operator+(const Vec3 &o) const { return {x + o.x, y + o.y, z + o.z}; }
+  Vec3 operator-(const Vec3 &o) const { return {x - o.x, y - o.y, z - o.z}; }
+  Vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
+  Vec3 &operator+=(const Vec3 &o) {
+    x += o.x;
+    y += o.y;
+    z += o.z;
+    return *this;
+  }
+};
+
+inline float dot(const Vec3 &a, const Vec3 &b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Vec3 cross(const Vec3 &a, const Vec3 &b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+
+inline float length(const Vec3 &v) { return std::sqrt(dot(v, v)); }
+
+inline Vec3 normalize(const Vec3 &v) {
+  float len = length(v);
+  return len > 0.0f ? v * (1.0f / len) : Vec3();
+}
+
+struct Mat4 {
+  float m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+  float &at(int row, int col) { return m[col * 4 + row]; }
+  float at(int row, int col) const { return m[col * 4 + row]; }
+
+  Mat4 operator*(const Mat4 &o) const {
+    Mat4 r;
+    for (int c = 0; c < 4; c++)
+      for (int row = 0; row < 4; row++)
+        r.at(row, c) = at(row, 0) * o.at(0, c) + at(row, 1) * o.at(1, c) +
+                       at(row, 2) * o.at(2, c) + at(row, 3) * o.at(3, c);
+    return r;
+  }
+
+  static Mat4 translate(const Vec3 &t) {
+    Mat4 r;
+    r.at(0, 3) = t.x;
+    r.at(1, 3) = t.y;
+    r.at(2, 3) = t.z;
+    return r;
+  }
+
+  static Mat4 scale(const Vec3 &s) {
+    Mat4 r;
+    r.at(0, 0) = s.x;
+    r.at(1, 1) = s.y;
+    r.at(2, 2) = s.z;
+    return r;
+  }
+
+  // fovY en radianes, igual que glm::perspective
+  static Mat4 perspective(float fovY, float aspect, float zNear, float zFar) {
+    Mat4 r;
+    float f = 1.0f / std::tan(fovY * 0.5f);
+    r.at(0, 0) = f / aspect;
+    r.at(1, 1) = f;
+    r.at(2, 2) = (zFar + zNear) / (zNear - zFar);
+    r.at(2, 3) = 2.0f * zFar * zNear / (zNear - zFar);
+    r.at(3, 2) = -1.0f;
+    r.at(3, 3) = 0.0f;
+    return r;
+  }
+
+  static Mat4 lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up) {
+    Vec3 f = normalize(center - eye);
+    Vec3 s = normalize(cross(f, up));
+    Vec3 u = cross(s, f);
+    Mat4 r;
+    r.at(0, 0) = s.x;
+    r.at(0, 1) = s.y;
+    r.at(0, 2) = s.z;
+    r.at(1, 0) = u.x;
+    r.at(1, 1) = u.y;
+    r.at(1, 2) = u.z;
+    r.at(2, 0) = -f.x;
+    r.at(2, 1) = -f.y;
+    r.at(2, 2) = -f.z;
+    r.at(0, 3) = -dot(s, eye);
+    r.at(1, 3) = -dot(u, eye);
+    r.at(2, 3) = dot(f, eye);
+    return r;
+  }
+};
+
+// Plano a*x + b*y + c*z + d = 0 con la normal apuntando hacia adentro
+struct Plane {
+  float a = 0.0f, b = 0.0f, c = 0.0f, d = 0.0f;
+
+  float distance(const Vec3 &p) const { return a * p.x + b * p.y + c * p.z + d; }
+};
+
+struct Frustum {
+  // left, right, bottom, top, near, far
+  Plane planes[6];
+
+  // Gribb/Hartmann: los planos salen de las filas de la matriz view-projection
+  static Frustum fromMatrix(const Mat4 &viewProjection) {
+    Frustum f;
+    for (int i = 0; i < 6; i++) {
+      int row = i / 2;
+      float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+      Plane &p = f.planes[i];
+      p.a = viewProjection.at(3, 0) + sign * viewProjection.at(row, 0);
+      p.b = viewProjection.at(3, 1) + sign * viewProjection.at(row, 1);
+      p.c = viewProjection.at(3, 2) + sign * viewProjection.at(row, 2);
+      p.d = viewProjection.at(3, 3) + sign * viewProjection.at(row, 3);
+      float len = std::sqrt(p.a * p.a + p.b * p.b + p.c * p.c);
+      if (len > 0.0f) {
+        p.a /= len;
+        p.b /= len;
+        p.c /= len;
+        p.d /= len;
+      }
+    }
+    return f;
+  }
+
+  bool intersectsSphere(const Vec3 &center, float radius) const {
+    for (const Plane &p : planes) {
+      if (p.distance(center) < -radius)
+        return false;
+    }
+    return true;
+  }
+};
+
+#endif // !MATH_UTILS_H
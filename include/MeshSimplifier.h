@@ -0,0 +1,85 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+
+/* Simplificacion de meshes por colapso de aristas con quadric error metrics
+ * (Garland-Heckbert). El error tiene en cuenta los atributos del vertice
+ * ademas de la posicion: para el layout intercalado de textures.cc
+ * (posicion, color, uv) cada vertice es un punto de 8 dimensiones y los
+ * colores/UVs se pesan con attributeWeights.
+ *
+ * Los vertices en bordes abiertos quedan fijos, asi las costuras de UV (que
+ * en el index buffer son bordes) no se abren. */
+
+struct SimplifyOptions {
+  // Floats per vertex; the first three are the position
+  size_t stride = 8;
+  // Floats after the position that take part in the error metric
+  size_t attributeCount = 5;
+  // One weight per attribute float, nullptr means 1.0 for all
+  const float *attributeWeights = nullptr;
+  // Stop when the next collapse would exceed this error (world units)
+  float maxError = 1e30f;
+};
+
+// Returns the simplified index buffer (same vertex buffer, fewer triangles)
+// and writes the largest collapse error to resultError if given.
+std::vector<unsigned int> simplifyMesh(const unsigned int *indices,
+                                       size_t indexCount,
+                                       const float *vertices,
+                                       size_t vertexCount,
+                                       size_t targetIndexCount,
+                                       const SimplifyOptions &options,
+                                       float *resultError = nullptr);
+
+struct LodLevel {
+  size_t indexOffset; // first index inside LodChain::indices
+  size_t indexCount;
+  float error;        // geometric error relative to the source mesh
+};
+
+// Todas las LODs comparten el vertex buffer y sus indices van juntos en un
+// solo EBO: cada nivel es un glDrawElements con otro offset.
+struct LodChain {
+  std::vector<unsigned int> indices;
+  std::vector<LodLevel> levels;
+};
+
+// Cook step: each level keeps `reduction` of the previous level's triangles
+LodChain generateLodChain(const unsigned int *indices, size_t indexCount,
+                          const float *vertices, size_t vertexCount,
+                          const SimplifyOptions &options, size_t maxLevels = 6,
+                          float reduction = 0.5f);
+
+/* Elige la LOD de cada objeto a partir de su error proyectado en pixeles.
+ * Para bajar de calidad el error tiene que quedar por debajo del umbral con
+ * un margen (hysteresis), asi un objeto en el limite no alterna entre dos
+ * niveles en cada frame. */
+class LodSelector {
+public:
+  float pixelThreshold;
+  float hysteresis;
+
+  explicit LodSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f);
+
+  // Projected error in pixels of a world-space error at `distance`
+  static float projectedError(float error, float distance, float fovY,
+                              float viewportHeight);
+
+  // Level to draw for `object` this frame; remembers it for the next one
+  size_t select(size_t object, const LodChain &chain, float distance,
+                float fovY, float viewportHeight);
+  // Same, for `levelCount` levels given how many pixels one unit of error
+  // covers on screen. Different objects may be selected from different
+  // threads once reserve() made room for all of them
+  size_t select(size_t object, const LodLevel *levels, size_t levelCount,
+                float pixelsPerUnit);
+  void reserve(size_t objects);
+
+private:
+  std::vector<size_t> currentLevel;
+};
+
+#endif // !MESH_SIMPLIFIER_H
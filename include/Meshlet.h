@@ -0,0 +1,73 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include "MathUtils.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Divide un mesh indexado en clusters (meshlets) de hasta 64 vertices y 124
+ * triangulos. Cada cluster guarda una esfera envolvente y un cono de normales
+ * para poder descartarlo en CPU antes de dibujar. Los indices de todos los
+ * clusters quedan contiguos en un solo element buffer, asi el dibujo es un
+ * glMultiDrawElements sobre el mismo VAO que usaria glDrawElements. */
+
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet {
+  uint32_t vertexOffset;   // first entry in MeshletMesh::vertices
+  uint32_t vertexCount;
+  uint32_t triangleOffset; // first entry in MeshletMesh::triangles / 3
+  uint32_t triangleCount;
+  uint32_t indexOffset;    // first index in the flattened element buffer
+};
+
+class MeshletMesh {
+public:
+  std::vector<Meshlet> meshlets;
+  // Global vertex index for each meshlet-local vertex
+  std::vector<uint32_t> vertices;
+  // Three meshlet-local indices per triangle
+  std::vector<uint8_t> triangles;
+  // Global indices grouped by meshlet, what ends up in the EBO
+  std::vector<unsigned int> indices;
+
+  // Bounds en formato SoA para el culling con SIMD
+  std::vector<float> centerX, centerY, centerZ, radius;
+  std::vector<float> coneX, coneY, coneZ, coneCutoff;
+
+  // Resultado del ultimo cull(), listo para glMultiDrawElements
+  std::vector<GLsizei> drawCounts;
+  std::vector<const void *> drawOffsets;
+
+  // `positions` points at the first position; `stride` is the vertex size
+  // in floats (8 for the interleaved layout used in textures.cc)
+  MeshletMesh(const unsigned int *sourceIndices, size_t indexCount,
+              const float *positions, size_t vertexCount, size_t stride,
+              size_t maxVertices = MESHLET_MAX_VERTICES,
+              size_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+  // Writes the flattened indices into EBO and attaches it to VAO
+  void uploadIndices(unsigned int VAO, unsigned int EBO) const;
+
+  // Rejects clusters outside the frustum or facing away from the camera
+  // and compacts the survivors into drawCounts/drawOffsets
+  size_t cull(const Frustum &frustum, const Vec3 &cameraPosition);
+
+  // Frustum test only, for meshes drawn without face culling. Const, so
+  // several threads can cull the same mesh: appends (first index, index
+  // count) pairs offset by `firstIndex`, merging clusters that are
+  // contiguous in the element buffer. Returns the visible cluster count
+  size_t cullRanges(const Frustum &frustum, uint32_t firstIndex,
+                    std::vector<uint32_t> &ranges) const;
+
+  // Un solo glMultiDrawElements con los clusters que sobrevivieron
+  void draw(unsigned int VAO) const;
+
+private:
+  void computeBounds(const float *positions, size_t stride);
+};
+
+#endif // !MESHLET_H
@@ -0,0 +1,89 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include "FrustumCuller.h"
+#include "MathUtils.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Occlusion culling en CPU, sin queries de GPU ni su latencia.
+ *
+ * Cada frame se rasterizan unos pocos oclusores elegidos (paredes, edificios:
+ * mallas grandes y de pocos triangulos) en un buffer de profundidad de baja
+ * resolucion, y despues se prueban contra el las cajas de los objetos: un
+ * objeto cuya parte mas cercana esta detras de todo lo que hay en los
+ * pixeles que cubre no se envia a GL.
+ *
+ * El buffer esta organizado en tiles de 8x4 pixeles (32 floats contiguos,
+ * una fila del tile es un registro AVX2) y es jerarquico: ademas de la
+ * profundidad por pixel se guarda la mas lejana de cada tile, y casi todas
+ * las pruebas se resuelven con ese valor sin mirar los pixeles. La
+ * rasterizacion evalua las funciones de arista de 8 pixeles por
+ * instruccion (AVX2 elegido en runtime, si no un loop escalar) y se reparte
+ * por filas de tiles entre los hilos de JobSystem; las pruebas de los
+ * objetos tambien corren en paralelo.
+ *
+ * Es conservador del lado de "visible": la profundidad de los oclusores se
+ * corre a la esquina mas lejana de cada pixel, los triangulos que cruzan el
+ * near plane no se rasterizan y los objetos que lo cruzan son visibles. La
+ * cobertura tambien es conservadora: un pixel de la resolucion baja cuenta
+ * como tapado solo si el triangulo lo cubre entero. Los kernels AVX2 y
+ * escalar hacen las mismas operaciones (fma explicitos) y llenan el mismo
+ * buffer. La profundidad es la de NDC llevada a [0, 1], 1 es el far
+ * plane. */
+class OcclusionCuller {
+public:
+  static const int TILE_WIDTH = 8;
+  static const int TILE_HEIGHT = 4;
+
+  // Multiples of the tile size
+  int width, height;
+  int tilesX, tilesY;
+  // Tiled depth, TILE_WIDTH * TILE_HEIGHT floats per tile, rows bottom-up
+  std::vector<float> depth;
+  // Farthest depth of each tile
+  std::vector<float> tileMaxDepth;
+
+  // Last frame
+  size_t occluderTriangles = 0;
+
+  OcclusionCuller(int width = 256, int height = 128);
+
+  // Clears the buffer and the occluder list
+  void beginFrame(const Mat4 &viewProjection);
+  // `stride` floats per vertex, position first. Indices are triangles
+  void addOccluder(const float *vertices, size_t stride,
+                   const uint32_t *indices, size_t indexCount,
+                   const Mat4 &model);
+  // Rasterizes the occluders added since beginFrame()
+  void rasterize();
+
+  // World space box against the rasterized occluders
+  bool isVisible(const Vec3 &boundsMin, const Vec3 &boundsMax) const;
+  // Filters `candidates` (indices into `objects`, e.g. objects.visible)
+  // into `visible`, keeping the order. Returns how many passed
+  size_t cull(const FrustumCuller &objects,
+              const std::vector<uint32_t> &candidates,
+              std::vector<uint32_t> &visible);
+
+  // "avx2" or "scalar", whichever rasterize() runs on this CPU
+  static const char *implementation();
+
+private:
+  // Triangulo en pixeles, listo para rasterizar: aristas y plano de
+  // profundidad como A * x + B * y + C
+  struct ScreenTriangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depthA, depthB, depthC;
+    int tileX0, tileY0, tileX1, tileY1; // inclusive
+  };
+
+  Mat4 viewProjection;
+  std::vector<ScreenTriangle> triangles;
+  std::vector<uint8_t> passed;
+
+  void rasterizeRows(size_t firstRow, size_t lastRow);
+};
+
+#endif // !OCCLUSION_CULLER_H
@@ -0,0 +1,32 @@
+#ifndef PERCENTILES_H
+#define PERCENTILES_H
+
+#include <algorithm>
+#include <vector>
+
+// Resumen de una serie de tiempos de frame (gl-bench, gl-replay)
+struct Percentiles {
+  double mean = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0;
+};
+
+// Nearest-rank percentiles; takes the samples by value because it sorts them
+inline Percentiles computePercentiles(std::vector<double> samples) {
+  Percentiles result;
+  if (samples.empty())
+    return result;
+  std::sort(samples.begin(), samples.end());
+  double sum = 0.0;
+  for (double sample : samples)
+    sum += sample;
+  result.mean = sum / samples.size();
+  auto rank = [&](double p) {
+    size_t index = (size_t)(p * samples.size() + 0.5);
+    return samples[std::min(samples.size() - 1, index > 0 ? index - 1 : 0)];
+  };
+  result.p50 = rank(0.50);
+  result.p95 = rank(0.95);
+  result.p99 = rank(0.99);
+  return result;
+}
+
+#endif // !PERCENTILES_H
@@ -0,0 +1,113 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Medicion de tiempos por pasada (clear, binds, draw, swap) en CPU y GPU.
+ *
+ * CPU: ProfileScope toma el tiempo al entrar y al salir. Se puede usar desde
+ * cualquier hilo.
+ * GPU: cada scope con gpu = true pone dos glQueryCounter(GL_TIMESTAMP). Las
+ * queries de un frame se leen varios frames despues (anillo de
+ * framesInFlight), y solo si ya estan disponibles; si no, ese frame se
+ * descarta en vez de esperar a la GPU. La parte GPU (beginFrame, endFrame,
+ * scopes con gpu y el destructor) tiene que correr en el hilo con el
+ * contexto.
+ *
+ * Los nombres tienen que vivir todo el programa (literales). summary()
+ * devuelve promedios por frame desde la ultima llamada; writeChromeTrace()
+ * escribe los eventos guardados en el formato de chrome://tracing y
+ * Perfetto. */
+class Profiler {
+public:
+  bool enabled = true;
+  bool gpuEnabled = true;
+
+  uint64_t frameIndex = 0;
+  uint64_t droppedGpuFrames = 0;
+  uint64_t droppedTraceEvents = 0;
+
+  explicit Profiler(size_t framesInFlight = 4,
+                    size_t maxTraceEvents = 200000);
+  ~Profiler();
+
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  void beginFrame();
+  void endFrame();
+
+  // Microseconds since the profiler was created
+  double now() const;
+  void addCpuEvent(const char *name, double startUs, double endUs);
+
+  // Returns a handle for endGpu, or -1 when GPU timing is off
+  int beginGpu(const char *name);
+  void endGpu(int handle);
+
+  // "frame 16.70 ms | draw 0.12/0.80 | ..." with CPU/GPU ms per frame
+  std::string summary();
+  bool writeChromeTrace(const char *path);
+
+private:
+  struct GpuQuery {
+    const char *name;
+    GLuint begin;
+    GLuint end;
+  };
+  struct GpuFrame {
+    std::vector<GpuQuery> queries;
+    size_t used = 0;
+    bool pending = false;
+  };
+  struct PassStats {
+    const char *name;
+    double cpuMs = 0.0;
+    double gpuMs = 0.0;
+  };
+  struct TraceEvent {
+    const char *name;
+    uint32_t thread;
+    double startUs;
+    double durationUs;
+  };
+
+  std::chrono::steady_clock::time_point origin;
+  std::vector<GpuFrame> gpuFrames;
+  GpuFrame *currentGpuFrame = nullptr;
+  double gpuOffsetUs = 0.0;
+  bool gpuCalibrated = false;
+  double frameStartUs = 0.0;
+
+  std::mutex mutex;
+  std::vector<PassStats> passes;
+  std::vector<TraceEvent> events;
+  size_t maxTraceEvents;
+  uint64_t framesSinceSummary = 0;
+
+  PassStats &pass(const char *name);
+  void collectGpuFrame(GpuFrame &frame);
+};
+
+class ProfileScope {
+public:
+  ProfileScope(Profiler *profiler, const char *name, bool gpu = false);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  Profiler *profiler;
+  const char *name;
+  double startUs = 0.0;
+  int gpuHandle = -1;
+};
+
+#endif // !PROFILER_H
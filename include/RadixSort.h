@@ -0,0 +1,20 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Clave de orden mas el indice del elemento al que pertenece
+struct SortItem {
+  uint64_t key;
+  uint32_t index;
+};
+
+/* LSD radix sort por bytes, estable: elementos con la misma clave mantienen
+ * el orden en que se enviaron. Las pasadas donde todas las claves comparten
+ * el mismo byte se saltan, asi claves con pocos bits usados cuestan poco.
+ * `scratch` se reutiliza entre frames para no asignar memoria. */
+void radixSort(std::vector<SortItem> &items, std::vector<SortItem> &scratch);
+
+#endif // !RADIX_SORT_H
@@ -0,0 +1,88 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "CommandList.h"
+#include "RadixSort.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Cola de draws con clave de orden de 64 bits. El codigo de escena solo
+ * envia paquetes con submit(); flush() los ordena con radix sort y los graba
+ * en una CommandList sin repetir el estado que no cambia, asi los cambios de
+ * estado quedan al minimo sin importar el orden en que se recorrio la
+ * escena. No llama a OpenGL: cada hilo puede llenar su propia cola.
+ *
+ * Clave (del bit mas alto al mas bajo):
+ *   opacos:       pass:4 | 0:1 | shader:11 | material:12 | texture:12 | depth:24
+ *   translucidos: pass:4 | 1:1 | depth invertida:24 | shader:11 | material:12 | texture:12
+ * Los opacos van de adelante hacia atras agrupados por estado; los
+ * translucidos de atras hacia adelante para que el blending sea correcto. */
+
+struct SortKeyFields {
+  uint32_t pass = 0;     // 0-15
+  bool translucent = false;
+  uint32_t shader = 0;   // 0-2047
+  uint32_t material = 0; // 0-4095
+  uint32_t texture = 0;  // 0-4095
+  float depth = 0.0f;    // normalized view depth, 0 = near, 1 = far
+};
+
+uint64_t makeSortKey(const SortKeyFields &fields);
+
+const int DRAW_PACKET_TEXTURES = 2;
+
+// Handles as in CommandList; triangles with 32-bit indices
+struct DrawPacket {
+  uint32_t program = 0;
+  uint32_t mesh = 0;
+  uint32_t textures[DRAW_PACKET_TEXTURES] = {0, 0}; // 0 keeps the bound one
+  uint32_t indexCount = 0;
+  uint32_t firstIndex = 0;
+  bool translucent = false; // blended, without depth writes
+  // Index ranges added with addRange(); if any, they replace
+  // firstIndex/indexCount and the packet becomes a multi-draw
+  uint32_t firstRange = 0;
+  uint32_t rangeCount = 0;
+  // Range inside the queue's uniform arena, filled by setUniform()
+  uint32_t firstUniform = 0;
+  uint32_t uniformCount = 0;
+};
+
+class RenderQueue {
+public:
+  // Estadisticas del ultimo flush()
+  size_t packetCount = 0;
+
+  // Returns the packet index so uniforms can be attached to it
+  size_t submit(uint64_t key, const DrawPacket &packet);
+
+  // Uniform values travel with the packet (location from the program)
+  void setUniform(size_t packet, int location, float x);
+  void setUniform(size_t packet, int location, float x, float y, float z,
+                  float w);
+  void setUniform(size_t packet, int location, int value);
+  // Draws several index ranges of the packet's mesh in one command
+  void addRange(size_t packet, uint32_t firstIndex, uint32_t indexCount);
+
+  // Sorts and records everything queued this frame, then clears the queue
+  void flush(CommandList &list);
+
+private:
+  struct UniformValue {
+    int location;
+    int components; // 1-4 floats, or 0 for an int
+    float value[4];
+    int intValue;
+  };
+
+  std::vector<DrawPacket> packets;
+  std::vector<UniformValue> uniforms;
+  std::vector<uint32_t> ranges; // first index, index count
+  std::vector<SortItem> order;
+  std::vector<SortItem> sortScratch;
+
+  void addUniform(size_t packet, const UniformValue &value);
+};
+
+#endif // !RENDER_QUEUE_H
@@ -0,0 +1,79 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+class Profiler;
+
+/* Todo lo que el hilo de render necesita para dibujar un frame. El hilo
+ * principal lo llena en cada tick de simulacion y lo publica; a partir de ahi
+ * es inmutable, el render trabaja sobre su propia copia. */
+struct FrameSnapshot {
+  uint64_t frameIndex = 0;
+  double time = 0.0;
+  int framebufferWidth = 0;
+  int framebufferHeight = 0;
+  float mixValue = 0.5f;
+};
+
+/* Hilo dedicado que es dueño del contexto GL de una ventana. El hilo
+ * principal se queda con los eventos de GLFW y la simulacion, y publica un
+ * FrameSnapshot por tick; mientras el render dibuja ese frame la simulacion
+ * ya avanza con el siguiente.
+ *
+ * Hay dos snapshots: el que se esta dibujando y el pendiente. publish()
+ * espera si el pendiente todavia no se consumio, asi la simulacion va como
+ * mucho un frame por delante del render.
+ *
+ * Mientras corre, el hilo de render es el hilo principal del JobSystem: los
+ * jobs de runOnMainThread() corren ahi, que es donde esta el contexto. */
+class RenderThread {
+public:
+  using RenderFunction = std::function<void(const FrameSnapshot &)>;
+
+  explicit RenderThread(GLFWwindow *window);
+  ~RenderThread();
+
+  RenderThread(const RenderThread &) = delete;
+  RenderThread &operator=(const RenderThread &) = delete;
+
+  // The calling thread must have released the context with
+  // glfwMakeContextCurrent(NULL). `render` runs on the render thread, which
+  // also sets the viewport and swaps buffers.
+  void start(RenderFunction render);
+
+  // Hands the next frame over; blocks while the previous one is pending
+  void publish(const FrameSnapshot &snapshot);
+
+  // Renders the pending snapshot, releases the context and joins; the
+  // calling thread gets the JobSystem main-thread jobs back
+  void stop();
+
+  bool isRunning() const { return thread.joinable(); }
+
+  // Only read after stop()
+  uint64_t framesRendered = 0;
+  // Optional; set before start(). Frames and swaps are timed on it
+  Profiler *profiler = nullptr;
+
+private:
+  GLFWwindow *window;
+  std::thread thread;
+  RenderFunction render;
+
+  std::mutex mutex;
+  std::condition_variable snapshotReady;
+  std::condition_variable snapshotTaken;
+  FrameSnapshot pending;
+  bool hasPending = false;
+  bool stopping = false;
+
+  void loop();
+};
+
+#endif // !RENDER_THREAD_H
@@ -0,0 +1,55 @@
+#ifndef SCENE_COOKER_H
+#define SCENE_COOKER_H
+
+#include "SceneImage.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Cocina la descripcion de una escena en JSON a la imagen binaria que lee
+ * SceneImage. Lo usa la herramienta scene-cook; los programas tambien
+ * aceptan el .json directo y lo cocinan en memoria (loadScene).
+ *
+ *   {
+ *     "textures":  [{"name": "wood", "path": "assets/container.jpg",
+ *                    "flipY": true, "wrap": ["repeat", "repeat"],
+ *                    "filter": ["linear_mipmap_linear", "linear"]}],
+ *     "materials": [{"name": "quad", "vertexShader": "shaders/texture.vert",
+ *                    "fragmentShader": "shaders/texture.frag",
+ *                    "textures": ["wood"], "translucent": false}],
+ *     "meshes":    [{"name": "quad", "vertices": [x, y, z, r, g, b, u, v,
+ *                    ...], "indices": [0, 1, 3, ...],
+ *                    "occluder": false, "lods": 4}],
+ *     "instances": [{"mesh": "quad", "material": "quad",
+ *                    "position": [0, 0, 0], "rotation": 0,
+ *                    "scale": [1, 1, 1]}],
+ *     "camera":    {"position": [0, 3, 8], "target": [0, 0, 0],
+ *                   "up": [0, 1, 0], "fovY": 60, "near": 0.1, "far": 100},
+ *     "lights":    [{"position": [0, 2, 0], "range": 8,
+ *                    "color": [1, 0.8, 0.6], "intensity": 2,
+ *                    "direction": [0, -1, 0], "spot": [20, 35]}]
+ *   }
+ *
+ * Las referencias entre objetos van por nombre o por indice. "rotation" es
+ * en grados alrededor de Z; en vez de position/rotation/scale se puede dar
+ * "transform" con las 12 componentes de una matriz 3x4 por filas. Las
+ * mallas "occluder" (paredes, edificios: grandes y cerradas) tapan a las
+ * demas en el occlusion culling de CPU. Cada malla se cocina con hasta
+ * "lods" niveles de detalle (4 por defecto, 1 = solo la malla completa),
+ * cada uno con la mitad de triangulos del anterior (ver MeshSimplifier.h);
+ * el runtime elige uno por instancia segun su error en pixeles.
+ *
+ * "camera" es opcional: sin ella las transformaciones de las instancias
+ * terminan en clip space, como el quad de siempre. Las "lights" (grados en
+ * "spot"; sin "spot" la luz es puntual) iluminan los materiales con
+ * shaders/clustered.vert y clustered.frag y necesitan una camara. Los
+ * errores se imprimen y cookScene devuelve false. */
+bool cookScene(const char *json, size_t length, std::vector<uint8_t> &image);
+
+// Maps a cooked scene, or cooks a .json in memory. Null if cooking fails;
+// check isValid for a cooked file that fails to load
+std::unique_ptr<SceneImage> loadScene(const std::string &path);
+
+#endif // !SCENE_COOKER_H
@@ -0,0 +1,184 @@
+#ifndef SCENE_IMAGE_H
+#define SCENE_IMAGE_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Escena cocinada: una imagen binaria plana que se mapea y se usa tal cual.
+ *
+ * scene-cook (ver SceneCooker.h) convierte la descripcion JSON de la escena
+ * en esta imagen. Todas las referencias son offsets o indices, nunca
+ * punteros, asi la imagen es relocatable: cargarla es un mmap, validar el
+ * header, resolver un puntero por seccion y una pasada lineal que valida
+ * las referencias (proporcional a la cantidad de indices, materiales e
+ * instancias; no se copia ni se convierte nada). Los vertices e indices van
+ * directo del mapeo a glBufferData.
+ *
+ * Layout (little endian, cada seccion alineada a SCENE_ALIGNMENT):
+ *   SceneHeader | strings | vertices | indices | textures | materials |
+ *   meshes | instances | lods | cameras | lights
+ * Los strings son terminados en '\0' y se referencian por su offset dentro
+ * de la seccion de strings. Al cargar se valida que los rangos de las
+ * mallas, sus indices y las referencias de materiales e instancias caigan
+ * dentro de la imagen; con una imagen valida no hace falta chequearlos. */
+
+const char SCENE_MAGIC[8] = {'S', 'C', 'E', 'N', 'E', 'I', 'M', 'G'};
+const uint32_t SCENE_VERSION = 3;
+const uint32_t SCENE_ALIGNMENT = 16;
+// Indice o string ausente
+const uint32_t SCENE_NONE = 0xffffffff;
+// position(3) color(3) uv(2), como los atributos de texture.vert
+const uint32_t SCENE_VERTEX_FLOATS = 8;
+const int SCENE_MATERIAL_TEXTURES = 2;
+// SceneMesh::flags: la malla se rasteriza como oclusor (ver OcclusionCuller)
+const uint32_t SCENE_MESH_OCCLUDER = 1u << 0;
+
+enum SceneSectionType : uint32_t {
+  SCENE_STRINGS,
+  SCENE_VERTICES,
+  SCENE_INDICES,
+  SCENE_TEXTURES,
+  SCENE_MATERIALS,
+  SCENE_MESHES,
+  SCENE_INSTANCES,
+  SCENE_LODS,
+  SCENE_CAMERAS,
+  SCENE_LIGHTS,
+  SCENE_SECTION_COUNT
+};
+
+struct SceneSection {
+  uint64_t offset; // bytes from the start of the image
+  uint64_t count;  // elements
+  uint32_t elementSize;
+  uint32_t reserved;
+};
+
+struct SceneHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t sectionCount;
+  uint64_t fileSize;
+  uint32_t vertexFloats;
+  uint32_t reserved;
+  SceneSection sections[SCENE_SECTION_COUNT];
+};
+
+struct SceneTexture {
+  uint32_t path; // string
+  uint32_t flipY;
+  // GL enums, resolved by the cooker
+  uint32_t wrapS, wrapT;
+  uint32_t minFilter, magFilter;
+};
+
+struct SceneMaterial {
+  uint32_t name, vertexShader, fragmentShader; // strings
+  uint32_t textures[SCENE_MATERIAL_TEXTURES];  // texture index or SCENE_NONE
+  uint32_t translucent;
+};
+
+struct SceneMesh {
+  uint32_t name; // string
+  // Indices are already rebased to the shared vertex section
+  uint32_t firstVertex, vertexCount;
+  // Full detail, the same range as the mesh's first LOD
+  uint32_t firstIndex, indexCount;
+  float boundsMin[3], boundsMax[3];
+  uint32_t flags; // SCENE_MESH_*
+  // Levels of detail, finest first; there is always at least one
+  uint32_t firstLod, lodCount;
+};
+
+// Un nivel de detalle: otros indices sobre los mismos vertices de la malla
+struct SceneLod {
+  uint32_t firstIndex, indexCount;
+  float error; // geometric error in mesh units, 0 for the full mesh
+  uint32_t reserved;
+};
+
+struct SceneInstance {
+  uint32_t mesh, material;
+  // Affine transform, 3 rows of a row-major 3x4 matrix
+  float transform[12];
+};
+
+/* Camara de la escena, a lo sumo una. Sin camara las transformaciones de
+ * las instancias ya terminan en clip space (view y projection identidad) */
+struct SceneCamera {
+  float position[3];
+  float fovY; // radians
+  float target[3];
+  float zNear;
+  float up[3];
+  float zFar;
+};
+
+// Luz puntual o spot para los materiales iluminados (ver ClusteredLighting)
+struct SceneLight {
+  float position[3]; // world space
+  float range;
+  float color[3];    // already multiplied by the intensity
+  float spotInner;   // cos of the inner cone angle
+  float direction[3];
+  float spotOuter;   // cos of the outer cone angle; <= -1 for point lights
+};
+
+static_assert(sizeof(SceneSection) == 24, "SceneSection layout");
+static_assert(sizeof(SceneHeader) == 32 + 24 * SCENE_SECTION_COUNT,
+              "SceneHeader layout");
+static_assert(sizeof(SceneTexture) == 24, "SceneTexture layout");
+static_assert(sizeof(SceneMaterial) == 24, "SceneMaterial layout");
+static_assert(sizeof(SceneMesh) == 56, "SceneMesh layout");
+static_assert(sizeof(SceneLod) == 16, "SceneLod layout");
+static_assert(sizeof(SceneInstance) == 56, "SceneInstance layout");
+static_assert(sizeof(SceneCamera) == 48, "SceneCamera layout");
+static_assert(sizeof(SceneLight) == 48, "SceneLight layout");
+
+class SceneImage {
+public:
+  bool isValid = false;
+
+  // Resolved once on load, they point into the image
+  const char *strings = nullptr;
+  const float *vertices = nullptr;
+  const uint32_t *indices = nullptr;
+  const SceneTexture *textures = nullptr;
+  const SceneMaterial *materials = nullptr;
+  const SceneMesh *meshes = nullptr;
+  const SceneInstance *instances = nullptr;
+  const SceneLod *lods = nullptr;
+  const SceneCamera *camera = nullptr; // nullptr without a camera
+  const SceneLight *lights = nullptr;
+  size_t stringBytes = 0, vertexCount = 0, indexCount = 0;
+  size_t textureCount = 0, materialCount = 0, meshCount = 0,
+         instanceCount = 0, lodCount = 0, lightCount = 0;
+
+  SceneImage() = default;
+  // Maps a cooked file
+  explicit SceneImage(const char *path);
+  // Takes an image cooked in memory (cookScene)
+  explicit SceneImage(std::vector<uint8_t> image);
+
+  SceneImage(const SceneImage &) = delete;
+  SceneImage &operator=(const SceneImage &) = delete;
+
+  // "" for SCENE_NONE or an offset outside the string section
+  const char *string(uint32_t offset) const;
+
+  const uint8_t *data() const { return bytes; }
+  size_t size() const { return length; }
+
+private:
+  MappedFile file;
+  std::vector<uint8_t> owned;
+  const uint8_t *bytes = nullptr;
+  size_t length = 0;
+
+  bool bind(const char *what);
+  bool validReferences(const char *what) const;
+};
+
+#endif // !SCENE_IMAGE_H
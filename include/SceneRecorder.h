@@ -0,0 +1,114 @@
+#ifndef SCENE_RECORDER_H
+#define SCENE_RECORDER_H
+
+#include "CommandList.h"
+#include "CommandRecorder.h"
+#include "JobSystem.h"
+#include "MathUtils.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+#include "RenderQueue.h"
+#include "SceneImage.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Graba las instancias visibles de una escena cocinada en CommandLists, en
+ * varios hilos a la vez, sin llamar a ninguna API. El backend (GL en
+ * textures.cc, software en soft-render) crea los recursos, llena los
+ * handles y reproduce lists() en orden: los dos dibujan exactamente la
+ * misma lista.
+ *
+ * Al construirse divide cada LOD de cada malla en meshlets (ver Meshlet.h)
+ * y arma el element buffer que hay que subir, indices(), con los triangulos
+ * de cada LOD ordenados por cluster. Cada frame elige la LOD de cada
+ * instancia con un LodSelector, a partir de cuantos pixeles cubre una
+ * unidad de la malla en el punto mas cercano de su caja; despues prueba
+ * los clusters de esa LOD contra el frustum y solo dibuja los que lo tocan:
+ * los contiguos van en un solo rango y varios rangos en un
+ * MultiDrawIndexed. No hay test de cono porque la escena se dibuja sin face
+ * culling.
+ *
+ * Las instancias opacas se reparten en particiones contiguas, cada una con
+ * su RenderQueue ordenada por estado. Las translucidas van todas en la
+ * ultima particion, asi su orden de atras hacia adelante no se corta entre
+ * listas. La profundidad de cada draw es la del centro de la caja de su
+ * malla (ver scenes/translucent.json). La primera lista empieza poniendo la camara del frame (view y
+ * projection) en cada programa que la usa: son uniforms del programa y no
+ * hace falta repetirlos en cada draw. */
+
+// Lo que el backend creo para un material; handles como en CommandList
+struct SceneMaterialBinding {
+  uint32_t program = 0; // 0: the material is not drawn
+  int time = -1;
+  int mixValue = -1;
+  int transformRows[3] = {-1, -1, -1};
+  int view = -1, projection = -1; // mat4, set once per frame
+};
+
+struct SceneFrame {
+  float time = 0.0f;
+  float mixValue = 0.0f;
+  // Applied after the instance transforms; identity when those already
+  // end in clip space
+  Mat4 view, projection;
+  // Pixels the scene is drawn at, for the LOD error
+  float viewportWidth = 1.0f;
+  float viewportHeight = 1.0f;
+};
+
+class SceneRecorder {
+public:
+  // Backend handles, filled before the first record()
+  uint32_t mesh = 0;              // every mesh shares one vertex array
+  std::vector<uint32_t> textures; // per scene texture
+  std::vector<SceneMaterialBinding> materials;
+
+  // Draws, clusters and instances drawn below full detail by the last
+  // record()
+  size_t drawCount = 0;
+  size_t clusterCount = 0;
+  size_t reducedCount = 0;
+
+  explicit SceneRecorder(const SceneImage &scene,
+                         JobSystem &jobs = JobSystem::shared());
+
+  SceneRecorder(const SceneRecorder &) = delete;
+  SceneRecorder &operator=(const SceneRecorder &) = delete;
+
+  // Element buffer for the shared vertex array: same size and per-LOD
+  // offsets as the scene's index section, triangles in cluster order
+  const std::vector<uint32_t> &indices() const { return elementIndices; }
+  size_t meshletCount() const;
+
+  // Records the instances in `visible` (ascending instance indices)
+  void record(const std::vector<uint32_t> &visible, const SceneFrame &frame);
+
+  const std::vector<CommandList> &lists() const { return recorder.lists(); }
+
+private:
+  // Lo que graba cada particion
+  struct Partition {
+    RenderQueue queue;
+    std::vector<uint32_t> ranges;
+    size_t clusters = 0;
+    size_t reduced = 0;
+  };
+
+  const SceneImage &scene;
+  ParallelCommandRecorder recorder;
+  std::vector<Partition> partitions;
+  std::vector<std::unique_ptr<MeshletMesh>> meshlets; // per scene LOD
+  std::vector<LodLevel> lodLevels;                     // per scene LOD
+  LodSelector lodSelector;                             // per instance
+  std::vector<uint32_t> elementIndices;
+  std::vector<uint32_t> opaque, translucent;
+  std::vector<uint32_t> cameraPrograms;
+
+  void buildMeshlets(JobSystem &jobs);
+  void recordCamera(CommandList &list, const SceneFrame &frame);
+  void submit(Partition &partition, uint32_t index, const SceneFrame &frame);
+};
+
+#endif // !SCENE_RECORDER_H
@@ -15,6 +15,8 @@ public:
 
   // Constructor reads and build  the shader
   Shader(const char* vertexPath, const char* fragmentPath);
+  // Compute shader program (GL 4.3+)
+  explicit Shader(const char* computePath);
 
   // Para activar el shader
   void use();
@@ -23,8 +25,10 @@ public:
   void setInt(const std::string &name, int value) const;
   void setFloat(const std::string &name, float value) const;
   void setColorRGB(const std::string &name, float r, float g, float b) const;
-private:
+  void setMat4(const std::string &name, const float *value) const;
+
   int getUniformLocation(const std::string &name) const;
+private:
   mutable std::map<std::string, int> uniformLocations;
 
 };
@@ -0,0 +1,207 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "CommandList.h"
+#include "JobSystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Backend de render por software: reproduce CommandLists como
+ * GLCommandExecutor, con los mismos comandos y estado de pipeline, sin
+ * driver de GL (soft-render las graba con el mismo SceneRecorder que
+ * textures.cc). Da siempre el mismo resultado bit a bit sin importar
+ * cuantos hilos tenga el JobSystem; no es bit a bit igual a un driver.
+ *
+ * Los shaders son funciones de C++ (ver SoftwareShaders.h) y los handles
+ * de la lista nombran texturas, mallas y programas creados aca. Cada draw
+ * corre el vertex shader, recorta contra near, far y una guard band, pasa
+ * los vertices a coordenadas de pantalla de punto fijo (1/16 de pixel) y
+ * reparte los triangulos en tiles de 64x64 segun su bounding box. flush()
+ * rasteriza los tiles en paralelo; cada tile recorre sus triangulos en el
+ * orden en que se enviaron, asi el blending y el depth test no dependen del
+ * orden de los hilos. Las funciones de arista son enteras (exactas, con
+ * regla top-left, sin huecos entre triangulos vecinos) y se evaluan de a 8
+ * pixeles con AVX2 si la CPU lo tiene, si no con un loop escalar que da la
+ * misma cobertura. Los varyings se interpolan con correccion de
+ * perspectiva y sus derivadas de pantalla llegan al fragment shader para
+ * elegir el mipmap, como hace texture() en GLSL.
+ *
+ * Blending (PIPELINE_BLEND) es SRC_ALPHA, ONE_MINUS_SRC_ALPHA y no escribe
+ * la profundidad, igual que en GLCommandExecutor; el depth test
+ * (PIPELINE_DEPTH_TEST) es GL_LESS y escribe la profundidad de los draws
+ * opacos. No hay face culling, igual que el estado por defecto de GL. */
+
+const int SOFTWARE_TEXTURE_UNITS = 8;
+const int SOFTWARE_MAX_VARYINGS = 16;
+
+// RGBA8 con su cadena de mipmaps. Wrap y filtros son enums de GL
+struct SoftwareTexture {
+  struct Level {
+    int width, height;
+    std::vector<uint8_t> pixels; // bottom row first, like glTexImage2D
+  };
+  std::vector<Level> levels;
+  uint32_t wrapS, wrapT, minFilter, magFilter;
+};
+
+// texture() de GLSL: `dudx`... son las derivadas de pantalla de las
+// coordenadas. Sin textura devuelve (0, 0, 0, 1) como una incompleta en GL
+void sampleTexture(const SoftwareTexture *texture, float u, float v,
+                   float dudx, float dvdx, float dudy, float dvdy,
+                   float color[4]);
+
+// Lo que ve un shader: los uniforms del programa y las texturas enlazadas
+struct SoftwareShaderContext {
+  const float *values;
+  const uint32_t *offsets;
+  const SoftwareTexture *const *units;
+
+  const float *uniform(int location) const {
+    return values + offsets[location];
+  }
+  // Sampler uniform: its value is the texture unit
+  const SoftwareTexture *sampler(int location) const {
+    int unit = (int)uniform(location)[0];
+    return unit >= 0 && unit < SOFTWARE_TEXTURE_UNITS ? units[unit] : nullptr;
+  }
+};
+
+// position sale en clip space, como gl_Position
+typedef void (*SoftwareVertexShader)(const SoftwareShaderContext &context,
+                                     const float *attributes,
+                                     float position[4], float *varyings);
+// ddx y ddy: derivadas de pantalla de cada varying
+typedef void (*SoftwareFragmentShader)(const SoftwareShaderContext &context,
+                                       const float *varyings,
+                                       const float *ddx, const float *ddy,
+                                       float color[4]);
+
+struct SoftwareProgram {
+  struct Uniform {
+    std::string name;
+    uint32_t floats; // 1 for float, int and samplers, 4 for vec4, 16 mat4
+  };
+  // The location of a uniform is its index here
+  std::vector<Uniform> uniforms;
+  uint32_t varyingCount = 0;
+  SoftwareVertexShader vertex = nullptr;
+  SoftwareFragmentShader fragment = nullptr;
+};
+
+class SoftwareRenderer {
+public:
+  bool isValid = false;
+  int width, height;
+  // RGBA8, bottom row first like glReadPixels
+  std::vector<uint8_t> color;
+  std::vector<float> depth;
+
+  // Since the last clear()
+  uint64_t drawCalls = 0;
+  uint64_t triangles = 0;
+
+  // Up to 8192x8192
+  SoftwareRenderer(int width, int height,
+                   JobSystem &jobs = JobSystem::shared());
+
+  SoftwareRenderer(const SoftwareRenderer &) = delete;
+  SoftwareRenderer &operator=(const SoftwareRenderer &) = delete;
+
+  // Handles start at 1; 0 is "none", like GL object names
+  // Copies the pixels and builds the mipmap chain
+  uint32_t createTexture(int width, int height, const uint8_t *rgba,
+                         uint32_t wrapS, uint32_t wrapT, uint32_t minFilter,
+                         uint32_t magFilter);
+  // `stride` floats per vertex, laid out as the program's vertex shader
+  // expects. Indices are triangles
+  uint32_t createMesh(const float *vertices, size_t vertexCount,
+                      size_t stride, const uint32_t *indices,
+                      size_t indexCount);
+  uint32_t createProgram(const SoftwareProgram &program);
+  // -1 if the program has no such uniform. "name" also finds "name[0]"
+  int getUniformLocation(uint32_t program, const std::string &name) const;
+
+  // Fills color and resets depth to 1
+  void clear(float r, float g, float b, float a);
+  // Runs the vertex stage and bins the draws of `list`; nothing is
+  // rasterized until flush()
+  void submit(const CommandList &list);
+  // Rasterizes everything submitted since the last flush
+  void flush();
+
+  // "avx2" or "scalar", whichever edge function kernel runs on this CPU
+  static const char *implementation();
+
+private:
+  static const int TILE_SIZE = 64;
+
+  struct Mesh {
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    size_t stride;
+  };
+  struct Program {
+    SoftwareProgram source;
+    std::vector<uint32_t> offsets;
+    std::vector<float> values;
+  };
+  // Estado de un draw al momento de enviarlo
+  struct Draw {
+    const Program *program;
+    size_t uniforms; // offset in drawUniforms
+    const SoftwareTexture *units[SOFTWARE_TEXTURE_UNITS];
+    uint32_t flags;
+  };
+  // Triangulo listo para rasterizar: aristas enteras en 1/16 de pixel y
+  // planos A * x + B * y + C en pixeles para profundidad, 1/w y varyings/w
+  struct Triangle {
+    int64_t edgeA[3], edgeB[3], edgeC[3];
+    int minX, minY, maxX, maxY; // pixels, inclusive
+    float depthPlane[3];
+    float inverseWPlane[3];
+    size_t planes; // varyingCount planes in planeValues
+    uint32_t draw;
+  };
+
+  JobSystem &jobs;
+  int tilesX, tilesY;
+  float guardBand;
+
+  std::vector<std::unique_ptr<SoftwareTexture>> textures;
+  std::vector<std::unique_ptr<Mesh>> meshes;
+  std::vector<std::unique_ptr<Program>> programs;
+
+  // Estado actual de la lista, como lo tendria el contexto GL
+  Program *currentProgram = nullptr;
+  uint32_t currentFlags = 0;
+  const Mesh *currentMesh = nullptr;
+  const SoftwareTexture *currentUnits[SOFTWARE_TEXTURE_UNITS] = {};
+
+  // Lo que se envio y todavia no se rasterizo
+  std::vector<Draw> draws;
+  std::vector<float> drawUniforms;
+  std::vector<Triangle> triangleList;
+  std::vector<float> planeValues;
+  std::vector<std::vector<uint32_t>> bins;
+  std::vector<float> vertexOutput;
+
+  void setUniform(uint32_t location, const float *values, uint32_t count);
+  void drawIndexed(uint32_t indexCount, uint32_t firstIndex,
+                   int32_t baseVertex);
+  void setupTriangle(const float *const vertices[3], uint32_t varyingCount,
+                     uint32_t draw);
+  void clipTriangle(const float *const vertices[3], uint32_t varyingCount,
+                    uint32_t draw);
+  void rasterizeTile(size_t tile);
+  void shadePixel(const Triangle &triangle, const Draw &draw, int x, int y);
+};
+
+// Same as the GL executor, on the software renderer; flushes at the end
+void executeCommandList(const CommandList &list, SoftwareRenderer &renderer);
+void executeCommandLists(const std::vector<CommandList> &lists,
+                         SoftwareRenderer &renderer);
+
+#endif // !SOFTWARE_RENDERER_H
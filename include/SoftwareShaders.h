@@ -0,0 +1,20 @@
+#ifndef SOFTWARE_SHADERS_H
+#define SOFTWARE_SHADERS_H
+
+#include "SoftwareRenderer.h"
+#include <string>
+
+/* Versiones en C++ de los shaders de src/shaders para SoftwareRenderer.
+ * Tienen los mismos uniforms (con los mismos nombres, asi
+ * getUniformLocation sirve igual que en GL) y hacen las mismas cuentas. */
+
+// texture.vert + texture.frag: mezcla de dos texturas con mixValue
+SoftwareProgram softwareTextureProgram();
+
+// The built-in program for a material's shader pair, matched by file name
+// (e.g. "shaders/texture.vert"). False if there is no C++ version
+bool findSoftwareProgram(const std::string &vertexShader,
+                         const std::string &fragmentShader,
+                         SoftwareProgram &program);
+
+#endif // !SOFTWARE_SHADERS_H
@@ -0,0 +1,88 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include "RadixSort.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Dibuja sprites 2D agrupandolos en la menor cantidad de draws posible. Los
+ * quads se acumulan entre begin() y end(); end() los ordena por capa de
+ * profundidad, shader y textura (radix sort estable), genera los vertices en
+ * un StreamBuffer y emite un glDrawElements por cada tramo que comparte
+ * shader y textura.
+ *
+ * Las texturas son GL_TEXTURE_2D_ARRAY: sprites de distintas capas del mismo
+ * arreglo, o de distintas regiones de un atlas (uvRect), caen en el mismo
+ * draw. Una textura normal se sube como un arreglo de una capa con
+ * createTextureArray(). */
+
+struct SpriteVertex {
+  float position[2];
+  float texCoord[2];
+  float layer;
+  uint8_t color[4];
+};
+
+class SpriteBatch {
+public:
+  // Estadisticas del ultimo end()
+  size_t spriteCount = 0;
+  size_t drawCalls = 0;
+
+  explicit SpriteBatch(size_t maxSprites = 262144,
+                       const char *vertexPath = "shaders/sprite.vert",
+                       const char *fragmentPath = "shaders/sprite.frag");
+  ~SpriteBatch();
+
+  SpriteBatch(const SpriteBatch &) = delete;
+  SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+  // `projection` is a column-major mat4 applied to sprite positions
+  void begin(const float *projection);
+
+  // Queues one quad. `depth` is a draw-order bucket (lower draws first);
+  // `program` 0 uses the built-in sprite shader.
+  void draw(unsigned int textureArray, float layer, float x, float y,
+            float width, float height, const float uvRect[4],
+            const uint8_t color[4], uint16_t depth = 0,
+            unsigned int program = 0);
+
+  // Sorts, uploads and flushes everything queued since begin()
+  void end();
+
+  // Uploads `layers` RGBA8 images of width x height, stored one after the
+  // other, as a mipmapped GL_TEXTURE_2D_ARRAY. A plain 2D image is one layer
+  static unsigned int createTextureArray(const unsigned char *pixels,
+                                         int width, int height,
+                                         int layers = 1);
+
+private:
+  struct QueuedSprite {
+    float x, y, width, height;
+    float uvRect[4];
+    float layer;
+    uint8_t color[4];
+    unsigned int texture;
+    unsigned int program;
+  };
+
+  Shader shader;
+  StreamBuffer vertexBuffer;
+  unsigned int VAO = 0;
+  unsigned int EBO = 0;
+  size_t maxSprites;
+  float projection[16];
+
+  std::vector<QueuedSprite> sprites;
+  std::vector<SortItem> order;
+  std::vector<SortItem> sortScratch;
+
+  void pointAttributes(size_t byteOffset);
+  void flush(size_t first, size_t count);
+};
+
+#endif // !SPRITE_BATCH_H
@@ -0,0 +1,40 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+/* Buffer para datos que cambian cada frame (instancias, sprites). Se escribe
+ * como un anillo con glMapBufferRange sin sincronizar; cuando se llena se
+ * "huerfana" el almacenamiento con glBufferData(NULL) para que el driver
+ * entregue memoria nueva sin esperar a que la GPU termine con la anterior. */
+class StreamBuffer {
+public:
+  unsigned int ID = 0;
+  GLenum target;
+  size_t capacity;
+
+  StreamBuffer(GLenum target, size_t capacity);
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  // Returns a write pointer for `bytes` bytes, or nullptr if the driver
+  // could not map it; call unmap() when done
+  void *map(size_t bytes, size_t alignment = 16);
+  // Returns the byte offset of the region written since map(). Does not
+  // touch GL if the last map() failed
+  size_t unmap();
+  bool isMapped() const { return mapped; }
+
+  // map + memcpy + unmap in one call
+  size_t write(const void *data, size_t bytes, size_t alignment = 16);
+
+private:
+  size_t head = 0;
+  size_t mappedOffset = 0;
+  bool mapped = false;
+};
+
+#endif // !STREAM_BUFFER_H
@@ -0,0 +1,71 @@
+#ifndef UPLOAD_THREAD_H
+#define UPLOAD_THREAD_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+/* Hilo de subidas con su propio contexto GL, creado en una ventana oculta
+ * que comparte objetos con la ventana principal. Ahi corren la creacion y el
+ * llenado de buffers y texturas, asi glBufferData / glTexImage2D no frenan el
+ * frame.
+ *
+ * Despues de cada subida se inserta un glFenceSync. El hilo de render llama a
+ * collect() una vez por frame: cuando la fence ya esta señalada ejecuta el
+ * callback ready en su contexto, que es donde se deben crear los objetos que
+ * no se comparten (VAOs) y desde donde el recurso ya se puede usar. */
+class UploadThread {
+public:
+  using UploadFunction = std::function<void()>;
+  using ReadyFunction = std::function<void()>;
+
+  bool isValid = false;
+
+  // Call from the main thread (it creates a GLFW window); the hints for the
+  // context version and profile must still be set as for `mainWindow`
+  explicit UploadThread(GLFWwindow *mainWindow);
+  // Call from the main thread after the render thread stopped calling
+  // collect(); uploads that did not reach collect() are dropped
+  ~UploadThread();
+
+  UploadThread(const UploadThread &) = delete;
+  UploadThread &operator=(const UploadThread &) = delete;
+
+  // `upload` runs on the upload thread, `ready` on the thread calling
+  // collect() once the GPU finished the upload
+  void submit(UploadFunction upload, ReadyFunction ready = nullptr);
+
+  // Non-blocking; runs the ready callbacks of finished uploads
+  size_t collect();
+
+  size_t pendingUploads() const { return pending.load(); }
+
+private:
+  struct Upload {
+    UploadFunction upload;
+    ReadyFunction ready;
+    GLsync fence = nullptr;
+  };
+
+  GLFWwindow *window = nullptr;
+  std::thread thread;
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::deque<Upload> queued;
+  std::vector<Upload> finished;
+  bool stopping = false;
+  std::atomic<size_t> pending{0};
+
+  void loop();
+};
+
+#endif // !UPLOAD_THREAD_H
@@ -0,0 +1,334 @@
+#include "ClusteredLighting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Luces por trabajo al pasarlas a espacio de vista
+const size_t LIGHT_GRAIN = 256;
+
+// Rango de tiles [first, last] que puede tocar el intervalo [low, high] de
+// una coordenada de vista (x o y) entre las profundidades dMin y dMax. Los
+// tiles se separan por pendiente: el tile i cubre x / profundidad en
+// [tile[i], tile[i + 1]]. Falso si cae fuera de la pantalla
+bool tileRange(float low, float high, float dMin, float dMax,
+               const float *tile, int tiles, int &first, int &last) {
+  float lowSlope = low / (low >= 0.0f ? dMax : dMin);
+  float highSlope = high / (high >= 0.0f ? dMin : dMax);
+  if (highSlope < tile[0] || lowSlope > tile[tiles])
+    return false;
+  float step = (tile[tiles] - tile[0]) / tiles;
+  lowSlope = std::max(lowSlope, tile[0]);
+  highSlope = std::min(highSlope, tile[tiles]);
+  first = std::max((int)std::floor((lowSlope - tile[0]) / step), 0);
+  last = std::min((int)std::floor((highSlope - tile[0]) / step), tiles - 1);
+  return first <= last;
+}
+
+// Distancia de `value` a la caja de un cluster en x o y: el tile va de la
+// pendiente `low` a `high` entre las dos profundidades de la rebanada
+inline float boxDistance(float value, float low, float high, float nearDepth,
+                         float farDepth) {
+  float boxMin = std::min(low * nearDepth, low * farDepth);
+  float boxMax = std::max(high * nearDepth, high * farDepth);
+  return std::min(std::max(value, boxMin), boxMax) - value;
+}
+
+// Indica si la esfera toca la cuna entre los planos (que pasan por la
+// camara) de pendiente `low` y `high`. La caja sola es muy floja en las
+// rebanadas lejanas, que son largas en z
+inline bool touchesWedge(float value, float z, float low, float high,
+                         float range) {
+  return value + low * z >= -range * std::sqrt(1.0f + low * low) &&
+         -value - high * z >= -range * std::sqrt(1.0f + high * high);
+}
+
+} // namespace
+
+ClusteredLighting::ClusteredLighting(size_t maxLights,
+                                     size_t averageLightsPerCluster,
+                                     bool allowCompute,
+                                     const char *clusterShaderPath,
+                                     JobSystem &jobs)
+    : maxLights(maxLights),
+      maxIndices((size_t)CLUSTER_COUNT * averageLightsPerCluster),
+      jobs(jobs) {
+  // Un texture buffer puede tener solo 64K texels en GL 3.3
+  GLint maxTexels = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+  maxIndices = std::min(maxIndices, (size_t)maxTexels);
+  if (this->maxLights * LIGHT_TEXELS > (size_t)maxTexels) {
+    std::cout << "ERROR::CLUSTER::TOO_MANY_LIGHTS " << maxLights << " > "
+              << maxTexels / LIGHT_TEXELS << std::endl;
+    this->maxLights = (size_t)maxTexels / LIGHT_TEXELS;
+  }
+
+  std::vector<uint32_t> emptyGrid((size_t)CLUSTER_COUNT * 2, 0);
+  glGenBuffers(1, &lightBuffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+  glBufferData(GL_TEXTURE_BUFFER, this->maxLights * sizeof(ClusterLight),
+               NULL, GL_DYNAMIC_DRAW);
+  glGenBuffers(1, &gridBuffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+  glBufferData(GL_TEXTURE_BUFFER, emptyGrid.size() * sizeof(uint32_t),
+               emptyGrid.data(), GL_DYNAMIC_DRAW);
+  glGenBuffers(1, &indexBuffer);
+  glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+  glBufferData(GL_TEXTURE_BUFFER, maxIndices * sizeof(uint32_t), NULL,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+  glGenTextures(1, &lightTexture);
+  glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer);
+  glGenTextures(1, &gridTexture);
+  glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+  glGenTextures(1, &indexTexture);
+  glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  if (allowCompute && GLAD_GL_VERSION_4_3) {
+    clusterShader = std::make_unique<Shader>(clusterShaderPath);
+    useCompute = clusterShader->isValid;
+    if (useCompute) {
+      glGenBuffers(1, &countBuffer);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), NULL,
+                   GL_DYNAMIC_DRAW);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    } else {
+      std::cout << "ERROR::CLUSTER::SHADER_INVALID (binning on the CPU)"
+                << std::endl;
+    }
+  }
+  if (!useCompute) {
+    grid.resize((size_t)CLUSTER_COUNT * 2);
+    binned.resize((size_t)CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+    indices.resize(maxIndices);
+  }
+  isValid = true;
+}
+
+ClusteredLighting::~ClusteredLighting() {
+  unsigned int buffers[] = {lightBuffer, gridBuffer, indexBuffer,
+                            countBuffer};
+  glDeleteBuffers(4, buffers);
+  unsigned int textures[] = {lightTexture, gridTexture, indexTexture};
+  glDeleteTextures(3, textures);
+  if (clusterShader)
+    glDeleteProgram(clusterShader->ID);
+}
+
+void ClusteredLighting::setLights(const ClusterLight *lights, size_t count) {
+  if (count > maxLights) {
+    std::cout << "ERROR::CLUSTER::TOO_MANY_LIGHTS " << count << " > "
+              << maxLights << std::endl;
+    count = maxLights;
+  }
+  lightCount = count;
+  this->lights.assign(lights, lights + count);
+  glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, count * sizeof(ClusterLight),
+                  lights);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::update(const Mat4 &view, float fovY, float aspect,
+                               float zNear, float zFar) {
+  if (!isValid)
+    return;
+  this->view = view;
+  this->zNear = zNear;
+  this->zFar = zFar;
+  float tanHalfY = std::tan(fovY * 0.5f);
+  float tanHalfX = tanHalfY * aspect;
+  if (useCompute)
+    updateCompute(tanHalfX, tanHalfY);
+  else
+    updateCPU(tanHalfX, tanHalfY);
+}
+
+void ClusteredLighting::updateCompute(float tanHalfX, float tanHalfY) {
+  unsigned int zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+                    GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  clusterShader->use();
+  clusterShader->setMat4("view", view.m);
+  glUniform1ui(clusterShader->getUniformLocation("lightCount"),
+               (GLuint)lightCount);
+  glUniform1ui(clusterShader->getUniformLocation("maxIndices"),
+               (GLuint)maxIndices);
+  glUniform2f(clusterShader->getUniformLocation("tanHalf"), tanHalfX,
+              tanHalfY);
+  glUniform2f(clusterShader->getUniformLocation("depthRange"), zNear, zFar);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_LIGHTS_BINDING,
+                   lightBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_GRID_BINDING,
+                   gridBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_INDICES_BINDING,
+                   indexBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_COUNT_BINDING,
+                   countBuffer);
+
+  // Un workgroup por cluster
+  glDispatchCompute(GRID_X, GRID_Y, GRID_Z);
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void ClusteredLighting::updateCPU(float tanHalfX, float tanHalfY) {
+  // Pendientes que separan los tiles: x / profundidad en cada borde
+  float tileX[GRID_X + 1], tileY[GRID_Y + 1];
+  for (int i = 0; i <= GRID_X; i++)
+    tileX[i] = (2.0f * i / GRID_X - 1.0f) * tanHalfX;
+  for (int i = 0; i <= GRID_Y; i++)
+    tileY[i] = (2.0f * i / GRID_Y - 1.0f) * tanHalfY;
+
+  // Cada luz a espacio de vista, con el rango de clusters que puede tocar
+  float sliceScale = GRID_Z / std::log(zFar / zNear);
+  viewLights.resize(lightCount);
+  jobs.parallelFor(0, lightCount, LIGHT_GRAIN, [&](size_t first,
+                                                   size_t last) {
+    for (size_t i = first; i < last; i++) {
+      const ClusterLight &light = lights[i];
+      ViewLight &viewLight = viewLights[i];
+      const float *p = light.position;
+      viewLight.x = view.at(0, 0) * p[0] + view.at(0, 1) * p[1] +
+                    view.at(0, 2) * p[2] + view.at(0, 3);
+      viewLight.y = view.at(1, 0) * p[0] + view.at(1, 1) * p[1] +
+                    view.at(1, 2) * p[2] + view.at(1, 3);
+      viewLight.z = view.at(2, 0) * p[0] + view.at(2, 1) * p[1] +
+                    view.at(2, 2) * p[2] + view.at(2, 3);
+      viewLight.range = light.range;
+      // Vacio hasta que se demuestre lo contrario
+      viewLight.minZ = 1;
+      viewLight.maxZ = 0;
+
+      // La camara mira hacia -z
+      float depth = -viewLight.z;
+      float dMin = std::max(depth - light.range, zNear);
+      float dMax = std::min(depth + light.range, zFar);
+      if (dMin > dMax ||
+          !tileRange(viewLight.x - light.range, viewLight.x + light.range,
+                     dMin, dMax, tileX, GRID_X, viewLight.minX,
+                     viewLight.maxX) ||
+          !tileRange(viewLight.y - light.range, viewLight.y + light.range,
+                     dMin, dMax, tileY, GRID_Y, viewLight.minY,
+                     viewLight.maxY))
+        continue;
+      viewLight.minZ = std::max(
+          (int)std::floor(std::log(dMin / zNear) * sliceScale), 0);
+      viewLight.maxZ = std::min(
+          (int)std::floor(std::log(dMax / zNear) * sliceScale), GRID_Z - 1);
+    }
+  });
+
+  // Cada rebanada arma las listas de sus clusters, en orden de luz
+  jobs.parallelFor(0, GRID_Z, 1, [&](size_t first, size_t last) {
+    for (size_t slice = first; slice < last; slice++)
+      binSlice((int)slice, tileX, tileY);
+  });
+
+  // Las listas quedan seguidas en el orden de los clusters
+  size_t offset = 0;
+  overflowedClusters = 0;
+  for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+    size_t count = grid[cluster * 2 + 1];
+    size_t kept = std::min(
+        std::min(count, (size_t)MAX_LIGHTS_PER_CLUSTER), maxIndices - offset);
+    if (kept < count)
+      overflowedClusters++;
+    std::memcpy(&indices[offset],
+                &binned[(size_t)cluster * MAX_LIGHTS_PER_CLUSTER],
+                kept * sizeof(uint32_t));
+    grid[cluster * 2] = (uint32_t)offset;
+    grid[cluster * 2 + 1] = (uint32_t)kept;
+    offset += kept;
+  }
+  assignedIndices = offset;
+
+  glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, grid.size() * sizeof(uint32_t),
+                  grid.data());
+  glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, offset * sizeof(uint32_t),
+                  indices.data());
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLighting::binSlice(int slice, const float *tileX,
+                                 const float *tileY) {
+  // Caja del cluster en espacio de vista: la rebanada va de -sliceNear a
+  // -sliceFar en z, y en x e y de las pendientes del tile por la
+  // profundidad
+  float ratio = zFar / zNear;
+  float sliceNear = zNear * std::pow(ratio, (float)slice / GRID_Z);
+  float sliceFar = zNear * std::pow(ratio, (float)(slice + 1) / GRID_Z);
+  size_t firstCluster = (size_t)slice * GRID_X * GRID_Y;
+  for (int i = 0; i < GRID_X * GRID_Y; i++)
+    grid[(firstCluster + i) * 2 + 1] = 0;
+
+  for (size_t i = 0; i < viewLights.size(); i++) {
+    const ViewLight &light = viewLights[i];
+    if (slice < light.minZ || slice > light.maxZ)
+      continue;
+    float dz =
+        std::min(std::max(light.z, -sliceFar), -sliceNear) - light.z;
+    float rangeLeft = light.range * light.range - dz * dz;
+    if (rangeLeft < 0.0f)
+      continue;
+    for (int y = light.minY; y <= light.maxY; y++) {
+      float dy = boxDistance(light.y, tileY[y], tileY[y + 1], sliceNear,
+                             sliceFar);
+      if (dy * dy > rangeLeft ||
+          !touchesWedge(light.y, light.z, tileY[y], tileY[y + 1],
+                        light.range))
+        continue;
+      for (int x = light.minX; x <= light.maxX; x++) {
+        float dx = boxDistance(light.x, tileX[x], tileX[x + 1], sliceNear,
+                               sliceFar);
+        if (dx * dx + dy * dy > rangeLeft ||
+            !touchesWedge(light.x, light.z, tileX[x], tileX[x + 1],
+                          light.range))
+          continue;
+        size_t cluster = firstCluster + (size_t)y * GRID_X + x;
+        uint32_t &count = grid[cluster * 2 + 1];
+        if (count < MAX_LIGHTS_PER_CLUSTER)
+          binned[cluster * MAX_LIGHTS_PER_CLUSTER + count] = (uint32_t)i;
+        count++;
+      }
+    }
+  }
+}
+
+void ClusteredLighting::bind(const Shader &program, int viewportWidth,
+                             int viewportHeight) const {
+  glActiveTexture(GL_TEXTURE0 + CLUSTER_LIGHTS_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+  glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+  glActiveTexture(GL_TEXTURE0 + CLUSTER_INDICES_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+  glActiveTexture(GL_TEXTURE0);
+
+  glUniform1i(program.getUniformLocation("clusterLights"),
+              CLUSTER_LIGHTS_UNIT);
+  glUniform1i(program.getUniformLocation("clusterGrid"), CLUSTER_GRID_UNIT);
+  glUniform1i(program.getUniformLocation("clusterIndices"),
+              CLUSTER_INDICES_UNIT);
+  glUniform3i(program.getUniformLocation("clusterGridSize"), GRID_X, GRID_Y,
+              GRID_Z);
+  glUniform2f(program.getUniformLocation("clusterTileScale"),
+              (float)GRID_X / viewportWidth, (float)GRID_Y / viewportHeight);
+  // rebanada = log(profundidad) * scale - bias
+  float scale = GRID_Z / std::log(zFar / zNear);
+  glUniform2f(program.getUniformLocation("clusterDepthScaleBias"), scale,
+              scale * std::log(zNear));
+}
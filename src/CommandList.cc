@@ -0,0 +1,49 @@
+#include "CommandList.h"
+#include <cstring>
+
+void CommandList::setPipeline(uint32_t program, uint32_t flags) {
+  commands.push_back({CommandType::SetPipeline, 0, program, flags, 0, {}});
+}
+
+void CommandList::bindTexture(uint8_t unit, uint32_t texture) {
+  commands.push_back({CommandType::BindTexture, unit, texture, 0, 0, {}});
+}
+
+void CommandList::bindMesh(uint32_t vertexArray) {
+  commands.push_back({CommandType::BindMesh, 0, vertexArray, 0, 0, {}});
+}
+
+void CommandList::setUniform(uint32_t location, float x) {
+  commands.push_back(
+      {CommandType::SetUniform1f, 0, location, 0, 0, {x, 0.0f, 0.0f, 0.0f}});
+}
+
+void CommandList::setUniform(uint32_t location, float x, float y, float z,
+                             float w) {
+  commands.push_back({CommandType::SetUniform4f, 0, location, 0, 0, {x, y, z, w}});
+}
+
+void CommandList::setUniform(uint32_t location, int value) {
+  commands.push_back(
+      {CommandType::SetUniform1i, 0, location, (uint32_t)value, 0, {}});
+}
+
+void CommandList::setUniformMat4(uint32_t location, const float *matrix) {
+  uint32_t offset = (uint32_t)payload.size();
+  payload.insert(payload.end(), matrix, matrix + 16);
+  commands.push_back({CommandType::SetUniformMat4, 0, location, offset, 0, {}});
+}
+
+void CommandList::drawIndexed(uint32_t indexCount, uint32_t firstIndex,
+                              int32_t baseVertex) {
+  commands.push_back(
+      {CommandType::DrawIndexed, 0, indexCount, firstIndex, baseVertex, {}});
+}
+
+void CommandList::multiDrawIndexed(const uint32_t *firstAndCount,
+                                   uint32_t rangeCount) {
+  uint32_t offset = (uint32_t)ranges.size();
+  ranges.insert(ranges.end(), firstAndCount, firstAndCount + 2 * rangeCount);
+  commands.push_back(
+      {CommandType::MultiDrawIndexed, 0, rangeCount, offset, 0, {}});
+}
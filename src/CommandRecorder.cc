@@ -0,0 +1,16 @@
+#include "CommandRecorder.h"
+
+ParallelCommandRecorder::ParallelCommandRecorder(size_t partitions,
+                                                 JobSystem &jobs)
+    : partitionLists(partitions), jobs(jobs) {}
+
+void ParallelCommandRecorder::record(const RecordFunction &recordPartition) {
+  // Una particion por job: suelen ser pocas y de tamano parecido
+  jobs.parallelFor(0, partitionLists.size(), 1,
+                   [&](size_t first, size_t last) {
+                     for (size_t i = first; i < last; i++) {
+                       partitionLists[i].clear();
+                       recordPartition(i, partitionLists[i]);
+                     }
+                   });
+}
@@ -0,0 +1,213 @@
+#include "DebugOutput.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+const char *const NO_SITE = "(sin zona)";
+// Largo maximo del mensaje que se guarda por balde
+const size_t MESSAGE_LENGTH = 160;
+
+struct BucketState {
+  DebugOutput::Bucket bucket;
+  uint64_t thisFrame = 0;
+  uint64_t sinceCollect = 0;
+};
+
+std::mutex mutex;
+std::vector<BucketState> buckets;
+uint64_t frames = 0;
+std::atomic<bool> callbackInstalled{false};
+
+thread_local const char *currentSite = nullptr;
+
+void APIENTRY debugCallback(GLenum source, GLenum type, GLuint id,
+                            GLenum severity, GLsizei length,
+                            const GLchar *message, const void *) {
+  const char *site = currentSite != nullptr ? currentSite : NO_SITE;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Pocos baldes distintos: busqueda lineal
+  BucketState *state = nullptr;
+  for (BucketState &candidate : buckets) {
+    const DebugOutput::Bucket &bucket = candidate.bucket;
+    if (bucket.site == site && bucket.id == id && bucket.type == type &&
+        bucket.source == source) {
+      state = &candidate;
+      break;
+    }
+  }
+
+  if (state == nullptr) {
+    DebugOutput::Bucket bucket;
+    bucket.site = site;
+    bucket.source = source;
+    bucket.type = type;
+    bucket.id = id;
+    bucket.severity = severity;
+    size_t messageLength = length >= 0 ? (size_t)length : std::strlen(message);
+    bucket.message.assign(message, std::min(messageLength, MESSAGE_LENGTH));
+    buckets.push_back(BucketState{bucket});
+    state = &buckets.back();
+
+    // Los errores se muestran enseguida, una vez por balde
+    if (type == GL_DEBUG_TYPE_ERROR)
+      std::cout << "ERROR::GL::DEBUG " << site << ": " << bucket.message
+                << std::endl;
+  }
+  state->thisFrame++;
+  state->sinceCollect++;
+  state->bucket.total++;
+}
+
+} // namespace
+
+bool DebugOutput::install() {
+  if (glad_glDebugMessageCallback == nullptr) {
+    std::cout << "ERROR::DEBUG_OUTPUT::UNAVAILABLE (needs GL 4.3 or KHR_debug)"
+              << std::endl;
+    return false;
+  }
+
+  GLint flags = 0;
+  glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+  if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+    std::cout << "DEBUG_OUTPUT::NOT_A_DEBUG_CONTEXT the driver may report "
+                 "less"
+              << std::endl;
+
+  glEnable(GL_DEBUG_OUTPUT);
+  glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(debugCallback, nullptr);
+  // Las notificaciones ("buffer en memoria de video", etc.) son ruido
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                        GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+  callbackInstalled = true;
+  return true;
+}
+
+bool DebugOutput::installed() { return callbackInstalled; }
+
+void DebugOutput::endFrame() {
+  if (!callbackInstalled)
+    return;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (BucketState &state : buckets) {
+    state.bucket.maxPerFrame =
+        std::max(state.bucket.maxPerFrame, state.thisFrame);
+    state.thisFrame = 0;
+  }
+  frames++;
+}
+
+std::vector<DebugOutput::Bucket> DebugOutput::collect(uint64_t *frameCount) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<Bucket> result;
+  for (BucketState &state : buckets) {
+    if (state.sinceCollect == 0)
+      continue;
+    Bucket bucket = state.bucket;
+    bucket.perFrame = frames > 0 ? (double)state.sinceCollect / frames
+                                 : (double)state.sinceCollect;
+    result.push_back(bucket);
+    state.sinceCollect = 0;
+    state.bucket.maxPerFrame = 0;
+  }
+  if (frameCount != nullptr)
+    *frameCount = frames;
+  frames = 0;
+
+  std::sort(result.begin(), result.end(),
+            [](const Bucket &a, const Bucket &b) {
+              return a.perFrame > b.perFrame;
+            });
+  return result;
+}
+
+std::string DebugOutput::report(size_t top) {
+  uint64_t frameCount = 0;
+  std::vector<Bucket> result = collect(&frameCount);
+  double perFrame = 0.0;
+  size_t performance = 0;
+  for (const Bucket &bucket : result) {
+    perFrame += bucket.perFrame;
+    if (bucket.type == GL_DEBUG_TYPE_PERFORMANCE)
+      performance++;
+  }
+
+  char line[512];
+  std::snprintf(line, sizeof(line),
+                "%llu frames | %zu buckets (%zu performance), %.2f messages "
+                "per frame\n",
+                (unsigned long long)frameCount, result.size(), performance,
+                perFrame);
+  std::string text = line;
+  for (size_t i = 0; i < result.size() && i < top; i++) {
+    const Bucket &bucket = result[i];
+    std::snprintf(line, sizeof(line),
+                  "  %6.2f/frame (max %llu) %s/%s/%s id 0x%x at %s: %s\n",
+                  bucket.perFrame, (unsigned long long)bucket.maxPerFrame,
+                  typeName(bucket.type), sourceName(bucket.source),
+                  severityName(bucket.severity), bucket.id, bucket.site,
+                  bucket.message.c_str());
+    text += line;
+  }
+  return text;
+}
+
+const char *DebugOutput::sourceName(unsigned int source) {
+  switch (source) {
+  case GL_DEBUG_SOURCE_API:
+    return "api";
+  case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+    return "window";
+  case GL_DEBUG_SOURCE_SHADER_COMPILER:
+    return "shader";
+  case GL_DEBUG_SOURCE_THIRD_PARTY:
+    return "third-party";
+  case GL_DEBUG_SOURCE_APPLICATION:
+    return "app";
+  }
+  return "other";
+}
+
+const char *DebugOutput::typeName(unsigned int type) {
+  switch (type) {
+  case GL_DEBUG_TYPE_ERROR:
+    return "error";
+  case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+    return "deprecated";
+  case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+    return "undefined";
+  case GL_DEBUG_TYPE_PORTABILITY:
+    return "portability";
+  case GL_DEBUG_TYPE_PERFORMANCE:
+    return "performance";
+  case GL_DEBUG_TYPE_MARKER:
+    return "marker";
+  }
+  return "other";
+}
+
+const char *DebugOutput::severityName(unsigned int severity) {
+  switch (severity) {
+  case GL_DEBUG_SEVERITY_HIGH:
+    return "high";
+  case GL_DEBUG_SEVERITY_MEDIUM:
+    return "medium";
+  case GL_DEBUG_SEVERITY_LOW:
+    return "low";
+  }
+  return "notification";
+}
+
+DebugSite::DebugSite(const char *name) : previous(currentSite) {
+  currentSite = name;
+}
+
+DebugSite::~DebugSite() { currentSite = previous; }
@@ -0,0 +1,214 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+// Peso del frame nuevo en el promedio del tiempo de GPU
+const double SMOOTHING = 0.2;
+// Se apunta a este porcentaje del presupuesto para tener margen
+const double AIM = 0.9;
+// Banda muerta: entre estos porcentajes del presupuesto no se toca la escala
+const double LOWER_BAND = 0.75;
+const double UPPER_BAND = 1.0;
+// Maximo cambio de escala por paso, y frames entre pasos: los tiempos llegan
+// con varios frames de atraso y hay que dejar que el cambio se vea
+const float MAX_STEP = 0.1f;
+const int SETTLE_FRAMES = 8;
+
+} // namespace
+
+DynamicResolution::DynamicResolution(int outputWidth, int outputHeight,
+                                     double targetMs)
+    : targetMs(targetMs),
+      shader("shaders/upscale.vert", "shaders/upscale.frag") {
+  if (!shader.isValid)
+    return;
+  sourceLocation = shader.getUniformLocation("source");
+  uvScaleLocation = shader.getUniformLocation("uvScale");
+  uvClampLocation = shader.getUniformLocation("uvClamp");
+  texelSizeLocation = shader.getUniformLocation("texelSize");
+  edgeAwareLocation = shader.getUniformLocation("edgeAware");
+  sharpnessLocation = shader.getUniformLocation("sharpness");
+
+  // El triangulo de pantalla completa sale de gl_VertexID, pero el core
+  // profile igual pide un VAO enlazado para dibujar
+  glGenVertexArrays(1, &emptyVAO);
+  glGenQueries(QUERY_RING * 2, &queries[0][0]);
+
+  this->outputWidth = outputWidth;
+  this->outputHeight = outputHeight;
+  isValid = createTarget();
+}
+
+DynamicResolution::~DynamicResolution() {
+  destroyTarget();
+  if (emptyVAO != 0)
+    glDeleteVertexArrays(1, &emptyVAO);
+  if (queries[0][0] != 0)
+    glDeleteQueries(QUERY_RING * 2, &queries[0][0]);
+}
+
+void DynamicResolution::resize(int width, int height) {
+  if (width == outputWidth && height == outputHeight)
+    return;
+  outputWidth = width;
+  outputHeight = height;
+  destroyTarget();
+  isValid = createTarget();
+}
+
+bool DynamicResolution::createTarget() {
+  float largest = std::max(maxScale, 1.0f);
+  textureWidth = std::max(1, (int)std::ceil(outputWidth * largest));
+  textureHeight = std::max(1, (int)std::ceil(outputHeight * largest));
+
+  glGenTextures(1, &colorTexture);
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, textureWidth, textureHeight, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  // Sin mipmaps: el upscale solo lee con filtrado bilineal
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, textureWidth,
+                        textureHeight);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  GLint previous = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         colorTexture, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depthBuffer);
+  bool complete =
+      glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  glBindFramebuffer(GL_FRAMEBUFFER, previous);
+  if (!complete) {
+    std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE "
+              << textureWidth << "x" << textureHeight << std::endl;
+    return false;
+  }
+
+  applyScale();
+  return true;
+}
+
+void DynamicResolution::destroyTarget() {
+  if (framebuffer != 0)
+    glDeleteFramebuffers(1, &framebuffer);
+  if (depthBuffer != 0)
+    glDeleteRenderbuffers(1, &depthBuffer);
+  if (colorTexture != 0)
+    glDeleteTextures(1, &colorTexture);
+  framebuffer = depthBuffer = colorTexture = 0;
+}
+
+void DynamicResolution::applyScale() {
+  scale = std::min(std::max(scale, minScale), maxScale);
+  renderWidth = std::min(textureWidth,
+                         std::max(1, (int)std::lround(outputWidth * scale)));
+  renderHeight = std::min(
+      textureHeight, std::max(1, (int)std::lround(outputHeight * scale)));
+}
+
+void DynamicResolution::beginScene() {
+  readQueries();
+  int slot = (int)(frameIndex % QUERY_RING);
+  // Si el resultado de hace QUERY_RING frames no llego, se descarta
+  queryPending[slot] = false;
+  glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(0, 0, renderWidth, renderHeight);
+}
+
+void DynamicResolution::endScene() {
+  int slot = (int)(frameIndex % QUERY_RING);
+  glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+  queryPending[slot] = true;
+  frameIndex++;
+}
+
+void DynamicResolution::readQueries() {
+  // Del mas viejo al mas nuevo; si uno no esta listo los siguientes tampoco
+  for (int i = 0; i < QUERY_RING; i++) {
+    int slot = (int)((frameIndex + i) % QUERY_RING);
+    if (!queryPending[slot])
+      continue;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE,
+                       &available);
+    if (!available)
+      break;
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+    queryPending[slot] = false;
+    updateScale((end - begin) / 1.0e6);
+  }
+}
+
+void DynamicResolution::updateScale(double frameGpuMs) {
+  gpuMs = gpuMs <= 0.0 ? frameGpuMs
+                       : gpuMs + (frameGpuMs - gpuMs) * SMOOTHING;
+  if (++framesSinceChange < SETTLE_FRAMES || gpuMs <= 0.0)
+    return;
+  if (gpuMs >= targetMs * LOWER_BAND && gpuMs <= targetMs * UPPER_BAND)
+    return;
+
+  // Costo ~ pixeles ~ scale^2
+  float wanted = scale * (float)std::sqrt(targetMs * AIM / gpuMs);
+  wanted = std::min(std::max(wanted, scale - MAX_STEP), scale + MAX_STEP);
+  wanted = std::min(std::max(wanted, minScale), maxScale);
+  if (std::fabs(wanted - scale) < 0.01f)
+    return;
+  scale = wanted;
+  applyScale();
+  framesSinceChange = 0;
+  scaleChanges++;
+}
+
+void DynamicResolution::present(GLuint target) {
+  glBindFramebuffer(GL_FRAMEBUFFER, target);
+  glViewport(0, 0, outputWidth, outputHeight);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_BLEND);
+
+  shader.use();
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, colorTexture);
+  glUniform1i(sourceLocation, 0);
+  float texelWidth = 1.0f / textureWidth, texelHeight = 1.0f / textureHeight;
+  glUniform2f(uvScaleLocation, renderWidth * texelWidth,
+              renderHeight * texelHeight);
+  // Medio texel adentro del borde de la region: no se filtra lo de afuera
+  glUniform2f(uvClampLocation, (renderWidth - 0.5f) * texelWidth,
+              (renderHeight - 0.5f) * texelHeight);
+  glUniform2f(texelSizeLocation, texelWidth, texelHeight);
+  glUniform1i(edgeAwareLocation, filter == UpscaleFilter::EdgeAware ? 1 : 0);
+  glUniform1f(sharpnessLocation, sharpness);
+
+  glBindVertexArray(emptyVAO);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glBindVertexArray(0);
+}
+
+std::string DynamicResolution::summary() const {
+  char text[160];
+  std::snprintf(text, sizeof(text),
+                "scale %.2f (%dx%d of %dx%d) | scene gpu %.2f ms of %.2f ms | "
+                "%llu changes",
+                scale, renderWidth, renderHeight, outputWidth, outputHeight,
+                gpuMs, targetMs, (unsigned long long)scaleChanges);
+  return text;
+}
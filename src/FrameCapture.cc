@@ -0,0 +1,390 @@
+#include "FrameCapture.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+uint32_t crc32(uint32_t crc, const unsigned char *data, size_t size) {
+  static uint32_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    tableReady = true;
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+void putU32(std::vector<unsigned char> &out, uint32_t value) {
+  out.push_back((unsigned char)(value >> 24));
+  out.push_back((unsigned char)(value >> 16));
+  out.push_back((unsigned char)(value >> 8));
+  out.push_back((unsigned char)value);
+}
+
+void putChunk(std::vector<unsigned char> &png, const char *type,
+              const std::vector<unsigned char> &data) {
+  putU32(png, (uint32_t)data.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  putU32(png, crc32(0, &png[start], png.size() - start));
+}
+
+// El framebuffer de GL empieza abajo; las imagenes empiezan arriba
+const unsigned char *rowFromTop(const unsigned char *rgba, int width,
+                                int height, int y) {
+  return rgba + (size_t)(height - 1 - y) * width * 4;
+}
+
+// Una conversion entera de printf: %d, %5d o %05d. Devuelve su largo o 0
+size_t integerConversion(const std::string &text, size_t percent) {
+  size_t end = percent + 1;
+  while (end < text.size() && text[end] >= '0' && text[end] <= '9')
+    end++;
+  return end < text.size() && text[end] == 'd' ? end + 1 - percent : 0;
+}
+
+unsigned char clampByte(float value) {
+  return value < 0.0f ? 0 : value > 255.0f ? 255 : (unsigned char)(value + 0.5f);
+}
+
+} // namespace
+
+bool writePPM(const char *path, int width, int height,
+              const unsigned char *rgba) {
+  FILE *file = std::fopen(path, "wb");
+  if (file == NULL)
+    return false;
+
+  std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+  std::vector<unsigned char> row((size_t)width * 3);
+  for (int y = 0; y < height; y++) {
+    const unsigned char *source = rowFromTop(rgba, width, height, y);
+    for (int x = 0; x < width; x++)
+      std::memcpy(&row[x * 3], source + x * 4, 3);
+    std::fwrite(row.data(), 1, row.size(), file);
+  }
+  return std::fclose(file) == 0;
+}
+
+/* PNG sin compresion: los datos van en bloques "stored" de deflate, asi que
+ * no hace falta zlib y escribir es casi un memcpy. Los archivos quedan del
+ * tamaño de la imagen en crudo. */
+bool writePNG(const char *path, int width, int height,
+              const unsigned char *rgba) {
+  // Cada fila: byte de filtro (0 = ninguno) + RGB
+  size_t rowBytes = (size_t)width * 3 + 1;
+  std::vector<unsigned char> raw(rowBytes * height);
+  for (int y = 0; y < height; y++) {
+    const unsigned char *source = rowFromTop(rgba, width, height, y);
+    unsigned char *target = &raw[y * rowBytes];
+    target[0] = 0;
+    for (int x = 0; x < width; x++)
+      std::memcpy(target + 1 + x * 3, source + x * 4, 3);
+  }
+
+  std::vector<unsigned char> zlib = {0x78, 0x01};
+  uint32_t adlerA = 1, adlerB = 0;
+  for (size_t offset = 0;;) {
+    size_t length = std::min<size_t>(65535, raw.size() - offset);
+    bool last = offset + length == raw.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back((unsigned char)length);
+    zlib.push_back((unsigned char)(length >> 8));
+    zlib.push_back((unsigned char)~length);
+    zlib.push_back((unsigned char)(~length >> 8));
+    zlib.insert(zlib.end(), raw.begin() + offset,
+                raw.begin() + offset + length);
+    offset += length;
+    if (last)
+      break;
+  }
+  for (unsigned char byte : raw) {
+    adlerA = (adlerA + byte) % 65521;
+    adlerB = (adlerB + adlerA) % 65521;
+  }
+  putU32(zlib, (adlerB << 16) | adlerA);
+
+  std::vector<unsigned char> header;
+  putU32(header, (uint32_t)width);
+  putU32(header, (uint32_t)height);
+  header.push_back(8); // bits por canal
+  header.push_back(2); // RGB
+  header.push_back(0);
+  header.push_back(0);
+  header.push_back(0);
+
+  std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  putChunk(png, "IHDR", header);
+  putChunk(png, "IDAT", zlib);
+  putChunk(png, "IEND", {});
+
+  FILE *file = std::fopen(path, "wb");
+  if (file == NULL)
+    return false;
+  std::fwrite(png.data(), 1, png.size(), file);
+  return std::fclose(file) == 0;
+}
+
+FrameCapture::FrameCapture(int width, int height, const std::string &output,
+                           CaptureFormat format, size_t ringSize,
+                           int framesPerSecond)
+    : width(width), height(height), format(format), output(output),
+      framesPerSecond(framesPerSecond) {
+  if (width <= 0 || height <= 0 || ringSize == 0) {
+    std::cout << "ERROR::FRAME_CAPTURE::INVALID_SIZE" << std::endl;
+    return;
+  }
+
+  if (format != CaptureFormat::Y4M && !framePattern(output, this->output))
+    return;
+  if (format == CaptureFormat::Y4M) {
+    stream = std::fopen(output.c_str(), "wb");
+    if (stream == NULL) {
+      std::cout << "ERROR::FRAME_CAPTURE::CANNOT_OPEN " << output << std::endl;
+      return;
+    }
+    // 4:4:4 evita promediar croma; ffmpeg y mpv lo leen sin problema
+    std::fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width,
+                 height, framesPerSecond);
+  }
+
+  size_t bytes = (size_t)width * height * 4;
+  ring.resize(ringSize);
+  for (Slot &slot : ring) {
+    glGenBuffers(1, &slot.buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    // STREAM_READ: la GPU escribe, la CPU lee una vez
+    glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  encoder = std::thread(&FrameCapture::encoderLoop, this);
+  isValid = true;
+}
+
+FrameCapture::~FrameCapture() {
+  finish();
+  for (Slot &slot : ring)
+    glDeleteBuffers(1, &slot.buffer);
+}
+
+bool FrameCapture::formatFromPath(const std::string &output,
+                                  CaptureFormat &format) {
+  size_t dot = output.find_last_of('.');
+  std::string extension = dot == std::string::npos ? "" : output.substr(dot);
+  if (extension == ".png")
+    format = CaptureFormat::PNG;
+  else if (extension == ".ppm")
+    format = CaptureFormat::PPM;
+  else if (extension == ".y4m")
+    format = CaptureFormat::Y4M;
+  else
+    return false;
+  return true;
+}
+
+bool FrameCapture::framePattern(const std::string &output,
+                                std::string &pattern) {
+  // El patron va a snprintf: solo se acepta una conversion entera y "%%"
+  int conversions = 0;
+  for (size_t i = 0; i < output.size(); i++) {
+    if (output[i] != '%')
+      continue;
+    if (i + 1 < output.size() && output[i + 1] == '%') {
+      i++;
+      continue;
+    }
+    size_t length = integerConversion(output, i);
+    if (length == 0 || ++conversions > 1) {
+      std::cout << "ERROR::FRAME_CAPTURE::BAD_PATTERN " << output
+                << " (use one %d, like frames/frame_%05d.png)" << std::endl;
+      return false;
+    }
+    i += length - 1;
+  }
+  pattern = output;
+  if (conversions == 0) {
+    // Sin numero cada frame pisaria el mismo archivo
+    size_t dot = pattern.find_last_of('.');
+    size_t slash = pattern.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+      dot = pattern.size();
+    pattern.insert(dot, "_%05d");
+  }
+  return true;
+}
+
+void FrameCapture::capture() {
+  if (!isValid || finished)
+    return;
+
+  Slot &slot = ring[nextSlot];
+  if (slot.fence != nullptr) {
+    // El slot mas viejo sigue en vuelo: todo el anillo esta ocupado
+    readSlot(slot, true);
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  // Con un PBO enlazado el ultimo argumento es un offset y la llamada no
+  // espera a que la GPU termine
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.frame = framesCaptured++;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  nextSlot = (nextSlot + 1) % ring.size();
+
+  // Vaciamos, en orden, los slots que ya terminaron
+  for (size_t i = 0; i < ring.size(); i++) {
+    Slot &oldest = ring[(nextSlot + i) % ring.size()];
+    if (oldest.fence == nullptr)
+      continue;
+    GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+      break;
+    readSlot(oldest, false);
+  }
+}
+
+void FrameCapture::readSlot(Slot &slot, bool wait) {
+  if (wait) {
+    GLenum status =
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      readbackStalls++;
+      glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    }
+  }
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  size_t bytes = (size_t)width * height * 4;
+  Frame frame;
+  frame.index = slot.frame;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.size() >= MAX_QUEUED_FRAMES) {
+      encoderStalls++;
+      queueChanged.wait(lock, [&] { return queue.size() < MAX_QUEUED_FRAMES; });
+    }
+    if (!freeBuffers.empty()) {
+      frame.pixels = std::move(freeBuffers.back());
+      freeBuffers.pop_back();
+    }
+  }
+  frame.pixels.resize(bytes);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes,
+                                  GL_MAP_READ_BIT);
+  if (mapped != nullptr) {
+    std::memcpy(frame.pixels.data(), mapped, bytes);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (mapped == nullptr) {
+    std::cout << "ERROR::FRAME_CAPTURE::MAP_FAILED frame " << frame.index
+              << std::endl;
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(std::move(frame.pixels));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(frame));
+  }
+  queueChanged.notify_all();
+}
+
+void FrameCapture::finish() {
+  if (!isValid || finished)
+    return;
+  finished = true;
+
+  for (size_t i = 0; i < ring.size(); i++) {
+    Slot &slot = ring[(nextSlot + i) % ring.size()];
+    if (slot.fence != nullptr)
+      readSlot(slot, true);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  queueChanged.notify_all();
+  encoder.join();
+
+  if (stream != NULL) {
+    std::fclose(stream);
+    stream = NULL;
+  }
+  std::cout << "CAPTURE::FINISHED " << output << " | " << framesWritten
+            << "/" << framesCaptured << " frames written, "
+            << readbackStalls << " readback stalls, " << encoderStalls
+            << " encoder stalls" << std::endl;
+}
+
+void FrameCapture::encoderLoop() {
+  while (true) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      queueChanged.wait(lock, [&] { return stopping || !queue.empty(); });
+      if (queue.empty())
+        return;
+      frame = std::move(queue.front());
+      queue.pop_front();
+    }
+    queueChanged.notify_all();
+
+    if (encode(frame))
+      framesWritten++;
+    else
+      std::cout << "ERROR::FRAME_CAPTURE::WRITE_FAILED frame " << frame.index
+                << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(std::move(frame.pixels));
+  }
+}
+
+bool FrameCapture::encode(const Frame &frame) {
+  const unsigned char *rgba = frame.pixels.data();
+  if (format == CaptureFormat::Y4M) {
+    // BT.601 full range, planos Y, U y V uno detras del otro
+    size_t planeSize = (size_t)width * height;
+    std::vector<unsigned char> planes(planeSize * 3);
+    for (int y = 0; y < height; y++) {
+      const unsigned char *source = rowFromTop(rgba, width, height, y);
+      for (int x = 0; x < width; x++) {
+        float r = source[x * 4], g = source[x * 4 + 1], b = source[x * 4 + 2];
+        size_t i = (size_t)y * width + x;
+        planes[i] = clampByte(0.299f * r + 0.587f * g + 0.114f * b);
+        planes[planeSize + i] =
+            clampByte(128.0f - 0.168736f * r - 0.331264f * g + 0.5f * b);
+        planes[planeSize * 2 + i] =
+            clampByte(128.0f + 0.5f * r - 0.418688f * g - 0.081312f * b);
+      }
+    }
+    std::fputs("FRAME\n", stream);
+    return std::fwrite(planes.data(), 1, planes.size(), stream) ==
+           planes.size();
+  }
+
+  char path[4096];
+  std::snprintf(path, sizeof(path), output.c_str(), (int)frame.index);
+  if (format == CaptureFormat::PNG)
+    return writePNG(path, width, height, rgba);
+  return writePPM(path, width, height, rgba);
+}
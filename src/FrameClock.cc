@@ -0,0 +1,42 @@
+#include "FrameClock.h"
+
+FrameClock::FrameClock(double fixedStep, double maxFrameTime)
+    : fixedStep(fixedStep), maxFrameTime(maxFrameTime) {}
+
+int FrameClock::advance(double now) {
+  if (!started) {
+    // El primer frame solo toma la referencia de tiempo
+    started = true;
+    lastTime = now;
+    frameTime = 0.0;
+    frameCount++;
+    return 0;
+  }
+
+  frameTime = now - lastTime;
+  lastTime = now;
+  if (frameTime < 0.0)
+    frameTime = 0.0;
+  if (frameTime > maxFrameTime)
+    frameTime = maxFrameTime;
+  frameCount++;
+
+  accumulator += frameTime;
+  int steps = 0;
+  while (accumulator >= fixedStep) {
+    accumulator -= fixedStep;
+    simulationTime += fixedStep;
+    steps++;
+  }
+  stepCount += steps;
+  return steps;
+}
+
+void FrameClock::reset() {
+  started = false;
+  accumulator = 0.0;
+  frameTime = 0.0;
+  simulationTime = 0.0;
+  frameCount = 0;
+  stepCount = 0;
+}
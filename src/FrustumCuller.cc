@@ -0,0 +1,305 @@
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_USE_SSE 1
+#endif
+
+// El kernel AVX2 se compila con atributos de target y se elige en runtime,
+// asi el resto del binario no depende de -mavx2
+#if (defined(__GNUC__) || defined(__clang__)) &&                            \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FRUSTUM_CULLER_USE_AVX2 1
+#endif
+
+namespace {
+
+// Objetos por grupo: un byte de mascara por grupo
+const size_t GROUP = 8;
+// Grupos por bloque de trabajo (8192 objetos, ~200 KB de SoA)
+const size_t BLOCK_GROUPS = 1024;
+
+struct CullPlanes {
+  float a[6], b[6], c[6], d[6];
+  float absA[6], absB[6], absC[6];
+};
+
+struct CullInput {
+  const float *centerX, *centerY, *centerZ;
+  const float *extentX, *extentY, *extentZ;
+  const float *radius;
+};
+
+// Escriben la mascara de los grupos [first, last) y devuelven los visibles
+typedef size_t (*CullKernel)(const CullInput &, const CullPlanes &,
+                             size_t first, size_t last, uint8_t *masks);
+
+#ifndef FRUSTUM_CULLER_USE_SSE
+// Solo sin SSE2: en x86 siempre hay un kernel vectorial
+size_t cullScalar(const CullInput &in, const CullPlanes &planes,
+                  size_t first, size_t last, uint8_t *masks) {
+  size_t visibleCount = 0;
+  for (size_t group = first; group < last; group++) {
+    unsigned mask = 0;
+    for (size_t lane = 0; lane < GROUP; lane++) {
+      size_t i = group * GROUP + lane;
+      bool inside = true;
+      for (int p = 0; p < 6 && inside; p++) {
+        float d = planes.a[p] * in.centerX[i] + planes.b[p] * in.centerY[i] +
+                  planes.c[p] * in.centerZ[i] + planes.d[p];
+        float e = planes.absA[p] * in.extentX[i] +
+                  planes.absB[p] * in.extentY[i] +
+                  planes.absC[p] * in.extentZ[i];
+        inside = d + std::min(e, in.radius[i]) >= 0.0f;
+      }
+      mask |= (unsigned)inside << lane;
+    }
+    masks[group] = (uint8_t)mask;
+    visibleCount += __builtin_popcount(mask);
+  }
+  return visibleCount;
+}
+#endif
+
+#ifdef FRUSTUM_CULLER_USE_SSE
+// Mitad de un grupo: 4 objetos desde i
+inline int cullFourSSE(const CullInput &in, const CullPlanes &planes,
+                       size_t i) {
+  __m128 cx = _mm_loadu_ps(in.centerX + i);
+  __m128 cy = _mm_loadu_ps(in.centerY + i);
+  __m128 cz = _mm_loadu_ps(in.centerZ + i);
+  __m128 ex = _mm_loadu_ps(in.extentX + i);
+  __m128 ey = _mm_loadu_ps(in.extentY + i);
+  __m128 ez = _mm_loadu_ps(in.extentZ + i);
+  __m128 r = _mm_loadu_ps(in.radius + i);
+  __m128 zero = _mm_setzero_ps();
+
+  __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (int p = 0; p < 6; p++) {
+    __m128 d = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.a[p]), cx),
+                   _mm_mul_ps(_mm_set1_ps(planes.b[p]), cy)),
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.c[p]), cz),
+                   _mm_set1_ps(planes.d[p])));
+    __m128 e = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.absA[p]), ex),
+                   _mm_mul_ps(_mm_set1_ps(planes.absB[p]), ey)),
+        _mm_mul_ps(_mm_set1_ps(planes.absC[p]), ez));
+    __m128 reach = _mm_add_ps(d, _mm_min_ps(e, r));
+    inside = _mm_and_ps(inside, _mm_cmpge_ps(reach, zero));
+  }
+  return _mm_movemask_ps(inside);
+}
+
+size_t cullSSE(const CullInput &in, const CullPlanes &planes, size_t first,
+               size_t last, uint8_t *masks) {
+  size_t visibleCount = 0;
+  for (size_t group = first; group < last; group++) {
+    size_t i = group * GROUP;
+    int mask = cullFourSSE(in, planes, i) |
+               (cullFourSSE(in, planes, i + 4) << 4);
+    masks[group] = (uint8_t)mask;
+    visibleCount += __builtin_popcount(mask);
+  }
+  return visibleCount;
+}
+#endif
+
+#ifdef FRUSTUM_CULLER_USE_AVX2
+__attribute__((target("avx2,fma"))) size_t
+cullAVX2(const CullInput &in, const CullPlanes &planes, size_t first,
+         size_t last, uint8_t *masks) {
+  size_t visibleCount = 0;
+  const __m256 zero = _mm256_setzero_ps();
+  for (size_t group = first; group < last; group++) {
+    size_t i = group * GROUP;
+    __m256 cx = _mm256_loadu_ps(in.centerX + i);
+    __m256 cy = _mm256_loadu_ps(in.centerY + i);
+    __m256 cz = _mm256_loadu_ps(in.centerZ + i);
+    __m256 ex = _mm256_loadu_ps(in.extentX + i);
+    __m256 ey = _mm256_loadu_ps(in.extentY + i);
+    __m256 ez = _mm256_loadu_ps(in.extentZ + i);
+    __m256 r = _mm256_loadu_ps(in.radius + i);
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      __m256 d = _mm256_fmadd_ps(
+          _mm256_set1_ps(planes.a[p]), cx,
+          _mm256_fmadd_ps(_mm256_set1_ps(planes.b[p]), cy,
+                          _mm256_fmadd_ps(_mm256_set1_ps(planes.c[p]), cz,
+                                          _mm256_set1_ps(planes.d[p]))));
+      // La caja corta el plano si d + |n|.e >= 0 y la esfera si d + r >= 0;
+      // las dos a la vez si d + min(|n|.e, r) >= 0
+      __m256 e = _mm256_fmadd_ps(
+          _mm256_set1_ps(planes.absA[p]), ex,
+          _mm256_fmadd_ps(_mm256_set1_ps(planes.absB[p]), ey,
+                          _mm256_mul_ps(_mm256_set1_ps(planes.absC[p]), ez)));
+      __m256 reach = _mm256_add_ps(d, _mm256_min_ps(e, r));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(reach, zero, _CMP_GE_OQ));
+    }
+    int mask = _mm256_movemask_ps(inside);
+    masks[group] = (uint8_t)mask;
+    visibleCount += __builtin_popcount(mask);
+  }
+  return visibleCount;
+}
+#endif
+
+struct KernelChoice {
+  CullKernel kernel;
+  const char *name;
+};
+
+// Se elige la primera vez que se usa y no en un constructor estatico:
+// __builtin_cpu_supports necesita que libgcc ya haya leido el cpuid
+const KernelChoice &kernelChoice() {
+  static const KernelChoice choice = [] {
+#ifdef FRUSTUM_CULLER_USE_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return KernelChoice{cullAVX2, "avx2"};
+#endif
+#ifdef FRUSTUM_CULLER_USE_SSE
+    return KernelChoice{cullSSE, "sse2"};
+#else
+    return KernelChoice{cullScalar, "scalar"};
+#endif
+  }();
+  return choice;
+}
+
+} // namespace
+
+uint32_t FrustumCuller::add(const Vec3 &boundsMin, const Vec3 &boundsMax,
+                            float sphereRadius) {
+  // Los arreglos crecen de a un grupo entero, con ceros de relleno: los
+  // kernels siempre leen 8 objetos
+  if (count == centerX.size()) {
+    size_t padded = count + GROUP;
+    for (std::vector<float> *array : {&centerX, &centerY, &centerZ, &extentX,
+                                      &extentY, &extentZ, &radius})
+      array->resize(padded, 0.0f);
+  }
+  uint32_t index = (uint32_t)count++;
+  update(index, boundsMin, boundsMax, sphereRadius);
+  return index;
+}
+
+void FrustumCuller::update(uint32_t index, const Vec3 &boundsMin,
+                           const Vec3 &boundsMax, float sphereRadius) {
+  float ex = (boundsMax.x - boundsMin.x) * 0.5f;
+  float ey = (boundsMax.y - boundsMin.y) * 0.5f;
+  float ez = (boundsMax.z - boundsMin.z) * 0.5f;
+  centerX[index] = boundsMin.x + ex;
+  centerY[index] = boundsMin.y + ey;
+  centerZ[index] = boundsMin.z + ez;
+  extentX[index] = ex;
+  extentY[index] = ey;
+  extentZ[index] = ez;
+  radius[index] = sphereRadius >= 0.0f
+                      ? sphereRadius
+                      : std::sqrt(ex * ex + ey * ey + ez * ez);
+}
+
+void FrustumCuller::reserve(size_t capacity) {
+  size_t padded = (capacity + GROUP - 1) / GROUP * GROUP;
+  for (std::vector<float> *array : {&centerX, &centerY, &centerZ, &extentX,
+                                    &extentY, &extentZ, &radius})
+    array->reserve(padded);
+  masks.reserve(padded / GROUP);
+  visible.reserve(capacity);
+}
+
+void FrustumCuller::clear() {
+  for (std::vector<float> *array : {&centerX, &centerY, &centerZ, &extentX,
+                                    &extentY, &extentZ, &radius})
+    array->clear();
+  visible.clear();
+  count = 0;
+}
+
+const char *FrustumCuller::implementation() { return kernelChoice().name; }
+
+size_t FrustumCuller::cull(const Frustum &frustum) {
+  if (count == 0) {
+    visible.clear();
+    return 0;
+  }
+
+  CullPlanes planes;
+  for (int p = 0; p < 6; p++) {
+    const Plane &plane = frustum.planes[p];
+    planes.a[p] = plane.a;
+    planes.b[p] = plane.b;
+    planes.c[p] = plane.c;
+    planes.d[p] = plane.d;
+    planes.absA[p] = std::fabs(plane.a);
+    planes.absB[p] = std::fabs(plane.b);
+    planes.absC[p] = std::fabs(plane.c);
+  }
+  CullInput in = {centerX.data(), centerY.data(), centerZ.data(),
+                  extentX.data(), extentY.data(), extentZ.data(),
+                  radius.data()};
+
+  CullKernel kernel = kernelChoice().kernel;
+  size_t groups = (count + GROUP - 1) / GROUP;
+  size_t blocks = (groups + BLOCK_GROUPS - 1) / BLOCK_GROUPS;
+  masks.resize(groups);
+  blockVisible.resize(blocks);
+  // Los objetos de relleno del ultimo grupo no cuentan
+  unsigned tailMask = count % GROUP == 0 ? 0xffu
+                                         : (1u << (count % GROUP)) - 1u;
+
+  auto testBlocks = [&](size_t firstBlock, size_t lastBlock) {
+    for (size_t block = firstBlock; block < lastBlock; block++) {
+      size_t first = block * BLOCK_GROUPS;
+      size_t last = std::min(groups, first + BLOCK_GROUPS);
+      size_t passed = kernel(in, planes, first, last, masks.data());
+      if (last == groups) {
+        uint8_t &tail = masks[groups - 1];
+        passed -= __builtin_popcount(tail & ~tailMask & 0xffu);
+        tail &= (uint8_t)tailMask;
+      }
+      blockVisible[block] = (uint32_t)passed;
+    }
+  };
+  auto writeBlocks = [&](size_t firstBlock, size_t lastBlock) {
+    for (size_t block = firstBlock; block < lastBlock; block++) {
+      uint32_t *out = visible.data() + blockVisible[block];
+      size_t first = block * BLOCK_GROUPS;
+      size_t last = std::min(groups, first + BLOCK_GROUPS);
+      for (size_t group = first; group < last; group++) {
+        unsigned mask = masks[group];
+        while (mask != 0) {
+          *out++ = (uint32_t)(group * GROUP + __builtin_ctz(mask));
+          mask &= mask - 1;
+        }
+      }
+    }
+  };
+
+  // Con un solo bloque no vale la pena despertar a los workers
+  if (blocks == 1)
+    testBlocks(0, 1);
+  else
+    JobSystem::shared().parallelFor(0, blocks, 1, testBlocks);
+
+  // Los conteos pasan a ser el offset de cada bloque en la lista
+  uint32_t total = 0;
+  for (uint32_t &blockCount : blockVisible) {
+    uint32_t passed = blockCount;
+    blockCount = total;
+    total += passed;
+  }
+  visible.resize(total);
+
+  if (blocks == 1)
+    writeBlocks(0, 1);
+  else
+    JobSystem::shared().parallelFor(0, blocks, 1, writeBlocks);
+  return total;
+}
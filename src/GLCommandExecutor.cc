@@ -0,0 +1,70 @@
+#include "GLCommandExecutor.h"
+#include <glad/glad.h>
+#include <vector>
+
+namespace {
+
+// Argumentos de glMultiDrawElements; solo los usa el hilo de GL
+std::vector<GLsizei> multiDrawCounts;
+std::vector<const void *> multiDrawOffsets;
+
+} // namespace
+
+void executeCommandList(const CommandList &list, GLStateCache &state) {
+  // La unica funcion de blending de las listas (ver PIPELINE_BLEND)
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  for (const Command &command : list.commands) {
+    switch (command.type) {
+    case CommandType::SetPipeline:
+      state.useProgram(command.a);
+      state.setBlend((command.b & PIPELINE_BLEND) != 0);
+      state.setDepthWrite((command.b & PIPELINE_BLEND) == 0);
+      state.setDepthTest((command.b & PIPELINE_DEPTH_TEST) != 0);
+      break;
+    case CommandType::BindTexture:
+      state.bindTexture(command.unit, GL_TEXTURE_2D, command.a);
+      break;
+    case CommandType::BindMesh:
+      state.bindVertexArray(command.a);
+      break;
+    case CommandType::SetUniform1f:
+      glUniform1f((GLint)command.a, command.values[0]);
+      break;
+    case CommandType::SetUniform4f:
+      glUniform4fv((GLint)command.a, 1, command.values);
+      break;
+    case CommandType::SetUniform1i:
+      glUniform1i((GLint)command.a, (GLint)command.b);
+      break;
+    case CommandType::SetUniformMat4:
+      glUniformMatrix4fv((GLint)command.a, 1, GL_FALSE,
+                         &list.payload[command.b]);
+      break;
+    case CommandType::DrawIndexed:
+      glDrawElementsBaseVertex(
+          GL_TRIANGLES, (GLsizei)command.a, GL_UNSIGNED_INT,
+          (void *)((size_t)command.b * sizeof(unsigned int)), command.c);
+      break;
+    case CommandType::MultiDrawIndexed: {
+      multiDrawCounts.resize(command.a);
+      multiDrawOffsets.resize(command.a);
+      const uint32_t *ranges = &list.ranges[command.b];
+      for (uint32_t i = 0; i < command.a; i++) {
+        multiDrawOffsets[i] =
+            (const void *)((size_t)ranges[2 * i] * sizeof(unsigned int));
+        multiDrawCounts[i] = (GLsizei)ranges[2 * i + 1];
+      }
+      glMultiDrawElements(GL_TRIANGLES, multiDrawCounts.data(),
+                          GL_UNSIGNED_INT, multiDrawOffsets.data(),
+                          (GLsizei)command.a);
+      break;
+    }
+    }
+  }
+}
+
+void executeCommandLists(const std::vector<CommandList> &lists,
+                         GLStateCache &state) {
+  for (const CommandList &list : lists)
+    executeCommandList(list, state);
+}
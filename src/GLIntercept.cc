@@ -0,0 +1,358 @@
+#include "GLIntercept.h"
+#include "GLFunctions.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <type_traits>
+
+namespace {
+
+const char *const FUNCTION_NAMES[GL_FN_COUNT] = {
+#define GL_INTERCEPT_NAME(name, kinds, object) "gl" #name,
+    GL_FUNCTIONS(GL_INTERCEPT_NAME)
+#undef GL_INTERCEPT_NAME
+};
+
+// Frame en curso; los escriben los envoltorios desde cualquier hilo
+struct Counters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> redundant{0};
+  std::atomic<uint64_t> nanoseconds{0};
+};
+
+// Acumulado desde el ultimo collect(), solo lo toca endFrame()/collect()
+struct Totals {
+  uint64_t calls = 0;
+  uint64_t redundant = 0;
+  uint64_t nanoseconds = 0;
+  uint64_t maxCalls = 0;
+};
+
+Counters counters[GL_FN_COUNT];
+Totals totals[GL_FN_COUNT];
+uint64_t totalFrames = 0;
+std::mutex totalsMutex;
+bool hooksInstalled = false;
+
+/* ------------ Deteccion de redundancias ------------ */
+
+const GLuint UNKNOWN = 0xffffffffu;
+const int TRACKED_UNITS = 32;
+const int TRACKED_CAPS = 16;
+
+// Lo que el contexto de este hilo tiene enlazado, segun lo que vimos pasar.
+// UNKNOWN hasta la primera llamada, asi nunca marcamos algo que no sabemos
+struct TrackedState {
+  GLuint program = UNKNOWN;
+  GLuint vertexArray = UNKNOWN;
+  GLuint elementBuffer = UNKNOWN; // parte del estado del VAO
+  GLuint arrayBuffer = UNKNOWN;
+  GLuint drawFramebuffer = UNKNOWN;
+  GLuint readFramebuffer = UNKNOWN;
+  GLenum activeUnit = UNKNOWN;
+  GLuint textures2D[TRACKED_UNITS];
+  GLenum caps[TRACKED_CAPS];
+  GLint capEnabled[TRACKED_CAPS];
+  int capCount = 0;
+  GLfloat clearColor[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+  GLint viewport[4] = {-1, -1, -1, -1};
+  GLenum blend[2] = {UNKNOWN, UNKNOWN};
+  GLint depthMask = -1;
+
+  TrackedState() {
+    std::fill(textures2D, textures2D + TRACKED_UNITS, UNKNOWN);
+  }
+
+  void reset() { *this = TrackedState(); }
+};
+
+thread_local TrackedState state;
+
+// Devuelve true si el valor ya era ese; si no, lo guarda
+template <typename T> bool same(T &tracked, T value) {
+  if (tracked == value)
+    return true;
+  tracked = value;
+  return false;
+}
+
+bool sameCap(GLenum cap, GLint enabled) {
+  for (int i = 0; i < state.capCount; i++)
+    if (state.caps[i] == cap)
+      return same(state.capEnabled[i], enabled);
+  if (state.capCount < TRACKED_CAPS) {
+    state.caps[state.capCount] = cap;
+    state.capEnabled[state.capCount] = enabled;
+    state.capCount++;
+  }
+  return false;
+}
+
+template <int Id> using Tag = std::integral_constant<int, Id>;
+
+// Por defecto una llamada nunca es redundante
+template <int Id, typename... Args> bool redundant(Tag<Id>, Args...) {
+  return false;
+}
+
+bool redundant(Tag<GL_FN_UseProgram>, GLuint program) {
+  return same(state.program, program);
+}
+
+bool redundant(Tag<GL_FN_BindVertexArray>, GLuint vertexArray) {
+  if (same(state.vertexArray, vertexArray))
+    return true;
+  state.elementBuffer = UNKNOWN;
+  return false;
+}
+
+bool redundant(Tag<GL_FN_BindBuffer>, GLenum target, GLuint buffer) {
+  if (target == GL_ARRAY_BUFFER)
+    return same(state.arrayBuffer, buffer);
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    return same(state.elementBuffer, buffer);
+  return false;
+}
+
+bool redundant(Tag<GL_FN_BindBufferBase>, GLenum target, GLuint, GLuint buffer) {
+  // Tambien cambia el binding generico del target
+  if (target == GL_ARRAY_BUFFER)
+    state.arrayBuffer = buffer;
+  return false;
+}
+
+bool redundant(Tag<GL_FN_ActiveTexture>, GLenum unit) {
+  return same(state.activeUnit, unit);
+}
+
+bool redundant(Tag<GL_FN_BindTexture>, GLenum target, GLuint texture) {
+  if (target != GL_TEXTURE_2D || state.activeUnit == UNKNOWN)
+    return false;
+  GLuint unit = state.activeUnit - GL_TEXTURE0;
+  if (unit >= (GLuint)TRACKED_UNITS)
+    return false;
+  return same(state.textures2D[unit], texture);
+}
+
+bool redundant(Tag<GL_FN_BindFramebuffer>, GLenum target, GLuint framebuffer) {
+  if (target == GL_DRAW_FRAMEBUFFER)
+    return same(state.drawFramebuffer, framebuffer);
+  if (target == GL_READ_FRAMEBUFFER)
+    return same(state.readFramebuffer, framebuffer);
+  bool draw = same(state.drawFramebuffer, framebuffer);
+  bool read = same(state.readFramebuffer, framebuffer);
+  return draw && read;
+}
+
+bool redundant(Tag<GL_FN_Enable>, GLenum cap) { return sameCap(cap, 1); }
+bool redundant(Tag<GL_FN_Disable>, GLenum cap) { return sameCap(cap, 0); }
+
+bool redundant(Tag<GL_FN_ClearColor>, GLfloat r, GLfloat g, GLfloat b,
+               GLfloat a) {
+  GLfloat color[4] = {r, g, b, a};
+  bool result = std::equal(color, color + 4, state.clearColor);
+  std::copy(color, color + 4, state.clearColor);
+  return result;
+}
+
+bool redundant(Tag<GL_FN_Viewport>, GLint x, GLint y, GLsizei width,
+               GLsizei height) {
+  GLint viewport[4] = {x, y, width, height};
+  bool result = std::equal(viewport, viewport + 4, state.viewport);
+  std::copy(viewport, viewport + 4, state.viewport);
+  return result;
+}
+
+bool redundant(Tag<GL_FN_BlendFunc>, GLenum source, GLenum destination) {
+  bool result = state.blend[0] == source && state.blend[1] == destination;
+  state.blend[0] = source;
+  state.blend[1] = destination;
+  return result;
+}
+
+bool redundant(Tag<GL_FN_DepthMask>, GLboolean flag) {
+  return same(state.depthMask, (GLint)flag);
+}
+
+// Borrar un objeto enlazado cambia el binding a 0 por detras; en vez de
+// seguir cada caso olvidamos todo lo que sabiamos
+template <typename... Args> bool forget(Args...) {
+  state.reset();
+  return false;
+}
+template <typename... Args>
+bool redundant(Tag<GL_FN_DeleteTextures>, Args... args) {
+  return forget(args...);
+}
+template <typename... Args>
+bool redundant(Tag<GL_FN_DeleteBuffers>, Args... args) {
+  return forget(args...);
+}
+template <typename... Args>
+bool redundant(Tag<GL_FN_DeleteVertexArrays>, Args... args) {
+  return forget(args...);
+}
+template <typename... Args>
+bool redundant(Tag<GL_FN_DeleteFramebuffers>, Args... args) {
+  return forget(args...);
+}
+template <typename... Args>
+bool redundant(Tag<GL_FN_DeleteProgram>, Args... args) {
+  return forget(args...);
+}
+
+/* ------------ Envoltorios ------------ */
+
+template <int Id, typename Pointer> struct Hook;
+
+template <int Id, typename R, typename... Args>
+struct Hook<Id, R(APIENTRYP)(Args...)> {
+  typedef R(APIENTRYP Pointer)(Args...);
+  static Pointer original;
+
+  static R APIENTRY call(Args... args) {
+    Counters &entry = counters[Id];
+    entry.calls.fetch_add(1, std::memory_order_relaxed);
+    if (redundant(Tag<Id>(), args...))
+      entry.redundant.fetch_add(1, std::memory_order_relaxed);
+
+    auto start = std::chrono::steady_clock::now();
+    if constexpr (std::is_void<R>::value) {
+      original(args...);
+      record(entry, start);
+    } else {
+      R result = original(args...);
+      record(entry, start);
+      return result;
+    }
+  }
+
+  static void record(Counters &entry,
+                     std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    entry.nanoseconds.fetch_add(
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            elapsed)
+            .count(),
+        std::memory_order_relaxed);
+  }
+};
+
+template <int Id, typename R, typename... Args>
+typename Hook<Id, R(APIENTRYP)(Args...)>::Pointer
+    Hook<Id, R(APIENTRYP)(Args...)>::original = nullptr;
+
+#define GL_INTERCEPT_HOOK(name)                                               \
+  Hook<GL_FN_##name, decltype(glad_gl##name)>
+
+} // namespace
+
+bool GLIntercept::install() {
+  if (hooksInstalled)
+    return true;
+  if (glad_glGetString == nullptr) {
+    std::cout << "ERROR::GL_INTERCEPT::GLAD_NOT_LOADED" << std::endl;
+    return false;
+  }
+  // Las que el driver no tiene quedan en nullptr, igual que sin la capa
+#define GL_INTERCEPT_INSTALL(name, kinds, object)                             \
+  if (glad_gl##name != nullptr) {                                             \
+    GL_INTERCEPT_HOOK(name)::original = glad_gl##name;                        \
+    glad_gl##name = &GL_INTERCEPT_HOOK(name)::call;                           \
+  }
+  GL_FUNCTIONS(GL_INTERCEPT_INSTALL)
+#undef GL_INTERCEPT_INSTALL
+  state.reset();
+  hooksInstalled = true;
+  return true;
+}
+
+void GLIntercept::uninstall() {
+  if (!hooksInstalled)
+    return;
+#define GL_INTERCEPT_UNINSTALL(name, kinds, object)                           \
+  if (GL_INTERCEPT_HOOK(name)::original != nullptr) {                         \
+    glad_gl##name = GL_INTERCEPT_HOOK(name)::original;                        \
+    GL_INTERCEPT_HOOK(name)::original = nullptr;                              \
+  }
+  GL_FUNCTIONS(GL_INTERCEPT_UNINSTALL)
+#undef GL_INTERCEPT_UNINSTALL
+  hooksInstalled = false;
+}
+
+bool GLIntercept::installed() { return hooksInstalled; }
+
+void GLIntercept::endFrame() {
+  if (!hooksInstalled)
+    return;
+  std::lock_guard<std::mutex> lock(totalsMutex);
+  for (int i = 0; i < GL_FN_COUNT; i++) {
+    uint64_t calls = counters[i].calls.exchange(0, std::memory_order_relaxed);
+    totals[i].calls += calls;
+    totals[i].redundant +=
+        counters[i].redundant.exchange(0, std::memory_order_relaxed);
+    totals[i].nanoseconds +=
+        counters[i].nanoseconds.exchange(0, std::memory_order_relaxed);
+    totals[i].maxCalls = std::max(totals[i].maxCalls, calls);
+  }
+  totalFrames++;
+}
+
+std::vector<GLIntercept::EntryStats> GLIntercept::collect(uint64_t *frames) {
+  std::lock_guard<std::mutex> lock(totalsMutex);
+  std::vector<EntryStats> entries;
+  double perFrame = totalFrames > 0 ? 1.0 / totalFrames : 0.0;
+  for (int i = 0; i < GL_FN_COUNT; i++) {
+    if (totals[i].calls == 0)
+      continue;
+    EntryStats stats;
+    stats.name = FUNCTION_NAMES[i];
+    stats.calls = totals[i].calls * perFrame;
+    stats.redundant = totals[i].redundant * perFrame;
+    stats.cpuUs = totals[i].nanoseconds / 1000.0 * perFrame;
+    stats.maxCalls = totals[i].maxCalls;
+    entries.push_back(stats);
+    totals[i] = Totals();
+  }
+  if (frames != nullptr)
+    *frames = totalFrames;
+  totalFrames = 0;
+
+  std::sort(entries.begin(), entries.end(),
+            [](const EntryStats &a, const EntryStats &b) {
+              return a.cpuUs > b.cpuUs;
+            });
+  return entries;
+}
+
+std::string GLIntercept::report(size_t top) {
+  uint64_t frames = 0;
+  std::vector<EntryStats> entries = collect(&frames);
+  double calls = 0.0, redundantCalls = 0.0, cpuUs = 0.0;
+  for (const EntryStats &stats : entries) {
+    calls += stats.calls;
+    redundantCalls += stats.redundant;
+    cpuUs += stats.cpuUs;
+  }
+
+  char line[160];
+  std::snprintf(line, sizeof(line),
+                "%llu frames | %.1f calls, %.1f redundant, %.3f ms in GL "
+                "per frame\n",
+                (unsigned long long)frames, calls, redundantCalls,
+                cpuUs / 1000.0);
+  std::string text = line;
+  for (size_t i = 0; i < entries.size() && i < top; i++) {
+    const EntryStats &stats = entries[i];
+    std::snprintf(line, sizeof(line),
+                  "  %-32s %9.1f calls (max %llu) %8.1f redundant %9.2f us\n",
+                  stats.name, stats.calls, (unsigned long long)stats.maxCalls,
+                  stats.redundant, stats.cpuUs);
+    text += line;
+  }
+  return text;
+}
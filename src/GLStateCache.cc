@@ -0,0 +1,87 @@
+#include "GLStateCache.h"
+
+const unsigned int UNKNOWN_OBJECT = 0xffffffffu;
+
+void GLStateCache::invalidate() {
+  program = UNKNOWN_OBJECT;
+  vertexArray = UNKNOWN_OBJECT;
+  activeUnit = -1;
+  for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+    textures[i] = UNKNOWN_OBJECT;
+    textureTargets[i] = 0;
+  }
+  blend = depthTest = depthWrite = cullFace = -1;
+}
+
+void GLStateCache::useProgram(unsigned int id) {
+  if (program == id) {
+    redundant++;
+    return;
+  }
+  program = id;
+  glUseProgram(id);
+  changes++;
+}
+
+void GLStateCache::bindVertexArray(unsigned int VAO) {
+  if (vertexArray == VAO) {
+    redundant++;
+    return;
+  }
+  vertexArray = VAO;
+  glBindVertexArray(VAO);
+  changes++;
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, unsigned int texture) {
+  if (unit < 0 || unit >= MAX_TEXTURE_UNITS)
+    return;
+  if (textures[unit] == texture && textureTargets[unit] == target) {
+    redundant++;
+    return;
+  }
+  if (activeUnit != unit) {
+    activeUnit = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+  textures[unit] = texture;
+  textureTargets[unit] = target;
+  glBindTexture(target, texture);
+  changes++;
+}
+
+void GLStateCache::setCapability(GLenum capability, int &current,
+                                 bool enabled) {
+  if (current == (int)enabled) {
+    redundant++;
+    return;
+  }
+  current = enabled;
+  if (enabled)
+    glEnable(capability);
+  else
+    glDisable(capability);
+  changes++;
+}
+
+void GLStateCache::setBlend(bool enabled) {
+  setCapability(GL_BLEND, blend, enabled);
+}
+
+void GLStateCache::setDepthTest(bool enabled) {
+  setCapability(GL_DEPTH_TEST, depthTest, enabled);
+}
+
+void GLStateCache::setCullFace(bool enabled) {
+  setCapability(GL_CULL_FACE, cullFace, enabled);
+}
+
+void GLStateCache::setDepthWrite(bool enabled) {
+  if (depthWrite == (int)enabled) {
+    redundant++;
+    return;
+  }
+  depthWrite = enabled;
+  glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+  changes++;
+}
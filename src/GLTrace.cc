@@ -0,0 +1,853 @@
+#include "GLTrace.h"
+#include "GLFunctions.h"
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+/* Formato (little endian, sin alinear):
+ *
+ *   header:  "GLTRACE1" u32 version, u32 GL_FN_COUNT, u32 ancho, u32 alto
+ *   record:  u16 funcion, u8 payloads, u8 slots, slots * u64,
+ *            payloads * (u32 tamaño, bytes)
+ *
+ * Los slots son los argumentos en orden (enteros extendidos a 64 bits,
+ * floats por bits, punteros por su valor) y al final el resultado si la
+ * funcion lo necesita al reproducir. Un payload con tamaño NULL_PAYLOAD es
+ * un puntero nulo o un offset dentro de un buffer, que queda en el slot. */
+
+namespace {
+
+const char MAGIC[8] = {'G', 'L', 'T', 'R', 'A', 'C', 'E', '1'};
+const uint32_t VERSION = 1;
+const uint32_t NULL_PAYLOAD = 0xffffffffu;
+// Registros que no son llamadas GL
+const uint16_t RECORD_FRAME_END = 0xffff; // slot: ns desde start()
+const uint16_t RECORD_MAP_WRITE = 0xfffe; // slot: target, payload: bytes
+const size_t FLUSH_BYTES = 1 << 20;
+
+const char *const KINDS[GL_FN_COUNT] = {
+#define GL_TRACE_KINDS(name, kinds, object) kinds,
+    GL_FUNCTIONS(GL_TRACE_KINDS)
+#undef GL_TRACE_KINDS
+};
+
+const char OBJECTS[GL_FN_COUNT] = {
+#define GL_TRACE_OBJECT(name, kinds, object) object,
+    GL_FUNCTIONS(GL_TRACE_OBJECT)
+#undef GL_TRACE_OBJECT
+};
+
+const char *const FUNCTION_NAMES[GL_FN_COUNT] = {
+#define GL_TRACE_NAME(name, kinds, object) "gl" #name,
+    GL_FUNCTIONS(GL_TRACE_NAME)
+#undef GL_TRACE_NAME
+};
+
+/* ------------ Slots ------------ */
+
+template <typename T> uint64_t toSlot(T value) {
+  if constexpr (std::is_pointer<T>::value) {
+    return (uint64_t)(uintptr_t)value;
+  } else if constexpr (std::is_same<T, float>::value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  } else if constexpr (std::is_same<T, double>::value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  } else {
+    return (uint64_t)(int64_t)value;
+  }
+}
+
+template <typename T> T fromSlot(uint64_t slot) {
+  if constexpr (std::is_pointer<T>::value) {
+    return (T)(uintptr_t)slot;
+  } else if constexpr (std::is_same<T, float>::value) {
+    uint32_t bits = (uint32_t)slot;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  } else if constexpr (std::is_same<T, double>::value) {
+    double value;
+    std::memcpy(&value, &slot, sizeof(value));
+    return value;
+  } else {
+    return (T)slot;
+  }
+}
+
+// Bytes por pixel de un formato/tipo de glTexImage2D o glReadPixels
+size_t pixelSize(GLenum format, GLenum type) {
+  switch (type) {
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+    return 2;
+  case GL_UNSIGNED_INT_8_8_8_8:
+  case GL_UNSIGNED_INT_8_8_8_8_REV:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_10F_11F_11F_REV:
+  case GL_UNSIGNED_INT_24_8:
+    return 4;
+  case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+    return 8;
+  }
+
+  size_t components = 4;
+  switch (format) {
+  case GL_RED:
+  case GL_RED_INTEGER:
+  case GL_DEPTH_COMPONENT:
+  case GL_STENCIL_INDEX:
+    components = 1;
+    break;
+  case GL_RG:
+  case GL_RG_INTEGER:
+    components = 2;
+    break;
+  case GL_RGB:
+  case GL_BGR:
+  case GL_RGB_INTEGER:
+    components = 3;
+    break;
+  }
+
+  switch (type) {
+  case GL_UNSIGNED_BYTE:
+  case GL_BYTE:
+    return components;
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return components * 2;
+  default:
+    return components * 4;
+  }
+}
+
+/* ------------ Grabacion ------------ */
+
+struct Payload {
+  const void *data;
+  uint32_t size;
+};
+
+struct Mapping {
+  GLenum target;
+  void *pointer;
+  size_t length;
+  GLbitfield access;
+};
+
+struct Recorder {
+  std::mutex mutex;
+  FILE *file = nullptr;
+  std::vector<uint8_t> buffer;
+  std::vector<Payload> payloads;
+  std::chrono::steady_clock::time_point origin;
+
+  // Estado que hace falta para saber el tamaño de los datos
+  GLuint unpackBuffer = 0;
+  GLuint packBuffer = 0;
+  GLint unpackAlignment = 4;
+  std::vector<Mapping> mappings;
+
+  void append(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+
+  void write(uint16_t function, const uint64_t *slots, uint8_t slotCount) {
+    uint8_t payloadCount = (uint8_t)payloads.size();
+    append(&function, sizeof(function));
+    append(&payloadCount, sizeof(payloadCount));
+    append(&slotCount, sizeof(slotCount));
+    append(slots, slotCount * sizeof(uint64_t));
+    for (const Payload &payload : payloads) {
+      append(&payload.size, sizeof(payload.size));
+      if (payload.size != NULL_PAYLOAD)
+        append(payload.data, payload.size);
+    }
+    payloads.clear();
+    if (buffer.size() >= FLUSH_BYTES)
+      flush();
+  }
+
+  void flush() {
+    if (file != nullptr && !buffer.empty())
+      std::fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+  }
+
+  void add(const void *data, size_t size) {
+    payloads.push_back(
+        Payload{data, data != nullptr ? (uint32_t)size : NULL_PAYLOAD});
+  }
+
+  // Pixeles de entrada: offset si hay un GL_PIXEL_UNPACK_BUFFER enlazado
+  void addImage(GLsizei width, GLsizei height, GLenum format, GLenum type,
+                const void *pixels) {
+    if (unpackBuffer != 0 || pixels == nullptr) {
+      add(nullptr, 0);
+      return;
+    }
+    size_t row = (size_t)width * pixelSize(format, type);
+    size_t stride = (row + unpackAlignment - 1) / unpackAlignment *
+                    unpackAlignment;
+    add(pixels, height > 0 ? stride * (height - 1) + row : 0);
+  }
+};
+
+Recorder recorder;
+bool hooksInstalled = false;
+
+template <int Id> using Tag = std::integral_constant<int, Id>;
+
+/* Datos a los que apuntan los argumentos, en el orden de los argumentos.
+ * Se llama despues de la llamada real, asi los Gen* ya tienen los nombres */
+template <int Id, typename... Args>
+void recordPayloads(Tag<Id>, uint64_t, Args...) {}
+
+void recordPayloads(Tag<GL_FN_BufferData>, uint64_t, GLenum, GLsizeiptr size,
+                    const void *data, GLenum) {
+  recorder.add(data, size);
+}
+
+void recordPayloads(Tag<GL_FN_BufferSubData>, uint64_t, GLenum, GLintptr,
+                    GLsizeiptr size, const void *data) {
+  recorder.add(data, size);
+}
+
+void recordPayloads(Tag<GL_FN_ClearBufferData>, uint64_t, GLenum, GLenum,
+                    GLenum format, GLenum type, const void *data) {
+  recorder.add(data, pixelSize(format, type));
+}
+
+void recordPayloads(Tag<GL_FN_TexImage2D>, uint64_t, GLenum, GLint, GLint,
+                    GLsizei width, GLsizei height, GLint, GLenum format,
+                    GLenum type, const void *pixels) {
+  recorder.addImage(width, height, format, type, pixels);
+}
+
+// Las capas van seguidas, como una imagen de height * depth filas
+void recordPayloads(Tag<GL_FN_TexImage3D>, uint64_t, GLenum, GLint, GLint,
+                    GLsizei width, GLsizei height, GLsizei depth, GLint,
+                    GLenum format, GLenum type, const void *pixels) {
+  recorder.addImage(width, height * depth, format, type, pixels);
+}
+
+void recordPayloads(Tag<GL_FN_TexSubImage2D>, uint64_t, GLenum, GLint, GLint,
+                    GLint, GLsizei width, GLsizei height, GLenum format,
+                    GLenum type, const void *pixels) {
+  recorder.addImage(width, height, format, type, pixels);
+}
+
+void recordPayloads(Tag<GL_FN_Uniform4fv>, uint64_t, GLint, GLsizei count,
+                    const GLfloat *value) {
+  recorder.add(value, count * 4 * sizeof(GLfloat));
+}
+
+void recordPayloads(Tag<GL_FN_UniformMatrix4fv>, uint64_t, GLint,
+                    GLsizei count, GLboolean, const GLfloat *value) {
+  recorder.add(value, count * 16 * sizeof(GLfloat));
+}
+
+void recordPayloads(Tag<GL_FN_MultiDrawElements>, uint64_t, GLenum,
+                    const GLsizei *count, GLenum, const void *const *indices,
+                    GLsizei drawCount) {
+  // Los indices son offsets dentro del GL_ELEMENT_ARRAY_BUFFER
+  recorder.add(count, drawCount * sizeof(GLsizei));
+  recorder.add(indices, drawCount * sizeof(void *));
+}
+
+void recordPayloads(Tag<GL_FN_DebugMessageControl>, uint64_t, GLenum, GLenum,
+                    GLenum, GLsizei count, const GLuint *ids, GLboolean) {
+  recorder.add(ids, count * sizeof(GLuint));
+}
+
+void recordPayloads(Tag<GL_FN_GetUniformLocation>, uint64_t, GLuint,
+                    const GLchar *name) {
+  recorder.add(name, std::strlen(name) + 1);
+}
+
+void recordPayloads(Tag<GL_FN_ShaderSource>, uint64_t, GLuint, GLsizei count,
+                    const GLchar *const *strings, const GLint *lengths) {
+  for (GLsizei i = 0; i < count; i++) {
+    size_t length = lengths != nullptr && lengths[i] >= 0
+                        ? (size_t)lengths[i]
+                        : std::strlen(strings[i]);
+    recorder.add(strings[i], length);
+  }
+}
+
+void recordNames(GLsizei count, const GLuint *names) {
+  recorder.add(names, count * sizeof(GLuint));
+}
+
+// Gen* recibe GLuint * y Delete* const GLuint *: el tipo tiene que ser
+// exacto o se elige la version generica que no graba nada
+#define GL_TRACE_NAMES(function, pointer)                                     \
+  void recordPayloads(Tag<GL_FN_##function>, uint64_t, GLsizei count,         \
+                      pointer names) {                                        \
+    recordNames(count, names);                                                \
+  }
+GL_TRACE_NAMES(GenBuffers, GLuint *)
+GL_TRACE_NAMES(GenFramebuffers, GLuint *)
+GL_TRACE_NAMES(GenQueries, GLuint *)
+GL_TRACE_NAMES(GenRenderbuffers, GLuint *)
+GL_TRACE_NAMES(GenTextures, GLuint *)
+GL_TRACE_NAMES(GenVertexArrays, GLuint *)
+GL_TRACE_NAMES(DeleteBuffers, const GLuint *)
+GL_TRACE_NAMES(DeleteFramebuffers, const GLuint *)
+GL_TRACE_NAMES(DeleteQueries, const GLuint *)
+GL_TRACE_NAMES(DeleteRenderbuffers, const GLuint *)
+GL_TRACE_NAMES(DeleteTextures, const GLuint *)
+GL_TRACE_NAMES(DeleteVertexArrays, const GLuint *)
+#undef GL_TRACE_NAMES
+
+void recordPayloads(Tag<GL_FN_BindBuffer>, uint64_t, GLenum target,
+                    GLuint buffer) {
+  if (target == GL_PIXEL_UNPACK_BUFFER)
+    recorder.unpackBuffer = buffer;
+  else if (target == GL_PIXEL_PACK_BUFFER)
+    recorder.packBuffer = buffer;
+}
+
+void recordPayloads(Tag<GL_FN_PixelStorei>, uint64_t, GLenum name,
+                    GLint value) {
+  if (name == GL_UNPACK_ALIGNMENT)
+    recorder.unpackAlignment = value;
+}
+
+void recordPayloads(Tag<GL_FN_MapBufferRange>, uint64_t result, GLenum target,
+                    GLintptr, GLsizeiptr length, GLbitfield access) {
+  if (result != 0)
+    recorder.mappings.push_back(
+        Mapping{target, (void *)(uintptr_t)result, (size_t)length, access});
+}
+
+// Antes de la llamada real: lo escrito en un mapeo se guarda antes de que
+// glUnmapBuffer lo invalide
+template <int Id, typename... Args> void beforeCall(Tag<Id>, Args...) {}
+
+void beforeCall(Tag<GL_FN_UnmapBuffer>, GLenum target) {
+  for (size_t i = 0; i < recorder.mappings.size(); i++) {
+    Mapping mapping = recorder.mappings[i];
+    if (mapping.target != target)
+      continue;
+    if ((mapping.access & GL_MAP_WRITE_BIT) != 0) {
+      uint64_t slot = target;
+      recorder.add(mapping.pointer, mapping.length);
+      recorder.write(RECORD_MAP_WRITE, &slot, 1);
+    }
+    recorder.mappings.erase(recorder.mappings.begin() + i);
+    return;
+  }
+}
+
+template <int Id, typename Pointer> struct Hook;
+
+template <int Id, typename R, typename... Args>
+struct Hook<Id, R(APIENTRYP)(Args...)> {
+  typedef R(APIENTRYP Pointer)(Args...);
+  static Pointer original;
+
+  static R APIENTRY call(Args... args) {
+    // Una llamada a la vez, asi el orden de la traza es el orden real
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    beforeCall(Tag<Id>(), args...);
+    uint64_t slots[sizeof...(Args) + 1] = {toSlot(args)...};
+    uint8_t slotCount = (uint8_t)sizeof...(Args);
+    bool keepResult = KINDS[Id][0] != '-';
+
+    if constexpr (std::is_void<R>::value) {
+      original(args...);
+      recordPayloads(Tag<Id>(), (uint64_t)0, args...);
+      recorder.write(Id, slots, slotCount);
+    } else {
+      R result = original(args...);
+      slots[slotCount] = toSlot(result);
+      recordPayloads(Tag<Id>(), slots[slotCount], args...);
+      recorder.write(Id, slots, slotCount + (keepResult ? 1 : 0));
+      return result;
+    }
+  }
+};
+
+template <int Id, typename R, typename... Args>
+typename Hook<Id, R(APIENTRYP)(Args...)>::Pointer
+    Hook<Id, R(APIENTRYP)(Args...)>::original = nullptr;
+
+#define GL_TRACE_HOOK(name) Hook<GL_FN_##name, decltype(glad_gl##name)>
+
+/* ------------ Funciones sin grabar ------------ */
+
+/* Mientras se graba, glad se recarga para que cada entry point que no esta
+ * en GLFunctions.h apunte a una trampa: avisa una vez y no llama al driver,
+ * asi lo que la traza no puede reproducir no pasa en silencio. Las trampas
+ * no leen sus argumentos, cosa que solo es segura si los limpia quien llama
+ * (no es el caso de __stdcall en Windows de 32 bits) */
+#if !defined(_WIN32) || defined(_WIN64)
+#define GL_TRACE_TRAP_UNTRACED 1
+#endif
+
+// Mas que todos los entry points de glad.h
+const size_t MAX_UNTRACED = 1024;
+
+struct Untraced {
+  GLADloadproc load = nullptr;
+  // Punteros de la lista al momento de recargar (quizas de GLIntercept)
+  void *traced[GL_FN_COUNT] = {};
+  const char *names[MAX_UNTRACED] = {};
+  bool reported[MAX_UNTRACED] = {};
+  size_t count = 0;
+  bool overflowed = false;
+};
+
+Untraced untraced;
+
+int tracedIndex(const char *name) {
+  for (int f = 0; f < GL_FN_COUNT; f++)
+    if (std::strcmp(name, FUNCTION_NAMES[f]) == 0)
+      return f;
+  return -1;
+}
+
+void saveTraced() {
+#define GL_TRACE_SAVE(name, kinds, object)                                    \
+  untraced.traced[GL_FN_##name] = (void *)glad_gl##name;
+  GL_FUNCTIONS(GL_TRACE_SAVE)
+#undef GL_TRACE_SAVE
+}
+
+#ifdef GL_TRACE_TRAP_UNTRACED
+template <size_t Slot> GLintptr APIENTRY untracedCall() {
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  if (!untraced.reported[Slot]) {
+    untraced.reported[Slot] = true;
+    std::cout << "ERROR::GL_TRACE::UNTRACED " << untraced.names[Slot]
+              << " is not in GLFunctions.h; the call was skipped"
+              << std::endl;
+  }
+  return 0;
+}
+
+typedef GLintptr(APIENTRYP UntracedCall)();
+
+template <size_t... Slots>
+const UntracedCall *untracedCalls(std::index_sequence<Slots...>) {
+  static const UntracedCall calls[] = {&untracedCall<Slots>...};
+  return calls;
+}
+
+void *trapLoader(const char *name) {
+  int f = tracedIndex(name);
+  if (f >= 0)
+    return untraced.traced[f];
+  if (untraced.count == MAX_UNTRACED) {
+    if (!untraced.overflowed)
+      std::cout << "ERROR::GL_TRACE::TOO_MANY_UNTRACED " << name
+                << " and later ones are not checked" << std::endl;
+    untraced.overflowed = true;
+    return untraced.load(name);
+  }
+  size_t slot = untraced.count++;
+  untraced.names[slot] = name;
+  untraced.reported[slot] = false;
+  return (void *)untracedCalls(std::make_index_sequence<MAX_UNTRACED>())[slot];
+}
+
+// Al terminar: la lista queda como esta y el resto vuelve al driver
+void *restoreLoader(const char *name) {
+  int f = tracedIndex(name);
+  return f >= 0 ? untraced.traced[f] : untraced.load(name);
+}
+#endif
+
+/* ------------ Reproduccion ------------ */
+
+template <typename R, typename... Args, size_t... I>
+uint64_t invokeSlots(R(APIENTRYP function)(Args...), const uint64_t *slots,
+                     std::index_sequence<I...>) {
+  if constexpr (std::is_void<R>::value) {
+    function(fromSlot<Args>(slots[I])...);
+    return 0;
+  } else {
+    return toSlot(function(fromSlot<Args>(slots[I])...));
+  }
+}
+
+template <typename R, typename... Args>
+uint64_t invoke(R(APIENTRYP function)(Args...), const uint64_t *slots) {
+  return invokeSlots(function, slots, std::index_sequence_for<Args...>());
+}
+
+typedef uint64_t (*Invoker)(const uint64_t *slots);
+
+// Lee el puntero de glad al momento de la llamada, no al armar la tabla
+const Invoker INVOKERS[GL_FN_COUNT] = {
+#define GL_TRACE_INVOKER(name, kinds, object)                                 \
+  [](const uint64_t *slots) -> uint64_t {                                     \
+    return glad_gl##name != nullptr ? invoke(glad_gl##name, slots) : 0;       \
+  },
+    GL_FUNCTIONS(GL_TRACE_INVOKER)
+#undef GL_TRACE_INVOKER
+};
+
+int objectIndex(char kind) {
+  switch (kind) {
+  case 'b':
+    return 0;
+  case 't':
+    return 1;
+  case 'a':
+    return 2;
+  case 'f':
+    return 3;
+  case 'r':
+    return 4;
+  case 'q':
+    return 5;
+  case 'p':
+    return 6;
+  case 's':
+    return 7;
+  }
+  return -1;
+}
+
+template <typename T> bool readValue(const uint8_t *&cursor,
+                                     const uint8_t *end, T &value) {
+  if ((size_t)(end - cursor) < sizeof(T))
+    return false;
+  std::memcpy(&value, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return true;
+}
+
+} // namespace
+
+bool GLTrace::start(const char *path, int width, int height,
+                    void *(*load)(const char *)) {
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  if (hooksInstalled)
+    return true;
+  if (glad_glGetString == nullptr) {
+    std::cout << "ERROR::GL_TRACE::GLAD_NOT_LOADED" << std::endl;
+    return false;
+  }
+  recorder.file = std::fopen(path, "wb");
+  if (recorder.file == nullptr) {
+    std::cout << "ERROR::GL_TRACE::CANNOT_OPEN " << path << std::endl;
+    return false;
+  }
+
+  uint32_t header[4] = {VERSION, GL_FN_COUNT, (uint32_t)width,
+                        (uint32_t)height};
+  recorder.append(MAGIC, sizeof(MAGIC));
+  recorder.append(header, sizeof(header));
+  recorder.origin = std::chrono::steady_clock::now();
+
+#ifdef GL_TRACE_TRAP_UNTRACED
+  untraced.load = load;
+  untraced.count = 0;
+  untraced.overflowed = false;
+  saveTraced();
+  if (!gladLoadGLLoader(trapLoader))
+    std::cout << "ERROR::GL_TRACE::RELOAD_FAILED untraced calls are not "
+                 "checked"
+              << std::endl;
+#else
+  (void)load;
+#endif
+
+#define GL_TRACE_INSTALL(name, kinds, object)                                 \
+  if (glad_gl##name != nullptr) {                                             \
+    GL_TRACE_HOOK(name)::original = glad_gl##name;                            \
+    glad_gl##name = &GL_TRACE_HOOK(name)::call;                               \
+  }
+  GL_FUNCTIONS(GL_TRACE_INSTALL)
+#undef GL_TRACE_INSTALL
+  hooksInstalled = true;
+  return true;
+}
+
+void GLTrace::endFrame() {
+  if (!hooksInstalled)
+    return;
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  uint64_t slot = (uint64_t)std::chrono::duration_cast<
+                      std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - recorder.origin)
+                      .count();
+  recorder.write(RECORD_FRAME_END, &slot, 1);
+}
+
+void GLTrace::stop() {
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  if (!hooksInstalled)
+    return;
+#define GL_TRACE_UNINSTALL(name, kinds, object)                               \
+  if (GL_TRACE_HOOK(name)::original != nullptr) {                             \
+    glad_gl##name = GL_TRACE_HOOK(name)::original;                            \
+    GL_TRACE_HOOK(name)::original = nullptr;                                  \
+  }
+  GL_FUNCTIONS(GL_TRACE_UNINSTALL)
+#undef GL_TRACE_UNINSTALL
+  hooksInstalled = false;
+#ifdef GL_TRACE_TRAP_UNTRACED
+  saveTraced();
+  gladLoadGLLoader(restoreLoader);
+#endif
+
+  recorder.flush();
+  std::fclose(recorder.file);
+  recorder.file = nullptr;
+  recorder.mappings.clear();
+}
+
+bool GLTrace::recording() { return hooksInstalled; }
+
+GLTracePlayer::GLTracePlayer(const char *path) : file(path) {
+  if (!file.isValid()) {
+    std::cout << "ERROR::GL_TRACE::CANNOT_OPEN " << path << std::endl;
+    return;
+  }
+  cursor = file.data();
+  end = file.data() + file.size();
+
+  uint32_t header[4];
+  if (file.size() < sizeof(MAGIC) + sizeof(header) ||
+      std::memcmp(cursor, MAGIC, sizeof(MAGIC)) != 0) {
+    std::cout << "ERROR::GL_TRACE::NOT_A_TRACE " << path << std::endl;
+    return;
+  }
+  cursor += sizeof(MAGIC);
+  std::memcpy(header, cursor, sizeof(header));
+  cursor += sizeof(header);
+  // Los ids de funcion son posiciones en GLFunctions.h: tienen que coincidir
+  if (header[0] != VERSION || header[1] != GL_FN_COUNT) {
+    std::cout << "ERROR::GL_TRACE::VERSION_MISMATCH " << path << std::endl;
+    return;
+  }
+  width = (int)header[2];
+  height = (int)header[3];
+  isValid = true;
+}
+
+uint32_t GLTracePlayer::translate(char kind, uint32_t name) {
+  if (name == 0)
+    return kind == 'f' ? defaultFramebuffer : 0;
+  int index = objectIndex(kind);
+  auto found = names[index].find(name);
+  if (found != names[index].end())
+    return found->second;
+  // Framebuffers creados antes de grabar (el FBO del modo headless)
+  return kind == 'f' ? defaultFramebuffer : name;
+}
+
+bool GLTracePlayer::playFrame(uint64_t *recordedTimeNs) {
+  while (cursor < end) {
+    uint16_t function = 0;
+    uint8_t payloadCount = 0, slotCount = 0;
+    uint64_t slots[16] = {};
+    const uint8_t *record = cursor;
+    bool complete = readValue(cursor, end, function) &&
+                    readValue(cursor, end, payloadCount) &&
+                    readValue(cursor, end, slotCount) && slotCount <= 16;
+    for (int i = 0; complete && i < slotCount; i++)
+      complete = readValue(cursor, end, slots[i]);
+
+    std::vector<Payload> payloads(payloadCount);
+    for (int i = 0; complete && i < payloadCount; i++) {
+      uint32_t size = 0;
+      complete = readValue(cursor, end, size) &&
+                 (size == NULL_PAYLOAD || (size_t)(end - cursor) >= size);
+      if (!complete)
+        break;
+      payloads[i] = Payload{size == NULL_PAYLOAD ? nullptr : cursor, size};
+      if (size != NULL_PAYLOAD)
+        cursor += size;
+    }
+    if (!complete ||
+        (function >= GL_FN_COUNT && function != RECORD_FRAME_END &&
+         function != RECORD_MAP_WRITE)) {
+      std::cout << "ERROR::GL_TRACE::CORRUPT_RECORD at byte "
+                << (record - file.data()) << std::endl;
+      cursor = end;
+      return false;
+    }
+
+    if (function == RECORD_FRAME_END) {
+      frameIndex++;
+      if (recordedTimeNs != nullptr)
+        *recordedTimeNs = slots[0];
+      return true;
+    }
+
+    if (function == RECORD_MAP_WRITE) {
+      for (const Mapping &mapping : mappings)
+        if (mapping.target == (uint32_t)slots[0] && payloadCount == 1 &&
+            payloads[0].data != nullptr)
+          std::memcpy(mapping.pointer, payloads[0].data,
+                      std::min<size_t>(mapping.length, payloads[0].size));
+      continue;
+    }
+
+    /* Traducimos cada argumento segun su tipo (ver GLFunctions.h). Lo que
+     * apunta a memoria temporal tiene que vivir hasta despues de la llamada */
+    const char *kinds = KINDS[function];
+    char object = OBJECTS[function];
+    int argumentCount = (int)std::strlen(kinds) - 1;
+    uint64_t arguments[16] = {};
+    std::memcpy(arguments, slots, sizeof(uint64_t) * argumentCount);
+    std::vector<GLuint> objectNames;
+    const GLuint *recordedNames = nullptr;
+    std::vector<const GLchar *> strings;
+    std::vector<GLint> lengths;
+    size_t payload = 0;
+    auto nextPayload = [&]() {
+      return payload < payloads.size() ? payloads[payload++]
+                                       : Payload{nullptr, NULL_PAYLOAD};
+    };
+
+    for (int i = 0; i < argumentCount; i++) {
+      uint64_t &argument = arguments[i];
+      char kind = kinds[i + 1];
+      switch (kind) {
+      case 'b':
+      case 't':
+      case 'a':
+      case 'f':
+      case 'r':
+      case 'q':
+      case 'p':
+      case 's':
+        argument = translate(kind, (uint32_t)argument);
+        break;
+      case 'y': {
+        auto found = syncs.find(argument);
+        argument = found != syncs.end() ? toSlot(found->second) : 0;
+        break;
+      }
+      case 'l': {
+        uint64_t key = (uint64_t)currentProgram << 32 | (uint32_t)argument;
+        auto found = locations.find(key);
+        if (found != locations.end())
+          argument = toSlot(found->second);
+        break;
+      }
+      case 'd':
+      case 'D': {
+        Payload data = nextPayload();
+        // Sin datos el slot ya tiene el puntero nulo o el offset
+        if (data.size != NULL_PAYLOAD)
+          argument = toSlot(data.data);
+        break;
+      }
+      case 'w':
+      case 'W': {
+        if (kind == 'W' && packBuffer != 0)
+          break;
+        // glReadPixels: ancho * alto * hasta 16 bytes por pixel
+        size_t size = kind == 'W' ? (size_t)arguments[2] * arguments[3] * 16
+                                  : 0;
+        if (scratch.size() < std::max<size_t>(size, 1 << 16))
+          scratch.resize(std::max<size_t>(size, 1 << 16));
+        argument = toSlot(scratch.data());
+        break;
+      }
+      case 'S':
+        for (uint64_t s = 0; s < arguments[i - 1]; s++) {
+          Payload source = nextPayload();
+          strings.push_back((const GLchar *)source.data);
+          lengths.push_back(source.size != NULL_PAYLOAD ? (GLint)source.size
+                                                        : 0);
+        }
+        argument = toSlot(strings.data());
+        break;
+      case 'x':
+        argument = toSlot(lengths.data());
+        break;
+      case 'N':
+      case 'G':
+        // Gen* recibe memoria para los nombres nuevos; Delete* los traducidos
+        recordedNames = (const GLuint *)nextPayload().data;
+        objectNames.resize(recordedNames != nullptr ? arguments[i - 1] : 0);
+        for (size_t n = 0; kind == 'N' && n < objectNames.size(); n++)
+          objectNames[n] = translate(object, recordedNames[n]);
+        argument = toSlot(objectNames.data());
+        break;
+      }
+    }
+    if (payload != payloads.size())
+      std::cout << "ERROR::GL_TRACE::PAYLOAD_MISMATCH "
+                << FUNCTION_NAMES[function] << std::endl;
+    // Punteros que solo valian en el proceso que grabo
+    if (std::strchr(kinds + 1, 'c') != nullptr)
+      continue;
+
+    uint64_t result = INVOKERS[function](arguments);
+
+    // Lo que la llamada creo o destruyo
+    uint64_t recordedResult = slots[argumentCount];
+    switch (kinds[0]) {
+    case 'p':
+    case 's':
+      names[objectIndex(kinds[0])][(uint32_t)recordedResult] =
+          (uint32_t)result;
+      break;
+    case 'y':
+      syncs[recordedResult] = (void *)(uintptr_t)result;
+      break;
+    case 'l':
+      locations[(uint64_t)arguments[0] << 32 | (uint32_t)recordedResult] =
+          (int32_t)result;
+      break;
+    case 'm':
+      if (result != 0)
+        mappings.push_back(Mapping{(uint32_t)arguments[0],
+                                   (void *)(uintptr_t)result,
+                                   (size_t)arguments[2]});
+      break;
+    }
+
+    if (recordedNames != nullptr) {
+      std::unordered_map<uint32_t, uint32_t> &map = names[objectIndex(object)];
+      for (size_t n = 0; n < objectNames.size(); n++) {
+        if (kinds[argumentCount] == 'G')
+          map[recordedNames[n]] = objectNames[n];
+        else
+          map.erase(recordedNames[n]);
+      }
+    }
+
+    switch (function) {
+    case GL_FN_UseProgram:
+      currentProgram = (uint32_t)arguments[0];
+      break;
+    case GL_FN_BindBuffer:
+      if (arguments[0] == GL_PIXEL_PACK_BUFFER)
+        packBuffer = (uint32_t)arguments[1];
+      break;
+    case GL_FN_DeleteSync:
+      syncs.erase(slots[0]);
+      break;
+    case GL_FN_UnmapBuffer:
+      for (size_t m = 0; m < mappings.size(); m++)
+        if (mappings[m].target == (uint32_t)arguments[0]) {
+          mappings.erase(mappings.begin() + m);
+          break;
+        }
+      break;
+    }
+  }
+  return false;
+}
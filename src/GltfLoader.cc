@@ -0,0 +1,502 @@
+#include "GltfLoader.h"
+#include "JobSystem.h"
+#include "JsonParser.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - since)
+      .count();
+}
+
+uint32_t readU32(const uint8_t *p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+int componentCount(std::string_view type) {
+  if (type == "SCALAR")
+    return 1;
+  if (type == "VEC2")
+    return 2;
+  if (type == "VEC3")
+    return 3;
+  if (type == "VEC4" || type == "MAT2")
+    return 4;
+  if (type == "MAT3")
+    return 9;
+  if (type == "MAT4")
+    return 16;
+  return 0;
+}
+
+// Bytes por componente; 0 si glTF no admite el tipo
+uint32_t componentSize(GLenum type) {
+  switch (type) {
+  case GL_BYTE:
+  case GL_UNSIGNED_BYTE:
+    return 1;
+  case GL_SHORT:
+  case GL_UNSIGNED_SHORT:
+    return 2;
+  case GL_UNSIGNED_INT:
+  case GL_FLOAT:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+// Indica si los `count` elementos del accessor caen dentro de su bufferView.
+// Los indices van sin stride y los atributos con el del view, asi que se
+// usa el mayor de los dos
+bool accessorFits(const GltfAccessor &accessor, const GltfBufferView &view) {
+  uint32_t elementSize =
+      (uint32_t)accessor.components * componentSize(accessor.componentType);
+  if (elementSize == 0)
+    return false;
+  if (accessor.count == 0)
+    return true;
+  uint64_t stride = std::max(view.byteStride, elementSize);
+  return (uint64_t)accessor.byteOffset + stride * (accessor.count - 1) +
+             elementSize <=
+         view.byteLength;
+}
+
+template <typename T> uint32_t largestIndex(const uint8_t *data, size_t count) {
+  uint32_t largest = 0;
+  for (size_t i = 0; i < count; i++) {
+    T index;
+    std::memcpy(&index, data + i * sizeof(T), sizeof(T));
+    largest = std::max(largest, (uint32_t)index);
+  }
+  return largest;
+}
+
+void atomicMin(std::atomic<long long> &value, long long candidate) {
+  long long current = value.load();
+  while (candidate < current &&
+         !value.compare_exchange_weak(current, candidate)) {
+  }
+}
+
+void atomicMax(std::atomic<long long> &value, long long candidate) {
+  long long current = value.load();
+  while (candidate > current &&
+         !value.compare_exchange_weak(current, candidate)) {
+  }
+}
+
+GltfPrimitive parsePrimitive(const JsonDocument &doc, int object) {
+  GltfPrimitive primitive;
+  int attributes = doc.find(object, "attributes");
+  primitive.position = (int)doc.intField(attributes, "POSITION", -1);
+  primitive.normal = (int)doc.intField(attributes, "NORMAL", -1);
+  primitive.texcoord = (int)doc.intField(attributes, "TEXCOORD_0", -1);
+  primitive.color = (int)doc.intField(attributes, "COLOR_0", -1);
+  primitive.indices = (int)doc.intField(object, "indices", -1);
+  primitive.material = (int)doc.intField(object, "material", -1);
+  primitive.mode = (GLenum)doc.intField(object, "mode", GL_TRIANGLES);
+  return primitive;
+}
+
+} // namespace
+
+GltfModel::GltfModel(const char *path) {
+  Clock::time_point start = Clock::now();
+
+  if (!readChunks(path))
+    return;
+  if (!parse()) {
+    std::cout << "ERROR::GLTF::INVALID_JSON " << path << std::endl;
+    return;
+  }
+  parseMs = elapsedMs(start);
+
+  Clock::time_point uploadStart = Clock::now();
+  upload();
+  uploadMs = elapsedMs(uploadStart);
+  totalMs = elapsedMs(start);
+
+  double megabytes = file.size() / (1024.0 * 1024.0);
+  std::cout << "GLTF::LOADED " << path << " " << megabytes << " MB, "
+            << meshes.size() << " meshes, " << images.size()
+            << " images | parse " << parseMs << " ms (decode " << decodeMs
+            << " ms), upload " << uploadMs << " ms, total " << totalMs
+            << " ms, " << megabytes / (totalMs / 1000.0) << " MB/s"
+            << std::endl;
+  isValid = true;
+}
+
+GltfModel::~GltfModel() { release(); }
+
+bool GltfModel::readChunks(const char *path) {
+  if (!file.open(path))
+    return false;
+
+  const uint8_t *data = file.data();
+  size_t size = file.size();
+  // Cabecera: magic, version, longitud total; luego el chunk JSON
+  if (size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2 ||
+      readU32(data + 8) > size) {
+    std::cout << "ERROR::GLTF::NOT_A_GLB_2_FILE " << path << std::endl;
+    return false;
+  }
+
+  size_t offset = 12;
+  while (offset + 8 <= size) {
+    uint32_t chunkLength = readU32(data + offset);
+    uint32_t chunkType = readU32(data + offset + 4);
+    const uint8_t *chunk = data + offset + 8;
+    if (offset + 8 + chunkLength > size)
+      break;
+    if (chunkType == GLB_CHUNK_JSON && json == nullptr) {
+      json = reinterpret_cast<const char *>(chunk);
+      jsonLength = chunkLength;
+    } else if (chunkType == GLB_CHUNK_BIN && bin == nullptr) {
+      bin = chunk;
+      binLength = chunkLength;
+    }
+    offset += 8 + ((chunkLength + 3) & ~3u);
+  }
+
+  if (json == nullptr) {
+    std::cout << "ERROR::GLTF::MISSING_JSON_CHUNK " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool GltfModel::parse() {
+  int tokenCount = jsonTokenize(json, jsonLength, nullptr, 0);
+  if (tokenCount <= 0)
+    return false;
+  // Unica asignacion del parser: el arreglo de tokens
+  std::vector<JsonToken> tokens(tokenCount);
+  if (jsonTokenize(json, jsonLength, tokens.data(), tokenCount) != tokenCount)
+    return false;
+  JsonDocument doc{json, tokens.data(), tokenCount};
+
+  int views = doc.find(0, "bufferViews");
+  for (int v = doc.firstChild(views); v >= 0; v = doc.nextSibling(v)) {
+    GltfBufferView view;
+    view.byteOffset = (uint32_t)doc.intField(v, "byteOffset", 0);
+    view.byteLength = (uint32_t)doc.intField(v, "byteLength", 0);
+    view.byteStride = (uint32_t)doc.intField(v, "byteStride", 0);
+    view.target = (GLenum)doc.intField(v, "target", 0);
+    // Solo soportamos el buffer 0, que en un .glb es el chunk BIN
+    if (doc.intField(v, "buffer", 0) != 0 || bin == nullptr ||
+        (uint64_t)view.byteOffset + view.byteLength > binLength) {
+      std::cout << "ERROR::GLTF::EXTERNAL_OR_INVALID_BUFFER" << std::endl;
+      return false;
+    }
+    bufferViews.push_back(view);
+  }
+
+  int accessorArray = doc.find(0, "accessors");
+  for (int a = doc.firstChild(accessorArray); a >= 0; a = doc.nextSibling(a)) {
+    GltfAccessor accessor;
+    accessor.bufferView = (int)doc.intField(a, "bufferView", -1);
+    accessor.byteOffset = (uint32_t)doc.intField(a, "byteOffset", 0);
+    accessor.componentType = (GLenum)doc.intField(a, "componentType", GL_FLOAT);
+    accessor.count = (uint32_t)doc.intField(a, "count", 0);
+    accessor.components = componentCount(doc.asString(doc.find(a, "type")));
+    accessor.normalized = doc.asBool(doc.find(a, "normalized"), false);
+    // Sin bufferView el accessor no tiene datos y no se puede dibujar
+    if (accessor.bufferView < -1 ||
+        accessor.bufferView >= (int)bufferViews.size() ||
+        (accessor.bufferView >= 0 &&
+         !accessorFits(accessor, bufferViews[accessor.bufferView]))) {
+      std::cout << "ERROR::GLTF::INVALID_ACCESSOR " << accessors.size()
+                << std::endl;
+      return false;
+    }
+    accessors.push_back(accessor);
+  }
+
+  // textures[i].source -> images[j]
+  std::vector<int> textureSources;
+  int textureArray = doc.find(0, "textures");
+  for (int t = doc.firstChild(textureArray); t >= 0; t = doc.nextSibling(t))
+    textureSources.push_back((int)doc.intField(t, "source", -1));
+
+  int materialArray = doc.find(0, "materials");
+  for (int m = doc.firstChild(materialArray); m >= 0; m = doc.nextSibling(m)) {
+    GltfMaterial material;
+    int pbr = doc.find(m, "pbrMetallicRoughness");
+    int factor = doc.find(pbr, "baseColorFactor");
+    for (uint32_t i = 0; i < 4; i++)
+      material.baseColorFactor[i] =
+          (float)doc.asNumber(doc.element(factor, i), 1.0);
+    long long texture =
+        doc.intField(doc.find(pbr, "baseColorTexture"), "index", -1);
+    if (texture >= 0 && texture < (long long)textureSources.size())
+      material.baseColorImage = textureSources[texture];
+    materials.push_back(material);
+  }
+
+  int imageArray = doc.find(0, "images");
+  for (int i = doc.firstChild(imageArray); i >= 0; i = doc.nextSibling(i)) {
+    GltfImage image;
+    image.bufferView = (int)doc.intField(i, "bufferView", -1);
+    images.push_back(image);
+  }
+
+  // Cada mesh es independiente: se parsean en paralelo junto con la
+  // decodificacion de imagenes
+  int meshArray = doc.find(0, "meshes");
+  size_t meshCount = meshArray >= 0 ? doc.tokens[meshArray].size : 0;
+  std::vector<int> meshTokens;
+  for (int m = doc.firstChild(meshArray); m >= 0; m = doc.nextSibling(m))
+    meshTokens.push_back(m);
+  meshes.resize(meshCount);
+
+  // Las imagenes se decodifican en varios hilos a la vez: decodeMs es el
+  // tiempo de reloj desde que empieza la primera hasta que termina la ultima
+  Clock::time_point tasksStart = Clock::now();
+  auto sinceStartNs = [&]() {
+    return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now() - tasksStart)
+        .count();
+  };
+  std::atomic<long long> firstDecodeNs{LLONG_MAX}, lastDecodeNs{0};
+  std::atomic<bool> invalidPrimitive{false};
+  auto loadTask = [&](size_t task) {
+    if (task < meshCount) {
+      int object = meshTokens[task];
+      GltfMesh &mesh = meshes[task];
+      mesh.name = std::string(doc.asString(doc.find(object, "name")));
+      int primitives = doc.find(object, "primitives");
+      for (int p = doc.firstChild(primitives); p >= 0;
+           p = doc.nextSibling(p)) {
+        mesh.primitives.push_back(parsePrimitive(doc, p));
+        if (!validPrimitive(mesh.primitives.back()))
+          invalidPrimitive = true;
+      }
+      return;
+    }
+
+    atomicMin(firstDecodeNs, sinceStartNs());
+    GltfImage &image = images[task - meshCount];
+    if (image.bufferView < 0 || image.bufferView >= (int)bufferViews.size())
+      return;
+    const GltfBufferView &view = bufferViews[image.bufferView];
+    // glTF usa el origen de UV arriba a la izquierda, no se voltea
+    stbi_set_flip_vertically_on_load_thread(0);
+    int channels;
+    image.pixels = stbi_load_from_memory(bin + view.byteOffset,
+                                         (int)view.byteLength, &image.width,
+                                         &image.height, &channels, 4);
+    if (image.pixels == nullptr)
+      std::cout << "ERROR::GLTF::IMAGE_DECODE_FAILED "
+                << stbi_failure_reason() << std::endl;
+    atomicMax(lastDecodeNs, sinceStartNs());
+  };
+  JobSystem::shared().parallelFor(0, meshCount + images.size(), 1,
+                                  [&](size_t first, size_t last) {
+    for (size_t task = first; task < last; task++)
+      loadTask(task);
+  });
+  if (lastDecodeNs > firstDecodeNs)
+    decodeMs = (lastDecodeNs - firstDecodeNs) / 1.0e6;
+
+  if (invalidPrimitive) {
+    std::cout << "ERROR::GLTF::INVALID_PRIMITIVE" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool GltfModel::validPrimitive(const GltfPrimitive &primitive) const {
+  auto hasData = [&](int accessor) {
+    return accessor >= 0 && accessor < (int)accessors.size() &&
+           accessors[accessor].bufferView >= 0;
+  };
+  // Todos los atributos tienen la misma cantidad de vertices que POSITION
+  if (!hasData(primitive.position))
+    return false;
+  uint32_t vertexCount = accessors[primitive.position].count;
+  for (int attribute : {primitive.normal, primitive.texcoord, primitive.color}) {
+    if (attribute != -1 &&
+        (!hasData(attribute) || accessors[attribute].count != vertexCount))
+      return false;
+  }
+  if (primitive.indices == -1)
+    return true;
+  if (!hasData(primitive.indices))
+    return false;
+
+  // El driver no revisa los indices: uno fuera de rango lee fuera del VBO
+  const GltfAccessor &accessor = accessors[primitive.indices];
+  if (accessor.components != 1 || accessor.count == 0)
+    return accessor.components == 1;
+  const uint8_t *data =
+      bin + bufferViews[accessor.bufferView].byteOffset + accessor.byteOffset;
+  uint32_t largest;
+  switch (accessor.componentType) {
+  case GL_UNSIGNED_BYTE:
+    largest = largestIndex<uint8_t>(data, accessor.count);
+    break;
+  case GL_UNSIGNED_SHORT:
+    largest = largestIndex<uint16_t>(data, accessor.count);
+    break;
+  case GL_UNSIGNED_INT:
+    largest = largestIndex<uint32_t>(data, accessor.count);
+    break;
+  default:
+    return false;
+  }
+  return largest < vertexCount;
+}
+
+void GltfModel::upload() {
+  // Marcamos los views de indices para subirlos como GL_ELEMENT_ARRAY_BUFFER
+  for (const GltfMesh &mesh : meshes) {
+    for (const GltfPrimitive &primitive : mesh.primitives) {
+      if (primitive.indices >= 0 &&
+          primitive.indices < (int)accessors.size()) {
+        int view = accessors[primitive.indices].bufferView;
+        if (view >= 0 && bufferViews[view].target == 0)
+          bufferViews[view].target = GL_ELEMENT_ARRAY_BUFFER;
+      }
+    }
+  }
+
+  std::vector<bool> referenced(bufferViews.size(), false);
+  for (const GltfAccessor &accessor : accessors) {
+    if (accessor.bufferView >= 0)
+      referenced[accessor.bufferView] = true;
+  }
+
+  for (size_t i = 0; i < bufferViews.size(); i++) {
+    GltfBufferView &view = bufferViews[i];
+    if (!referenced[i])
+      continue;
+    if (view.target == 0)
+      view.target = GL_ARRAY_BUFFER;
+    glGenBuffers(1, &view.buffer);
+    // Binding it to the copy target keeps the upload from disturbing any
+    // VAO's element buffer binding
+    glBindBuffer(GL_COPY_WRITE_BUFFER, view.buffer);
+    // Sin copia: el driver lee directamente del chunk BIN mapeado
+    glBufferData(GL_COPY_WRITE_BUFFER, view.byteLength, bin + view.byteOffset,
+                 GL_STATIC_DRAW);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  for (GltfMesh &mesh : meshes) {
+    for (GltfPrimitive &primitive : mesh.primitives) {
+      glGenVertexArrays(1, &primitive.VAO);
+      glBindVertexArray(primitive.VAO);
+
+      const int attributes[] = {primitive.position, primitive.color,
+                                primitive.texcoord, primitive.normal};
+      for (GLuint location = 0; location < 4; location++) {
+        int index = attributes[location];
+        if (index < 0 || index >= (int)accessors.size())
+          continue;
+        const GltfAccessor &accessor = accessors[index];
+        if (accessor.bufferView < 0)
+          continue;
+        const GltfBufferView &view = bufferViews[accessor.bufferView];
+        glBindBuffer(GL_ARRAY_BUFFER, view.buffer);
+        glVertexAttribPointer(location, accessor.components,
+                              accessor.componentType,
+                              accessor.normalized ? GL_TRUE : GL_FALSE,
+                              view.byteStride,
+                              (void *)(uintptr_t)accessor.byteOffset);
+        glEnableVertexAttribArray(location);
+      }
+
+      if (primitive.indices >= 0 &&
+          primitive.indices < (int)accessors.size()) {
+        int view = accessors[primitive.indices].bufferView;
+        if (view >= 0 && view < (int)bufferViews.size())
+          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferViews[view].buffer);
+      }
+      glBindVertexArray(0);
+    }
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  for (GltfImage &image : images) {
+    if (image.pixels == nullptr)
+      continue;
+    glGenTextures(1, &image.texture);
+    glBindTexture(GL_TEXTURE_2D, image.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    stbi_image_free(image.pixels);
+    image.pixels = nullptr;
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GltfModel::draw() const {
+  for (size_t i = 0; i < meshes.size(); i++)
+    drawMesh(i);
+}
+
+void GltfModel::drawMesh(size_t index) const {
+  for (const GltfPrimitive &primitive : meshes[index].primitives) {
+    if (primitive.material >= 0 &&
+        primitive.material < (int)materials.size()) {
+      int image = materials[primitive.material].baseColorImage;
+      if (image >= 0 && image < (int)images.size()) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, images[image].texture);
+      }
+    }
+
+    // parse() ya rechazo los primitives con accessors fuera de rango
+    glBindVertexArray(primitive.VAO);
+    if (primitive.indices >= 0 &&
+        primitive.indices < (int)accessors.size()) {
+      const GltfAccessor &accessor = accessors[primitive.indices];
+      glDrawElements(primitive.mode, accessor.count, accessor.componentType,
+                     (void *)(uintptr_t)accessor.byteOffset);
+    } else if (primitive.position >= 0 &&
+               primitive.position < (int)accessors.size()) {
+      glDrawArrays(primitive.mode, 0, accessors[primitive.position].count);
+    }
+  }
+  glBindVertexArray(0);
+}
+
+void GltfModel::release() {
+  for (GltfMesh &mesh : meshes) {
+    for (GltfPrimitive &primitive : mesh.primitives) {
+      if (primitive.VAO)
+        glDeleteVertexArrays(1, &primitive.VAO);
+    }
+  }
+  for (GltfBufferView &view : bufferViews) {
+    if (view.buffer)
+      glDeleteBuffers(1, &view.buffer);
+  }
+  for (GltfImage &image : images) {
+    if (image.texture)
+      glDeleteTextures(1, &image.texture);
+    stbi_image_free(image.pixels);
+  }
+}
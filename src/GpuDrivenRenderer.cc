@@ -0,0 +1,155 @@
+#include "GpuDrivenRenderer.h"
+#include <cstring>
+#include <iostream>
+
+bool GpuDrivenRenderer::supported() {
+  if (!GLAD_GL_VERSION_4_3)
+    return false;
+  GLint extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+  for (GLint i = 0; i < extensions; i++) {
+    const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    if (name != nullptr &&
+        std::strcmp(name, "GL_ARB_shader_draw_parameters") == 0)
+      return true;
+  }
+  return false;
+}
+
+GpuDrivenRenderer::GpuDrivenRenderer(size_t maxObjects,
+                                     const char *cullShaderPath)
+    : maxObjects(maxObjects) {
+  if (!supported()) {
+    std::cout << "ERROR::GPU_DRIVEN::UNSUPPORTED needs GL 4.3 and "
+                 "GL_ARB_shader_draw_parameters"
+              << std::endl;
+    return;
+  }
+  cullShader = std::make_unique<Shader>(cullShaderPath);
+  isValid = cullShader->isValid;
+
+  glGenBuffers(1, &objectBuffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, maxObjects * sizeof(GpuObject), NULL,
+               GL_DYNAMIC_DRAW);
+
+  glGenBuffers(1, &commandBuffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               maxObjects * sizeof(DrawElementsIndirectCommand), NULL,
+               GL_DYNAMIC_DRAW);
+
+  glGenBuffers(1, &visibleBuffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, maxObjects * sizeof(unsigned int),
+               NULL, GL_DYNAMIC_DRAW);
+
+  glGenBuffers(1, &countBuffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), NULL,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  if (!isValid)
+    std::cout << "ERROR::GPU_DRIVEN::CULL_SHADER_INVALID" << std::endl;
+}
+
+GpuDrivenRenderer::~GpuDrivenRenderer() {
+  unsigned int buffers[] = {objectBuffer, commandBuffer, visibleBuffer,
+                            countBuffer};
+  glDeleteBuffers(4, buffers);
+  if (cullShader)
+    glDeleteProgram(cullShader->ID);
+}
+
+void GpuDrivenRenderer::setObjects(const GpuObject *objects, size_t count) {
+  if (!isValid)
+    return;
+  if (count > maxObjects) {
+    std::cout << "ERROR::GPU_DRIVEN::TOO_MANY_OBJECTS " << count << " > "
+              << maxObjects << std::endl;
+    count = maxObjects;
+  }
+  objectCount = count;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(GpuObject),
+                  objects);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::updateObject(size_t index, const GpuObject &object) {
+  if (!isValid || index >= objectCount)
+    return;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(GpuObject),
+                  sizeof(GpuObject), &object);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::cull(const Frustum &frustum) {
+  if (!isValid || objectCount == 0)
+    return;
+
+  // El contador vuelve a cero y los comandos sobrantes quedan con count 0,
+  // asi el multi-draw sin contador no dibuja basura
+  unsigned int zero = 0;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+                    GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+  glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+                    GL_UNSIGNED_INT, &zero);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  cullShader->use();
+  float planes[24];
+  for (int i = 0; i < 6; i++) {
+    planes[i * 4 + 0] = frustum.planes[i].a;
+    planes[i * 4 + 1] = frustum.planes[i].b;
+    planes[i * 4 + 2] = frustum.planes[i].c;
+    planes[i * 4 + 3] = frustum.planes[i].d;
+  }
+  glUniform4fv(glGetUniformLocation(cullShader->ID, "frustumPlanes"), 6,
+               planes);
+  glUniform1ui(glGetUniformLocation(cullShader->ID, "objectCount"),
+               (GLuint)objectCount);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_OBJECTS_BINDING,
+                   objectBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_COMMANDS_BINDING,
+                   commandBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_VISIBLE_BINDING,
+                   visibleBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_COUNT_BINDING,
+                   countBuffer);
+
+  // local_size_x = 64 en cull.comp
+  glDispatchCompute((GLuint)((objectCount + 63) / 64), 1, 1);
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuDrivenRenderer::draw(unsigned int VAO, GLenum indexType) const {
+  if (!isValid || objectCount == 0)
+    return;
+
+  // El vertex shader lee objects[visible[gl_DrawID]]
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_OBJECTS_BINDING,
+                   objectBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_DRIVEN_VISIBLE_BINDING,
+                   visibleBuffer);
+
+  glBindVertexArray(VAO);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+  if (glMultiDrawElementsIndirectCount) {
+    // GL 4.6: la GPU tambien decide cuantos draws hay
+    glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+    glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexType, 0, 0,
+                                     (GLsizei)objectCount, 0);
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+  } else {
+    glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0,
+                                (GLsizei)objectCount, 0);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  glBindVertexArray(0);
+}
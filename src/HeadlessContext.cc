@@ -0,0 +1,248 @@
+#include "HeadlessContext.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#ifdef HAVE_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+HeadlessContext::HeadlessContext(int width, int height, int major, int minor,
+                                 bool debug)
+    : width(width), height(height) {
+  if (!createEGL(major, minor, debug) && !createOSMesa(major, minor)) {
+    std::cout << "ERROR::HEADLESS::NO_BACKEND (EGL surfaceless and OSMesa "
+                 "both unavailable)"
+              << std::endl;
+    return;
+  }
+
+  if (!gladLoadGLLoader((GLADloadproc)procAddress)) {
+    std::cout << "ERROR::HEADLESS::GLAD_LOAD_FAILED" << std::endl;
+    return;
+  }
+
+  if (!createFramebuffer())
+    return;
+
+  std::cout << "HEADLESS::CONTEXT " << backend << " " << width << "x"
+            << height << " " << glGetString(GL_RENDERER) << " / "
+            << glGetString(GL_VERSION) << std::endl;
+  isValid = true;
+}
+
+HeadlessContext::~HeadlessContext() {
+  if (context == nullptr)
+    return;
+  if (makeCurrent()) {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+  }
+  release();
+
+#ifdef HAVE_EGL
+  if (display != nullptr) {
+    eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+    eglTerminate((EGLDisplay)display);
+    return;
+  }
+#endif
+#ifdef HAVE_OSMESA
+  OSMesaDestroyContext((OSMesaContext)context);
+#endif
+}
+
+bool HeadlessContext::createEGL(int major, int minor, bool debug) {
+#ifdef HAVE_EGL
+  // Plataforma surfaceless de Mesa: no necesita X11, Wayland ni /dev/dri
+  EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+          "eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay != nullptr)
+    eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                    EGL_DEFAULT_DISPLAY, NULL);
+  if (eglDisplay == EGL_NO_DISPLAY)
+    eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint eglMajor, eglMinor;
+  if (eglDisplay == EGL_NO_DISPLAY ||
+      !eglInitialize(eglDisplay, &eglMajor, &eglMinor))
+    return false;
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    eglTerminate(eglDisplay);
+    return false;
+  }
+
+  const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                               major,
+                               EGL_CONTEXT_MINOR_VERSION,
+                               minor,
+                               EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                               EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                               EGL_CONTEXT_OPENGL_DEBUG,
+                               debug ? EGL_TRUE : EGL_FALSE,
+                               EGL_NONE};
+  // Sin config (EGL_KHR_no_config_context): no vamos a crear superficies
+  EGLContext eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR,
+                                           EGL_NO_CONTEXT, attributes);
+  if (eglContext == EGL_NO_CONTEXT) {
+    std::cout << "ERROR::HEADLESS::EGL_CONTEXT_FAILED 0x" << std::hex
+              << eglGetError() << std::dec << std::endl;
+    eglTerminate(eglDisplay);
+    return false;
+  }
+
+  display = eglDisplay;
+  context = eglContext;
+  backend = "EGL";
+  procAddress = (void *(*)(const char *))eglGetProcAddress;
+  return makeCurrent();
+#else
+  (void)major;
+  (void)minor;
+  (void)debug;
+  return false;
+#endif
+}
+
+bool HeadlessContext::createOSMesa(int major, int minor) {
+#ifdef HAVE_OSMESA
+  const int attributes[] = {OSMESA_FORMAT,
+                            OSMESA_RGBA,
+                            OSMESA_DEPTH_BITS,
+                            24,
+                            OSMESA_STENCIL_BITS,
+                            8,
+                            OSMESA_PROFILE,
+                            OSMESA_CORE_PROFILE,
+                            OSMESA_CONTEXT_MAJOR_VERSION,
+                            major,
+                            OSMESA_CONTEXT_MINOR_VERSION,
+                            minor,
+                            0};
+  OSMesaContext osmesaContext = OSMesaCreateContextAttribs(attributes, NULL);
+  if (osmesaContext == NULL)
+    return false;
+
+  // OSMesa necesita un buffer en memoria para el framebuffer por defecto,
+  // aunque nosotros dibujemos en el FBO
+  osmesaBuffer.resize((size_t)width * height * 4);
+  context = osmesaContext;
+  backend = "OSMesa";
+  procAddress = (void *(*)(const char *))OSMesaGetProcAddress;
+  return makeCurrent();
+#else
+  (void)major;
+  (void)minor;
+  return false;
+#endif
+}
+
+bool HeadlessContext::createFramebuffer() {
+  glGenRenderbuffers(1, &colorBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, colorBuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depthBuffer);
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cout << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE 0x" << std::hex
+              << status << std::dec << std::endl;
+    return false;
+  }
+  bindFramebuffer();
+  return true;
+}
+
+bool HeadlessContext::makeCurrent() {
+#ifdef HAVE_EGL
+  if (display != nullptr)
+    return eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                          (EGLContext)context) == EGL_TRUE;
+#endif
+#ifdef HAVE_OSMESA
+  if (context != nullptr)
+    return OSMesaMakeCurrent((OSMesaContext)context, osmesaBuffer.data(),
+                             GL_UNSIGNED_BYTE, width, height) == GL_TRUE;
+#endif
+  return false;
+}
+
+void HeadlessContext::release() {
+#ifdef HAVE_EGL
+  if (display != nullptr) {
+    eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    return;
+  }
+#endif
+#ifdef HAVE_OSMESA
+  OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+#endif
+}
+
+void HeadlessContext::bindFramebuffer() {
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(0, 0, width, height);
+}
+
+void HeadlessContext::readPixels(std::vector<unsigned char> &pixels) {
+  pixels.resize((size_t)width * height * 4);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+HeadlessStats runHeadless(HeadlessContext &context, int frames,
+                          const std::function<void(int frame)> &renderFrame) {
+  using Clock = std::chrono::steady_clock;
+  HeadlessStats stats;
+  if (!context.isValid || frames <= 0)
+    return stats;
+
+  stats.minFrameMs = 1.0e30;
+  Clock::time_point start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    Clock::time_point frameStart = Clock::now();
+    context.bindFramebuffer();
+    renderFrame(frame);
+    // Sin swap no hay nada que marque el fin del frame; esperamos a la GPU
+    glFinish();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                          frameStart)
+                    .count();
+    stats.minFrameMs = std::min(stats.minFrameMs, ms);
+    stats.maxFrameMs = std::max(stats.maxFrameMs, ms);
+  }
+  stats.frames = frames;
+  stats.totalMs =
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  stats.averageFrameMs = stats.totalMs / frames;
+  stats.framesPerSecond = 1000.0 / stats.averageFrameMs;
+
+  std::cout << "HEADLESS::STATS " << context.backend << " " << context.width
+            << "x" << context.height << " | " << stats.frames << " frames in "
+            << stats.totalMs << " ms | avg " << stats.averageFrameMs
+            << " ms, min " << stats.minFrameMs << " ms, max "
+            << stats.maxFrameMs << " ms | " << stats.framesPerSecond
+            << " fps" << std::endl;
+  return stats;
+}
@@ -0,0 +1,84 @@
+#include "InstancedMesh.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+InstancedMesh::InstancedMesh(unsigned int VAO, GLsizei indexCount,
+                             size_t maxInstances, GLenum indexType)
+    : VAO(VAO), indexCount(indexCount), indexType(indexType),
+      instanceBuffer(GL_ARRAY_BUFFER, maxInstances * sizeof(InstanceData) * 3),
+      maxInstances(maxInstances) {
+  glBindVertexArray(VAO);
+  for (GLuint i = 0; i < 4; i++) {
+    glEnableVertexAttribArray(INSTANCE_ATTRIBUTE_TRANSFORM + i);
+    glVertexAttribDivisor(INSTANCE_ATTRIBUTE_TRANSFORM + i, 1);
+  }
+  for (GLuint location : {INSTANCE_ATTRIBUTE_UV_RECT, INSTANCE_ATTRIBUTE_TINT,
+                          INSTANCE_ATTRIBUTE_LAYER}) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+  pointAttributes(0);
+  glBindVertexArray(0);
+}
+
+void InstancedMesh::pointAttributes(size_t byteOffset) {
+  // El offset cambia cada frame porque el stream buffer avanza como anillo
+  const GLsizei stride = sizeof(InstanceData);
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.ID);
+  for (GLuint i = 0; i < 4; i++) {
+    glVertexAttribPointer(
+        INSTANCE_ATTRIBUTE_TRANSFORM + i, 4, GL_FLOAT, GL_FALSE, stride,
+        (void *)(byteOffset + offsetof(InstanceData, transform) +
+                 i * 4 * sizeof(float)));
+  }
+  glVertexAttribPointer(INSTANCE_ATTRIBUTE_UV_RECT, 4, GL_FLOAT, GL_FALSE,
+                        stride,
+                        (void *)(byteOffset + offsetof(InstanceData, uvRect)));
+  glVertexAttribPointer(INSTANCE_ATTRIBUTE_TINT, 4, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(byteOffset + offsetof(InstanceData, tint)));
+  glVertexAttribPointer(INSTANCE_ATTRIBUTE_LAYER, 1, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(byteOffset + offsetof(InstanceData, layer)));
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstanceData *InstancedMesh::beginInstances(size_t count) {
+  if (count > maxInstances && !reportedOverflow) {
+    // Una vez: en un loop de frames se repetiria en cada uno
+    std::cout << "ERROR::INSTANCED_MESH::TOO_MANY_INSTANCES " << count
+              << " > " << maxInstances << ", the rest are not drawn"
+              << std::endl;
+    reportedOverflow = true;
+  }
+  count = std::min(count, maxInstances);
+  if (count == 0)
+    return nullptr;
+  return static_cast<InstanceData *>(
+      instanceBuffer.map(count * sizeof(InstanceData), sizeof(InstanceData)));
+}
+
+void InstancedMesh::endInstances(size_t count) {
+  count = std::min(count, maxInstances);
+  if (!instanceBuffer.isMapped())
+    return;
+  size_t offset = instanceBuffer.unmap();
+  if (count == 0)
+    return;
+
+  glBindVertexArray(VAO);
+  pointAttributes(offset);
+  glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0,
+                          (GLsizei)count);
+  glBindVertexArray(0);
+}
+
+void InstancedMesh::draw(const InstanceData *instances, size_t count) {
+  if (count == 0)
+    return;
+  InstanceData *target = beginInstances(count);
+  if (target == nullptr)
+    return;
+  count = std::min(count, maxInstances);
+  std::memcpy(target, instances, count * sizeof(InstanceData));
+  endInstances(count);
+}
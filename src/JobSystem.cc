@@ -0,0 +1,295 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+struct Job {
+  JobSystem::JobFunction function;
+  JobCounter *counter;
+};
+
+namespace {
+
+// Indice de cola del hilo actual y el sistema al que pertenece
+thread_local const JobSystem *threadSystem = nullptr;
+thread_local int threadQueue = -1;
+
+// xorshift por hilo para elegir a quien robarle
+thread_local uint32_t stealSeed = 0x9e3779b9u;
+
+uint32_t nextRandom() {
+  stealSeed ^= stealSeed << 13;
+  stealSeed ^= stealSeed >> 17;
+  stealSeed ^= stealSeed << 5;
+  return stealSeed;
+}
+
+} // namespace
+
+WorkStealingDeque::WorkStealingDeque()
+    : buffer(new std::atomic<Job *>[CAPACITY]) {}
+
+bool WorkStealingDeque::push(Job *job) {
+  int64_t b = bottom.load(std::memory_order_relaxed);
+  int64_t t = top.load(std::memory_order_acquire);
+  if (b - t >= CAPACITY)
+    return false;
+  buffer[b & (CAPACITY - 1)].store(job, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b + 1, std::memory_order_relaxed);
+  return true;
+}
+
+Job *WorkStealingDeque::pop() {
+  int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top.load(std::memory_order_relaxed);
+
+  if (t > b) {
+    // Vacia
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Job *job = buffer[b & (CAPACITY - 1)].load(std::memory_order_acquire);
+  if (t == b) {
+    // Ultimo elemento: competimos con los ladrones
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+      job = nullptr;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+Job *WorkStealingDeque::steal() {
+  int64_t t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t b = bottom.load(std::memory_order_acquire);
+  if (t >= b)
+    return nullptr;
+
+  Job *job = buffer[t & (CAPACITY - 1)].load(std::memory_order_acquire);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                   std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+JobSystem::JobSystem(size_t workerCount) : mainThread(std::this_thread::get_id()) {
+  if (workerCount == 0) {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    workerCount = hardware > 1 ? hardware - 1 : 1;
+  }
+
+  for (size_t i = 0; i <= workerCount; i++)
+    deques.push_back(std::make_unique<WorkStealingDeque>());
+
+  threadSystem = this;
+  threadQueue = 0;
+  for (size_t i = 1; i <= workerCount; i++)
+    workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (std::thread &worker : workers)
+    worker.join();
+  if (threadSystem == this) {
+    threadSystem = nullptr;
+    threadQueue = -1;
+  }
+}
+
+JobSystem &JobSystem::shared() {
+  static JobSystem system;
+  return system;
+}
+
+bool JobSystem::isMainThread() const {
+  return std::this_thread::get_id() ==
+         mainThread.load(std::memory_order_acquire);
+}
+
+void JobSystem::setMainThread() {
+  // Solo cambia quien corre los jobs del hilo principal; la cola 0 sigue
+  // siendo del hilo que creo el JobSystem
+  mainThread.store(std::this_thread::get_id(), std::memory_order_release);
+}
+
+int JobSystem::currentQueue() const {
+  return threadSystem == this ? threadQueue : -1;
+}
+
+void JobSystem::schedule(Job *job) {
+  int queue = currentQueue();
+  if (queue < 0 || !deques[queue]->push(job)) {
+    std::lock_guard<std::mutex> lock(injectMutex);
+    injected.push_back(job);
+  }
+  // seq_cst con el worker que se duerme (store buffering): si los dos
+  // fueran acquire/release podrian leer el valor viejo y el worker se
+  // dormiria con un job en la cola
+  queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+  if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+    // Tomar el mutex evita perder el aviso si un worker se esta durmiendo
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeUp.notify_one();
+  }
+}
+
+void JobSystem::run(JobFunction function, JobCounter *counter) {
+  if (counter)
+    counter->count.fetch_add(1, std::memory_order_relaxed);
+  schedule(new Job{std::move(function), counter});
+}
+
+void JobSystem::runAfter(JobCounter &dependency, JobFunction function,
+                         JobCounter *counter) {
+  if (counter)
+    counter->count.fetch_add(1, std::memory_order_relaxed);
+  Job *job = new Job{std::move(function), counter};
+
+  std::unique_lock<std::mutex> lock(dependency.mutex);
+  if (dependency.done()) {
+    lock.unlock();
+    schedule(job);
+  } else {
+    dependency.waiting.push_back(job);
+  }
+}
+
+void JobSystem::runOnMainThread(JobFunction function, JobCounter *counter) {
+  if (counter)
+    counter->count.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mainMutex);
+  mainJobs.push_back(new Job{std::move(function), counter});
+}
+
+void JobSystem::runMainThreadJobs() {
+  std::vector<Job *> jobs;
+  {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    jobs.swap(mainJobs);
+  }
+  for (Job *job : jobs)
+    execute(job);
+}
+
+Job *JobSystem::findJob(size_t self) {
+  Job *job = deques[self]->pop();
+  if (!job) {
+    std::lock_guard<std::mutex> lock(injectMutex);
+    if (!injected.empty()) {
+      job = injected.back();
+      injected.pop_back();
+    }
+  }
+  if (!job) {
+    // Robamos empezando por una cola al azar
+    size_t count = deques.size();
+    size_t start = nextRandom() % count;
+    for (size_t i = 0; i < count && !job; i++) {
+      size_t victim = (start + i) % count;
+      if (victim != self)
+        job = deques[victim]->steal();
+    }
+  }
+  if (job)
+    queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+  return job;
+}
+
+void JobSystem::execute(Job *job) {
+  job->function();
+  JobCounter *counter = job->counter;
+  delete job;
+
+  if (!counter)
+    return;
+
+  // Se baja el contador con el mutex tomado: wait() lo toma antes de volver,
+  // asi nadie destruye el contador mientras todavia lo estamos usando
+  std::vector<Job *> ready;
+  {
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      ready.swap(counter->waiting); // se cumplio la dependencia
+  }
+  for (Job *waiting : ready)
+    schedule(waiting);
+}
+
+void JobSystem::workerLoop(size_t index) {
+  threadSystem = this;
+  threadQueue = (int)index;
+  stealSeed ^= (uint32_t)(index * 2654435761u);
+
+  while (!stopping.load(std::memory_order_acquire)) {
+    Job *job = findJob(index);
+    if (job) {
+      execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    // seq_cst, la otra mitad del handshake de schedule()
+    sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+    wakeUp.wait(lock, [&] {
+      return stopping.load(std::memory_order_acquire) ||
+             queuedJobs.load(std::memory_order_seq_cst) > 0;
+    });
+    sleepingWorkers.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+void JobSystem::wait(JobCounter &counter) {
+  int queue = currentQueue();
+  bool mainThreadWaiting = isMainThread();
+
+  while (!counter.done()) {
+    if (mainThreadWaiting)
+      runMainThreadJobs();
+
+    Job *job = nullptr;
+    if (queue >= 0) {
+      job = findJob((size_t)queue);
+    } else {
+      std::lock_guard<std::mutex> lock(injectMutex);
+      if (!injected.empty()) {
+        job = injected.back();
+        injected.pop_back();
+        queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    }
+
+    if (job)
+      execute(job);
+    else
+      std::this_thread::yield();
+  }
+  std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain,
+                            const RangeFunction &body) {
+  if (begin >= end)
+    return;
+  grain = std::max<size_t>(grain, 1);
+  size_t total = end - begin;
+  // Como mucho unos pocos chunks por hilo para repartir bien sin inflar
+  // la cantidad de jobs
+  size_t threads = workers.size() + 1;
+  size_t chunk = std::max(grain, (total + threads * 4 - 1) / (threads * 4));
+
+  JobCounter counter;
+  for (size_t first = begin; first < end; first += chunk) {
+    size_t last = std::min(end, first + chunk);
+    run([&body, first, last] { body(first, last); }, &counter);
+  }
+  wait(counter);
+}
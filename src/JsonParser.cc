@@ -0,0 +1,276 @@
+#include "JsonParser.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+struct TokenizerState {
+  const char *json;
+  size_t length;
+  size_t pos = 0;
+  JsonToken *tokens;
+  unsigned int maxTokens;
+  unsigned int next = 0;
+  int super = -1;
+};
+
+int allocToken(TokenizerState &s, JsonType type, size_t start, size_t end) {
+  if (s.next >= s.maxTokens)
+    return -1;
+  int index = static_cast<int>(s.next++);
+  JsonToken &t = s.tokens[index];
+  t.type = type;
+  t.start = static_cast<uint32_t>(start);
+  t.end = static_cast<uint32_t>(end);
+  t.size = 0;
+  t.next = s.next;
+  t.parent = s.super;
+  return index;
+}
+
+bool isContainer(const JsonToken &t) {
+  return t.type == JsonType::Object || t.type == JsonType::Array;
+}
+
+bool isPrimitiveChar(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' ||
+         c == '+' || c == '.' || c == 'E';
+}
+
+// Devuelve el final del string (posicion de la comilla de cierre) o < 0
+long scanString(const char *json, size_t length, size_t pos) {
+  for (size_t i = pos + 1; i < length; i++) {
+    char c = json[i];
+    if (c == '"')
+      return static_cast<long>(i);
+    if (c == '\\') {
+      i++;
+      if (i >= length)
+        return JSON_ERROR_PARTIAL;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      return JSON_ERROR_INVALID;
+    }
+  }
+  return JSON_ERROR_PARTIAL;
+}
+
+size_t scanPrimitive(const char *json, size_t length, size_t pos) {
+  while (pos < length && isPrimitiveChar(json[pos]))
+    pos++;
+  return pos;
+}
+
+int countTokens(const char *json, size_t length) {
+  int count = 0;
+  int depth = 0;
+  for (size_t i = 0; i < length; i++) {
+    char c = json[i];
+    if (c == '{' || c == '[') {
+      count++;
+      depth++;
+    } else if (c == '}' || c == ']') {
+      if (--depth < 0)
+        return JSON_ERROR_INVALID;
+    } else if (c == '"') {
+      long end = scanString(json, length, i);
+      if (end < 0)
+        return static_cast<int>(end);
+      i = static_cast<size_t>(end);
+      count++;
+    } else if (isPrimitiveChar(c)) {
+      i = scanPrimitive(json, length, i) - 1;
+      count++;
+    }
+  }
+  return depth == 0 ? count : JSON_ERROR_PARTIAL;
+}
+
+} // namespace
+
+int jsonTokenize(const char *json, size_t length, JsonToken *tokens,
+                 unsigned int maxTokens) {
+  if (tokens == nullptr)
+    return countTokens(json, length);
+
+  TokenizerState s{json, length, 0, tokens, maxTokens};
+
+  for (; s.pos < length; s.pos++) {
+    char c = json[s.pos];
+    switch (c) {
+    case '{':
+    case '[': {
+      if (s.super >= 0) {
+        JsonToken &parent = tokens[s.super];
+        // Un objeto solo puede tener strings como claves
+        if (parent.type == JsonType::Object)
+          return JSON_ERROR_INVALID;
+        parent.size++;
+      }
+      int index = allocToken(s, c == '{' ? JsonType::Object : JsonType::Array,
+                             s.pos, 0);
+      if (index < 0)
+        return JSON_ERROR_NOMEM;
+      s.super = index;
+      break;
+    }
+    case '}':
+    case ']': {
+      JsonType type = c == '}' ? JsonType::Object : JsonType::Array;
+      // Subimos por los padres hasta el contenedor que sigue abierto
+      int open = s.super;
+      while (open >= 0 && !(isContainer(tokens[open]) && tokens[open].end == 0))
+        open = tokens[open].parent;
+      if (open < 0 || tokens[open].type != type)
+        return JSON_ERROR_INVALID;
+      tokens[open].end = static_cast<uint32_t>(s.pos + 1);
+      tokens[open].next = s.next;
+      // Keys that own this container are complete as well
+      int parent = tokens[open].parent;
+      if (parent >= 0 && tokens[parent].type == JsonType::String)
+        parent = tokens[parent].parent;
+      s.super = parent;
+      break;
+    }
+    case '"': {
+      long end = scanString(json, length, s.pos);
+      if (end < 0)
+        return static_cast<int>(end);
+      int index = allocToken(s, JsonType::String, s.pos + 1,
+                             static_cast<size_t>(end));
+      if (index < 0)
+        return JSON_ERROR_NOMEM;
+      if (s.super >= 0)
+        tokens[s.super].size++;
+      s.pos = static_cast<size_t>(end);
+      break;
+    }
+    case ':':
+      // El siguiente valor cuelga de la ultima clave
+      if (s.next == 0 || tokens[s.next - 1].type != JsonType::String)
+        return JSON_ERROR_INVALID;
+      s.super = static_cast<int>(s.next - 1);
+      break;
+    case ',':
+      if (s.super >= 0 && tokens[s.super].type == JsonType::String)
+        s.super = tokens[s.super].parent;
+      break;
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+      break;
+    default: {
+      if (!isPrimitiveChar(c))
+        return JSON_ERROR_INVALID;
+      if (s.super >= 0 && tokens[s.super].type == JsonType::Object)
+        return JSON_ERROR_INVALID;
+      size_t end = scanPrimitive(json, length, s.pos);
+      int index = allocToken(s, JsonType::Primitive, s.pos, end);
+      if (index < 0)
+        return JSON_ERROR_NOMEM;
+      if (s.super >= 0)
+        tokens[s.super].size++;
+      s.pos = end - 1;
+      break;
+    }
+    }
+  }
+
+  for (unsigned int i = 0; i < s.next; i++) {
+    if (isContainer(tokens[i]) && tokens[i].end == 0)
+      return JSON_ERROR_PARTIAL;
+    // Cada clave tiene exactamente un valor: {"a"} o {"a": 1 2} no valen
+    int parent = tokens[i].parent;
+    if (tokens[i].type == JsonType::String && parent >= 0 &&
+        tokens[parent].type == JsonType::Object && tokens[i].size != 1)
+      return JSON_ERROR_INVALID;
+  }
+  return static_cast<int>(s.next);
+}
+
+int JsonDocument::firstChild(int container) const {
+  if (container < 0 || container >= count)
+    return -1;
+  const JsonToken &t = tokens[container];
+  if (!isContainer(t) || t.size == 0)
+    return -1;
+  return container + 1;
+}
+
+int JsonDocument::nextSibling(int token) const {
+  if (token < 0 || token >= count)
+    return -1;
+  int parent = tokens[token].parent;
+  if (parent < 0)
+    return -1;
+  // En objetos hay que saltar tambien el valor de la clave
+  uint32_t next = tokens[parent].type == JsonType::Object &&
+                          tokens[token].size > 0 && token + 1 < count
+                      ? tokens[token + 1].next
+                      : tokens[token].next;
+  return next < tokens[parent].next ? static_cast<int>(next) : -1;
+}
+
+int JsonDocument::find(int object, const char *key) const {
+  if (object < 0 || object >= count || tokens[object].type != JsonType::Object)
+    return -1;
+  for (int k = firstChild(object); k >= 0; k = nextSibling(k)) {
+    if (equals(k, key))
+      return tokens[k].size > 0 && k + 1 < count ? k + 1 : -1;
+  }
+  return -1;
+}
+
+int JsonDocument::element(int array, uint32_t i) const {
+  if (array < 0 || array >= count || tokens[array].type != JsonType::Array ||
+      i >= tokens[array].size)
+    return -1;
+  int e = firstChild(array);
+  while (i-- > 0 && e >= 0)
+    e = nextSibling(e);
+  return e;
+}
+
+bool JsonDocument::equals(int token, const char *text) const {
+  if (token < 0 || token >= count)
+    return false;
+  const JsonToken &t = tokens[token];
+  size_t length = t.end - t.start;
+  return std::strlen(text) == length &&
+         std::memcmp(json + t.start, text, length) == 0;
+}
+
+std::string_view JsonDocument::asString(int token) const {
+  if (token < 0 || token >= count || tokens[token].type != JsonType::String)
+    return {};
+  const JsonToken &t = tokens[token];
+  return std::string_view(json + t.start, t.end - t.start);
+}
+
+long long JsonDocument::asInt(int token, long long fallback) const {
+  if (token < 0 || token >= count || tokens[token].type != JsonType::Primitive)
+    return fallback;
+  const JsonToken &t = tokens[token];
+  long long value = fallback;
+  auto result = std::from_chars(json + t.start, json + t.end, value);
+  return result.ec == std::errc() ? value : fallback;
+}
+
+double JsonDocument::asNumber(int token, double fallback) const {
+  if (token < 0 || token >= count || tokens[token].type != JsonType::Primitive)
+    return fallback;
+  const JsonToken &t = tokens[token];
+  double value = fallback;
+  auto result = std::from_chars(json + t.start, json + t.end, value);
+  return result.ec == std::errc() ? value : fallback;
+}
+
+bool JsonDocument::asBool(int token, bool fallback) const {
+  if (token < 0 || token >= count || tokens[token].type != JsonType::Primitive)
+    return fallback;
+  if (equals(token, "true"))
+    return true;
+  if (equals(token, "false"))
+    return false;
+  return fallback;
+}
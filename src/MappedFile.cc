@@ -0,0 +1,67 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile(const char *path) { open(path); }
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(other.bytes), length(other.length) {
+  other.bytes = nullptr;
+  other.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    std::swap(bytes, other.bytes);
+    std::swap(length, other.length);
+  }
+  return *this;
+}
+
+bool MappedFile::open(const char *path) {
+  close();
+
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    std::cout << "ERROR::MAPPED_FILE::EMPTY_OR_UNREADABLE " << path
+              << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // El descriptor ya no hace falta, el mapeo sigue vivo hasta munmap
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cout << "ERROR::MAPPED_FILE::MMAP_FAILED " << path << std::endl;
+    return false;
+  }
+
+  // Pedimos al kernel que empiece a leer por adelantado
+  madvise(mapping, info.st_size, MADV_WILLNEED);
+
+  bytes = static_cast<const uint8_t *>(mapping);
+  length = static_cast<size_t>(info.st_size);
+  return true;
+}
+
+void MappedFile::close() {
+  if (bytes) {
+    munmap(const_cast<uint8_t *>(bytes), length);
+    bytes = nullptr;
+    length = 0;
+  }
+}
@@ -0,0 +1,403 @@
+#include "MeshSimplifier.h"
+#include "MathUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+const size_t MAX_DIMENSION = 16;
+
+struct Collapse {
+  float cost;
+  unsigned int from;
+  unsigned int to;
+  unsigned int fromStamp;
+  unsigned int toStamp;
+
+  bool operator>(const Collapse &o) const { return cost > o.cost; }
+};
+
+class Simplifier {
+public:
+  Simplifier(const float *vertices, size_t vertexCount,
+             const SimplifyOptions &options)
+      : vertices(vertices), vertexCount(vertexCount), options(options),
+        dimension(3 + std::min(options.attributeCount, MAX_DIMENSION - 3)),
+        quadricSize(dimension * (dimension + 1) / 2 + dimension + 2) {}
+
+  std::vector<unsigned int> run(const unsigned int *indices, size_t indexCount,
+                                size_t targetIndexCount, float *resultError);
+
+private:
+  const float *vertices;
+  size_t vertexCount;
+  SimplifyOptions options;
+  size_t dimension;
+  // A triangular superior, b, c y el peso (suma de areas)
+  size_t quadricSize;
+
+  std::vector<double> quadrics;
+  std::vector<unsigned int> triangles;
+  std::vector<bool> triangleAlive;
+  std::vector<std::vector<unsigned int>> adjacency;
+  std::vector<unsigned int> stamp;
+  std::vector<bool> locked;
+  std::vector<bool> removed;
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>
+      heap;
+
+  void point(unsigned int v, double *out) const {
+    const float *p = vertices + (size_t)v * options.stride;
+    for (size_t i = 0; i < 3; i++)
+      out[i] = p[i];
+    for (size_t i = 3; i < dimension; i++) {
+      float weight =
+          options.attributeWeights ? options.attributeWeights[i - 3] : 1.0f;
+      out[i] = p[i] * weight;
+    }
+  }
+
+  Vec3 position(unsigned int v) const {
+    const float *p = vertices + (size_t)v * options.stride;
+    return Vec3(p[0], p[1], p[2]);
+  }
+
+  double *quadric(unsigned int v) { return &quadrics[(size_t)v * quadricSize]; }
+
+  void addTriangleQuadric(unsigned int a, unsigned int b, unsigned int c);
+  double evaluate(unsigned int q, const double *x);
+  float collapseCost(unsigned int from, unsigned int to);
+  void pushEdge(unsigned int a, unsigned int b);
+  bool flips(unsigned int from, unsigned int to);
+  void collapse(unsigned int from, unsigned int to, size_t &aliveTriangles);
+};
+
+void Simplifier::addTriangleQuadric(unsigned int a, unsigned int b,
+                                    unsigned int c) {
+  double p1[MAX_DIMENSION], p2[MAX_DIMENSION], p3[MAX_DIMENSION];
+  point(a, p1);
+  point(b, p2);
+  point(c, p3);
+
+  double area = 0.5 * length(cross(position(b) - position(a),
+                                   position(c) - position(a)));
+  if (area <= 0.0)
+    return;
+
+  // Base ortonormal (e1, e2) del plano del triangulo en R^n
+  double e1[MAX_DIMENSION], e2[MAX_DIMENSION];
+  double len1 = 0.0;
+  for (size_t i = 0; i < dimension; i++) {
+    e1[i] = p2[i] - p1[i];
+    len1 += e1[i] * e1[i];
+  }
+  len1 = std::sqrt(len1);
+  if (len1 == 0.0)
+    return;
+  double projection = 0.0;
+  for (size_t i = 0; i < dimension; i++) {
+    e1[i] /= len1;
+    projection += e1[i] * (p3[i] - p1[i]);
+  }
+  double len2 = 0.0;
+  for (size_t i = 0; i < dimension; i++) {
+    e2[i] = p3[i] - p1[i] - projection * e1[i];
+    len2 += e2[i] * e2[i];
+  }
+  len2 = std::sqrt(len2);
+  if (len2 == 0.0)
+    return;
+  for (size_t i = 0; i < dimension; i++)
+    e2[i] /= len2;
+
+  double p1e1 = 0.0, p1e2 = 0.0, p1p1 = 0.0;
+  for (size_t i = 0; i < dimension; i++) {
+    p1e1 += p1[i] * e1[i];
+    p1e2 += p1[i] * e2[i];
+    p1p1 += p1[i] * p1[i];
+  }
+
+  // A = I - e1 e1^T - e2 e2^T, b = (p.e1) e1 + (p.e2) e2 - p,
+  // c = p.p - (p.e1)^2 - (p.e2)^2; todo ponderado por el area
+  double q[MAX_DIMENSION * (MAX_DIMENSION + 1) / 2 + MAX_DIMENSION + 2];
+  size_t k = 0;
+  for (size_t i = 0; i < dimension; i++)
+    for (size_t j = i; j < dimension; j++)
+      q[k++] = area * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+  for (size_t i = 0; i < dimension; i++)
+    q[k++] = area * (p1e1 * e1[i] + p1e2 * e2[i] - p1[i]);
+  q[k++] = area * (p1p1 - p1e1 * p1e1 - p1e2 * p1e2);
+  q[k++] = area;
+
+  for (unsigned int v : {a, b, c}) {
+    double *target = quadric(v);
+    for (size_t i = 0; i < quadricSize; i++)
+      target[i] += q[i];
+  }
+}
+
+double Simplifier::evaluate(unsigned int v, const double *x) {
+  const double *q = quadric(v);
+  double result = 0.0;
+  size_t k = 0;
+  for (size_t i = 0; i < dimension; i++)
+    for (size_t j = i; j < dimension; j++)
+      result += q[k++] * x[i] * x[j] * (i == j ? 1.0 : 2.0);
+  for (size_t i = 0; i < dimension; i++)
+    result += 2.0 * q[k++] * x[i];
+  result += q[k];
+  return result;
+}
+
+float Simplifier::collapseCost(unsigned int from, unsigned int to) {
+  double x[MAX_DIMENSION];
+  point(to, x);
+  double weight = quadric(from)[quadricSize - 1] + quadric(to)[quadricSize - 1];
+  double error = evaluate(from, x) + evaluate(to, x);
+  // Error cuadratico medio por unidad de area, en unidades del mundo
+  return weight > 0.0 ? (float)std::sqrt(std::max(0.0, error / weight)) : 0.0f;
+}
+
+void Simplifier::pushEdge(unsigned int a, unsigned int b) {
+  // Colapsamos siempre el vertice libre hacia el otro (half-edge collapse)
+  if (!locked[a]) {
+    heap.push({collapseCost(a, b), a, b, stamp[a], stamp[b]});
+  }
+  if (!locked[b]) {
+    heap.push({collapseCost(b, a), b, a, stamp[b], stamp[a]});
+  }
+}
+
+bool Simplifier::flips(unsigned int from, unsigned int to) {
+  Vec3 target = position(to);
+  for (unsigned int t : adjacency[from]) {
+    if (!triangleAlive[t])
+      continue;
+    const unsigned int *tri = &triangles[t * 3];
+    if (tri[0] == to || tri[1] == to || tri[2] == to)
+      continue;
+
+    Vec3 before[3], after[3];
+    for (int k = 0; k < 3; k++) {
+      before[k] = position(tri[k]);
+      after[k] = tri[k] == from ? target : before[k];
+    }
+    Vec3 n0 = cross(before[1] - before[0], before[2] - before[0]);
+    Vec3 n1 = cross(after[1] - after[0], after[2] - after[0]);
+    // Rechazamos si el triangulo se da vuelta o queda degenerado
+    if (dot(n0, n1) <= 0.0f)
+      return true;
+  }
+  return false;
+}
+
+void Simplifier::collapse(unsigned int from, unsigned int to,
+                          size_t &aliveTriangles) {
+  for (unsigned int t : adjacency[from]) {
+    if (!triangleAlive[t])
+      continue;
+    unsigned int *tri = &triangles[t * 3];
+    if (tri[0] == to || tri[1] == to || tri[2] == to) {
+      triangleAlive[t] = false;
+      aliveTriangles--;
+      continue;
+    }
+    for (int k = 0; k < 3; k++) {
+      if (tri[k] == from)
+        tri[k] = to;
+    }
+    adjacency[to].push_back(t);
+  }
+  adjacency[from].clear();
+
+  double *source = quadric(from);
+  double *target = quadric(to);
+  for (size_t i = 0; i < quadricSize; i++)
+    target[i] += source[i];
+
+  removed[from] = true;
+  stamp[to]++;
+
+  // Compactamos la lista de triangulos de `to` y recalculamos sus aristas
+  std::vector<unsigned int> &list = adjacency[to];
+  list.erase(std::remove_if(list.begin(), list.end(),
+                            [&](unsigned int t) { return !triangleAlive[t]; }),
+             list.end());
+  for (unsigned int t : list) {
+    const unsigned int *tri = &triangles[t * 3];
+    for (int k = 0; k < 3; k++) {
+      if (tri[k] != to)
+        pushEdge(to, tri[k]);
+    }
+  }
+}
+
+std::vector<unsigned int> Simplifier::run(const unsigned int *indices,
+                                          size_t indexCount,
+                                          size_t targetIndexCount,
+                                          float *resultError) {
+  size_t triangleCount = indexCount / 3;
+  triangles.assign(indices, indices + triangleCount * 3);
+  triangleAlive.assign(triangleCount, true);
+  adjacency.assign(vertexCount, {});
+  stamp.assign(vertexCount, 0);
+  locked.assign(vertexCount, false);
+  removed.assign(vertexCount, false);
+  quadrics.assign(vertexCount * quadricSize, 0.0);
+
+  std::unordered_map<unsigned long long, int> edgeUse;
+  auto edgeKey = [](unsigned int a, unsigned int b) {
+    return ((unsigned long long)std::min(a, b) << 32) | std::max(a, b);
+  };
+
+  for (size_t t = 0; t < triangleCount; t++) {
+    const unsigned int *tri = &triangles[t * 3];
+    addTriangleQuadric(tri[0], tri[1], tri[2]);
+    for (int k = 0; k < 3; k++) {
+      adjacency[tri[k]].push_back((unsigned int)t);
+      edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])]++;
+    }
+  }
+
+  // Vertices en bordes abiertos (incluye costuras de UV) no se mueven
+  for (const auto &edge : edgeUse) {
+    if (edge.second == 1) {
+      locked[edge.first >> 32] = true;
+      locked[edge.first & 0xffffffffu] = true;
+    }
+  }
+  for (const auto &edge : edgeUse)
+    pushEdge((unsigned int)(edge.first >> 32),
+             (unsigned int)(edge.first & 0xffffffffu));
+
+  size_t aliveTriangles = triangleCount;
+  size_t targetTriangles = targetIndexCount / 3;
+  float maxApplied = 0.0f;
+
+  while (aliveTriangles > targetTriangles && !heap.empty()) {
+    Collapse c = heap.top();
+    heap.pop();
+    if (c.cost > options.maxError)
+      break;
+    if (removed[c.from] || removed[c.to] || stamp[c.from] != c.fromStamp ||
+        stamp[c.to] != c.toStamp)
+      continue;
+    if (flips(c.from, c.to))
+      continue;
+    collapse(c.from, c.to, aliveTriangles);
+    maxApplied = std::max(maxApplied, c.cost);
+  }
+
+  std::vector<unsigned int> result;
+  result.reserve(aliveTriangles * 3);
+  for (size_t t = 0; t < triangleCount; t++) {
+    if (triangleAlive[t])
+      result.insert(result.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+  }
+  if (resultError)
+    *resultError = maxApplied;
+  return result;
+}
+
+} // namespace
+
+std::vector<unsigned int> simplifyMesh(const unsigned int *indices,
+                                       size_t indexCount,
+                                       const float *vertices,
+                                       size_t vertexCount,
+                                       size_t targetIndexCount,
+                                       const SimplifyOptions &options,
+                                       float *resultError) {
+  Simplifier simplifier(vertices, vertexCount, options);
+  return simplifier.run(indices, indexCount, targetIndexCount, resultError);
+}
+
+LodChain generateLodChain(const unsigned int *indices, size_t indexCount,
+                          const float *vertices, size_t vertexCount,
+                          const SimplifyOptions &options, size_t maxLevels,
+                          float reduction) {
+  LodChain chain;
+  chain.indices.assign(indices, indices + indexCount);
+  chain.levels.push_back({0, indexCount, 0.0f});
+
+  std::vector<unsigned int> previous(indices, indices + indexCount);
+  float accumulatedError = 0.0f;
+  while (chain.levels.size() < maxLevels) {
+    size_t target = (size_t)(previous.size() * reduction) / 3 * 3;
+    if (target < 3)
+      break;
+
+    // Cada nivel parte del anterior; el error se acumula de forma
+    // conservadora sumando el de cada paso
+    float error = 0.0f;
+    std::vector<unsigned int> level =
+        simplifyMesh(previous.data(), previous.size(), vertices, vertexCount,
+                     target, options, &error);
+    // Si ya casi no se puede reducir (bordes bloqueados, maxError) paramos
+    if (level.empty() || level.size() > previous.size() * 0.95f)
+      break;
+
+    accumulatedError += error;
+    chain.levels.push_back(
+        {chain.indices.size(), level.size(), accumulatedError});
+    chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+    previous.swap(level);
+  }
+  return chain;
+}
+
+LodSelector::LodSelector(float pixelThreshold, float hysteresis)
+    : pixelThreshold(pixelThreshold), hysteresis(hysteresis) {}
+
+float LodSelector::projectedError(float error, float distance, float fovY,
+                                  float viewportHeight) {
+  distance = std::max(distance, 1e-4f);
+  return error * viewportHeight / (2.0f * distance * std::tan(fovY * 0.5f));
+}
+
+size_t LodSelector::select(size_t object, const LodChain &chain,
+                           float distance, float fovY, float viewportHeight) {
+  return select(object, chain.levels.data(), chain.levels.size(),
+                projectedError(1.0f, distance, fovY, viewportHeight));
+}
+
+void LodSelector::reserve(size_t objects) {
+  if (objects > currentLevel.size())
+    currentLevel.resize(objects, 0);
+}
+
+size_t LodSelector::select(size_t object, const LodLevel *levels,
+                           size_t levelCount, float pixelsPerUnit) {
+  if (object >= currentLevel.size())
+    currentLevel.resize(object + 1, 0);
+  if (levelCount == 0)
+    return 0;
+
+  size_t &current = currentLevel[object];
+  current = std::min(current, levelCount - 1);
+
+  // El nivel mas grueso cuyo error proyectado queda bajo `limit`
+  auto coarsestBelow = [&](float limit) {
+    size_t level = 0;
+    for (size_t i = 1; i < levelCount; i++) {
+      if (levels[i].error * pixelsPerUnit <= limit)
+        level = i;
+      else
+        break;
+    }
+    return level;
+  };
+
+  size_t desired = coarsestBelow(pixelThreshold);
+  if (desired < current) {
+    // El nivel actual ya se nota: subimos de calidad enseguida
+    current = desired;
+  } else if (desired > current) {
+    // Para bajar de calidad pedimos margen extra
+    current = std::max(current,
+                       coarsestBelow(pixelThreshold * (1.0f - hysteresis)));
+  }
+  return current;
+}
@@ -0,0 +1,306 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESHLET_USE_SSE 1
+#endif
+
+#ifdef MESHLET_USE_SSE
+namespace {
+
+// Carriles cuya esfera toca el frustum (todos sus bits en 1)
+__m128 spheresInFrustum(const Frustum &frustum, __m128 cx, __m128 cy,
+                        __m128 cz, __m128 r) {
+  __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+  __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (const Plane &p : frustum.planes) {
+    __m128 d = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a), cx),
+                   _mm_mul_ps(_mm_set1_ps(p.b), cy)),
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.c), cz), _mm_set1_ps(p.d)));
+    visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negR));
+  }
+  return visible;
+}
+
+} // namespace
+#endif
+
+MeshletMesh::MeshletMesh(const unsigned int *sourceIndices, size_t indexCount,
+                         const float *positions, size_t vertexCount,
+                         size_t stride, size_t maxVertices,
+                         size_t maxTriangles) {
+  maxVertices = std::min<size_t>(maxVertices, 255);
+  size_t triangleCount = indexCount / 3;
+
+  // Adyacencia vertice -> triangulos en formato CSR
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (size_t i = 0; i < triangleCount * 3; i++)
+    adjacencyOffsets[sourceIndices[i] + 1]++;
+  for (size_t v = 0; v < vertexCount; v++)
+    adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+  for (size_t t = 0; t < triangleCount; t++)
+    for (size_t k = 0; k < 3; k++)
+      adjacency[fill[sourceIndices[t * 3 + k]]++] = (uint32_t)t;
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<int16_t> localIndex(vertexCount, -1);
+  Meshlet current = {0, 0, 0, 0, 0};
+  size_t seed = 0;
+
+  auto newVertices = [&](size_t t) {
+    int count = 0;
+    for (size_t k = 0; k < 3; k++)
+      count += localIndex[sourceIndices[t * 3 + k]] < 0;
+    return count;
+  };
+
+  auto flush = [&]() {
+    for (uint32_t i = 0; i < current.vertexCount; i++)
+      localIndex[vertices[current.vertexOffset + i]] = -1;
+    meshlets.push_back(current);
+    current.vertexOffset = (uint32_t)vertices.size();
+    current.triangleOffset = (uint32_t)(triangles.size() / 3);
+    current.indexOffset = (uint32_t)indices.size();
+    current.vertexCount = 0;
+    current.triangleCount = 0;
+  };
+
+  for (size_t added = 0; added < triangleCount; added++) {
+    // Buscamos el triangulo vecino que agregue menos vertices nuevos
+    long best = -1;
+    int bestCost = 4;
+    for (uint32_t i = 0; i < current.vertexCount && bestCost > 0; i++) {
+      uint32_t v = vertices[current.vertexOffset + i];
+      for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+        uint32_t t = adjacency[a];
+        if (emitted[t])
+          continue;
+        int cost = newVertices(t);
+        if (cost < bestCost) {
+          best = t;
+          bestCost = cost;
+          if (cost == 0)
+            break;
+        }
+      }
+    }
+
+    // Sin vecinos libres: seguimos con el siguiente triangulo en orden
+    if (best < 0) {
+      while (emitted[seed])
+        seed++;
+      best = (long)seed;
+      bestCost = newVertices(seed);
+    }
+
+    if (current.vertexCount + bestCost > maxVertices ||
+        current.triangleCount + 1 > maxTriangles) {
+      flush();
+      bestCost = 3;
+    }
+
+    for (size_t k = 0; k < 3; k++) {
+      uint32_t v = sourceIndices[best * 3 + k];
+      if (localIndex[v] < 0) {
+        localIndex[v] = (int16_t)current.vertexCount++;
+        vertices.push_back(v);
+      }
+      triangles.push_back((uint8_t)localIndex[v]);
+      indices.push_back(v);
+    }
+    current.triangleCount++;
+    emitted[best] = true;
+  }
+  if (current.triangleCount > 0)
+    flush();
+
+  computeBounds(positions, stride);
+}
+
+void MeshletMesh::computeBounds(const float *positions, size_t stride) {
+  size_t count = meshlets.size();
+  centerX.resize(count);
+  centerY.resize(count);
+  centerZ.resize(count);
+  radius.resize(count);
+  coneX.resize(count);
+  coneY.resize(count);
+  coneZ.resize(count);
+  coneCutoff.resize(count);
+
+  auto position = [&](uint32_t v) {
+    const float *p = positions + (size_t)v * stride;
+    return Vec3(p[0], p[1], p[2]);
+  };
+
+  for (size_t m = 0; m < count; m++) {
+    const Meshlet &meshlet = meshlets[m];
+
+    // Esfera: centro de la AABB y la distancia maxima a ese centro
+    Vec3 lo = position(vertices[meshlet.vertexOffset]);
+    Vec3 hi = lo;
+    for (uint32_t i = 1; i < meshlet.vertexCount; i++) {
+      Vec3 p = position(vertices[meshlet.vertexOffset + i]);
+      lo = Vec3(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+      hi = Vec3(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+    }
+    Vec3 center = (lo + hi) * 0.5f;
+    float r = 0.0f;
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+      r = std::max(r, length(position(vertices[meshlet.vertexOffset + i]) -
+                             center));
+
+    // Cono: eje promedio de las normales y el angulo al que mas se aleja
+    std::vector<Vec3> normals;
+    Vec3 axis;
+    for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+      const unsigned int *tri = &indices[meshlet.indexOffset + t * 3];
+      Vec3 a = position(tri[0]);
+      Vec3 n = cross(position(tri[1]) - a, position(tri[2]) - a);
+      if (length(n) == 0.0f)
+        continue;
+      normals.push_back(normalize(n));
+      axis += normals.back();
+    }
+    axis = normalize(axis);
+    float minDot = 1.0f;
+    for (const Vec3 &n : normals)
+      minDot = std::min(minDot, dot(n, axis));
+
+    centerX[m] = center.x;
+    centerY[m] = center.y;
+    centerZ[m] = center.z;
+    radius[m] = r;
+    coneX[m] = axis.x;
+    coneY[m] = axis.y;
+    coneZ[m] = axis.z;
+    // cos(angulo + 90) del cono de back-facing; 1 desactiva el test
+    coneCutoff[m] = (normals.empty() || minDot <= 0.0f)
+                        ? 1.0f
+                        : std::sqrt(1.0f - minDot * minDot);
+  }
+}
+
+void MeshletMesh::uploadIndices(unsigned int VAO, unsigned int EBO) const {
+  glBindVertexArray(VAO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
+               indices.data(), GL_STATIC_DRAW);
+  glBindVertexArray(0);
+}
+
+size_t MeshletMesh::cull(const Frustum &frustum, const Vec3 &cameraPosition) {
+  drawCounts.clear();
+  drawOffsets.clear();
+
+  auto emit = [&](size_t m) {
+    const Meshlet &meshlet = meshlets[m];
+    drawCounts.push_back((GLsizei)(meshlet.triangleCount * 3));
+    drawOffsets.push_back(
+        (const void *)(uintptr_t)(meshlet.indexOffset * sizeof(unsigned int)));
+  };
+
+  size_t count = meshlets.size();
+  size_t m = 0;
+
+#ifdef MESHLET_USE_SSE
+  const __m128 camX = _mm_set1_ps(cameraPosition.x);
+  const __m128 camY = _mm_set1_ps(cameraPosition.y);
+  const __m128 camZ = _mm_set1_ps(cameraPosition.z);
+  for (; m + 4 <= count; m += 4) {
+    __m128 cx = _mm_loadu_ps(&centerX[m]);
+    __m128 cy = _mm_loadu_ps(&centerY[m]);
+    __m128 cz = _mm_loadu_ps(&centerZ[m]);
+    __m128 r = _mm_loadu_ps(&radius[m]);
+    __m128 visible = spheresInFrustum(frustum, cx, cy, cz, r);
+
+    __m128 vx = _mm_sub_ps(cx, camX);
+    __m128 vy = _mm_sub_ps(cy, camY);
+    __m128 vz = _mm_sub_ps(cz, camZ);
+    __m128 distance = _mm_sqrt_ps(_mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)),
+        _mm_mul_ps(vz, vz)));
+    __m128 along = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&coneX[m])),
+                   _mm_mul_ps(vy, _mm_loadu_ps(&coneY[m]))),
+        _mm_mul_ps(vz, _mm_loadu_ps(&coneZ[m])));
+    __m128 backFacing = _mm_cmpge_ps(
+        along,
+        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&coneCutoff[m]), distance), r));
+    visible = _mm_andnot_ps(backFacing, visible);
+
+    int mask = _mm_movemask_ps(visible);
+    for (int lane = 0; lane < 4; lane++) {
+      if (mask & (1 << lane))
+        emit(m + lane);
+    }
+  }
+#endif
+
+  for (; m < count; m++) {
+    Vec3 center(centerX[m], centerY[m], centerZ[m]);
+    if (!frustum.intersectsSphere(center, radius[m]))
+      continue;
+    Vec3 view = center - cameraPosition;
+    Vec3 axis(coneX[m], coneY[m], coneZ[m]);
+    if (dot(view, axis) >= coneCutoff[m] * length(view) + radius[m])
+      continue;
+    emit(m);
+  }
+
+  return drawCounts.size();
+}
+
+size_t MeshletMesh::cullRanges(const Frustum &frustum, uint32_t firstIndex,
+                               std::vector<uint32_t> &ranges) const {
+  size_t visibleCount = 0;
+  size_t rangeStart = ranges.size();
+  auto emit = [&](size_t m) {
+    const Meshlet &meshlet = meshlets[m];
+    uint32_t first = firstIndex + meshlet.indexOffset;
+    uint32_t count = meshlet.triangleCount * 3;
+    visibleCount++;
+    // Clusters vecinos quedan pegados en el element buffer: un solo rango
+    if (ranges.size() > rangeStart &&
+        ranges[ranges.size() - 2] + ranges.back() == first) {
+      ranges.back() += count;
+      return;
+    }
+    ranges.push_back(first);
+    ranges.push_back(count);
+  };
+
+  size_t count = meshlets.size();
+  size_t m = 0;
+#ifdef MESHLET_USE_SSE
+  for (; m + 4 <= count; m += 4) {
+    int mask = _mm_movemask_ps(spheresInFrustum(
+        frustum, _mm_loadu_ps(&centerX[m]), _mm_loadu_ps(&centerY[m]),
+        _mm_loadu_ps(&centerZ[m]), _mm_loadu_ps(&radius[m])));
+    for (int lane = 0; lane < 4; lane++) {
+      if (mask & (1 << lane))
+        emit(m + lane);
+    }
+  }
+#endif
+  for (; m < count; m++) {
+    if (frustum.intersectsSphere(Vec3(centerX[m], centerY[m], centerZ[m]),
+                                 radius[m]))
+      emit(m);
+  }
+  return visibleCount;
+}
+
+void MeshletMesh::draw(unsigned int VAO) const {
+  if (drawCounts.empty())
+    return;
+  glBindVertexArray(VAO);
+  glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT,
+                      drawOffsets.data(), (GLsizei)drawCounts.size());
+  glBindVertexArray(0);
+}
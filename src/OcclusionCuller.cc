@@ -0,0 +1,443 @@
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                            \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OCCLUSION_CULLER_USE_AVX2 1
+#endif
+
+namespace {
+
+const int TILE_PIXELS =
+    OcclusionCuller::TILE_WIDTH * OcclusionCuller::TILE_HEIGHT;
+// Por debajo de esto w se considera detras de la camara
+const float MIN_W = 1e-5f;
+// Cuanto se corren las aristas hacia adentro, en pixeles: medio pixel en
+// cada eje (el pixel entero queda adentro) mas un margen para el redondeo
+const float EDGE_SHRINK = 0.5f + 1.0f / 256.0f;
+// Candidatos por bloque de trabajo en cull()
+const size_t TEST_BLOCK = 1024;
+
+struct ClipVertex {
+  float x, y, z, w;
+};
+
+ClipVertex toClip(const Mat4 &m, float x, float y, float z) {
+  return {m.at(0, 0) * x + m.at(0, 1) * y + m.at(0, 2) * z + m.at(0, 3),
+          m.at(1, 0) * x + m.at(1, 1) * y + m.at(1, 2) * z + m.at(1, 3),
+          m.at(2, 0) * x + m.at(2, 1) * y + m.at(2, 2) * z + m.at(2, 3),
+          m.at(3, 0) * x + m.at(3, 1) * y + m.at(3, 2) * z + m.at(3, 3)};
+}
+
+// Indica si algun pixel del tile podria estar adentro de la arista
+inline bool tileTouchesEdge(float a, float b, float c, float x, float y) {
+  float best = a * x + b * y + c;
+  best += std::max(a, 0.0f) * (OcclusionCuller::TILE_WIDTH - 1);
+  best += std::max(b, 0.0f) * (OcclusionCuller::TILE_HEIGHT - 1);
+  return best >= 0.0f;
+}
+
+// Rasteriza un tile: `x`, `y` son el centro de su pixel inferior izquierdo
+typedef void (*TileKernel)(const float *edgeA, const float *edgeB,
+                           const float *edgeC, float depthA, float depthB,
+                           float depthC, float x, float y, float *tile);
+
+// Hace las mismas operaciones que rasterizeTileAVX2 en el mismo orden (un
+// fma por columna y despues sumar B en cada fila), asi los dos kernels
+// llenan el mismo buffer bit a bit
+void rasterizeTileScalar(const float *edgeA, const float *edgeB,
+                         const float *edgeC, float depthA, float depthB,
+                         float depthC, float x, float y, float *tile) {
+  for (int lane = 0; lane < OcclusionCuller::TILE_WIDTH; lane++) {
+    float px = x + lane;
+    float e[3];
+    for (int i = 0; i < 3; i++)
+      e[i] = std::fma(edgeA[i], px, std::fma(edgeB[i], y, edgeC[i]));
+    float z = std::fma(depthA, px, std::fma(depthB, y, depthC));
+    for (int row = 0; row < OcclusionCuller::TILE_HEIGHT; row++) {
+      float &stored = tile[row * OcclusionCuller::TILE_WIDTH + lane];
+      if (e[0] >= 0.0f && e[1] >= 0.0f && e[2] >= 0.0f && z < stored)
+        stored = z;
+      for (int i = 0; i < 3; i++)
+        e[i] += edgeB[i];
+      z += depthB;
+    }
+  }
+}
+
+#ifdef OCCLUSION_CULLER_USE_AVX2
+__attribute__((target("avx2,fma"))) void
+rasterizeTileAVX2(const float *edgeA, const float *edgeB, const float *edgeC,
+                  float depthA, float depthB, float depthC, float x, float y,
+                  float *tile) {
+  const __m256 px =
+      _mm256_add_ps(_mm256_set1_ps(x),
+                    _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f,
+                                   7.0f));
+  const __m256 zero = _mm256_setzero_ps();
+  // std::fma explicito: que el compilador contraiga o no B * y + C no
+  // puede cambiar el resultado respecto del kernel escalar
+  __m256 e0 = _mm256_fmadd_ps(_mm256_set1_ps(edgeA[0]), px,
+                              _mm256_set1_ps(std::fma(edgeB[0], y, edgeC[0])));
+  __m256 e1 = _mm256_fmadd_ps(_mm256_set1_ps(edgeA[1]), px,
+                              _mm256_set1_ps(std::fma(edgeB[1], y, edgeC[1])));
+  __m256 e2 = _mm256_fmadd_ps(_mm256_set1_ps(edgeA[2]), px,
+                              _mm256_set1_ps(std::fma(edgeB[2], y, edgeC[2])));
+  __m256 z = _mm256_fmadd_ps(_mm256_set1_ps(depthA), px,
+                             _mm256_set1_ps(std::fma(depthB, y, depthC)));
+  const __m256 stepE0 = _mm256_set1_ps(edgeB[0]);
+  const __m256 stepE1 = _mm256_set1_ps(edgeB[1]);
+  const __m256 stepE2 = _mm256_set1_ps(edgeB[2]);
+  const __m256 stepZ = _mm256_set1_ps(depthB);
+
+  // Una fila del tile por iteracion; de una fila a la otra las aristas y la
+  // profundidad solo suman B
+  for (int row = 0; row < OcclusionCuller::TILE_HEIGHT; row++) {
+    __m256 inside = _mm256_and_ps(
+        _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+                      _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+        _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+    float *line = tile + row * OcclusionCuller::TILE_WIDTH;
+    __m256 stored = _mm256_loadu_ps(line);
+    // min(z, stored) se queda con stored si son iguales, como el escalar
+    _mm256_storeu_ps(line, _mm256_blendv_ps(
+                               stored, _mm256_min_ps(z, stored), inside));
+    e0 = _mm256_add_ps(e0, stepE0);
+    e1 = _mm256_add_ps(e1, stepE1);
+    e2 = _mm256_add_ps(e2, stepE2);
+    z = _mm256_add_ps(z, stepZ);
+  }
+}
+#endif
+
+// Caja proyectada: rectangulo en pixeles y la profundidad mas cercana
+struct ScreenBounds {
+  float minX, minY, maxX, maxY, nearest;
+};
+
+// Proyecta las 8 esquinas de la caja; false si alguna queda detras de la
+// camara. `m` es la view-projection column-major
+typedef bool (*ProjectKernel)(const float *m, const Vec3 &boundsMin,
+                              const Vec3 &boundsMax, float width,
+                              float height, ScreenBounds &bounds);
+
+bool projectBoundsScalar(const float *m, const Vec3 &boundsMin,
+                         const Vec3 &boundsMax, float width, float height,
+                         ScreenBounds &bounds) {
+  bounds = {INFINITY, INFINITY, -INFINITY, -INFINITY, INFINITY};
+  for (int corner = 0; corner < 8; corner++) {
+    float x = corner & 1 ? boundsMax.x : boundsMin.x;
+    float y = corner & 2 ? boundsMax.y : boundsMin.y;
+    float z = corner & 4 ? boundsMax.z : boundsMin.z;
+    float w = m[3] * x + m[7] * y + m[11] * z + m[15];
+    if (w < MIN_W)
+      return false;
+    float inverseW = 1.0f / w;
+    float sx = (m[0] * x + m[4] * y + m[8] * z + m[12]) * inverseW;
+    float sy = (m[1] * x + m[5] * y + m[9] * z + m[13]) * inverseW;
+    float sz = (m[2] * x + m[6] * y + m[10] * z + m[14]) * inverseW;
+    bounds.minX = std::min(bounds.minX, sx);
+    bounds.maxX = std::max(bounds.maxX, sx);
+    bounds.minY = std::min(bounds.minY, sy);
+    bounds.maxY = std::max(bounds.maxY, sy);
+    bounds.nearest = std::min(bounds.nearest, sz);
+  }
+  bounds.minX = (bounds.minX * 0.5f + 0.5f) * width;
+  bounds.maxX = (bounds.maxX * 0.5f + 0.5f) * width;
+  bounds.minY = (bounds.minY * 0.5f + 0.5f) * height;
+  bounds.maxY = (bounds.maxY * 0.5f + 0.5f) * height;
+  bounds.nearest = bounds.nearest * 0.5f + 0.5f;
+  return true;
+}
+
+#ifdef OCCLUSION_CULLER_USE_AVX2
+__attribute__((target("avx2,fma"))) inline float
+horizontalMin(__m256 v) {
+  __m128 half = _mm_min_ps(_mm256_castps256_ps128(v),
+                           _mm256_extractf128_ps(v, 1));
+  half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+  return _mm_cvtss_f32(half);
+}
+
+__attribute__((target("avx2,fma"))) inline float
+horizontalMax(__m256 v) {
+  __m128 half = _mm_max_ps(_mm256_castps256_ps128(v),
+                           _mm256_extractf128_ps(v, 1));
+  half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+  return _mm_cvtss_f32(half);
+}
+
+// Fila r de la matriz por las 8 esquinas
+__attribute__((target("avx2,fma"))) inline __m256
+projectRowAVX2(const float *m, int r, __m256 x, __m256 y, __m256 z) {
+  return _mm256_fmadd_ps(
+      _mm256_set1_ps(m[r]), x,
+      _mm256_fmadd_ps(_mm256_set1_ps(m[4 + r]), y,
+                      _mm256_fmadd_ps(_mm256_set1_ps(m[8 + r]), z,
+                                      _mm256_set1_ps(m[12 + r]))));
+}
+
+// Las 8 esquinas en paralelo, una por lane
+__attribute__((target("avx2,fma"))) bool
+projectBoundsAVX2(const float *m, const Vec3 &boundsMin,
+                  const Vec3 &boundsMax, float width, float height,
+                  ScreenBounds &bounds) {
+  // Esquina i: bit 0 elige x, bit 1 y, bit 2 z, igual que el escalar
+  __m256 x = _mm256_blend_ps(_mm256_set1_ps(boundsMin.x),
+                             _mm256_set1_ps(boundsMax.x), 0xaa);
+  __m256 y = _mm256_blend_ps(_mm256_set1_ps(boundsMin.y),
+                             _mm256_set1_ps(boundsMax.y), 0xcc);
+  __m256 z = _mm256_blend_ps(_mm256_set1_ps(boundsMin.z),
+                             _mm256_set1_ps(boundsMax.z), 0xf0);
+  __m256 w = projectRowAVX2(m, 3, x, y, z);
+  if (_mm256_movemask_ps(
+          _mm256_cmp_ps(w, _mm256_set1_ps(MIN_W), _CMP_LT_OQ)) != 0)
+    return false;
+  __m256 inverseW = _mm256_div_ps(_mm256_set1_ps(1.0f), w);
+  __m256 sx = _mm256_mul_ps(projectRowAVX2(m, 0, x, y, z), inverseW);
+  __m256 sy = _mm256_mul_ps(projectRowAVX2(m, 1, x, y, z), inverseW);
+  __m256 sz = _mm256_mul_ps(projectRowAVX2(m, 2, x, y, z), inverseW);
+  bounds.minX = (horizontalMin(sx) * 0.5f + 0.5f) * width;
+  bounds.maxX = (horizontalMax(sx) * 0.5f + 0.5f) * width;
+  bounds.minY = (horizontalMin(sy) * 0.5f + 0.5f) * height;
+  bounds.maxY = (horizontalMax(sy) * 0.5f + 0.5f) * height;
+  bounds.nearest = horizontalMin(sz) * 0.5f + 0.5f;
+  return true;
+}
+#endif
+
+struct KernelChoice {
+  TileKernel kernel;
+  ProjectKernel project;
+  const char *name;
+};
+
+// Igual que en FrustumCuller: se elige la primera vez que se usa
+const KernelChoice &kernelChoice() {
+  static const KernelChoice choice = [] {
+#ifdef OCCLUSION_CULLER_USE_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return KernelChoice{rasterizeTileAVX2, projectBoundsAVX2, "avx2"};
+#endif
+    return KernelChoice{rasterizeTileScalar, projectBoundsScalar, "scalar"};
+  }();
+  return choice;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(int width, int height) {
+  tilesX = std::max(1, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+  tilesY = std::max(1, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+  this->width = tilesX * TILE_WIDTH;
+  this->height = tilesY * TILE_HEIGHT;
+  depth.assign((size_t)tilesX * tilesY * TILE_PIXELS, 1.0f);
+  tileMaxDepth.assign((size_t)tilesX * tilesY, 1.0f);
+}
+
+const char *OcclusionCuller::implementation() { return kernelChoice().name; }
+
+void OcclusionCuller::beginFrame(const Mat4 &viewProjection) {
+  this->viewProjection = viewProjection;
+  triangles.clear();
+  occluderTriangles = 0;
+}
+
+void OcclusionCuller::addOccluder(const float *vertices, size_t stride,
+                                  const uint32_t *indices,
+                                  size_t indexCount, const Mat4 &model) {
+  Mat4 toScreen = viewProjection * model;
+  for (size_t i = 0; i + 2 < indexCount; i += 3) {
+    occluderTriangles++;
+    float x[3], y[3], z[3];
+    bool behind = false;
+    for (int v = 0; v < 3; v++) {
+      const float *position = vertices + indices[i + v] * stride;
+      ClipVertex clip = toClip(toScreen, position[0], position[1],
+                               position[2]);
+      // Recortar contra el near plane no vale la pena para un oclusor: se
+      // descarta el triangulo entero si algun vertice queda detras del ojo
+      // o entre el ojo y el near plane, y eso solo deja pasar mas objetos
+      if (clip.w < MIN_W || clip.z < -clip.w) {
+        behind = true;
+        break;
+      }
+      float inverseW = 1.0f / clip.w;
+      x[v] = (clip.x * inverseW * 0.5f + 0.5f) * width;
+      y[v] = (clip.y * inverseW * 0.5f + 0.5f) * height;
+      z[v] = clip.z * inverseW * 0.5f + 0.5f;
+    }
+    if (behind)
+      continue;
+
+    // Los oclusores tapan de los dos lados: se ordenan los vertices para
+    // que el area sea positiva
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::fabs(area) < 1e-6f)
+      continue;
+    if (area < 0.0f) {
+      std::swap(x[1], x[2]);
+      std::swap(y[1], y[2]);
+      std::swap(z[1], z[2]);
+      area = -area;
+    }
+
+    float minX = std::min({x[0], x[1], x[2]});
+    float maxX = std::max({x[0], x[1], x[2]});
+    float minY = std::min({y[0], y[1], y[2]});
+    float maxY = std::max({y[0], y[1], y[2]});
+    if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+      continue;
+
+    ScreenTriangle triangle;
+    for (int e = 0; e < 3; e++) {
+      int next = (e + 1) % 3;
+      triangle.edgeA[e] = y[e] - y[next];
+      triangle.edgeB[e] = x[next] - x[e];
+      // Evaluada en el centro del pixel y corrida hacia adentro: solo
+      // cuentan los pixeles que el triangulo cubre enteros. Un oclusor nunca
+      // tapa un pixel que tiene algun hueco; en las aristas compartidas
+      // puede quedar un pixel sin cubrir, que solo deja pasar mas objetos
+      triangle.edgeC[e] =
+          -(triangle.edgeA[e] * x[e] + triangle.edgeB[e] * y[e]) -
+          EDGE_SHRINK * (std::fabs(triangle.edgeA[e]) +
+                         std::fabs(triangle.edgeB[e]));
+    }
+    triangle.depthA =
+        ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) /
+        area;
+    triangle.depthB =
+        ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) /
+        area;
+    // Corrida a la esquina mas lejana del pixel: nunca tapa de mas
+    triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0] +
+                      0.5f * (std::fabs(triangle.depthA) +
+                              std::fabs(triangle.depthB));
+    // Recortada en float: con w cerca de MIN_W la caja no entra en un int
+    triangle.tileX0 = (int)std::max(minX, 0.0f) / TILE_WIDTH;
+    triangle.tileY0 = (int)std::max(minY, 0.0f) / TILE_HEIGHT;
+    triangle.tileX1 = (int)std::min(maxX, (float)(width - 1)) / TILE_WIDTH;
+    triangle.tileY1 = (int)std::min(maxY, (float)(height - 1)) / TILE_HEIGHT;
+    triangles.push_back(triangle);
+  }
+}
+
+void OcclusionCuller::rasterize() {
+  std::fill(depth.begin(), depth.end(), 1.0f);
+  // Cada job toma filas de tiles enteras: nadie escribe el tile de otro
+  if (triangles.empty())
+    std::fill(tileMaxDepth.begin(), tileMaxDepth.end(), 1.0f);
+  else
+    JobSystem::shared().parallelFor(
+        0, (size_t)tilesY, 1,
+        [this](size_t first, size_t last) { rasterizeRows(first, last); });
+}
+
+void OcclusionCuller::rasterizeRows(size_t firstRow, size_t lastRow) {
+  TileKernel kernel = kernelChoice().kernel;
+  for (const ScreenTriangle &triangle : triangles) {
+    int tileY0 = std::max(triangle.tileY0, (int)firstRow);
+    int tileY1 = std::min(triangle.tileY1, (int)lastRow - 1);
+    for (int ty = tileY0; ty <= tileY1; ty++) {
+      float y = ty * TILE_HEIGHT + 0.5f;
+      for (int tx = triangle.tileX0; tx <= triangle.tileX1; tx++) {
+        float x = tx * TILE_WIDTH + 0.5f;
+        if (!tileTouchesEdge(triangle.edgeA[0], triangle.edgeB[0],
+                             triangle.edgeC[0], x, y) ||
+            !tileTouchesEdge(triangle.edgeA[1], triangle.edgeB[1],
+                             triangle.edgeC[1], x, y) ||
+            !tileTouchesEdge(triangle.edgeA[2], triangle.edgeB[2],
+                             triangle.edgeC[2], x, y))
+          continue;
+        kernel(triangle.edgeA, triangle.edgeB, triangle.edgeC,
+               triangle.depthA, triangle.depthB, triangle.depthC, x, y,
+               &depth[((size_t)ty * tilesX + tx) * TILE_PIXELS]);
+      }
+    }
+  }
+
+  // Segundo nivel de la jerarquia
+  for (size_t ty = firstRow; ty < lastRow; ty++)
+    for (int tx = 0; tx < tilesX; tx++) {
+      size_t tile = ty * tilesX + tx;
+      const float *pixels = &depth[tile * TILE_PIXELS];
+      tileMaxDepth[tile] = *std::max_element(pixels, pixels + TILE_PIXELS);
+    }
+}
+
+bool OcclusionCuller::isVisible(const Vec3 &boundsMin,
+                                const Vec3 &boundsMax) const {
+  ScreenBounds bounds;
+  // La caja toca el near plane o esta detras de la camara
+  if (!kernelChoice().project(viewProjection.m, boundsMin, boundsMax,
+                              (float)width, (float)height, bounds) ||
+      bounds.nearest <= 0.0f)
+    return true;
+  if (bounds.maxX < 0.0f || bounds.maxY < 0.0f || bounds.minX >= width ||
+      bounds.minY >= height)
+    return false; // fuera de la pantalla
+
+  // Todos los pixeles que toca la caja proyectada
+  int x0 = (int)std::max(bounds.minX, 0.0f);
+  int y0 = (int)std::max(bounds.minY, 0.0f);
+  int x1 = (int)std::min(bounds.maxX, width - 1.0f);
+  int y1 = (int)std::min(bounds.maxY, height - 1.0f);
+  float nearest = bounds.nearest;
+
+  for (int ty = y0 / TILE_HEIGHT; ty <= y1 / TILE_HEIGHT; ty++)
+    for (int tx = x0 / TILE_WIDTH; tx <= x1 / TILE_WIDTH; tx++) {
+      size_t tile = (size_t)ty * tilesX + tx;
+      // Todo el tile esta mas cerca que el objeto
+      if (tileMaxDepth[tile] < nearest)
+        continue;
+      const float *pixels = &depth[tile * TILE_PIXELS];
+      int rowBegin = std::max(y0 - ty * TILE_HEIGHT, 0);
+      int rowEnd = std::min(y1 - ty * TILE_HEIGHT, TILE_HEIGHT - 1);
+      int laneBegin = std::max(x0 - tx * TILE_WIDTH, 0);
+      int laneEnd = std::min(x1 - tx * TILE_WIDTH, TILE_WIDTH - 1);
+      for (int row = rowBegin; row <= rowEnd; row++)
+        for (int lane = laneBegin; lane <= laneEnd; lane++)
+          if (pixels[row * TILE_WIDTH + lane] >= nearest)
+            return true;
+    }
+  return false;
+}
+
+size_t OcclusionCuller::cull(const FrustumCuller &objects,
+                             const std::vector<uint32_t> &candidates,
+                             std::vector<uint32_t> &visible) {
+  size_t count = candidates.size();
+  size_t blocks = (count + TEST_BLOCK - 1) / TEST_BLOCK;
+  passed.resize(count);
+
+  auto testBlocks = [&](size_t firstBlock, size_t lastBlock) {
+    for (size_t block = firstBlock; block < lastBlock; block++) {
+      size_t first = block * TEST_BLOCK;
+      size_t last = std::min(count, first + TEST_BLOCK);
+      for (size_t i = first; i < last; i++) {
+        uint32_t object = candidates[i];
+        Vec3 center(objects.centerX[object], objects.centerY[object],
+                    objects.centerZ[object]);
+        Vec3 extent(objects.extentX[object], objects.extentY[object],
+                    objects.extentZ[object]);
+        passed[i] = isVisible(center - extent, center + extent) ? 1 : 0;
+      }
+    }
+  };
+  if (blocks <= 1)
+    testBlocks(0, blocks);
+  else
+    JobSystem::shared().parallelFor(0, blocks, 1, testBlocks);
+
+  // Compactado en orden; es solo una copia, no vale repartirlo
+  visible.clear();
+  for (size_t i = 0; i < count; i++)
+    if (passed[i])
+      visible.push_back(candidates[i]);
+  return visible.size();
+}
@@ -0,0 +1,207 @@
+#include "Profiler.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// tid 0 es la linea de tiempo de la GPU; cada hilo de CPU recibe el suyo
+const uint32_t GPU_THREAD = 0;
+
+uint32_t currentThread() {
+  static std::atomic<uint32_t> nextThread{1};
+  thread_local uint32_t thread = nextThread++;
+  return thread;
+}
+
+} // namespace
+
+Profiler::Profiler(size_t framesInFlight, size_t maxTraceEvents)
+    : origin(std::chrono::steady_clock::now()),
+      gpuFrames(framesInFlight > 0 ? framesInFlight : 1),
+      maxTraceEvents(maxTraceEvents) {
+  events.reserve(maxTraceEvents < 65536 ? maxTraceEvents : 65536);
+}
+
+Profiler::~Profiler() {
+  for (GpuFrame &frame : gpuFrames)
+    for (GpuQuery &query : frame.queries) {
+      glDeleteQueries(1, &query.begin);
+      glDeleteQueries(1, &query.end);
+    }
+}
+
+double Profiler::now() const {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - origin)
+      .count();
+}
+
+Profiler::PassStats &Profiler::pass(const char *name) {
+  // Hay pocas pasadas, una busqueda lineal es mas barata que un mapa
+  for (PassStats &stats : passes)
+    if (stats.name == name || std::strcmp(stats.name, name) == 0)
+      return stats;
+  passes.push_back(PassStats{name});
+  return passes.back();
+}
+
+void Profiler::addCpuEvent(const char *name, double startUs, double endUs) {
+  if (!enabled)
+    return;
+  uint32_t thread = currentThread();
+  std::lock_guard<std::mutex> lock(mutex);
+  pass(name).cpuMs += (endUs - startUs) / 1000.0;
+  if (events.size() < maxTraceEvents)
+    events.push_back(TraceEvent{name, thread, startUs, endUs - startUs});
+  else
+    droppedTraceEvents++;
+}
+
+void Profiler::beginFrame() {
+  frameStartUs = now();
+  frameIndex++;
+  currentGpuFrame = nullptr;
+  if (!enabled || !gpuEnabled)
+    return;
+
+  if (!gpuCalibrated) {
+    // Una sola lectura sincronica para alinear el reloj de la GPU con el de
+    // la CPU en la traza
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuOffsetUs = now() - gpuNow / 1000.0;
+    gpuCalibrated = true;
+  }
+
+  GpuFrame &frame = gpuFrames[frameIndex % gpuFrames.size()];
+  if (frame.pending)
+    collectGpuFrame(frame);
+  frame.used = 0;
+  frame.pending = false;
+  currentGpuFrame = &frame;
+}
+
+void Profiler::endFrame() {
+  if (!enabled)
+    return;
+  addCpuEvent("frame", frameStartUs, now());
+  if (currentGpuFrame != nullptr)
+    currentGpuFrame->pending = currentGpuFrame->used > 0;
+  currentGpuFrame = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  framesSinceSummary++;
+}
+
+int Profiler::beginGpu(const char *name) {
+  if (currentGpuFrame == nullptr)
+    return -1;
+  GpuFrame &frame = *currentGpuFrame;
+  if (frame.used == frame.queries.size()) {
+    GpuQuery query{name, 0, 0};
+    glGenQueries(1, &query.begin);
+    glGenQueries(1, &query.end);
+    frame.queries.push_back(query);
+  }
+  GpuQuery &query = frame.queries[frame.used];
+  query.name = name;
+  glQueryCounter(query.begin, GL_TIMESTAMP);
+  return (int)frame.used++;
+}
+
+void Profiler::endGpu(int handle) {
+  if (handle < 0 || currentGpuFrame == nullptr)
+    return;
+  glQueryCounter(currentGpuFrame->queries[handle].end, GL_TIMESTAMP);
+}
+
+void Profiler::collectGpuFrame(GpuFrame &frame) {
+  // Las queries terminan en orden: si la ultima esta lista, todas lo estan
+  GLint available = 0;
+  glGetQueryObjectiv(frame.queries[frame.used - 1].end,
+                     GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) {
+    droppedGpuFrames++;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (size_t i = 0; i < frame.used; i++) {
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(frame.queries[i].begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame.queries[i].end, GL_QUERY_RESULT, &end);
+    double startUs = begin / 1000.0 + gpuOffsetUs;
+    double durationUs = (end - begin) / 1000.0;
+    pass(frame.queries[i].name).gpuMs += durationUs / 1000.0;
+    if (events.size() < maxTraceEvents)
+      events.push_back(
+          TraceEvent{frame.queries[i].name, GPU_THREAD, startUs, durationUs});
+    else
+      droppedTraceEvents++;
+  }
+}
+
+std::string Profiler::summary() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (framesSinceSummary == 0)
+    return "";
+
+  double frames = (double)framesSinceSummary;
+  std::string text;
+  char buffer[128];
+  for (PassStats &stats : passes) {
+    if (!text.empty())
+      text += " | ";
+    if (std::strcmp(stats.name, "frame") == 0 || stats.gpuMs == 0.0)
+      std::snprintf(buffer, sizeof(buffer), "%s %.2f", stats.name,
+                    stats.cpuMs / frames);
+    else
+      std::snprintf(buffer, sizeof(buffer), "%s %.2f/%.2f", stats.name,
+                    stats.cpuMs / frames, stats.gpuMs / frames);
+    text += buffer;
+    stats.cpuMs = 0.0;
+    stats.gpuMs = 0.0;
+  }
+  framesSinceSummary = 0;
+  return text + " ms (cpu/gpu)";
+}
+
+bool Profiler::writeChromeTrace(const char *path) {
+  FILE *file = std::fopen(path, "w");
+  if (file == NULL) {
+    std::cout << "ERROR::PROFILER::CANNOT_OPEN " << path << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::fprintf(file, "{\"traceEvents\":[\n");
+  std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                     "\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+               GPU_THREAD);
+  for (const TraceEvent &event : events)
+    std::fprintf(file,
+                 ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                 "\"ts\":%.3f,\"dur\":%.3f}",
+                 event.name, event.thread, event.startUs, event.durationUs);
+  std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  return std::fclose(file) == 0;
+}
+
+ProfileScope::ProfileScope(Profiler *profiler, const char *name, bool gpu)
+    : profiler(profiler != nullptr && profiler->enabled ? profiler : nullptr),
+      name(name) {
+  if (this->profiler == nullptr)
+    return;
+  if (gpu)
+    gpuHandle = this->profiler->beginGpu(name);
+  startUs = this->profiler->now();
+}
+
+ProfileScope::~ProfileScope() {
+  if (profiler == nullptr)
+    return;
+  profiler->addCpuEvent(name, startUs, profiler->now());
+  profiler->endGpu(gpuHandle);
+}
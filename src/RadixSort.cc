@@ -0,0 +1,44 @@
+#include "RadixSort.h"
+#include <cstring>
+
+void radixSort(std::vector<SortItem> &items, std::vector<SortItem> &scratch) {
+  size_t count = items.size();
+  if (count < 2)
+    return;
+  scratch.resize(count);
+
+  // Un histograma por byte en una sola pasada sobre los datos
+  uint32_t histograms[8][256];
+  std::memset(histograms, 0, sizeof(histograms));
+  for (const SortItem &item : items) {
+    uint64_t key = item.key;
+    for (int pass = 0; pass < 8; pass++)
+      histograms[pass][(key >> (pass * 8)) & 0xff]++;
+  }
+
+  SortItem *source = items.data();
+  SortItem *target = scratch.data();
+  for (int pass = 0; pass < 8; pass++) {
+    uint32_t *histogram = histograms[pass];
+    // Si todas las claves caen en el mismo bucket la pasada no cambia nada
+    if (histogram[(source[0].key >> (pass * 8)) & 0xff] == count)
+      continue;
+
+    uint32_t offset = 0;
+    for (int bucket = 0; bucket < 256; bucket++) {
+      uint32_t size = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += size;
+    }
+    for (size_t i = 0; i < count; i++) {
+      const SortItem &item = source[i];
+      target[histogram[(item.key >> (pass * 8)) & 0xff]++] = item;
+    }
+    SortItem *swap = source;
+    source = target;
+    target = swap;
+  }
+
+  if (source != items.data())
+    items.swap(scratch);
+}
@@ -0,0 +1,125 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <iostream>
+
+uint64_t makeSortKey(const SortKeyFields &fields) {
+  uint64_t depth =
+      (uint64_t)(std::min(std::max(fields.depth, 0.0f), 1.0f) * 0xffffff);
+  uint64_t state = ((uint64_t)(fields.shader & 0x7ff) << 24) |
+                   ((uint64_t)(fields.material & 0xfff) << 12) |
+                   (fields.texture & 0xfff);
+  uint64_t key = (uint64_t)(fields.pass & 0xf) << 60;
+  if (fields.translucent) {
+    // Lo mas lejano primero
+    key |= 1ull << 59;
+    key |= (0xffffff - depth) << 35;
+    key |= state;
+  } else {
+    key |= state << 24;
+    key |= depth;
+  }
+  return key;
+}
+
+size_t RenderQueue::submit(uint64_t key, const DrawPacket &packet) {
+  DrawPacket copy = packet;
+  copy.firstUniform = (uint32_t)uniforms.size();
+  copy.uniformCount = 0;
+  copy.firstRange = (uint32_t)(ranges.size() / 2);
+  copy.rangeCount = 0;
+  packets.push_back(copy);
+  order.push_back({key, (uint32_t)(packets.size() - 1)});
+  return packets.size() - 1;
+}
+
+void RenderQueue::addUniform(size_t packet, const UniformValue &value) {
+  // Los uniforms de un paquete tienen que quedar contiguos
+  if (packet + 1 != packets.size()) {
+    std::cout << "ERROR::RENDER_QUEUE::UNIFORM_FOR_OLD_PACKET" << std::endl;
+    return;
+  }
+  uniforms.push_back(value);
+  packets[packet].uniformCount++;
+}
+
+void RenderQueue::setUniform(size_t packet, int location, float x) {
+  addUniform(packet, {location, 1, {x, 0.0f, 0.0f, 0.0f}, 0});
+}
+
+void RenderQueue::setUniform(size_t packet, int location, float x, float y,
+                             float z, float w) {
+  addUniform(packet, {location, 4, {x, y, z, w}, 0});
+}
+
+void RenderQueue::setUniform(size_t packet, int location, int value) {
+  addUniform(packet, {location, 0, {0.0f, 0.0f, 0.0f, 0.0f}, value});
+}
+
+void RenderQueue::addRange(size_t packet, uint32_t firstIndex,
+                           uint32_t indexCount) {
+  // Igual que los uniforms, los rangos de un paquete quedan contiguos
+  if (packet + 1 != packets.size()) {
+    std::cout << "ERROR::RENDER_QUEUE::RANGE_FOR_OLD_PACKET" << std::endl;
+    return;
+  }
+  ranges.push_back(firstIndex);
+  ranges.push_back(indexCount);
+  packets[packet].rangeCount++;
+}
+
+void RenderQueue::flush(CommandList &list) {
+  packetCount = packets.size();
+  radixSort(order, sortScratch);
+
+  // Estado grabado hasta aca en la lista; al empezar no se sabe nada
+  const uint32_t UNKNOWN = 0xffffffff;
+  uint32_t program = UNKNOWN, flags = UNKNOWN, mesh = UNKNOWN;
+  uint32_t textures[DRAW_PACKET_TEXTURES] = {UNKNOWN, UNKNOWN};
+
+  for (const SortItem &item : order) {
+    const DrawPacket &packet = packets[item.index];
+
+    uint32_t packetFlags = packet.translucent ? PIPELINE_BLEND : 0;
+    if (packet.program != program || packetFlags != flags) {
+      list.setPipeline(packet.program, packetFlags);
+      program = packet.program;
+      flags = packetFlags;
+    }
+    for (int unit = 0; unit < DRAW_PACKET_TEXTURES; unit++) {
+      if (packet.textures[unit] && packet.textures[unit] != textures[unit]) {
+        list.bindTexture((uint8_t)unit, packet.textures[unit]);
+        textures[unit] = packet.textures[unit];
+      }
+    }
+    if (packet.mesh != mesh) {
+      list.bindMesh(packet.mesh);
+      mesh = packet.mesh;
+    }
+
+    for (uint32_t i = 0; i < packet.uniformCount; i++) {
+      const UniformValue &u = uniforms[packet.firstUniform + i];
+      switch (u.components) {
+      case 0:
+        list.setUniform((uint32_t)u.location, u.intValue);
+        break;
+      case 1:
+        list.setUniform((uint32_t)u.location, u.value[0]);
+        break;
+      default:
+        list.setUniform((uint32_t)u.location, u.value[0], u.value[1],
+                        u.value[2], u.value[3]);
+        break;
+      }
+    }
+
+    if (packet.rangeCount > 0)
+      list.multiDrawIndexed(&ranges[2 * packet.firstRange], packet.rangeCount);
+    else
+      list.drawIndexed(packet.indexCount, packet.firstIndex);
+  }
+
+  packets.clear();
+  uniforms.clear();
+  ranges.clear();
+  order.clear();
+}
@@ -0,0 +1,84 @@
+#include "RenderThread.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+RenderThread::RenderThread(GLFWwindow *window) : window(window) {}
+
+RenderThread::~RenderThread() { stop(); }
+
+void RenderThread::start(RenderFunction renderFunction) {
+  if (thread.joinable())
+    return;
+  render = std::move(renderFunction);
+  hasPending = false;
+  stopping = false;
+  thread = std::thread(&RenderThread::loop, this);
+}
+
+void RenderThread::publish(const FrameSnapshot &snapshot) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    snapshotTaken.wait(lock, [&] { return !hasPending || stopping; });
+    pending = snapshot;
+    hasPending = true;
+  }
+  snapshotReady.notify_one();
+}
+
+void RenderThread::stop() {
+  if (!thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  snapshotReady.notify_one();
+  thread.join();
+  // El contexto vuelve a quien llamo a stop(), y con el los jobs de GL
+  JobSystem::shared().setMainThread();
+}
+
+void RenderThread::loop() {
+  glfwMakeContextCurrent(window);
+  // Los jobs de GL (runOnMainThread) corren donde esta el contexto
+  JobSystem::shared().setMainThread();
+
+  FrameSnapshot current;
+  int viewportWidth = -1, viewportHeight = -1;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      snapshotReady.wait(lock, [&] { return hasPending || stopping; });
+      if (!hasPending)
+        break;
+      current = pending;
+      hasPending = false;
+    }
+    // La simulacion ya puede preparar el siguiente frame
+    snapshotTaken.notify_one();
+
+    // El viewport se cambia aca porque el callback de resize corre en el
+    // hilo principal, que ya no tiene el contexto
+    if (current.framebufferWidth != viewportWidth ||
+        current.framebufferHeight != viewportHeight) {
+      viewportWidth = current.framebufferWidth;
+      viewportHeight = current.framebufferHeight;
+      glViewport(0, 0, viewportWidth, viewportHeight);
+    }
+
+    if (profiler != nullptr)
+      profiler->beginFrame();
+    render(current);
+    {
+      ProfileScope scope(profiler, "swap");
+      glfwSwapBuffers(window);
+    }
+    if (profiler != nullptr)
+      profiler->endFrame();
+    framesRendered++;
+  }
+
+  glfwMakeContextCurrent(NULL);
+}
@@ -0,0 +1,430 @@
+#include "SceneCooker.h"
+#include "JsonParser.h"
+#include "MappedFile.h"
+#include "MeshSimplifier.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
+// Niveles de detalle por malla si el JSON no dice otra cosa, y el maximo
+const long long DEFAULT_LODS = 4;
+const long long MAX_LODS = 8;
+
+// Nombre -> indice de cada tabla, para las referencias entre objetos
+typedef std::unordered_map<std::string_view, uint32_t> NameTable;
+
+struct CookState {
+  const JsonDocument &doc;
+  std::vector<char> strings;
+  std::unordered_map<std::string, uint32_t> stringOffsets;
+
+  explicit CookState(const JsonDocument &doc) : doc(doc) {}
+
+  uint32_t addString(std::string_view text) {
+    std::string key(text);
+    auto found = stringOffsets.find(key);
+    if (found != stringOffsets.end())
+      return found->second;
+    uint32_t offset = (uint32_t)strings.size();
+    strings.insert(strings.end(), text.begin(), text.end());
+    strings.push_back('\0');
+    stringOffsets.emplace(std::move(key), offset);
+    return offset;
+  }
+
+  uint32_t stringField(int object, const char *key) {
+    int token = doc.find(object, key);
+    if (token < 0)
+      return SCENE_NONE;
+    return addString(doc.asString(token));
+  }
+};
+
+// Referencia por nombre ("wood") o por indice (0). SCENE_NONE si no existe
+uint32_t resolve(const JsonDocument &doc, int token, const NameTable &names,
+                 size_t count) {
+  if (token < 0)
+    return SCENE_NONE;
+  if (doc.tokens[token].type == JsonType::String) {
+    auto found = names.find(doc.asString(token));
+    return found != names.end() ? found->second : SCENE_NONE;
+  }
+  long long index = doc.asInt(token, -1);
+  return index >= 0 && index < (long long)count ? (uint32_t)index : SCENE_NONE;
+}
+
+void addName(const JsonDocument &doc, int object, NameTable &names,
+             uint32_t index) {
+  int name = doc.find(object, "name");
+  if (name >= 0)
+    names.emplace(doc.asString(name), index);
+}
+
+uint32_t wrapMode(std::string_view name) {
+  if (name == "mirrored_repeat")
+    return GL_MIRRORED_REPEAT;
+  if (name == "clamp_to_edge")
+    return GL_CLAMP_TO_EDGE;
+  if (name == "clamp_to_border")
+    return GL_CLAMP_TO_BORDER;
+  return GL_REPEAT;
+}
+
+uint32_t filterMode(std::string_view name, uint32_t fallback) {
+  if (name == "nearest")
+    return GL_NEAREST;
+  if (name == "linear")
+    return GL_LINEAR;
+  if (name == "nearest_mipmap_nearest")
+    return GL_NEAREST_MIPMAP_NEAREST;
+  if (name == "linear_mipmap_nearest")
+    return GL_LINEAR_MIPMAP_NEAREST;
+  if (name == "nearest_mipmap_linear")
+    return GL_NEAREST_MIPMAP_LINEAR;
+  if (name == "linear_mipmap_linear")
+    return GL_LINEAR_MIPMAP_LINEAR;
+  return fallback;
+}
+
+// T * Rz * S como 3 filas de una matriz 3x4
+void composeTransform(const JsonDocument &doc, int object, float *rows) {
+  int matrix = doc.find(object, "transform");
+  if (matrix >= 0) {
+    for (uint32_t i = 0; i < 12; i++)
+      rows[i] = (float)doc.asNumber(doc.element(matrix, i),
+                                    i % 5 == 0 ? 1.0 : 0.0);
+    return;
+  }
+
+  int position = doc.find(object, "position");
+  int scaleToken = doc.find(object, "scale");
+  float translation[3], scale[3];
+  for (uint32_t i = 0; i < 3; i++) {
+    translation[i] = (float)doc.asNumber(doc.element(position, i), 0.0);
+    // "scale": 2 escala igual en los tres ejes
+    scale[i] = (float)(scaleToken >= 0 &&
+                               doc.tokens[scaleToken].type == JsonType::Array
+                           ? doc.asNumber(doc.element(scaleToken, i), 1.0)
+                           : doc.asNumber(scaleToken, 1.0));
+  }
+  double radians =
+      doc.numberField(object, "rotation", 0.0) * DEGREES_TO_RADIANS;
+  float c = (float)std::cos(radians), s = (float)std::sin(radians);
+
+  const float result[12] = {
+      c * scale[0], -s * scale[1], 0.0f,     translation[0],
+      s * scale[0], c * scale[1],  0.0f,     translation[1],
+      0.0f,         0.0f,          scale[2], translation[2]};
+  std::memcpy(rows, result, sizeof(result));
+}
+
+// Un vector de 3 del JSON; `fallback` para lo que falte
+void vectorField(const JsonDocument &doc, int object, const char *key,
+                 float fallback, float *result) {
+  int array = doc.find(object, key);
+  for (uint32_t i = 0; i < 3; i++)
+    result[i] = (float)doc.asNumber(doc.element(array, i), fallback);
+}
+
+size_t alignUp(size_t value) {
+  return (value + SCENE_ALIGNMENT - 1) / SCENE_ALIGNMENT * SCENE_ALIGNMENT;
+}
+
+} // namespace
+
+bool cookScene(const char *json, size_t length, std::vector<uint8_t> &image) {
+  int tokenCount = jsonTokenize(json, length, nullptr, 0);
+  if (tokenCount <= 0) {
+    std::cout << "ERROR::SCENE_COOK::INVALID_JSON" << std::endl;
+    return false;
+  }
+  std::vector<JsonToken> tokens(tokenCount);
+  if (jsonTokenize(json, length, tokens.data(), tokenCount) != tokenCount) {
+    std::cout << "ERROR::SCENE_COOK::INVALID_JSON" << std::endl;
+    return false;
+  }
+  JsonDocument doc{json, tokens.data(), tokenCount};
+  CookState state(doc);
+
+  std::vector<SceneTexture> textures;
+  NameTable textureNames;
+  int textureArray = doc.find(0, "textures");
+  for (int t = doc.firstChild(textureArray); t >= 0; t = doc.nextSibling(t)) {
+    SceneTexture texture;
+    texture.path = state.stringField(t, "path");
+    texture.flipY = doc.asBool(doc.find(t, "flipY"), true) ? 1 : 0;
+    int wrap = doc.find(t, "wrap");
+    texture.wrapS = wrapMode(doc.asString(doc.element(wrap, 0)));
+    texture.wrapT = wrapMode(doc.asString(doc.element(wrap, 1)));
+    int filter = doc.find(t, "filter");
+    texture.minFilter = filterMode(doc.asString(doc.element(filter, 0)),
+                                   GL_LINEAR_MIPMAP_LINEAR);
+    texture.magFilter =
+        filterMode(doc.asString(doc.element(filter, 1)), GL_LINEAR);
+    if (texture.path == SCENE_NONE) {
+      std::cout << "ERROR::SCENE_COOK::TEXTURE_WITHOUT_PATH "
+                << textures.size() << std::endl;
+      return false;
+    }
+    addName(doc, t, textureNames, (uint32_t)textures.size());
+    textures.push_back(texture);
+  }
+
+  std::vector<SceneMaterial> materials;
+  NameTable materialNames;
+  int materialArray = doc.find(0, "materials");
+  for (int m = doc.firstChild(materialArray); m >= 0; m = doc.nextSibling(m)) {
+    SceneMaterial material;
+    material.name = state.stringField(m, "name");
+    material.vertexShader = state.stringField(m, "vertexShader");
+    material.fragmentShader = state.stringField(m, "fragmentShader");
+    int list = doc.find(m, "textures");
+    for (uint32_t i = 0; i < SCENE_MATERIAL_TEXTURES; i++) {
+      int reference = doc.element(list, i);
+      material.textures[i] =
+          resolve(doc, reference, textureNames, textures.size());
+      if (reference >= 0 && material.textures[i] == SCENE_NONE) {
+        std::cout << "ERROR::SCENE_COOK::UNKNOWN_TEXTURE in material "
+                  << materials.size() << std::endl;
+        return false;
+      }
+    }
+    material.translucent = doc.asBool(doc.find(m, "translucent")) ? 1 : 0;
+    if (material.vertexShader == SCENE_NONE ||
+        material.fragmentShader == SCENE_NONE) {
+      std::cout << "ERROR::SCENE_COOK::MATERIAL_WITHOUT_SHADERS "
+                << materials.size() << std::endl;
+      return false;
+    }
+    addName(doc, m, materialNames, (uint32_t)materials.size());
+    materials.push_back(material);
+  }
+
+  // Todas las mallas comparten un solo buffer de vertices y uno de indices
+  std::vector<float> vertices;
+  std::vector<uint32_t> indices;
+  std::vector<SceneMesh> meshes;
+  std::vector<SceneLod> lods;
+  NameTable meshNames;
+  int meshArray = doc.find(0, "meshes");
+  for (int m = doc.firstChild(meshArray); m >= 0; m = doc.nextSibling(m)) {
+    SceneMesh mesh = {};
+    mesh.name = state.stringField(m, "name");
+    int vertexArray = doc.find(m, "vertices");
+    int indexArray = doc.find(m, "indices");
+    uint32_t floatCount =
+        vertexArray >= 0 ? doc.tokens[vertexArray].size : 0;
+    if (floatCount == 0 || floatCount % SCENE_VERTEX_FLOATS != 0) {
+      std::cout << "ERROR::SCENE_COOK::BAD_VERTICES in mesh " << meshes.size()
+                << " (expected " << SCENE_VERTEX_FLOATS
+                << " floats per vertex)" << std::endl;
+      return false;
+    }
+    mesh.firstVertex = (uint32_t)(vertices.size() / SCENE_VERTEX_FLOATS);
+    mesh.vertexCount = floatCount / SCENE_VERTEX_FLOATS;
+    for (int v = doc.firstChild(vertexArray); v >= 0; v = doc.nextSibling(v))
+      vertices.push_back((float)doc.asNumber(v));
+
+    for (int axis = 0; axis < 3; axis++) {
+      mesh.boundsMin[axis] = INFINITY;
+      mesh.boundsMax[axis] = -INFINITY;
+    }
+    for (uint32_t v = 0; v < mesh.vertexCount; v++) {
+      const float *position =
+          &vertices[(mesh.firstVertex + v) * SCENE_VERTEX_FLOATS];
+      for (int axis = 0; axis < 3; axis++) {
+        mesh.boundsMin[axis] = std::fmin(mesh.boundsMin[axis], position[axis]);
+        mesh.boundsMax[axis] = std::fmax(mesh.boundsMax[axis], position[axis]);
+      }
+    }
+
+    mesh.firstIndex = (uint32_t)indices.size();
+    for (int i = doc.firstChild(indexArray); i >= 0; i = doc.nextSibling(i)) {
+      long long index = doc.asInt(i, -1);
+      if (index < 0 || index >= (long long)mesh.vertexCount) {
+        std::cout << "ERROR::SCENE_COOK::INDEX_OUT_OF_RANGE in mesh "
+                  << meshes.size() << std::endl;
+        return false;
+      }
+      // Rebasado al buffer compartido: el draw no necesita base vertex
+      indices.push_back(mesh.firstVertex + (uint32_t)index);
+    }
+    mesh.indexCount = (uint32_t)indices.size() - mesh.firstIndex;
+
+    // La primera LOD es la malla completa; las demas salen de simplificarla
+    // y van en la seccion de indices detras de ella
+    mesh.firstLod = (uint32_t)lods.size();
+    lods.push_back({mesh.firstIndex, mesh.indexCount, 0.0f, 0});
+    long long levels = std::min(doc.asInt(doc.find(m, "lods"), DEFAULT_LODS),
+                                MAX_LODS);
+    if (levels > 1 && mesh.indexCount >= 3) {
+      std::vector<unsigned int> local(mesh.indexCount / 3 * 3);
+      for (size_t i = 0; i < local.size(); i++)
+        local[i] = indices[mesh.firstIndex + i] - mesh.firstVertex;
+      LodChain chain = generateLodChain(
+          local.data(), local.size(),
+          &vertices[(size_t)mesh.firstVertex * SCENE_VERTEX_FLOATS],
+          mesh.vertexCount, SimplifyOptions(), (size_t)levels);
+      for (size_t l = 1; l < chain.levels.size(); l++) {
+        const LodLevel &level = chain.levels[l];
+        lods.push_back({(uint32_t)indices.size(), (uint32_t)level.indexCount,
+                        level.error, 0});
+        for (size_t i = 0; i < level.indexCount; i++)
+          indices.push_back(mesh.firstVertex +
+                            chain.indices[level.indexOffset + i]);
+      }
+    }
+    mesh.lodCount = (uint32_t)lods.size() - mesh.firstLod;
+    if (doc.asBool(doc.find(m, "occluder")))
+      mesh.flags |= SCENE_MESH_OCCLUDER;
+    addName(doc, m, meshNames, (uint32_t)meshes.size());
+    meshes.push_back(mesh);
+  }
+
+  std::vector<SceneInstance> instances;
+  int instanceArray = doc.find(0, "instances");
+  if (instanceArray >= 0)
+    instances.reserve(doc.tokens[instanceArray].size);
+  for (int i = doc.firstChild(instanceArray); i >= 0; i = doc.nextSibling(i)) {
+    SceneInstance instance;
+    instance.mesh = resolve(doc, doc.find(i, "mesh"), meshNames, meshes.size());
+    instance.material = resolve(doc, doc.find(i, "material"), materialNames,
+                                materials.size());
+    if (instance.mesh == SCENE_NONE || instance.material == SCENE_NONE) {
+      std::cout << "ERROR::SCENE_COOK::BAD_INSTANCE " << instances.size()
+                << " (unknown mesh or material)" << std::endl;
+      return false;
+    }
+    composeTransform(doc, i, instance.transform);
+    instances.push_back(instance);
+  }
+
+  // Sin camara las instancias ya estan en clip space; las luces necesitan
+  // una porque se asignan a clusters del frustum de la camara
+  std::vector<SceneCamera> cameras;
+  int cameraObject = doc.find(0, "camera");
+  if (cameraObject >= 0) {
+    SceneCamera camera;
+    vectorField(doc, cameraObject, "position", 0.0f, camera.position);
+    vectorField(doc, cameraObject, "target", 0.0f, camera.target);
+    int up = doc.find(cameraObject, "up");
+    for (uint32_t i = 0; i < 3; i++)
+      camera.up[i] = (float)doc.asNumber(doc.element(up, i), i == 1);
+    camera.fovY = (float)(doc.numberField(cameraObject, "fovY", 60.0) *
+                          DEGREES_TO_RADIANS);
+    camera.zNear = (float)doc.numberField(cameraObject, "near", 0.1);
+    camera.zFar = (float)doc.numberField(cameraObject, "far", 100.0);
+    if (!(camera.fovY > 0.0f && camera.fovY < 3.14f) ||
+        !(camera.zNear > 0.0f && camera.zFar > camera.zNear)) {
+      std::cout << "ERROR::SCENE_COOK::BAD_CAMERA (fovY in (0, 180), "
+                   "0 < near < far)"
+                << std::endl;
+      return false;
+    }
+    cameras.push_back(camera);
+  }
+
+  std::vector<SceneLight> lights;
+  int lightArray = doc.find(0, "lights");
+  for (int l = doc.firstChild(lightArray); l >= 0; l = doc.nextSibling(l)) {
+    SceneLight light;
+    vectorField(doc, l, "position", 0.0f, light.position);
+    light.range = (float)doc.numberField(l, "range", 10.0);
+    float intensity = (float)doc.numberField(l, "intensity", 1.0);
+    vectorField(doc, l, "color", 1.0f, light.color);
+    for (int c = 0; c < 3; c++)
+      light.color[c] *= intensity;
+    vectorField(doc, l, "direction", 0.0f, light.direction);
+    // "spot": [interior, exterior] en grados; sin el es una luz puntual
+    int spot = doc.find(l, "spot");
+    light.spotInner =
+        spot >= 0 ? (float)std::cos(doc.asNumber(doc.element(spot, 0)) *
+                                    DEGREES_TO_RADIANS)
+                  : 0.0f;
+    light.spotOuter =
+        spot >= 0 ? (float)std::cos(doc.asNumber(doc.element(spot, 1)) *
+                                    DEGREES_TO_RADIANS)
+                  : -2.0f;
+    if (!(light.range > 0.0f)) {
+      std::cout << "ERROR::SCENE_COOK::BAD_LIGHT " << lights.size()
+                << " (range must be positive)" << std::endl;
+      return false;
+    }
+    lights.push_back(light);
+  }
+  if (!lights.empty() && cameras.empty()) {
+    std::cout << "ERROR::SCENE_COOK::LIGHTS_WITHOUT_CAMERA" << std::endl;
+    return false;
+  }
+
+  // --- Imagen: header y secciones alineadas ---
+  SceneHeader header = {};
+  std::memcpy(header.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC));
+  header.version = SCENE_VERSION;
+  header.sectionCount = SCENE_SECTION_COUNT;
+  header.vertexFloats = SCENE_VERTEX_FLOATS;
+
+  const void *sources[SCENE_SECTION_COUNT] = {
+      state.strings.data(), vertices.data(),  indices.data(),
+      textures.data(),      materials.data(), meshes.data(),
+      instances.data(),     lods.data(),      cameras.data(),
+      lights.data()};
+  const size_t counts[SCENE_SECTION_COUNT] = {
+      state.strings.size(), vertices.size() / SCENE_VERTEX_FLOATS,
+      indices.size(),       textures.size(),
+      materials.size(),     meshes.size(),
+      instances.size(),     lods.size(),
+      cameras.size(),       lights.size()};
+  const uint32_t elementSizes[SCENE_SECTION_COUNT] = {
+      1,
+      SCENE_VERTEX_FLOATS * sizeof(float),
+      sizeof(uint32_t),
+      sizeof(SceneTexture),
+      sizeof(SceneMaterial),
+      sizeof(SceneMesh),
+      sizeof(SceneInstance),
+      sizeof(SceneLod),
+      sizeof(SceneCamera),
+      sizeof(SceneLight)};
+
+  size_t offset = alignUp(sizeof(SceneHeader));
+  for (uint32_t s = 0; s < SCENE_SECTION_COUNT; s++) {
+    header.sections[s].offset = offset;
+    header.sections[s].count = counts[s];
+    header.sections[s].elementSize = elementSizes[s];
+    offset = alignUp(offset + counts[s] * elementSizes[s]);
+  }
+  header.fileSize = offset;
+
+  image.assign(offset, 0);
+  std::memcpy(image.data(), &header, sizeof(header));
+  for (uint32_t s = 0; s < SCENE_SECTION_COUNT; s++) {
+    if (counts[s] > 0)
+      std::memcpy(image.data() + header.sections[s].offset, sources[s],
+                  counts[s] * elementSizes[s]);
+  }
+  return true;
+}
+
+std::unique_ptr<SceneImage> loadScene(const std::string &path) {
+  if (path.size() > 5 && path.compare(path.size() - 5, 5, ".json") == 0) {
+    MappedFile source(path.c_str());
+    std::vector<uint8_t> image;
+    if (!source.isValid() ||
+        !cookScene(reinterpret_cast<const char *>(source.data()),
+                   source.size(), image)) {
+      std::cout << "ERROR::SCENE_COOK::FAILED " << path << std::endl;
+      return nullptr;
+    }
+    return std::make_unique<SceneImage>(std::move(image));
+  }
+  return std::make_unique<SceneImage>(path.c_str());
+}
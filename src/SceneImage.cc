@@ -0,0 +1,168 @@
+#include "SceneImage.h"
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+SceneImage::SceneImage(const char *path) {
+  if (!file.open(path))
+    return;
+  bytes = file.data();
+  length = file.size();
+  isValid = bind(path);
+}
+
+SceneImage::SceneImage(std::vector<uint8_t> image) : owned(std::move(image)) {
+  bytes = owned.data();
+  length = owned.size();
+  isValid = bind("(memory)");
+}
+
+const char *SceneImage::string(uint32_t offset) const {
+  if (offset == SCENE_NONE || offset >= stringBytes)
+    return "";
+  return strings + offset;
+}
+
+bool SceneImage::bind(const char *what) {
+  if (length < sizeof(SceneHeader)) {
+    std::cout << "ERROR::SCENE::TRUNCATED " << what << std::endl;
+    return false;
+  }
+  const SceneHeader *header = reinterpret_cast<const SceneHeader *>(bytes);
+  if (std::memcmp(header->magic, SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0 ||
+      header->version != SCENE_VERSION ||
+      header->sectionCount != SCENE_SECTION_COUNT ||
+      header->vertexFloats != SCENE_VERTEX_FLOATS) {
+    std::cout << "ERROR::SCENE::BAD_HEADER " << what
+              << " (recook with scene-cook)" << std::endl;
+    return false;
+  }
+  if (header->fileSize != length) {
+    std::cout << "ERROR::SCENE::TRUNCATED " << what << std::endl;
+    return false;
+  }
+
+  // Un chequeo de rango y un puntero por seccion; la imagen se usa en el
+  // lugar. Despues se validan las referencias entre secciones (ver abajo)
+  const uint32_t elementSizes[SCENE_SECTION_COUNT] = {
+      1,
+      SCENE_VERTEX_FLOATS * sizeof(float),
+      sizeof(uint32_t),
+      sizeof(SceneTexture),
+      sizeof(SceneMaterial),
+      sizeof(SceneMesh),
+      sizeof(SceneInstance),
+      sizeof(SceneLod),
+      sizeof(SceneCamera),
+      sizeof(SceneLight)};
+  const uint8_t *sections[SCENE_SECTION_COUNT];
+  for (uint32_t i = 0; i < SCENE_SECTION_COUNT; i++) {
+    const SceneSection &section = header->sections[i];
+    if (section.elementSize != elementSizes[i] ||
+        section.offset % SCENE_ALIGNMENT != 0 || section.offset > length ||
+        section.count > (length - section.offset) / section.elementSize) {
+      std::cout << "ERROR::SCENE::BAD_SECTION " << i << " in " << what
+                << std::endl;
+      return false;
+    }
+    sections[i] = bytes + section.offset;
+  }
+
+  stringBytes = header->sections[SCENE_STRINGS].count;
+  // string() devuelve punteros a la seccion, el ultimo tiene que terminar
+  if (stringBytes > 0 && sections[SCENE_STRINGS][stringBytes - 1] != '\0') {
+    std::cout << "ERROR::SCENE::BAD_SECTION strings in " << what << std::endl;
+    return false;
+  }
+
+  strings = reinterpret_cast<const char *>(sections[SCENE_STRINGS]);
+  vertices = reinterpret_cast<const float *>(sections[SCENE_VERTICES]);
+  indices = reinterpret_cast<const uint32_t *>(sections[SCENE_INDICES]);
+  textures = reinterpret_cast<const SceneTexture *>(sections[SCENE_TEXTURES]);
+  materials =
+      reinterpret_cast<const SceneMaterial *>(sections[SCENE_MATERIALS]);
+  meshes = reinterpret_cast<const SceneMesh *>(sections[SCENE_MESHES]);
+  instances =
+      reinterpret_cast<const SceneInstance *>(sections[SCENE_INSTANCES]);
+  lods = reinterpret_cast<const SceneLod *>(sections[SCENE_LODS]);
+  vertexCount = header->sections[SCENE_VERTICES].count;
+  indexCount = header->sections[SCENE_INDICES].count;
+  textureCount = header->sections[SCENE_TEXTURES].count;
+  materialCount = header->sections[SCENE_MATERIALS].count;
+  meshCount = header->sections[SCENE_MESHES].count;
+  instanceCount = header->sections[SCENE_INSTANCES].count;
+  lodCount = header->sections[SCENE_LODS].count;
+  lights = reinterpret_cast<const SceneLight *>(sections[SCENE_LIGHTS]);
+  lightCount = header->sections[SCENE_LIGHTS].count;
+  if (header->sections[SCENE_CAMERAS].count > 1) {
+    std::cout << "ERROR::SCENE::BAD_SECTION cameras in " << what << std::endl;
+    return false;
+  }
+  if (header->sections[SCENE_CAMERAS].count == 1)
+    camera = reinterpret_cast<const SceneCamera *>(sections[SCENE_CAMERAS]);
+  return validReferences(what);
+}
+
+bool SceneImage::validReferences(const char *what) const {
+  /* Los rangos de las mallas y los indices van directo a glDrawElements y al
+   * rasterizador de oclusores: una imagen corrupta no puede leer fuera de
+   * los buffers. Es el unico recorrido de la carga, lineal en los indices */
+  auto validRange = [&](uint32_t first, uint32_t count, uint32_t firstVertex,
+                        uint32_t lastVertex) {
+    if (first > indexCount || count > indexCount - first)
+      return false;
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t index = indices[first + i];
+      if (index < firstVertex || index >= lastVertex)
+        return false;
+    }
+    return true;
+  };
+  for (size_t m = 0; m < meshCount; m++) {
+    const SceneMesh &mesh = meshes[m];
+    if (mesh.firstVertex > vertexCount ||
+        mesh.vertexCount > vertexCount - mesh.firstVertex ||
+        mesh.lodCount == 0 || mesh.firstLod > lodCount ||
+        mesh.lodCount > lodCount - mesh.firstLod) {
+      std::cout << "ERROR::SCENE::BAD_MESH_RANGE " << m << " in " << what
+                << std::endl;
+      return false;
+    }
+    uint32_t lastVertex = mesh.firstVertex + mesh.vertexCount;
+    bool valid =
+        validRange(mesh.firstIndex, mesh.indexCount, mesh.firstVertex,
+                   lastVertex);
+    for (uint32_t l = 0; l < mesh.lodCount && valid; l++) {
+      const SceneLod &lod = lods[mesh.firstLod + l];
+      if (lod.firstIndex == mesh.firstIndex &&
+          lod.indexCount == mesh.indexCount)
+        continue;
+      valid = validRange(lod.firstIndex, lod.indexCount, mesh.firstVertex,
+                         lastVertex);
+    }
+    if (!valid) {
+      std::cout << "ERROR::SCENE::INDEX_OUT_OF_RANGE in mesh " << m << " in "
+                << what << std::endl;
+      return false;
+    }
+  }
+  for (size_t m = 0; m < materialCount; m++) {
+    for (int t = 0; t < SCENE_MATERIAL_TEXTURES; t++) {
+      uint32_t texture = materials[m].textures[t];
+      if (texture != SCENE_NONE && texture >= textureCount) {
+        std::cout << "ERROR::SCENE::BAD_MATERIAL " << m << " in " << what
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+  for (size_t i = 0; i < instanceCount; i++) {
+    if (instances[i].mesh >= meshCount ||
+        instances[i].material >= materialCount) {
+      std::cout << "ERROR::SCENE::BAD_INSTANCE " << i << " in " << what
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,237 @@
+#include "SceneRecorder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Menos instancias por particion no pagan el job
+const size_t MIN_PARTITION_INSTANCES = 256;
+
+// Particiones opacas, una por hilo como mucho, mas la translucida
+size_t partitionCount(const SceneImage &scene, JobSystem &jobs) {
+  size_t byWork = (scene.instanceCount + MIN_PARTITION_INSTANCES - 1) /
+                  MIN_PARTITION_INSTANCES;
+  return std::max<size_t>(1, std::min(byWork, jobs.workerCount() + 1)) + 1;
+}
+
+// Pixeles que cubre una unidad de la malla donde queda mas cerca de la
+// camara. Cota por arriba: la derivada de x / w sin el termino de w, con el
+// menor w de las esquinas de la caja. Infinito si la caja cruza el plano
+// w = 0
+float pixelsPerUnit(const Mat4 &transform, const SceneMesh &mesh,
+                    const SceneFrame &frame) {
+  float minW = INFINITY;
+  for (int corner = 0; corner < 8; corner++) {
+    float x = corner & 1 ? mesh.boundsMax[0] : mesh.boundsMin[0];
+    float y = corner & 2 ? mesh.boundsMax[1] : mesh.boundsMin[1];
+    float z = corner & 4 ? mesh.boundsMax[2] : mesh.boundsMin[2];
+    float w = transform.at(3, 0) * x + transform.at(3, 1) * y +
+              transform.at(3, 2) * z + transform.at(3, 3);
+    minW = std::min(minW, w);
+  }
+  if (!(minW > 1e-6f))
+    return INFINITY;
+  auto rowLength = [&](int row) {
+    return std::sqrt(transform.at(row, 0) * transform.at(row, 0) +
+                     transform.at(row, 1) * transform.at(row, 1) +
+                     transform.at(row, 2) * transform.at(row, 2));
+  };
+  return std::max(rowLength(0) * frame.viewportWidth,
+                  rowLength(1) * frame.viewportHeight) *
+         0.5f / minW;
+}
+
+// Profundidad del centro de la caja en [0, 1] (0 cerca), la que ordena la
+// RenderQueue. Un centro detras de la camara cuenta como el mas cercano
+float viewDepth(const Mat4 &transform, const SceneMesh &mesh) {
+  float center[3];
+  for (int axis = 0; axis < 3; axis++)
+    center[axis] = (mesh.boundsMin[axis] + mesh.boundsMax[axis]) * 0.5f;
+  auto clip = [&](int row) {
+    return transform.at(row, 0) * center[0] +
+           transform.at(row, 1) * center[1] +
+           transform.at(row, 2) * center[2] + transform.at(row, 3);
+  };
+  float w = clip(3);
+  if (!(w > 1e-6f))
+    return 0.0f;
+  return clip(2) / w * 0.5f + 0.5f;
+}
+
+} // namespace
+
+SceneRecorder::SceneRecorder(const SceneImage &scene, JobSystem &jobs)
+    : textures(scene.textureCount, 0), materials(scene.materialCount),
+      scene(scene), recorder(partitionCount(scene, jobs), jobs),
+      partitions(recorder.lists().size()) {
+  buildMeshlets(jobs);
+  lodSelector.reserve(scene.instanceCount);
+}
+
+void SceneRecorder::buildMeshlets(JobSystem &jobs) {
+  // Los indices que sobran de un triangulo incompleto quedan como estaban
+  elementIndices.assign(scene.indices, scene.indices + scene.indexCount);
+  meshlets.resize(scene.lodCount);
+  lodLevels.resize(scene.lodCount);
+  for (size_t m = 0; m < scene.meshCount; m++) {
+    const SceneMesh &mesh = scene.meshes[m];
+    for (uint32_t l = 0; l < mesh.lodCount; l++) {
+      const SceneLod &lod = scene.lods[mesh.firstLod + l];
+      lodLevels[mesh.firstLod + l] = {lod.firstIndex, lod.indexCount,
+                                      lod.error};
+    }
+  }
+  jobs.parallelFor(0, scene.meshCount, 1, [&](size_t first, size_t last) {
+    std::vector<uint32_t> local;
+    for (size_t m = first; m < last; m++) {
+      // Los meshlets se arman sobre los vertices de la malla, sin el rebase
+      const SceneMesh &mesh = scene.meshes[m];
+      for (uint32_t l = mesh.firstLod; l < mesh.firstLod + mesh.lodCount;
+           l++) {
+        const SceneLod &lod = scene.lods[l];
+        local.resize(lod.indexCount);
+        for (uint32_t i = 0; i < lod.indexCount; i++)
+          local[i] = scene.indices[lod.firstIndex + i] - mesh.firstVertex;
+        meshlets[l] = std::make_unique<MeshletMesh>(
+            local.data(), local.size(),
+            scene.vertices + (size_t)mesh.firstVertex * SCENE_VERTEX_FLOATS,
+            mesh.vertexCount, SCENE_VERTEX_FLOATS);
+        const std::vector<unsigned int> &clustered = meshlets[l]->indices;
+        for (size_t i = 0; i < clustered.size(); i++)
+          elementIndices[lod.firstIndex + i] =
+              clustered[i] + mesh.firstVertex;
+      }
+    }
+  });
+}
+
+size_t SceneRecorder::meshletCount() const {
+  size_t count = 0;
+  for (const std::unique_ptr<MeshletMesh> &mesh : meshlets)
+    count += mesh->meshlets.size();
+  return count;
+}
+
+void SceneRecorder::record(const std::vector<uint32_t> &visible,
+                           const SceneFrame &frame) {
+  opaque.clear();
+  translucent.clear();
+  for (uint32_t i : visible) {
+    const SceneInstance &instance = scene.instances[i];
+    if (materials[instance.material].program == 0)
+      continue;
+    if (scene.materials[instance.material].translucent)
+      translucent.push_back(i);
+    else
+      opaque.push_back(i);
+  }
+
+  size_t opaquePartitions = partitions.size() - 1;
+  recorder.record([&](size_t index, CommandList &list) {
+    if (index == 0)
+      recordCamera(list, frame);
+    Partition &partition = partitions[index];
+    partition.clusters = 0;
+    partition.reduced = 0;
+    if (index == opaquePartitions) {
+      for (uint32_t i : translucent)
+        submit(partition, i, frame);
+    } else {
+      size_t first = opaque.size() * index / opaquePartitions;
+      size_t last = opaque.size() * (index + 1) / opaquePartitions;
+      for (size_t i = first; i < last; i++)
+        submit(partition, opaque[i], frame);
+    }
+    partition.queue.flush(list);
+  });
+
+  drawCount = 0;
+  clusterCount = 0;
+  reducedCount = 0;
+  for (const Partition &partition : partitions) {
+    drawCount += partition.queue.packetCount;
+    clusterCount += partition.clusters;
+    reducedCount += partition.reduced;
+  }
+}
+
+void SceneRecorder::recordCamera(CommandList &list, const SceneFrame &frame) {
+  // Un programa puede estar en varios materiales: una vez cada uno
+  cameraPrograms.clear();
+  for (const SceneMaterialBinding &binding : materials) {
+    if (binding.program == 0 || (binding.view < 0 && binding.projection < 0) ||
+        std::find(cameraPrograms.begin(), cameraPrograms.end(),
+                  binding.program) != cameraPrograms.end())
+      continue;
+    cameraPrograms.push_back(binding.program);
+    list.setPipeline(binding.program);
+    if (binding.view >= 0)
+      list.setUniformMat4((uint32_t)binding.view, frame.view.m);
+    if (binding.projection >= 0)
+      list.setUniformMat4((uint32_t)binding.projection, frame.projection.m);
+  }
+}
+
+void SceneRecorder::submit(Partition &partition, uint32_t index,
+                           const SceneFrame &frame) {
+  // La imagen ya valido las referencias al cargarse
+  const SceneInstance &instance = scene.instances[index];
+  const SceneMesh &sceneMesh = scene.meshes[instance.mesh];
+  const SceneMaterial &material = scene.materials[instance.material];
+  const SceneMaterialBinding &binding = materials[instance.material];
+
+  // LOD y frustum en el espacio de la malla: los clusters se prueban sin
+  // transformar sus esferas
+  Mat4 model;
+  for (int row = 0; row < 3; row++)
+    for (int col = 0; col < 4; col++)
+      model.at(row, col) = instance.transform[row * 4 + col];
+  Mat4 transform = frame.projection * frame.view * model;
+  // Cada instancia esta en una sola particion: select() no se pisa
+  size_t level = lodSelector.select(
+      index, &lodLevels[sceneMesh.firstLod], sceneMesh.lodCount,
+      pixelsPerUnit(transform, sceneMesh, frame));
+  uint32_t lod = sceneMesh.firstLod + (uint32_t)level;
+
+  Frustum frustum = Frustum::fromMatrix(transform);
+  partition.ranges.clear();
+  size_t clusters = meshlets[lod]->cullRanges(
+      frustum, scene.lods[lod].firstIndex, partition.ranges);
+  if (clusters == 0)
+    return;
+  partition.clusters += clusters;
+  if (level > 0)
+    partition.reduced++;
+
+  DrawPacket packet;
+  packet.program = binding.program;
+  packet.mesh = mesh;
+  for (int t = 0; t < DRAW_PACKET_TEXTURES; t++)
+    if (material.textures[t] != SCENE_NONE)
+      packet.textures[t] = textures[material.textures[t]];
+  packet.firstIndex = partition.ranges[0];
+  packet.indexCount = partition.ranges[1];
+  packet.translucent = material.translucent != 0;
+
+  // Los handles son chicos en los dos backends, entran en los 11 bits
+  SortKeyFields key;
+  key.translucent = packet.translucent;
+  key.shader = binding.program;
+  key.material = instance.material;
+  key.texture = material.textures[0] != SCENE_NONE ? material.textures[0] : 0;
+  key.depth = viewDepth(transform, sceneMesh);
+  RenderQueue &queue = partition.queue;
+  size_t packetIndex = queue.submit(makeSortKey(key), packet);
+  // Un rango es un draw comun; con mas, uno solo con todos
+  if (partition.ranges.size() > 2)
+    for (size_t r = 0; r < partition.ranges.size(); r += 2)
+      queue.addRange(packetIndex, partition.ranges[r],
+                     partition.ranges[r + 1]);
+  queue.setUniform(packetIndex, binding.time, frame.time);
+  queue.setUniform(packetIndex, binding.mixValue, frame.mixValue);
+  for (int row = 0; row < 3; row++) {
+    const float *values = instance.transform + row * 4;
+    queue.setUniform(packetIndex, binding.transformRows[row], values[0],
+                     values[1], values[2], values[3]);
+  }
+}
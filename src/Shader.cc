@@ -66,6 +66,7 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath) {
   glLinkProgram(ID);
 
   glGetProgramiv(ID, GL_LINK_STATUS, &success);
+  isValid = success != 0;
   if (!success) {
     glGetProgramInfoLog(ID, 512, NULL, infoLog);
     std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
@@ -76,23 +77,81 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath) {
   glDeleteShader(fragment);
 }
 
+Shader::Shader(const char *computePath) {
+  std::string computeCode;
+  std::ifstream cShaderFile;
+  cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+  try {
+    cShaderFile.open(computePath);
+    std::stringstream cShaderStream;
+    cShaderStream << cShaderFile.rdbuf();
+    cShaderFile.close();
+    computeCode = cShaderStream.str();
+  } catch (std::ifstream::failure &e) {
+    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+  }
+  const char *cShaderCode = computeCode.c_str();
+
+  int success;
+  char infoLog[512];
+
+  unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(compute, 1, &cShaderCode, NULL);
+  glCompileShader(compute);
+
+  glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(compute, 512, NULL, infoLog);
+    std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n"
+              << infoLog << std::endl;
+  }
+
+  ID = glCreateProgram();
+  glAttachShader(ID, compute);
+  glLinkProgram(ID);
+
+  glGetProgramiv(ID, GL_LINK_STATUS, &success);
+  isValid = success != 0;
+  if (!success) {
+    glGetProgramInfoLog(ID, 512, NULL, infoLog);
+    std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+              << infoLog << std::endl;
+  }
+
+  glDeleteShader(compute);
+}
+
 void Shader::use() {
   glUseProgram(ID);
 }
 
 void Shader::setBool(const std::string &name, bool value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+  glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string &name, int value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+  glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const {
-  glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+  glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setColorRGB(const std::string &name, float r, float g, float b) const {
-  glUniform4f(glGetUniformLocation(ID, name.c_str()), r, g, b, 1.0);
+  glUniform4f(getUniformLocation(name), r, g, b, 1.0);
+
+}
+
+void Shader::setMat4(const std::string &name, const float *value) const {
+  glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, value);
+}
 
+int Shader::getUniformLocation(const std::string &name) const {
+  // Cacheamos la location para no preguntarle al driver en cada frame
+  auto it = uniformLocations.find(name);
+  if (it != uniformLocations.end())
+    return it->second;
+  int location = glGetUniformLocation(ID, name.c_str());
+  uniformLocations[name] = location;
+  return location;
 }
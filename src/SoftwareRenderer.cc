@@ -0,0 +1,762 @@
+#include "SoftwareRenderer.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                            \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SOFTWARE_RENDERER_USE_AVX2 1
+#endif
+
+namespace {
+
+// Precision de las coordenadas de pantalla: 1/16 de pixel
+const int SUBPIXEL_BITS = 4;
+const int SUBPIXEL = 1 << SUBPIXEL_BITS;
+// Las funciones de arista al principio de cada fila se recortan a esto; con
+// pasos de a lo sumo 2^23 por pixel una fila de 64 pixeles no cambia de
+// signo por el recorte y todo entra en int32
+const int64_t EDGE_LIMIT = (int64_t)1 << 29;
+// Por debajo de esto w se considera detras de la camara
+const float MIN_W = 1e-6f;
+// Vertices por draw a partir de los cuales el vertex stage va en paralelo
+const size_t VERTEX_JOB_THRESHOLD = 4096;
+const size_t VERTEX_GRAIN = 1024;
+// Floats de un vertice recortado: posicion de clip y varyings
+const int CLIP_FLOATS = 4 + SOFTWARE_MAX_VARYINGS;
+// 3 vertices mas uno por cada plano de recorte
+const int CLIP_MAX_VERTICES = 9;
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+  int64_t quotient = value / divisor;
+  return quotient * divisor > value ? quotient - 1 : quotient;
+}
+
+// Plano A * x + B * y + C que pasa por los valores `f` de los tres vertices
+void interpolationPlane(const float x[3], const float y[3], const float f[3],
+                        float area, float plane[3]) {
+  float d1 = f[1] - f[0], d2 = f[2] - f[0];
+  plane[0] = (d1 * (y[2] - y[0]) - d2 * (y[1] - y[0])) / area;
+  plane[1] = ((x[1] - x[0]) * d2 - (x[2] - x[0]) * d1) / area;
+  plane[2] = f[0] - plane[0] * x[0] - plane[1] * y[0];
+}
+
+inline int lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(mask);
+#else
+  int bit = 0;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+inline float clamp01(float value) {
+  return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+inline uint8_t toByte(float value) {
+  return (uint8_t)(clamp01(value) * 255.0f + 0.5f);
+}
+
+// Cobertura de `count` pixeles (hasta 64) de una fila: bit i si el pixel i
+// esta adentro de las tres aristas. `start` es el valor en el primero y
+// `step` lo que cambia de un pixel al siguiente
+typedef uint64_t (*RowKernel)(const int32_t start[3], const int32_t step[3],
+                              int count);
+
+uint64_t coverRowScalar(const int32_t start[3], const int32_t step[3],
+                        int count) {
+  int32_t e0 = start[0], e1 = start[1], e2 = start[2];
+  uint64_t mask = 0;
+  for (int i = 0; i < count; i++) {
+    if ((e0 | e1 | e2) >= 0)
+      mask |= (uint64_t)1 << i;
+    e0 += step[0];
+    e1 += step[1];
+    e2 += step[2];
+  }
+  return mask;
+}
+
+#ifdef SOFTWARE_RENDERER_USE_AVX2
+__attribute__((target("avx2"))) uint64_t
+coverRowAVX2(const int32_t start[3], const int32_t step[3], int count) {
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i e0 = _mm256_add_epi32(
+      _mm256_set1_epi32(start[0]),
+      _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step[0])));
+  __m256i e1 = _mm256_add_epi32(
+      _mm256_set1_epi32(start[1]),
+      _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step[1])));
+  __m256i e2 = _mm256_add_epi32(
+      _mm256_set1_epi32(start[2]),
+      _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step[2])));
+  const __m256i step0 = _mm256_set1_epi32(step[0] * 8);
+  const __m256i step1 = _mm256_set1_epi32(step[1] * 8);
+  const __m256i step2 = _mm256_set1_epi32(step[2] * 8);
+
+  uint64_t mask = 0;
+  for (int i = 0; i < count; i += 8) {
+    // El bit de signo del or es 1 si alguna arista es negativa
+    __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), e2);
+    uint32_t outside =
+        (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(any));
+    mask |= (uint64_t)(~outside & 0xffu) << i;
+    e0 = _mm256_add_epi32(e0, step0);
+    e1 = _mm256_add_epi32(e1, step1);
+    e2 = _mm256_add_epi32(e2, step2);
+  }
+  if (count < 64)
+    mask &= ((uint64_t)1 << count) - 1;
+  return mask;
+}
+#endif
+
+struct KernelChoice {
+  RowKernel kernel;
+  const char *name;
+};
+
+const KernelChoice &kernelChoice() {
+  static const KernelChoice choice = [] {
+#ifdef SOFTWARE_RENDERER_USE_AVX2
+    if (__builtin_cpu_supports("avx2"))
+      return KernelChoice{coverRowAVX2, "avx2"};
+#endif
+    return KernelChoice{coverRowScalar, "scalar"};
+  }();
+  return choice;
+}
+
+// --- Texturas ---
+
+// Texel `i` de una fila de `size`; -1 es el borde de CLAMP_TO_BORDER
+int wrapTexel(int i, int size, uint32_t wrap) {
+  switch (wrap) {
+  case GL_REPEAT:
+    return ((i % size) + size) % size;
+  case GL_MIRRORED_REPEAT: {
+    int period = 2 * size;
+    int m = ((i % period) + period) % period;
+    return m < size ? m : period - 1 - m;
+  }
+  case GL_CLAMP_TO_BORDER:
+    return i < 0 || i >= size ? -1 : i;
+  default:
+    return std::min(std::max(i, 0), size - 1);
+  }
+}
+
+void fetchTexel(const SoftwareTexture::Level &level, int x, int y,
+                const SoftwareTexture &texture, float color[4]) {
+  x = wrapTexel(x, level.width, texture.wrapS);
+  y = wrapTexel(y, level.height, texture.wrapT);
+  if (x < 0 || y < 0) {
+    color[0] = color[1] = color[2] = color[3] = 0.0f;
+    return;
+  }
+  const uint8_t *texel = &level.pixels[((size_t)y * level.width + x) * 4];
+  for (int c = 0; c < 4; c++)
+    color[c] = texel[c] * (1.0f / 255.0f);
+}
+
+void sampleLevel(const SoftwareTexture &texture, int index, bool linear,
+                 float u, float v, float color[4]) {
+  const SoftwareTexture::Level &level = texture.levels[index];
+  // Recorta coordenadas absurdas (o NaN) antes de pasarlas a int
+  float x = std::min(1e7f, std::max(-1e7f, u * level.width));
+  float y = std::min(1e7f, std::max(-1e7f, v * level.height));
+  if (!linear) {
+    fetchTexel(level, (int)std::floor(x), (int)std::floor(y), texture,
+               color);
+    return;
+  }
+  x -= 0.5f;
+  y -= 0.5f;
+  float x0 = std::floor(x), y0 = std::floor(y);
+  float fx = x - x0, fy = y - y0;
+  int i = (int)x0, j = (int)y0;
+  float c00[4], c10[4], c01[4], c11[4];
+  fetchTexel(level, i, j, texture, c00);
+  fetchTexel(level, i + 1, j, texture, c10);
+  fetchTexel(level, i, j + 1, texture, c01);
+  fetchTexel(level, i + 1, j + 1, texture, c11);
+  for (int c = 0; c < 4; c++) {
+    float bottom = c00[c] + (c10[c] - c00[c]) * fx;
+    float top = c01[c] + (c11[c] - c01[c]) * fx;
+    color[c] = bottom + (top - bottom) * fy;
+  }
+}
+
+} // namespace
+
+void sampleTexture(const SoftwareTexture *texture, float u, float v,
+                   float dudx, float dvdx, float dudy, float dvdy,
+                   float color[4]) {
+  if (!texture || texture->levels.empty()) {
+    color[0] = color[1] = color[2] = 0.0f;
+    color[3] = 1.0f;
+    return;
+  }
+  // Nivel de detalle como en la especificacion de GL: log2 de la mayor
+  // derivada en texels del nivel 0
+  const SoftwareTexture::Level &base = texture->levels[0];
+  float xx = dudx * base.width, yx = dvdx * base.height;
+  float xy = dudy * base.width, yy = dvdy * base.height;
+  float rho = std::sqrt(std::max(xx * xx + yx * yx, xy * xy + yy * yy));
+  float lambda = rho > 0.0f ? std::log2(rho) : -128.0f;
+  int maxLevel = (int)texture->levels.size() - 1;
+
+  uint32_t filter = lambda > 0.0f ? texture->minFilter : texture->magFilter;
+  switch (filter) {
+  case GL_NEAREST:
+    sampleLevel(*texture, 0, false, u, v, color);
+    break;
+  case GL_NEAREST_MIPMAP_NEAREST:
+  case GL_LINEAR_MIPMAP_NEAREST: {
+    int level = lambda <= 0.5f ? 0 : (int)std::ceil(lambda + 0.5f) - 1;
+    sampleLevel(*texture, std::min(level, maxLevel),
+                filter == GL_LINEAR_MIPMAP_NEAREST, u, v, color);
+    break;
+  }
+  case GL_NEAREST_MIPMAP_LINEAR:
+  case GL_LINEAR_MIPMAP_LINEAR: {
+    bool linear = filter == GL_LINEAR_MIPMAP_LINEAR;
+    if (lambda >= (float)maxLevel) {
+      sampleLevel(*texture, maxLevel, linear, u, v, color);
+      break;
+    }
+    int level = (int)std::floor(lambda);
+    float weight = lambda - (float)level;
+    float next[4];
+    sampleLevel(*texture, level, linear, u, v, color);
+    sampleLevel(*texture, level + 1, linear, u, v, next);
+    for (int c = 0; c < 4; c++)
+      color[c] += (next[c] - color[c]) * weight;
+    break;
+  }
+  default:
+    sampleLevel(*texture, 0, true, u, v, color);
+    break;
+  }
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, JobSystem &jobs)
+    : width(width), height(height), jobs(jobs) {
+  if (width < 1 || height < 1 || width > 8192 || height > 8192) {
+    std::cout << "ERROR::SOFTWARE::INVALID_SIZE " << width << "x" << height
+              << std::endl;
+    this->width = this->height = 0;
+    tilesX = tilesY = 0;
+    guardBand = 1.0f;
+    return;
+  }
+  tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+  tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+  // Guard band en NDC: lo que queda adentro cae a menos de 2^14 pixeles
+  // del origen, asi las coordenadas de punto fijo entran en 18 bits
+  guardBand = 32768.0f / (float)std::max(width, height) - 1.0f;
+  color.assign((size_t)width * height * 4, 0);
+  depth.assign((size_t)width * height, 1.0f);
+  bins.resize((size_t)tilesX * tilesY);
+  isValid = true;
+}
+
+const char *SoftwareRenderer::implementation() { return kernelChoice().name; }
+
+uint32_t SoftwareRenderer::createTexture(int width, int height,
+                                         const uint8_t *rgba, uint32_t wrapS,
+                                         uint32_t wrapT, uint32_t minFilter,
+                                         uint32_t magFilter) {
+  if (width < 1 || height < 1 || !rgba) {
+    std::cout << "ERROR::SOFTWARE::INVALID_TEXTURE" << std::endl;
+    return 0;
+  }
+  std::unique_ptr<SoftwareTexture> texture(new SoftwareTexture());
+  texture->wrapS = wrapS;
+  texture->wrapT = wrapT;
+  texture->minFilter = minFilter;
+  texture->magFilter = magFilter;
+  texture->levels.push_back(
+      {width, height,
+       std::vector<uint8_t>(rgba, rgba + (size_t)width * height * 4)});
+
+  // Mipmaps con un promedio de 2x2, como glGenerateMipmap
+  while (texture->levels.back().width > 1 ||
+         texture->levels.back().height > 1) {
+    const SoftwareTexture::Level &source = texture->levels.back();
+    SoftwareTexture::Level level;
+    level.width = std::max(1, source.width / 2);
+    level.height = std::max(1, source.height / 2);
+    level.pixels.resize((size_t)level.width * level.height * 4);
+    for (int y = 0; y < level.height; y++) {
+      int y0 = std::min(2 * y, source.height - 1);
+      int y1 = std::min(2 * y + 1, source.height - 1);
+      for (int x = 0; x < level.width; x++) {
+        int x0 = std::min(2 * x, source.width - 1);
+        int x1 = std::min(2 * x + 1, source.width - 1);
+        const uint8_t *a = &source.pixels[((size_t)y0 * source.width + x0) * 4];
+        const uint8_t *b = &source.pixels[((size_t)y0 * source.width + x1) * 4];
+        const uint8_t *c = &source.pixels[((size_t)y1 * source.width + x0) * 4];
+        const uint8_t *d = &source.pixels[((size_t)y1 * source.width + x1) * 4];
+        uint8_t *out = &level.pixels[((size_t)y * level.width + x) * 4];
+        for (int k = 0; k < 4; k++)
+          out[k] = (uint8_t)((a[k] + b[k] + c[k] + d[k] + 2) / 4);
+      }
+    }
+    texture->levels.push_back(std::move(level));
+  }
+  textures.push_back(std::move(texture));
+  return (uint32_t)textures.size();
+}
+
+uint32_t SoftwareRenderer::createMesh(const float *vertices,
+                                      size_t vertexCount, size_t stride,
+                                      const uint32_t *indices,
+                                      size_t indexCount) {
+  if (stride < 1) {
+    std::cout << "ERROR::SOFTWARE::INVALID_MESH" << std::endl;
+    return 0;
+  }
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  mesh->vertices.assign(vertices, vertices + vertexCount * stride);
+  mesh->indices.assign(indices, indices + indexCount);
+  mesh->stride = stride;
+  meshes.push_back(std::move(mesh));
+  return (uint32_t)meshes.size();
+}
+
+uint32_t SoftwareRenderer::createProgram(const SoftwareProgram &program) {
+  if (!program.vertex || !program.fragment ||
+      program.varyingCount > (uint32_t)SOFTWARE_MAX_VARYINGS) {
+    std::cout << "ERROR::SOFTWARE::INVALID_PROGRAM" << std::endl;
+    return 0;
+  }
+  std::unique_ptr<Program> created(new Program());
+  created->source = program;
+  uint32_t floats = 0;
+  for (const SoftwareProgram::Uniform &uniform : program.uniforms) {
+    created->offsets.push_back(floats);
+    floats += uniform.floats;
+  }
+  created->values.assign(floats, 0.0f);
+  programs.push_back(std::move(created));
+  return (uint32_t)programs.size();
+}
+
+int SoftwareRenderer::getUniformLocation(uint32_t program,
+                                         const std::string &name) const {
+  if (program < 1 || program > programs.size())
+    return -1;
+  const std::vector<SoftwareProgram::Uniform> &uniforms =
+      programs[program - 1]->source.uniforms;
+  for (size_t i = 0; i < uniforms.size(); i++)
+    if (uniforms[i].name == name || uniforms[i].name == name + "[0]")
+      return (int)i;
+  return -1;
+}
+
+void SoftwareRenderer::clear(float r, float g, float b, float a) {
+  const uint8_t value[4] = {toByte(r), toByte(g), toByte(b), toByte(a)};
+  for (size_t i = 0; i < color.size(); i += 4)
+    std::memcpy(&color[i], value, 4);
+  std::fill(depth.begin(), depth.end(), 1.0f);
+  drawCalls = 0;
+  triangles = 0;
+}
+
+void SoftwareRenderer::submit(const CommandList &list) {
+  for (const Command &command : list.commands) {
+    switch (command.type) {
+    case CommandType::SetPipeline:
+      currentProgram = command.a >= 1 && command.a <= programs.size()
+                           ? programs[command.a - 1].get()
+                           : nullptr;
+      currentFlags = command.b;
+      break;
+    case CommandType::BindTexture:
+      if (command.unit < SOFTWARE_TEXTURE_UNITS)
+        currentUnits[command.unit] =
+            command.a >= 1 && command.a <= textures.size()
+                ? textures[command.a - 1].get()
+                : nullptr;
+      break;
+    case CommandType::BindMesh:
+      currentMesh = command.a >= 1 && command.a <= meshes.size()
+                        ? meshes[command.a - 1].get()
+                        : nullptr;
+      break;
+    case CommandType::SetUniform1f:
+      setUniform(command.a, command.values, 1);
+      break;
+    case CommandType::SetUniform4f:
+      setUniform(command.a, command.values, 4);
+      break;
+    case CommandType::SetUniform1i: {
+      float value = (float)(int32_t)command.b;
+      setUniform(command.a, &value, 1);
+      break;
+    }
+    case CommandType::SetUniformMat4:
+      setUniform(command.a, &list.payload[command.b], 16);
+      break;
+    case CommandType::DrawIndexed:
+      drawIndexed(command.a, command.b, command.c);
+      break;
+    case CommandType::MultiDrawIndexed:
+      // Un draw por rango, con el mismo estado
+      for (uint32_t i = 0; i < command.a; i++)
+        drawIndexed(list.ranges[command.b + 2 * i + 1],
+                    list.ranges[command.b + 2 * i], 0);
+      break;
+    }
+  }
+}
+
+void SoftwareRenderer::setUniform(uint32_t location, const float *values,
+                                  uint32_t count) {
+  // Como en GL, una location invalida (-1) no hace nada
+  if (!currentProgram || location >= currentProgram->offsets.size())
+    return;
+  uint32_t floats = currentProgram->source.uniforms[location].floats;
+  std::memcpy(&currentProgram->values[currentProgram->offsets[location]],
+              values, std::min(count, floats) * sizeof(float));
+}
+
+void SoftwareRenderer::drawIndexed(uint32_t indexCount, uint32_t firstIndex,
+                                   int32_t baseVertex) {
+  if (!isValid || !currentProgram || !currentMesh)
+    return;
+  const Mesh &mesh = *currentMesh;
+  const Program &program = *currentProgram;
+  indexCount -= indexCount % 3;
+  if ((size_t)firstIndex + indexCount > mesh.indices.size()) {
+    std::cout << "ERROR::SOFTWARE::INDEX_OUT_OF_RANGE" << std::endl;
+    return;
+  }
+  if (indexCount == 0)
+    return;
+
+  // Rango de vertices que usa el draw; el vertex shader corre una vez por
+  // vertice y los triangulos comparten el resultado
+  const uint32_t *indices = &mesh.indices[firstIndex];
+  int64_t first = INT64_MAX, last = INT64_MIN;
+  for (uint32_t i = 0; i < indexCount; i++) {
+    int64_t index = (int64_t)indices[i] + baseVertex;
+    first = std::min(first, index);
+    last = std::max(last, index);
+  }
+  if (first < 0 || (size_t)last >= mesh.vertices.size() / mesh.stride) {
+    std::cout << "ERROR::SOFTWARE::VERTEX_OUT_OF_RANGE" << std::endl;
+    return;
+  }
+
+  Draw draw;
+  draw.program = &program;
+  draw.uniforms = drawUniforms.size();
+  drawUniforms.insert(drawUniforms.end(), program.values.begin(),
+                      program.values.end());
+  std::memcpy(draw.units, currentUnits, sizeof(draw.units));
+  draw.flags = currentFlags;
+  uint32_t drawIndex = (uint32_t)draws.size();
+  draws.push_back(draw);
+  drawCalls++;
+
+  // Vertex stage
+  uint32_t varyingCount = program.source.varyingCount;
+  size_t outputFloats = 4 + varyingCount;
+  size_t vertexCount = (size_t)(last - first + 1);
+  vertexOutput.resize(vertexCount * outputFloats);
+  SoftwareShaderContext context = {program.values.data(),
+                                   program.offsets.data(), currentUnits};
+  auto runVertices = [&](size_t begin, size_t end) {
+    for (size_t v = begin; v < end; v++) {
+      float *output = &vertexOutput[v * outputFloats];
+      program.source.vertex(context,
+                            &mesh.vertices[(first + v) * mesh.stride],
+                            output, output + 4);
+    }
+  };
+  if (vertexCount >= VERTEX_JOB_THRESHOLD)
+    jobs.parallelFor(0, vertexCount, VERTEX_GRAIN, runVertices);
+  else
+    runVertices(0, vertexCount);
+
+  // Primitivas: las que estan enteras adentro de la guard band no se recortan
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    const float *vertices[3];
+    bool inside = true;
+    for (int k = 0; k < 3; k++) {
+      vertices[k] = &vertexOutput[((int64_t)indices[i + k] + baseVertex -
+                                   first) *
+                                  outputFloats];
+      float x = vertices[k][0], y = vertices[k][1], z = vertices[k][2];
+      float w = vertices[k][3], guard = guardBand * w;
+      inside = inside && z >= -w && z <= w && x >= -guard && x <= guard &&
+               y >= -guard && y <= guard && w >= MIN_W;
+    }
+    if (inside)
+      setupTriangle(vertices, varyingCount, drawIndex);
+    else
+      clipTriangle(vertices, varyingCount, drawIndex);
+  }
+}
+
+void SoftwareRenderer::clipTriangle(const float *const vertices[3],
+                                    uint32_t varyingCount, uint32_t draw) {
+  // Sutherland-Hodgman en clip space: near, far y los cuatro lados de la
+  // guard band. Los varyings se interpolan lineal en clip space, que es lo
+  // correcto antes de la division por w
+  const float planes[6][4] = {
+      {0.0f, 0.0f, 1.0f, 1.0f},       {0.0f, 0.0f, -1.0f, 1.0f},
+      {1.0f, 0.0f, 0.0f, guardBand},  {-1.0f, 0.0f, 0.0f, guardBand},
+      {0.0f, 1.0f, 0.0f, guardBand},  {0.0f, -1.0f, 0.0f, guardBand}};
+  size_t floats = 4 + varyingCount;
+  float buffers[2][CLIP_MAX_VERTICES][CLIP_FLOATS];
+  int count = 3;
+  for (int k = 0; k < 3; k++)
+    std::memcpy(buffers[0][k], vertices[k], floats * sizeof(float));
+
+  int current = 0;
+  for (const float *plane : planes) {
+    float (*input)[CLIP_FLOATS] = buffers[current];
+    float (*output)[CLIP_FLOATS] = buffers[1 - current];
+    int outputCount = 0;
+    for (int i = 0; i < count; i++) {
+      const float *a = input[i];
+      const float *b = input[(i + 1) % count];
+      float da = plane[0] * a[0] + plane[1] * a[1] + plane[2] * a[2] +
+                 plane[3] * a[3];
+      float db = plane[0] * b[0] + plane[1] * b[1] + plane[2] * b[2] +
+                 plane[3] * b[3];
+      if (da >= 0.0f)
+        std::memcpy(output[outputCount++], a, floats * sizeof(float));
+      if ((da >= 0.0f) != (db >= 0.0f)) {
+        float t = da / (da - db);
+        float *out = output[outputCount++];
+        for (size_t f = 0; f < floats; f++)
+          out[f] = a[f] + (b[f] - a[f]) * t;
+      }
+    }
+    count = outputCount;
+    current = 1 - current;
+    if (count < 3)
+      return;
+  }
+
+  for (int i = 1; i + 1 < count; i++) {
+    const float *const triangle[3] = {buffers[current][0],
+                                      buffers[current][i],
+                                      buffers[current][i + 1]};
+    setupTriangle(triangle, varyingCount, draw);
+  }
+}
+
+void SoftwareRenderer::setupTriangle(const float *const vertices[3],
+                                     uint32_t varyingCount, uint32_t draw) {
+  float screenX[3], screenY[3], screenZ[3], inverseW[3];
+  int64_t x[3], y[3];
+  for (int k = 0; k < 3; k++) {
+    float w = vertices[k][3];
+    if (w < MIN_W)
+      return;
+    inverseW[k] = 1.0f / w;
+    float sx = (vertices[k][0] * inverseW[k] * 0.5f + 0.5f) * (float)width;
+    float sy = (vertices[k][1] * inverseW[k] * 0.5f + 0.5f) * (float)height;
+    x[k] = (int64_t)std::lround(sx * SUBPIXEL);
+    y[k] = (int64_t)std::lround(sy * SUBPIXEL);
+    screenX[k] = (float)x[k] / SUBPIXEL;
+    screenY[k] = (float)y[k] / SUBPIXEL;
+    screenZ[k] = vertices[k][2] * inverseW[k] * 0.5f + 0.5f;
+  }
+
+  int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (area == 0)
+    return;
+  // Sin face culling: los triangulos en sentido horario se dan vuelta
+  int order[3] = {0, 1, 2};
+  if (area < 0)
+    std::swap(order[1], order[2]);
+
+  Triangle triangle;
+  for (int e = 0; e < 3; e++) {
+    int i = order[e], j = order[(e + 1) % 3];
+    triangle.edgeA[e] = y[i] - y[j];
+    triangle.edgeB[e] = x[j] - x[i];
+    triangle.edgeC[e] = -triangle.edgeA[e] * x[i] - triangle.edgeB[e] * y[i];
+    // Regla top-left: un pixel justo sobre la arista es de un solo triangulo
+    bool topLeft = y[j] < y[i] || (y[j] == y[i] && x[j] < x[i]);
+    if (!topLeft)
+      triangle.edgeC[e] -= 1;
+  }
+
+  // Pixeles cuyo centro cae dentro de la bounding box
+  int64_t minX = std::min({x[0], x[1], x[2]}) - SUBPIXEL / 2;
+  int64_t maxX = std::max({x[0], x[1], x[2]}) - SUBPIXEL / 2;
+  int64_t minY = std::min({y[0], y[1], y[2]}) - SUBPIXEL / 2;
+  int64_t maxY = std::max({y[0], y[1], y[2]}) - SUBPIXEL / 2;
+  triangle.minX = (int)std::max<int64_t>(
+      floorDiv(minX + SUBPIXEL - 1, SUBPIXEL), 0);
+  triangle.minY = (int)std::max<int64_t>(
+      floorDiv(minY + SUBPIXEL - 1, SUBPIXEL), 0);
+  triangle.maxX =
+      (int)std::min<int64_t>(floorDiv(maxX, SUBPIXEL), width - 1);
+  triangle.maxY =
+      (int)std::min<int64_t>(floorDiv(maxY, SUBPIXEL), height - 1);
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    return;
+
+  // Planos de interpolacion con los vertices ya ordenados y redondeados
+  float px[3], py[3], pz[3], pw[3];
+  for (int k = 0; k < 3; k++) {
+    px[k] = screenX[order[k]];
+    py[k] = screenY[order[k]];
+    pz[k] = screenZ[order[k]];
+    pw[k] = inverseW[order[k]];
+  }
+  float areaPixels = (float)std::abs(area) / (SUBPIXEL * SUBPIXEL);
+  interpolationPlane(px, py, pz, areaPixels, triangle.depthPlane);
+  interpolationPlane(px, py, pw, areaPixels, triangle.inverseWPlane);
+  triangle.planes = planeValues.size();
+  planeValues.resize(planeValues.size() + 3 * varyingCount);
+  for (uint32_t i = 0; i < varyingCount; i++) {
+    float values[3];
+    for (int k = 0; k < 3; k++)
+      values[k] = vertices[order[k]][4 + i] * pw[k];
+    interpolationPlane(px, py, values, areaPixels,
+                       &planeValues[triangle.planes + 3 * i]);
+  }
+  triangle.draw = draw;
+
+  uint32_t index = (uint32_t)triangleList.size();
+  triangleList.push_back(triangle);
+  triangles++;
+  for (int ty = triangle.minY / TILE_SIZE; ty <= triangle.maxY / TILE_SIZE;
+       ty++)
+    for (int tx = triangle.minX / TILE_SIZE; tx <= triangle.maxX / TILE_SIZE;
+         tx++)
+      bins[(size_t)ty * tilesX + tx].push_back(index);
+}
+
+void SoftwareRenderer::flush() {
+  if (!triangleList.empty())
+    jobs.parallelFor(0, bins.size(), 1, [this](size_t first, size_t last) {
+      for (size_t tile = first; tile < last; tile++)
+        rasterizeTile(tile);
+    });
+  for (std::vector<uint32_t> &bin : bins)
+    bin.clear();
+  triangleList.clear();
+  planeValues.clear();
+  draws.clear();
+  drawUniforms.clear();
+}
+
+void SoftwareRenderer::rasterizeTile(size_t tile) {
+  const std::vector<uint32_t> &bin = bins[tile];
+  if (bin.empty())
+    return;
+  int tileX0 = (int)(tile % tilesX) * TILE_SIZE;
+  int tileY0 = (int)(tile / tilesX) * TILE_SIZE;
+  int tileX1 = std::min(tileX0 + TILE_SIZE, width) - 1;
+  int tileY1 = std::min(tileY0 + TILE_SIZE, height) - 1;
+  RowKernel cover = kernelChoice().kernel;
+
+  for (uint32_t index : bin) {
+    const Triangle &triangle = triangleList[index];
+    const Draw &draw = draws[triangle.draw];
+    int x0 = std::max(triangle.minX, tileX0);
+    int x1 = std::min(triangle.maxX, tileX1);
+    int y0 = std::max(triangle.minY, tileY0);
+    int y1 = std::min(triangle.maxY, tileY1);
+    if (x0 > x1 || y0 > y1)
+      continue;
+
+    // Funciones de arista en el centro de los pixeles
+    int64_t centerX = (int64_t)x0 * SUBPIXEL + SUBPIXEL / 2;
+    int32_t step[3];
+    for (int e = 0; e < 3; e++)
+      step[e] = (int32_t)(triangle.edgeA[e] * SUBPIXEL);
+    for (int y = y0; y <= y1; y++) {
+      int64_t centerY = (int64_t)y * SUBPIXEL + SUBPIXEL / 2;
+      int32_t start[3];
+      for (int e = 0; e < 3; e++) {
+        int64_t value = triangle.edgeA[e] * centerX +
+                        triangle.edgeB[e] * centerY + triangle.edgeC[e];
+        start[e] = (int32_t)std::min(std::max(value, -EDGE_LIMIT), EDGE_LIMIT);
+      }
+      uint64_t mask = cover(start, step, x1 - x0 + 1);
+      while (mask) {
+        shadePixel(triangle, draw, x0 + lowestBit(mask), y);
+        mask &= mask - 1;
+      }
+    }
+  }
+}
+
+void SoftwareRenderer::shadePixel(const Triangle &triangle, const Draw &draw,
+                                  int x, int y) {
+  float fx = (float)x + 0.5f, fy = (float)y + 0.5f;
+  size_t pixel = (size_t)y * width + x;
+  bool depthTest = (draw.flags & PIPELINE_DEPTH_TEST) != 0;
+  float z = triangle.depthPlane[0] * fx + triangle.depthPlane[1] * fy +
+            triangle.depthPlane[2];
+  if (depthTest && !(z < depth[pixel]))
+    return;
+
+  // Varyings con correccion de perspectiva en el pixel y en sus vecinos de
+  // la derecha y de arriba, para las derivadas
+  const Program &program = *draw.program;
+  uint32_t varyingCount = program.source.varyingCount;
+  const float *w = triangle.inverseWPlane;
+  float q = w[0] * fx + w[1] * fy + w[2];
+  float inverse = 1.0f / q;
+  float inverseX = 1.0f / (q + w[0]);
+  float inverseY = 1.0f / (q + w[1]);
+  float varyings[SOFTWARE_MAX_VARYINGS];
+  float ddx[SOFTWARE_MAX_VARYINGS], ddy[SOFTWARE_MAX_VARYINGS];
+  const float *planes = planeValues.data() + triangle.planes;
+  for (uint32_t i = 0; i < varyingCount; i++) {
+    const float *plane = &planes[3 * i];
+    float value = plane[0] * fx + plane[1] * fy + plane[2];
+    varyings[i] = value * inverse;
+    ddx[i] = (value + plane[0]) * inverseX - varyings[i];
+    ddy[i] = (value + plane[1]) * inverseY - varyings[i];
+  }
+
+  SoftwareShaderContext context = {drawUniforms.data() + draw.uniforms,
+                                   program.offsets.data(), draw.units};
+  float out[4];
+  program.source.fragment(context, varyings, ddx, ddy, out);
+
+  uint8_t *target = &color[pixel * 4];
+  if (draw.flags & PIPELINE_BLEND) {
+    float alpha = clamp01(out[3]);
+    for (int c = 0; c < 4; c++)
+      out[c] = clamp01(out[c]) * alpha +
+               target[c] * (1.0f / 255.0f) * (1.0f - alpha);
+  }
+  for (int c = 0; c < 4; c++)
+    target[c] = toByte(out[c]);
+  if (depthTest && !(draw.flags & PIPELINE_BLEND))
+    depth[pixel] = z;
+}
+
+void executeCommandList(const CommandList &list, SoftwareRenderer &renderer) {
+  renderer.submit(list);
+  renderer.flush();
+}
+
+void executeCommandLists(const std::vector<CommandList> &lists,
+                         SoftwareRenderer &renderer) {
+  for (const CommandList &list : lists)
+    renderer.submit(list);
+  renderer.flush();
+}
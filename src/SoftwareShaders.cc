@@ -0,0 +1,92 @@
+#include "SoftwareShaders.h"
+
+namespace {
+
+// Locations de texture.vert/texture.frag, en el orden de `uniforms`
+enum TextureUniform {
+  TEXTURE_TIME,
+  TEXTURE_TRANSFORM_ROWS, // 3 vec4
+  TEXTURE_MIX_VALUE = TEXTURE_TRANSFORM_ROWS + 3,
+  TEXTURE_TEXTURE1,
+  TEXTURE_TEXTURE2,
+  TEXTURE_VIEW,
+  TEXTURE_PROJECTION
+};
+
+// Varyings: ourColor (3) y TexCoord (2)
+const uint32_t TEXTURE_VARYINGS = 5;
+
+// matrix * vector con la matriz por columnas, como mat4 en GLSL
+void transformPoint(const float *matrix, const float *vector, float *result) {
+  for (int row = 0; row < 4; row++)
+    result[row] = matrix[row] * vector[0] + matrix[4 + row] * vector[1] +
+                  matrix[8 + row] * vector[2] + matrix[12 + row] * vector[3];
+}
+
+void textureVertex(const SoftwareShaderContext &context,
+                   const float *attributes, float position[4],
+                   float *varyings) {
+  const float *rows = context.uniform(TEXTURE_TRANSFORM_ROWS);
+  float world[4], view[4];
+  for (int row = 0; row < 3; row++) {
+    const float *r = rows + 4 * row;
+    world[row] = r[0] * attributes[0] + r[1] * attributes[1] +
+                 r[2] * attributes[2] + r[3];
+  }
+  world[3] = 1.0f;
+  transformPoint(context.uniform(TEXTURE_VIEW), world, view);
+  transformPoint(context.uniform(TEXTURE_PROJECTION), view, position);
+  for (int i = 0; i < 5; i++)
+    varyings[i] = attributes[3 + i];
+}
+
+void textureFragment(const SoftwareShaderContext &context,
+                     const float *varyings, const float *ddx,
+                     const float *ddy, float color[4]) {
+  float u = varyings[3], v = varyings[4];
+  float first[4], second[4];
+  sampleTexture(context.sampler(TEXTURE_TEXTURE1), u, v, ddx[3], ddx[4],
+                ddy[3], ddy[4], first);
+  // vec2(1.0 - TexCoord.x, TexCoord.y): la derivada de x cambia de signo
+  sampleTexture(context.sampler(TEXTURE_TEXTURE2), 1.0f - u, v, -ddx[3],
+                ddx[4], -ddy[3], ddy[4], second);
+  float mixValue = context.uniform(TEXTURE_MIX_VALUE)[0];
+  for (int c = 0; c < 4; c++)
+    color[c] = first[c] + (second[c] - first[c]) * mixValue;
+}
+
+bool endsWith(const std::string &value, const std::string &suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(),
+                       suffix) == 0;
+}
+
+} // namespace
+
+SoftwareProgram softwareTextureProgram() {
+  SoftwareProgram program;
+  program.uniforms = {{"time", 1},
+                      {"transformRows[0]", 4},
+                      {"transformRows[1]", 4},
+                      {"transformRows[2]", 4},
+                      {"mixValue", 1},
+                      {"texture1", 1},
+                      {"texture2", 1},
+                      {"view", 16},
+                      {"projection", 16}};
+  program.varyingCount = TEXTURE_VARYINGS;
+  program.vertex = textureVertex;
+  program.fragment = textureFragment;
+  return program;
+}
+
+bool findSoftwareProgram(const std::string &vertexShader,
+                         const std::string &fragmentShader,
+                         SoftwareProgram &program) {
+  if (endsWith(vertexShader, "texture.vert") &&
+      endsWith(fragmentShader, "texture.frag")) {
+    program = softwareTextureProgram();
+    return true;
+  }
+  return false;
+}
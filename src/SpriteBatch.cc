@@ -0,0 +1,179 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <cstring>
+
+SpriteBatch::SpriteBatch(size_t maxSprites, const char *vertexPath,
+                         const char *fragmentPath)
+    : shader(vertexPath, fragmentPath),
+      vertexBuffer(GL_ARRAY_BUFFER, maxSprites * 4 * sizeof(SpriteVertex) * 2),
+      maxSprites(maxSprites) {
+  // Los indices de los quads nunca cambian: 0 1 2, 2 3 0 por cada sprite
+  std::vector<unsigned int> indices(maxSprites * 6);
+  for (size_t i = 0; i < maxSprites; i++) {
+    unsigned int base = (unsigned int)(i * 4);
+    unsigned int quad[6] = {base, base + 1, base + 2, base + 2, base + 3, base};
+    std::memcpy(&indices[i * 6], quad, sizeof(quad));
+  }
+
+  glGenVertexArrays(1, &VAO);
+  glGenBuffers(1, &EBO);
+  glBindVertexArray(VAO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
+               indices.data(), GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+  glEnableVertexAttribArray(3);
+  pointAttributes(0);
+  glBindVertexArray(0);
+
+  std::memset(projection, 0, sizeof(projection));
+  projection[0] = projection[5] = projection[10] = projection[15] = 1.0f;
+}
+
+SpriteBatch::~SpriteBatch() {
+  glDeleteVertexArrays(1, &VAO);
+  glDeleteBuffers(1, &EBO);
+  glDeleteProgram(shader.ID);
+}
+
+void SpriteBatch::pointAttributes(size_t byteOffset) {
+  const GLsizei stride = sizeof(SpriteVertex);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.ID);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(byteOffset + offsetof(SpriteVertex, position)));
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(byteOffset + offsetof(SpriteVertex, texCoord)));
+  glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride,
+                        (void *)(byteOffset + offsetof(SpriteVertex, layer)));
+  glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        (void *)(byteOffset + offsetof(SpriteVertex, color)));
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::begin(const float *projectionMatrix) {
+  std::memcpy(projection, projectionMatrix, sizeof(projection));
+  sprites.clear();
+  // Si el end() anterior no llego a correr, su orden apunta a sprites viejos
+  order.clear();
+  spriteCount = 0;
+  drawCalls = 0;
+}
+
+void SpriteBatch::draw(unsigned int textureArray, float layer, float x,
+                       float y, float width, float height,
+                       const float uvRect[4], const uint8_t color[4],
+                       uint16_t depth, unsigned int program) {
+  QueuedSprite sprite;
+  sprite.x = x;
+  sprite.y = y;
+  sprite.width = width;
+  sprite.height = height;
+  std::memcpy(sprite.uvRect, uvRect, sizeof(sprite.uvRect));
+  sprite.layer = layer;
+  std::memcpy(sprite.color, color, sizeof(sprite.color));
+  sprite.texture = textureArray;
+  sprite.program = program ? program : shader.ID;
+  sprites.push_back(sprite);
+
+  // capa de profundidad | shader | textura: la capa manda para que el
+  // blending respete el orden, dentro de ella se agrupa por estado
+  order.push_back({((uint64_t)depth << 48) |
+                       ((uint64_t)(sprite.program & 0xffff) << 32) |
+                       sprite.texture,
+                   (uint32_t)(sprites.size() - 1)});
+}
+
+void SpriteBatch::end() {
+  spriteCount = sprites.size();
+  if (sprites.empty()) {
+    order.clear();
+    return;
+  }
+
+  radixSort(order, sortScratch);
+
+  GLboolean blendWasEnabled = glIsEnabled(GL_BLEND);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glActiveTexture(GL_TEXTURE0);
+  glBindVertexArray(VAO);
+
+  for (size_t first = 0; first < order.size(); first += maxSprites)
+    flush(first, std::min(maxSprites, order.size() - first));
+
+  glBindVertexArray(0);
+  if (!blendWasEnabled)
+    glDisable(GL_BLEND);
+  order.clear();
+}
+
+unsigned int SpriteBatch::createTextureArray(const unsigned char *pixels,
+                                             int width, int height,
+                                             int layers) {
+  unsigned int texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, layers, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  return texture;
+}
+
+void SpriteBatch::flush(size_t first, size_t count) {
+  SpriteVertex *vertices = static_cast<SpriteVertex *>(
+      vertexBuffer.map(count * 4 * sizeof(SpriteVertex), sizeof(SpriteVertex)));
+  if (vertices == nullptr)
+    return;
+
+  for (size_t i = 0; i < count; i++) {
+    const QueuedSprite &s = sprites[order[first + i].index];
+    float u0 = s.uvRect[0], v0 = s.uvRect[1];
+    float u1 = u0 + s.uvRect[2], v1 = v0 + s.uvRect[3];
+    SpriteVertex *quad = vertices + i * 4;
+    quad[0] = {{s.x, s.y}, {u0, v0}, s.layer, {0, 0, 0, 0}};
+    quad[1] = {{s.x + s.width, s.y}, {u1, v0}, s.layer, {0, 0, 0, 0}};
+    quad[2] = {{s.x + s.width, s.y + s.height}, {u1, v1}, s.layer, {0, 0, 0, 0}};
+    quad[3] = {{s.x, s.y + s.height}, {u0, v1}, s.layer, {0, 0, 0, 0}};
+    for (int k = 0; k < 4; k++)
+      std::memcpy(quad[k].color, s.color, 4);
+  }
+  pointAttributes(vertexBuffer.unmap());
+
+  // Un draw por cada tramo con el mismo shader y la misma textura
+  unsigned int boundProgram = 0;
+  unsigned int boundTexture = 0;
+  size_t runStart = 0;
+  for (size_t i = 1; i <= count; i++) {
+    const QueuedSprite &start = sprites[order[first + runStart].index];
+    if (i < count) {
+      const QueuedSprite &s = sprites[order[first + i].index];
+      if (s.program == start.program && s.texture == start.texture)
+        continue;
+    }
+
+    if (start.program != boundProgram) {
+      boundProgram = start.program;
+      glUseProgram(boundProgram);
+      glUniformMatrix4fv(glGetUniformLocation(boundProgram, "projection"), 1,
+                         GL_FALSE, projection);
+      glUniform1i(glGetUniformLocation(boundProgram, "spriteTexture"), 0);
+    }
+    if (start.texture != boundTexture) {
+      boundTexture = start.texture;
+      glBindTexture(GL_TEXTURE_2D_ARRAY, boundTexture);
+    }
+    glDrawElements(GL_TRIANGLES, (GLsizei)((i - runStart) * 6),
+                   GL_UNSIGNED_INT,
+                   (void *)(runStart * 6 * sizeof(unsigned int)));
+    drawCalls++;
+    runStart = i;
+  }
+}
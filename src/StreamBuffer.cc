@@ -0,0 +1,63 @@
+#include "StreamBuffer.h"
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(GLenum target, size_t capacity)
+    : target(target), capacity(capacity) {
+  glGenBuffers(1, &ID);
+  glBindBuffer(target, ID);
+  glBufferData(target, capacity, NULL, GL_STREAM_DRAW);
+  glBindBuffer(target, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+  if (ID)
+    glDeleteBuffers(1, &ID);
+}
+
+void *StreamBuffer::map(size_t bytes, size_t alignment) {
+  if (bytes > capacity) {
+    std::cout << "ERROR::STREAM_BUFFER::REQUEST_LARGER_THAN_CAPACITY " << bytes
+              << " > " << capacity << std::endl;
+    return nullptr;
+  }
+
+  size_t offset = (head + alignment - 1) / alignment * alignment;
+  GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                      GL_MAP_INVALIDATE_RANGE_BIT;
+  glBindBuffer(target, ID);
+  if (offset + bytes > capacity) {
+    // Sin espacio: pedimos almacenamiento nuevo y volvemos al inicio
+    glBufferData(target, capacity, NULL, GL_STREAM_DRAW);
+    offset = 0;
+    access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+  }
+
+  void *pointer = glMapBufferRange(target, offset, bytes, access);
+  if (pointer == nullptr) {
+    std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED " << bytes << " bytes"
+              << std::endl;
+    return nullptr;
+  }
+  mapped = true;
+  mappedOffset = offset;
+  head = offset + bytes;
+  return pointer;
+}
+
+size_t StreamBuffer::unmap() {
+  if (!mapped)
+    return mappedOffset;
+  mapped = false;
+  glBindBuffer(target, ID);
+  glUnmapBuffer(target);
+  return mappedOffset;
+}
+
+size_t StreamBuffer::write(const void *data, size_t bytes, size_t alignment) {
+  void *pointer = map(bytes, alignment);
+  if (pointer == nullptr)
+    return 0;
+  std::memcpy(pointer, data, bytes);
+  return unmap();
+}
@@ -0,0 +1,104 @@
+#include "UploadThread.h"
+#include "DebugOutput.h"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+UploadThread::UploadThread(GLFWwindow *mainWindow) {
+  // Ventana de 1x1 que nunca se muestra, solo la usamos por su contexto
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  window = glfwCreateWindow(1, 1, "upload", NULL, mainWindow);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+  if (window == NULL) {
+    std::cout << "ERROR::UPLOAD_THREAD::CONTEXT_CREATION_FAILED" << std::endl;
+    return;
+  }
+  thread = std::thread(&UploadThread::loop, this);
+  isValid = true;
+}
+
+UploadThread::~UploadThread() {
+  if (thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wakeUp.notify_one();
+    thread.join();
+  }
+  if (window != NULL)
+    glfwDestroyWindow(window);
+}
+
+void UploadThread::submit(UploadFunction upload, ReadyFunction ready) {
+  pending++;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.push_back(Upload{std::move(upload), std::move(ready)});
+  }
+  wakeUp.notify_one();
+}
+
+size_t UploadThread::collect() {
+  std::vector<Upload> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < finished.size();) {
+      // Timeout 0: solo consulta, nunca espera a la GPU
+      GLenum status = glClientWaitSync(finished[i].fence, 0, 0);
+      if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        done.push_back(std::move(finished[i]));
+        finished[i] = std::move(finished.back());
+        finished.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+
+  for (Upload &upload : done) {
+    glDeleteSync(upload.fence);
+    if (upload.ready)
+      upload.ready();
+    pending--;
+  }
+  return done.size();
+}
+
+void UploadThread::loop() {
+  glfwMakeContextCurrent(window);
+  // Con --gl-debug las subidas tambien reportan, en su GL_DEBUG_SITE
+  if (DebugOutput::installed())
+    DebugOutput::install();
+
+  while (true) {
+    Upload upload;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wakeUp.wait(lock, [&] { return stopping || !queued.empty(); });
+      if (stopping)
+        break;
+      upload = std::move(queued.front());
+      queued.pop_front();
+    }
+
+    upload.upload();
+    // Restauramos los binds para que la siguiente subida empiece limpia
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Sin flush la fence podria no llegar nunca a la GPU y el otro
+    // contexto la esperaria para siempre
+    glFlush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished.push_back(std::move(upload));
+  }
+
+  // Nadie va a consultar estas fences
+  for (Upload &upload : finished)
+    glDeleteSync(upload.fence);
+  finished.clear();
+  glfwMakeContextCurrent(NULL);
+}
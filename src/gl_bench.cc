@@ -0,0 +1,830 @@
+#include "ClusteredLighting.h"
+#include "FrustumCuller.h"
+#include "GpuDrivenRenderer.h"
+#include "HeadlessContext.h"
+#include "InstancedMesh.h"
+#include "OcclusionCuller.h"
+#include "Percentiles.h"
+#include "Shader.h"
+#include "SpriteBatch.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* gl-bench: mide frame time de CPU y GPU en escenarios sinteticos.
+ *
+ *   gl-bench [--headless] [--size WxH] [--frames N] [--warmup N]
+ *            [--count N] [--scenario quads|shader_switch|texture_bind|
+ *            uniform_update|instanced|sprites|gpu_driven|cull|occlusion|
+ *            lights|lights_cpu|all]
+ *            [--output gl-bench.json]
+ *
+ * Cada escenario hace `count` operaciones por frame y corre `frames` frames
+ * despues de `warmup` frames que no se miden. El tiempo de CPU es el del
+ * frame completo (incluye swap, o la espera de la fence en headless). El de
+ * GPU sale de dos glQueryCounter(GL_TIMESTAMP) por frame, que se leen recien
+ * al final para no frenar el loop.
+ *
+ * `instanced` dibuja los mismos quads que `quads` con un solo
+ * glDrawElementsInstanced de InstancedMesh, cada uno con una capa distinta
+ * del arreglo de texturas; las instancias se escriben directo en el
+ * StreamBuffer mapeado. `sprites` manda los mismos quads por SpriteBatch
+ * en 4 capas de profundidad, alternando entre el arreglo de tableros y un
+ * disco semitransparente: el batch los junta en un draw por capa y textura.
+ *
+ * `gpu_driven` reparte `count` quads en un cubo alrededor de una camara que
+ * gira; GpuDrivenRenderer los descarta en un compute shader y dibuja los
+ * visibles con un solo multi-draw indirecto. Necesita GL 4.3 y
+ * GL_ARB_shader_draw_parameters; si no estan, el escenario se saltea.
+ *
+ * `cull` pasa count * 1000 cajas (un millon por defecto) por FrustumCuller
+ * con una camara que gira, y dibuja un solo quad: el frame time de CPU es
+ * el del culling. `occlusion` usa las mismas cajas entre una grilla de
+ * edificios: frustum culling, los edificios rasterizados como oclusores en
+ * OcclusionCuller y la prueba de las cajas que pasaron el frustum.
+ *
+ * `lights` ilumina un piso de 200x200 con `count` luces puntuales y spot
+ * usando ClusteredLighting, con la asignacion a clusters en compute si hay
+ * GL 4.3; `lights_cpu` es lo mismo con la asignacion en la CPU. */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int PROGRAM_COUNT = 8;
+const int TEXTURE_COUNT = 16;
+// Frames que dejamos adelantarse a la CPU, como un swap chain doble
+const int FRAMES_IN_FLIGHT = 2;
+// Objetos por unidad de --count en el escenario de culling
+const int CULL_OBJECTS_PER_COUNT = 1000;
+// Camara de los escenarios de luces
+const float LIGHTS_FOV = 1.05f;
+const float LIGHTS_NEAR = 0.1f;
+const float LIGHTS_FAR = 150.0f;
+
+struct BenchOptions {
+  bool headless = false;
+  int width = 800;
+  int height = 600;
+  int frames = 500;
+  int warmup = 50;
+  int count = 1000;
+  std::string scenario = "all";
+  std::string output = "gl-bench.json";
+};
+
+struct ScenarioResult {
+  std::string name;
+  Percentiles cpu;
+  Percentiles gpu;
+};
+
+// Recursos compartidos por todos los escenarios
+struct BenchScene {
+  std::vector<std::unique_ptr<Shader>> programs;
+  std::vector<GLint> rectLocations;
+  std::vector<GLint> tintLocations;
+  std::vector<unsigned int> textures;
+  // Las mismas texturas como capas de un GL_TEXTURE_2D_ARRAY
+  unsigned int textureArray = 0;
+  unsigned int VAO = 0, VBO = 0, EBO = 0;
+  // Solo si se corre el escenario instanced; VAO propio sobre el mismo quad
+  unsigned int instancedVAO = 0;
+  std::unique_ptr<Shader> instancedProgram;
+  std::unique_ptr<InstancedMesh> instanced;
+  // Solo si se corre el escenario sprites
+  std::unique_ptr<SpriteBatch> sprites;
+  unsigned int discTexture = 0; // arreglo de una capa
+  // Solo si se corre gpu_driven y el contexto lo soporta
+  std::unique_ptr<Shader> gpuDrivenProgram;
+  std::unique_ptr<GpuDrivenRenderer> gpuDriven;
+  // Solo si se corren los escenarios de culling
+  std::unique_ptr<FrustumCuller> culler;
+  std::unique_ptr<OcclusionCuller> occlusion;
+  std::vector<Mat4> buildings; // cubo unitario -> edificio
+  mutable std::vector<uint32_t> unoccluded;
+  // Solo si se corren los escenarios de luces
+  int width = 0, height = 0;
+  std::unique_ptr<Shader> clusteredProgram;
+  std::unique_ptr<ClusteredLighting> lighting;    // compute si se puede
+  std::unique_ptr<ClusteredLighting> lightingCPU;
+};
+
+bool setupScene(BenchScene &scene) {
+  // El mismo programa compilado varias veces: para el driver son programas
+  // distintos, que es lo que necesita el escenario de cambios de shader
+  for (int i = 0; i < PROGRAM_COUNT; i++) {
+    std::unique_ptr<Shader> program = std::make_unique<Shader>(
+        "shaders/bench.vert", "shaders/bench.frag");
+    if (!program->isValid)
+      return false;
+    program->use();
+    program->setInt("texture1", 0);
+    scene.rectLocations.push_back(program->getUniformLocation("rect"));
+    scene.tintLocations.push_back(program->getUniformLocation("tint"));
+    glUniform4f(scene.tintLocations.back(), 1.0f, 1.0f, 1.0f, 1.0f);
+    scene.programs.push_back(std::move(program));
+  }
+
+  // Mismo quad que textures.cc
+  float vertices[] = {
+      // positions          // colors           // texture coords
+      0.5f,  0.5f,  0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // top right
+      0.5f,  -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // bottom right
+      -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // bottom left
+      -0.5f, 0.5f,  0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f  // top left
+  };
+  unsigned int indices[] = {0, 1, 3, 1, 2, 3};
+
+  glGenVertexArrays(1, &scene.VAO);
+  glGenBuffers(1, &scene.VBO);
+  glGenBuffers(1, &scene.EBO);
+  glBindVertexArray(scene.VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, scene.VBO);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+               GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)(6 * sizeof(float)));
+  glEnableVertexAttribArray(2);
+  glBindVertexArray(0);
+
+  // Texturas generadas (tablero de 64x64 de distinto color), asi el
+  // benchmark no depende de los assets ni del decodificador de imagenes
+  std::vector<unsigned char> pixels(64 * 64 * 4 * TEXTURE_COUNT);
+  scene.textures.resize(TEXTURE_COUNT);
+  glGenTextures(TEXTURE_COUNT, scene.textures.data());
+  for (int t = 0; t < TEXTURE_COUNT; t++) {
+    unsigned char *layer = &pixels[t * 64 * 64 * 4];
+    for (int y = 0; y < 64; y++)
+      for (int x = 0; x < 64; x++) {
+        unsigned char *p = &layer[(y * 64 + x) * 4];
+        bool dark = ((x / 8) + (y / 8)) % 2 == 0;
+        p[0] = (unsigned char)(dark ? 40 : 40 + t * 13);
+        p[1] = (unsigned char)(dark ? 40 : 200 - t * 9);
+        p[2] = (unsigned char)(dark ? 40 : 120);
+        p[3] = 255;
+      }
+    glBindTexture(GL_TEXTURE_2D, scene.textures[t]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, layer);
+    glGenerateMipmap(GL_TEXTURE_2D);
+  }
+
+  glGenTextures(1, &scene.textureArray);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, scene.textureArray);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, 64, 64, TEXTURE_COUNT, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  return true;
+}
+
+// El quad de setupScene en otro VAO, al que InstancedMesh le agrega los
+// atributos por instancia
+bool setupInstancing(BenchScene &scene, size_t instances) {
+  scene.instancedProgram = std::make_unique<Shader>(
+      "shaders/instanced.vert", "shaders/instanced.frag");
+  if (!scene.instancedProgram->isValid)
+    return false;
+  scene.instancedProgram->use();
+  scene.instancedProgram->setInt("textureArray", 0);
+
+  glGenVertexArrays(1, &scene.instancedVAO);
+  glBindVertexArray(scene.instancedVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, scene.VBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.EBO);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                        (void *)(6 * sizeof(float)));
+  glEnableVertexAttribArray(2);
+  glBindVertexArray(0);
+  scene.instanced =
+      std::make_unique<InstancedMesh>(scene.instancedVAO, 6, instances);
+  return true;
+}
+
+// Cajas al azar (siempre las mismas) en un cubo de 200 unidades alrededor
+// de la camara
+void setupCulling(BenchScene &scene, size_t objects) {
+  scene.culler = std::make_unique<FrustumCuller>();
+  scene.culler->reserve(objects);
+  uint32_t seed = 12345;
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+  };
+  for (size_t i = 0; i < objects; i++) {
+    Vec3 center(next() * 200.0f - 100.0f, next() * 200.0f - 100.0f,
+                next() * 200.0f - 100.0f);
+    Vec3 extent(0.1f + next() * 2.0f, 0.1f + next() * 2.0f,
+                0.1f + next() * 2.0f);
+    scene.culler->add(center - extent, center + extent);
+  }
+}
+
+// Edificios de 10 x 20-40 x 10 en una grilla de 8x8 cada 20 unidades; la
+// camara queda en la calle del medio
+void setupOcclusion(BenchScene &scene) {
+  scene.occlusion = std::make_unique<OcclusionCuller>();
+  for (int z = -4; z < 4; z++)
+    for (int x = -4; x < 4; x++) {
+      float height = 20.0f + (float)((x * 7 + z * 13) & 7) * 2.5f;
+      scene.buildings.push_back(
+          Mat4::translate(Vec3(x * 20.0f + 10.0f, height * 0.5f - 2.0f,
+                               z * 20.0f + 10.0f)) *
+          Mat4::scale(Vec3(10.0f, height, 10.0f)));
+    }
+}
+
+// Luces al azar (siempre las mismas) sobre el piso de 200x200; una de cada
+// cuatro es un spot que apunta hacia abajo
+bool setupLighting(BenchScene &scene, size_t lights, int width, int height) {
+  scene.clusteredProgram = std::make_unique<Shader>(
+      "shaders/clustered.vert", "shaders/clustered.frag");
+  if (!scene.clusteredProgram->isValid)
+    return false;
+  scene.clusteredProgram->use();
+  scene.clusteredProgram->setInt("texture1", 0);
+  glUniform3f(scene.clusteredProgram->getUniformLocation("ambient"), 0.05f,
+              0.05f, 0.05f);
+  scene.width = width;
+  scene.height = height;
+
+  uint32_t seed = 4242;
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+  };
+  std::vector<ClusterLight> data(lights);
+  for (size_t i = 0; i < lights; i++) {
+    ClusterLight &light = data[i];
+    light.position[0] = next() * 200.0f - 100.0f;
+    light.position[1] = 0.5f + next() * 3.5f;
+    light.position[2] = next() * 200.0f - 100.0f;
+    light.range = 3.0f + next() * 7.0f;
+    for (int c = 0; c < 3; c++)
+      light.color[c] = 0.5f + next() * 1.5f;
+    light.direction[0] = 0.0f;
+    light.direction[1] = -1.0f;
+    light.direction[2] = 0.0f;
+    bool spot = i % 4 == 3;
+    light.spotInner = spot ? 0.94f : 0.0f;  // ~20 grados
+    light.spotOuter = spot ? 0.82f : -2.0f; // ~35 grados
+  }
+  scene.lighting = std::make_unique<ClusteredLighting>(lights);
+  scene.lightingCPU = std::make_unique<ClusteredLighting>(lights, 32, false);
+  scene.lighting->setLights(data.data(), data.size());
+  scene.lightingCPU->setLights(data.data(), data.size());
+  return scene.lighting->isValid && scene.lightingCPU->isValid;
+}
+
+// Disco blanco con borde transparente, subido con createTextureArray
+void setupSprites(BenchScene &scene, size_t sprites) {
+  scene.sprites = std::make_unique<SpriteBatch>(sprites);
+  std::vector<unsigned char> disc(64 * 64 * 4, 255);
+  for (int y = 0; y < 64; y++)
+    for (int x = 0; x < 64; x++) {
+      float dx = x - 31.5f, dy = y - 31.5f;
+      disc[(y * 64 + x) * 4 + 3] = dx * dx + dy * dy < 32.0f * 32.0f ? 160 : 0;
+    }
+  scene.discTexture = SpriteBatch::createTextureArray(disc.data(), 64, 64);
+}
+
+// Quads al azar (siempre los mismos) en un cubo de 60 unidades alrededor de
+// la camara. False sin soporte en el contexto: el escenario se saltea
+bool setupGpuDriven(BenchScene &scene, size_t objects) {
+  if (!GpuDrivenRenderer::supported())
+    return false;
+  scene.gpuDrivenProgram = std::make_unique<Shader>(
+      "shaders/gpu_driven.vert", "shaders/gpu_driven.frag");
+  scene.gpuDriven = std::make_unique<GpuDrivenRenderer>(objects);
+  if (!scene.gpuDrivenProgram->isValid || !scene.gpuDriven->isValid)
+    return false;
+  scene.gpuDrivenProgram->use();
+  scene.gpuDrivenProgram->setInt("texture1", 0);
+
+  uint32_t seed = 777;
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+  };
+  std::vector<GpuObject> data(objects);
+  for (GpuObject &object : data) {
+    Vec3 center(next() * 60.0f - 30.0f, next() * 60.0f - 30.0f,
+                next() * 60.0f - 30.0f);
+    Mat4 model = Mat4::translate(center) * Mat4::scale(Vec3(2.0f, 2.0f, 1.0f));
+    std::memset(&object, 0, sizeof(object));
+    object.center[0] = center.x;
+    object.center[1] = center.y;
+    object.center[2] = center.z;
+    object.radius = 1.5f; // media diagonal del quad de 2x2
+    object.indexCount = 6;
+    std::memcpy(object.model, model.m, sizeof(object.model));
+  }
+  scene.gpuDriven->setObjects(data.data(), data.size());
+  return true;
+}
+
+void releaseScene(BenchScene &scene) {
+  glDeleteTextures((GLsizei)scene.textures.size(), scene.textures.data());
+  glDeleteTextures(1, &scene.textureArray);
+  scene.instanced.reset();
+  if (scene.instancedProgram)
+    glDeleteProgram(scene.instancedProgram->ID);
+  glDeleteVertexArrays(1, &scene.instancedVAO);
+  scene.sprites.reset();
+  glDeleteTextures(1, &scene.discTexture);
+  scene.gpuDriven.reset();
+  if (scene.gpuDrivenProgram)
+    glDeleteProgram(scene.gpuDrivenProgram->ID);
+  glDeleteVertexArrays(1, &scene.VAO);
+  glDeleteBuffers(1, &scene.VBO);
+  glDeleteBuffers(1, &scene.EBO);
+  for (std::unique_ptr<Shader> &program : scene.programs)
+    glDeleteProgram(program->ID);
+  scene.programs.clear();
+  if (scene.clusteredProgram)
+    glDeleteProgram(scene.clusteredProgram->ID);
+  scene.lighting.reset();
+  scene.lightingCPU.reset();
+}
+
+// Quad `i` de `count` en una grilla que cubre toda la pantalla
+void gridRect(int i, int count, float rect[4]) {
+  int columns = 1;
+  while (columns * columns < count)
+    columns++;
+  float cell = 2.0f / columns;
+  rect[0] = -1.0f + cell * (i % columns + 0.5f);
+  rect[1] = -1.0f + cell * (i / columns + 0.5f);
+  rect[2] = cell;
+  rect[3] = cell;
+}
+
+void drawScenario(const std::string &name, const BenchScene &scene,
+                  int count, int frame) {
+  float rect[4];
+  glBindVertexArray(scene.VAO);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, scene.textures[0]);
+  scene.programs[0]->use();
+
+  if (name == "quads") {
+    // N quads texturados, un draw por quad
+    for (int i = 0; i < count; i++) {
+      gridRect(i, count, rect);
+      glUniform4fv(scene.rectLocations[0], 1, rect);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+  } else if (name == "shader_switch") {
+    for (int i = 0; i < count; i++) {
+      int program = i % PROGRAM_COUNT;
+      scene.programs[program]->use();
+      gridRect(i, count, rect);
+      glUniform4fv(scene.rectLocations[program], 1, rect);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+  } else if (name == "texture_bind") {
+    for (int i = 0; i < count; i++) {
+      glBindTexture(GL_TEXTURE_2D, scene.textures[i % TEXTURE_COUNT]);
+      gridRect(i, count, rect);
+      glUniform4fv(scene.rectLocations[0], 1, rect);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+  } else if (name == "instanced") {
+    // Los mismos quads que "quads" en un solo draw
+    scene.instancedProgram->use();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, scene.textureArray);
+    InstanceData *instances = scene.instanced->beginInstances(count);
+    if (instances != nullptr) {
+      for (int i = 0; i < count; i++) {
+        InstanceData &instance = instances[i];
+        gridRect(i, count, rect);
+        std::memset(&instance, 0, sizeof(instance));
+        instance.transform[0] = rect[2];
+        instance.transform[5] = rect[3];
+        instance.transform[10] = 1.0f;
+        instance.transform[12] = rect[0];
+        instance.transform[13] = rect[1];
+        instance.transform[15] = 1.0f;
+        instance.uvRect[2] = 1.0f;
+        instance.uvRect[3] = 1.0f;
+        for (int c = 0; c < 4; c++)
+          instance.tint[c] = 1.0f;
+        instance.layer = (float)(i % TEXTURE_COUNT);
+      }
+    }
+    scene.instanced->endInstances(count);
+  } else if (name == "sprites") {
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0,
+                                       0, 0, 1, 0, 0, 0, 0, 1};
+    static const float fullUv[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    static const uint8_t white[4] = {255, 255, 255, 255};
+    scene.sprites->begin(identity);
+    for (int i = 0; i < count; i++) {
+      gridRect(i, count, rect);
+      bool disc = i % 2 == 1;
+      scene.sprites->draw(disc ? scene.discTexture : scene.textureArray,
+                          disc ? 0.0f : (float)(i % TEXTURE_COUNT),
+                          rect[0] - rect[2] * 0.5f, rect[1] - rect[3] * 0.5f,
+                          rect[2], rect[3], fullUv, white, (uint16_t)(i % 4));
+    }
+    scene.sprites->end();
+  } else if (name == "gpu_driven") {
+    float angle = frame * 0.01f;
+    Mat4 viewProjection =
+        Mat4::perspective(1.05f, 4.0f / 3.0f, 0.1f, 150.0f) *
+        Mat4::lookAt(Vec3(0.0f, 0.0f, 0.0f),
+                     Vec3(std::sin(angle), 0.2f, std::cos(angle)),
+                     Vec3(0.0f, 1.0f, 0.0f));
+    scene.gpuDriven->cull(Frustum::fromMatrix(viewProjection));
+    scene.gpuDrivenProgram->use();
+    scene.gpuDrivenProgram->setMat4("viewProjection", viewProjection.m);
+    scene.gpuDriven->draw(scene.VAO);
+  } else if (name == "cull") {
+    float angle = frame * 0.01f;
+    Mat4 viewProjection =
+        Mat4::perspective(1.05f, 4.0f / 3.0f, 0.1f, 150.0f) *
+        Mat4::lookAt(Vec3(0.0f, 0.0f, 0.0f),
+                     Vec3(std::sin(angle), 0.2f, std::cos(angle)),
+                     Vec3(0.0f, 1.0f, 0.0f));
+    size_t visible =
+        scene.culler->cull(Frustum::fromMatrix(viewProjection));
+    // Un quad con el tinte segun la fraccion visible, para usar el resultado
+    float value = (float)visible / (float)scene.culler->size();
+    glUniform4f(scene.tintLocations[0], value, value, 1.0f, 1.0f);
+    float fullscreen[4] = {0.0f, 0.0f, 2.0f, 2.0f};
+    glUniform4fv(scene.rectLocations[0], 1, fullscreen);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  } else if (name == "occlusion") {
+    static const float cube[] = {-0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f,
+                                 0.5f,  0.5f,  -0.5f, -0.5f, 0.5f, -0.5f,
+                                 -0.5f, -0.5f, 0.5f,  0.5f, -0.5f, 0.5f,
+                                 0.5f,  0.5f,  0.5f,  -0.5f, 0.5f, 0.5f};
+    static const uint32_t cubeIndices[] = {
+        0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 0, 4, 5, 0, 5, 1,
+        3, 2, 6, 3, 6, 7, 0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2};
+    float angle = frame * 0.01f;
+    Mat4 viewProjection =
+        Mat4::perspective(1.05f, 4.0f / 3.0f, 0.1f, 150.0f) *
+        Mat4::lookAt(Vec3(0.0f, 0.0f, 0.0f),
+                     Vec3(std::sin(angle), 0.0f, std::cos(angle)),
+                     Vec3(0.0f, 1.0f, 0.0f));
+    scene.culler->cull(Frustum::fromMatrix(viewProjection));
+    scene.occlusion->beginFrame(viewProjection);
+    for (const Mat4 &building : scene.buildings)
+      scene.occlusion->addOccluder(cube, 3, cubeIndices, 36, building);
+    scene.occlusion->rasterize();
+    size_t visible = scene.occlusion->cull(
+        *scene.culler, scene.culler->visible, scene.unoccluded);
+    float value = (float)visible / (float)scene.culler->size();
+    glUniform4f(scene.tintLocations[0], value, value, 1.0f, 1.0f);
+    float fullscreen[4] = {0.0f, 0.0f, 2.0f, 2.0f};
+    glUniform4fv(scene.rectLocations[0], 1, fullscreen);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  } else if (name == "lights" || name == "lights_cpu") {
+    ClusteredLighting &lighting =
+        name == "lights" ? *scene.lighting : *scene.lightingCPU;
+    float angle = frame * 0.01f;
+    float aspect = (float)scene.width / (float)scene.height;
+    Mat4 view = Mat4::lookAt(Vec3(0.0f, 3.0f, 0.0f),
+                             Vec3(std::sin(angle), 2.6f, std::cos(angle)),
+                             Vec3(0.0f, 1.0f, 0.0f));
+    Mat4 projection =
+        Mat4::perspective(LIGHTS_FOV, aspect, LIGHTS_NEAR, LIGHTS_FAR);
+    lighting.update(view, LIGHTS_FOV, aspect, LIGHTS_NEAR, LIGHTS_FAR);
+
+    Shader &program = *scene.clusteredProgram;
+    program.use();
+    GLint transformRows = program.getUniformLocation("transformRows");
+    lighting.bind(program, scene.width, scene.height);
+    program.setMat4("view", view.m);
+    program.setMat4("projection", projection.m);
+    // Piso de 20x20 quads de 10 unidades: el quad va del plano XY al XZ
+    Mat4 model;
+    model.at(0, 0) = 10.0f;
+    model.at(1, 1) = 0.0f;
+    model.at(2, 1) = -10.0f;
+    model.at(1, 2) = 1.0f;
+    model.at(2, 2) = 0.0f;
+    for (int z = 0; z < 20; z++)
+      for (int x = 0; x < 20; x++) {
+        model.at(0, 3) = x * 10.0f - 95.0f;
+        model.at(2, 3) = z * 10.0f - 95.0f;
+        float rows[12];
+        for (int row = 0; row < 3; row++)
+          for (int col = 0; col < 4; col++)
+            rows[row * 4 + col] = model.at(row, col);
+        glUniform4fv(transformRows, 3, rows);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+      }
+  } else if (name == "uniform_update") {
+    // Solo el costo de subir uniforms: N updates y un unico draw
+    for (int i = 0; i < count; i++) {
+      float value = (float)((i + frame) % 256) / 255.0f;
+      glUniform4f(scene.tintLocations[0], value, 1.0f - value, 1.0f, 1.0f);
+    }
+    float fullscreen[4] = {0.0f, 0.0f, 2.0f, 2.0f};
+    glUniform4fv(scene.rectLocations[0], 1, fullscreen);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  }
+}
+
+ScenarioResult runScenario(const std::string &name, const BenchScene &scene,
+                           const BenchOptions &options, GLFWwindow *window,
+                           HeadlessContext *headless) {
+  int total = options.warmup + options.frames;
+  std::vector<GLuint> queries(options.frames * 2);
+  glGenQueries((GLsizei)queries.size(), queries.data());
+  std::vector<double> cpuMs;
+  cpuMs.reserve(options.frames);
+  GLsync fences[FRAMES_IN_FLIGHT] = {};
+
+  for (int frame = 0; frame < total; frame++) {
+    int measured = frame - options.warmup;
+    Clock::time_point start = Clock::now();
+
+    if (headless != nullptr)
+      headless->bindFramebuffer();
+    if (measured >= 0)
+      glQueryCounter(queries[measured * 2], GL_TIMESTAMP);
+
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawScenario(name, scene, options.count, frame);
+
+    if (measured >= 0)
+      glQueryCounter(queries[measured * 2 + 1], GL_TIMESTAMP);
+
+    if (window != NULL) {
+      glfwSwapBuffers(window);
+      glfwPollEvents();
+    } else {
+      // Sin swap la CPU podria encolar frames sin limite; esperamos al
+      // frame de hace FRAMES_IN_FLIGHT como lo haria un swap chain
+      GLsync &fence = fences[frame % FRAMES_IN_FLIGHT];
+      if (fence != nullptr) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(fence);
+      }
+      fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+    }
+
+    if (measured >= 0)
+      cpuMs.push_back(std::chrono::duration<double, std::milli>(
+                          Clock::now() - start)
+                          .count());
+  }
+
+  glFinish();
+  for (GLsync fence : fences)
+    if (fence != nullptr)
+      glDeleteSync(fence);
+
+  std::vector<double> gpuMs;
+  gpuMs.reserve(options.frames);
+  for (int i = 0; i < options.frames; i++) {
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(queries[i * 2], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+    gpuMs.push_back((end - begin) / 1.0e6);
+  }
+  glDeleteQueries((GLsizei)queries.size(), queries.data());
+
+  ScenarioResult result;
+  result.name = name;
+  result.cpu = computePercentiles(cpuMs);
+  result.gpu = computePercentiles(gpuMs);
+  return result;
+}
+
+void writePercentiles(FILE *file, const char *name,
+                      const Percentiles &values) {
+  std::fprintf(file,
+               "\"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, "
+               "\"p99\": %.4f}",
+               name, values.mean, values.p50, values.p95, values.p99);
+}
+
+bool writeReport(const BenchOptions &options,
+                 const std::vector<ScenarioResult> &results) {
+  FILE *file = std::fopen(options.output.c_str(), "w");
+  if (file == NULL) {
+    std::cout << "ERROR::BENCH::CANNOT_OPEN " << options.output << std::endl;
+    return false;
+  }
+
+  // Las cadenas del driver no tienen comillas ni barras en la practica
+  std::fprintf(file, "{\n  \"renderer\": \"%s\",\n  \"version\": \"%s\",\n",
+               (const char *)glGetString(GL_RENDERER),
+               (const char *)glGetString(GL_VERSION));
+  std::fprintf(file,
+               "  \"headless\": %s,\n  \"width\": %d,\n  \"height\": %d,\n"
+               "  \"frames\": %d,\n  \"warmup\": %d,\n  \"count\": %d,\n"
+               "  \"unit\": \"ms\",\n  \"scenarios\": [\n",
+               options.headless ? "true" : "false", options.width,
+               options.height, options.frames, options.warmup, options.count);
+  for (size_t i = 0; i < results.size(); i++) {
+    std::fprintf(file, "    {\"name\": \"%s\", ", results[i].name.c_str());
+    writePercentiles(file, "cpu", results[i].cpu);
+    std::fprintf(file, ", ");
+    writePercentiles(file, "gpu", results[i].gpu);
+    std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+  return std::fclose(file) == 0;
+}
+
+GLFWwindow *createBenchWindow(int width, int height) {
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  GLFWwindow *window = glfwCreateWindow(width, height, "gl-bench", NULL, NULL);
+  if (window == NULL) {
+    std::cout << "Fail to create GLFW window (try --headless)" << std::endl;
+    glfwTerminate();
+    return NULL;
+  }
+  glfwMakeContextCurrent(window);
+  // Sin vsync: queremos el frame time real, no el del monitor
+  glfwSwapInterval(0);
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    std::cout << "Fail to initialize GLAD" << std::endl;
+    glfwTerminate();
+    return NULL;
+  }
+  return window;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--headless") {
+      options.headless = true;
+    } else if (argument == "--size" && hasValue) {
+      std::sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+    } else if (argument == "--frames" && hasValue) {
+      options.frames = std::max(1, std::atoi(argv[++i]));
+    } else if (argument == "--warmup" && hasValue) {
+      options.warmup = std::max(0, std::atoi(argv[++i]));
+    } else if (argument == "--count" && hasValue) {
+      options.count = std::max(1, std::atoi(argv[++i]));
+    } else if (argument == "--scenario" && hasValue) {
+      options.scenario = argv[++i];
+    } else if (argument == "--output" && hasValue) {
+      options.output = argv[++i];
+    } else {
+      std::cout << "Unknown argument " << argument << std::endl;
+      return -1;
+    }
+  }
+
+  const char *allScenarios[] = {"quads", "shader_switch", "texture_bind",
+                                "uniform_update", "instanced", "sprites",
+                                "gpu_driven", "cull", "occlusion", "lights",
+                                "lights_cpu"};
+  std::vector<std::string> scenarios;
+  for (const char *name : allScenarios)
+    if (options.scenario == "all" || options.scenario == name)
+      scenarios.push_back(name);
+  if (scenarios.empty()) {
+    std::cout << "Unknown scenario " << options.scenario << std::endl;
+    return -1;
+  }
+
+  GLFWwindow *window = NULL;
+  std::unique_ptr<HeadlessContext> headless;
+  if (options.headless) {
+    headless = std::make_unique<HeadlessContext>(options.width,
+                                                 options.height);
+    if (!headless->isValid)
+      return -1;
+  } else {
+    window = createBenchWindow(options.width, options.height);
+    if (window == NULL)
+      return -1;
+    glViewport(0, 0, options.width, options.height);
+  }
+
+  BenchScene scene;
+  if (!setupScene(scene)) {
+    std::cout << "ERROR::BENCH::SETUP_FAILED" << std::endl;
+    return -1;
+  }
+  bool instancing = false, sprites = false, gpuDriven = false,
+       culling = false, occlusion = false, lights = false;
+  for (const std::string &name : scenarios) {
+    gpuDriven = gpuDriven || name == "gpu_driven";
+    instancing = instancing || name == "instanced";
+    sprites = sprites || name == "sprites";
+    culling = culling || name == "cull" || name == "occlusion";
+    occlusion = occlusion || name == "occlusion";
+    lights = lights || name == "lights" || name == "lights_cpu";
+  }
+  if (instancing && !setupInstancing(scene, (size_t)options.count)) {
+    std::cout << "ERROR::BENCH::INSTANCED_SETUP_FAILED" << std::endl;
+    return -1;
+  }
+  if (sprites)
+    setupSprites(scene, (size_t)options.count);
+  if (gpuDriven && !setupGpuDriven(scene, (size_t)options.count)) {
+    if (scene.gpuDriven) {
+      std::cout << "ERROR::BENCH::GPU_DRIVEN_SETUP_FAILED" << std::endl;
+      return -1;
+    }
+    std::cout << "BENCH::GPU_DRIVEN skipped, needs GL 4.3 and "
+                 "GL_ARB_shader_draw_parameters"
+              << std::endl;
+  }
+  if (culling) {
+    setupCulling(scene, (size_t)options.count * CULL_OBJECTS_PER_COUNT);
+    std::cout << "BENCH::CULL " << scene.culler->size() << " objects | "
+              << FrustumCuller::implementation() << std::endl;
+  }
+  if (occlusion) {
+    setupOcclusion(scene);
+    std::cout << "BENCH::OCCLUSION " << scene.buildings.size()
+              << " occluders | " << scene.occlusion->width << "x"
+              << scene.occlusion->height << " "
+              << OcclusionCuller::implementation() << std::endl;
+  }
+  if (lights) {
+    if (!setupLighting(scene, (size_t)options.count, options.width,
+                       options.height)) {
+      std::cout << "ERROR::BENCH::LIGHTS_SETUP_FAILED" << std::endl;
+      return -1;
+    }
+    std::cout << "BENCH::LIGHTS " << scene.lighting->lightCount
+              << " lights | grid " << ClusteredLighting::GRID_X << "x"
+              << ClusteredLighting::GRID_Y << "x"
+              << ClusteredLighting::GRID_Z << " | lights: "
+              << (scene.lighting->useCompute ? "compute" : "cpu")
+              << " binning" << std::endl;
+  }
+
+  std::vector<ScenarioResult> results;
+  for (const std::string &name : scenarios) {
+    if (name == "gpu_driven" && !scene.gpuDriven)
+      continue;
+    ScenarioResult result =
+        runScenario(name, scene, options, window, headless.get());
+    std::cout << "BENCH::" << name << " count " << options.count
+              << " | cpu mean " << result.cpu.mean << " p50 "
+              << result.cpu.p50 << " p95 " << result.cpu.p95 << " p99 "
+              << result.cpu.p99 << " ms | gpu mean " << result.gpu.mean
+              << " p50 " << result.gpu.p50 << " p95 " << result.gpu.p95
+              << " p99 " << result.gpu.p99 << " ms" << std::endl;
+    if (name == "sprites")
+      std::cout << "BENCH::SPRITES " << scene.sprites->spriteCount
+                << " sprites in " << scene.sprites->drawCalls << " draws"
+                << std::endl;
+    results.push_back(result);
+  }
+
+  bool written = writeReport(options, results);
+  if (written)
+    std::cout << "BENCH::REPORT " << options.output << std::endl;
+
+  releaseScene(scene);
+  headless.reset();
+  if (window != NULL)
+    glfwTerminate();
+  return written ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+#include "GLTrace.h"
+#include "HeadlessContext.h"
+#include "Percentiles.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* gl-replay: reproduce una traza grabada con `OpenGL-project --record`.
+ *
+ *   gl-replay traza.gltrace [--headless] [--realtime] [--csv frames.csv]
+ *
+ * Por defecto ejecuta los frames lo mas rapido posible; con --realtime
+ * espera para que cada frame termine cuando termino al grabar. Al final
+ * imprime el costo por frame (CPU y GPU) y con --csv lo guarda frame por
+ * frame. */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Frames que dejamos adelantarse a la CPU en headless, como gl-bench
+const int FRAMES_IN_FLIGHT = 2;
+
+GLFWwindow *createReplayWindow(int width, int height) {
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+  GLFWwindow *window =
+      glfwCreateWindow(width, height, "gl-replay", NULL, NULL);
+  if (window == NULL) {
+    std::cout << "Fail to create GLFW window (try --headless)" << std::endl;
+    glfwTerminate();
+    return NULL;
+  }
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    std::cout << "Fail to initialize GLAD" << std::endl;
+    glfwTerminate();
+    return NULL;
+  }
+  return window;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const char *tracePath = NULL;
+  const char *csvPath = NULL;
+  bool headless = false;
+  bool realtime = false;
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    if (argument == "--headless") {
+      headless = true;
+    } else if (argument == "--realtime") {
+      realtime = true;
+    } else if (argument == "--csv" && i + 1 < argc) {
+      csvPath = argv[++i];
+    } else {
+      tracePath = argv[i];
+    }
+  }
+  if (tracePath == NULL) {
+    std::cout << "Usage: gl-replay trace.gltrace [--headless] [--realtime] "
+                 "[--csv frames.csv]"
+              << std::endl;
+    return -1;
+  }
+
+  GLTracePlayer player(tracePath);
+  if (!player.isValid)
+    return -1;
+
+  GLFWwindow *window = NULL;
+  std::unique_ptr<HeadlessContext> headlessContext;
+  if (headless) {
+    headlessContext =
+        std::make_unique<HeadlessContext>(player.width, player.height);
+    if (!headlessContext->isValid)
+      return -1;
+    player.defaultFramebuffer = headlessContext->framebuffer;
+    headlessContext->bindFramebuffer();
+  } else {
+    window = createReplayWindow(player.width, player.height);
+    if (window == NULL)
+      return -1;
+  }
+
+  std::vector<double> cpuMs;
+  std::vector<GLuint> queries;
+  GLsync fences[FRAMES_IN_FLIGHT] = {};
+  Clock::time_point replayStart = Clock::now();
+
+  while (!player.finished()) {
+    if (window != NULL && glfwWindowShouldClose(window))
+      break;
+    Clock::time_point start = Clock::now();
+    GLuint frameQueries[2];
+    glGenQueries(2, frameQueries);
+    glQueryCounter(frameQueries[0], GL_TIMESTAMP);
+
+    uint64_t recordedTimeNs = 0;
+    bool complete = player.playFrame(&recordedTimeNs);
+
+    glQueryCounter(frameQueries[1], GL_TIMESTAMP);
+    // Lo que queda despues del ultimo fin de frame (la limpieza al salir)
+    // no es un frame
+    if (!complete) {
+      glDeleteQueries(2, frameQueries);
+      break;
+    }
+    queries.push_back(frameQueries[0]);
+    queries.push_back(frameQueries[1]);
+
+    if (window != NULL) {
+      glfwSwapBuffers(window);
+      glfwPollEvents();
+    } else {
+      GLsync &fence = fences[cpuMs.size() % FRAMES_IN_FLIGHT];
+      if (fence != nullptr) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(fence);
+      }
+      fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+    }
+    cpuMs.push_back(
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count());
+
+    // Con --realtime el frame no termina antes que en la grabacion
+    if (realtime)
+      std::this_thread::sleep_until(
+          replayStart + std::chrono::nanoseconds(recordedTimeNs));
+  }
+
+  glFinish();
+  for (GLsync fence : fences)
+    if (fence != nullptr)
+      glDeleteSync(fence);
+
+  std::vector<double> gpuMs;
+  for (size_t i = 0; i + 1 < queries.size(); i += 2) {
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries[i + 1], GL_QUERY_RESULT, &end);
+    gpuMs.push_back((end - begin) / 1.0e6);
+  }
+  glDeleteQueries((GLsizei)queries.size(), queries.data());
+
+  if (csvPath != NULL) {
+    FILE *csv = std::fopen(csvPath, "w");
+    if (csv == NULL) {
+      std::cout << "ERROR::REPLAY::CANNOT_OPEN " << csvPath << std::endl;
+    } else {
+      std::fprintf(csv, "frame,cpu_ms,gpu_ms\n");
+      for (size_t i = 0; i < cpuMs.size(); i++)
+        std::fprintf(csv, "%zu,%.4f,%.4f\n", i, cpuMs[i], gpuMs[i]);
+      std::fclose(csv);
+    }
+  }
+
+  Percentiles cpu = computePercentiles(cpuMs);
+  Percentiles gpu = computePercentiles(gpuMs);
+  std::cout << "REPLAY::STATS " << cpuMs.size() << " frames "
+            << player.width << "x" << player.height << " | cpu mean "
+            << cpu.mean << " p50 " << cpu.p50 << " p95 " << cpu.p95
+            << " p99 " << cpu.p99 << " ms | gpu mean " << gpu.mean << " p50 "
+            << gpu.p50 << " p95 " << gpu.p95 << " p99 " << gpu.p99 << " ms"
+            << std::endl;
+
+  headlessContext.reset();
+  if (window != NULL)
+    glfwTerminate();
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include "MappedFile.h"
+#include "SceneCooker.h"
+#include "SceneImage.h"
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+/* scene-cook: convierte la descripcion JSON de una escena en la imagen
+ * binaria que carga SceneImage.
+ *
+ *   scene-cook escena.json escena.scene
+ *
+ * El build cocina las escenas de scenes/ a <build>/scenes/ (ver
+ * CMakeLists.txt). */
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cout << "Usage: scene-cook scene.json scene.scene" << std::endl;
+    return -1;
+  }
+
+  MappedFile source(argv[1]);
+  if (!source.isValid())
+    return -1;
+  std::vector<uint8_t> image;
+  if (!cookScene(reinterpret_cast<const char *>(source.data()), source.size(),
+                 image)) {
+    std::cout << "ERROR::SCENE_COOK::FAILED " << argv[1] << std::endl;
+    return -1;
+  }
+
+  FILE *output = std::fopen(argv[2], "wb");
+  if (output == NULL) {
+    std::cout << "ERROR::SCENE_COOK::CANNOT_OPEN " << argv[2] << std::endl;
+    return -1;
+  }
+  bool written =
+      std::fwrite(image.data(), 1, image.size(), output) == image.size();
+  if (std::fclose(output) != 0 || !written) {
+    std::cout << "ERROR::SCENE_COOK::WRITE_FAILED " << argv[2] << std::endl;
+    std::remove(argv[2]);
+    return -1;
+  }
+
+  const SceneHeader *header =
+      reinterpret_cast<const SceneHeader *>(image.data());
+  std::cout << "SCENE_COOK::DONE " << argv[2] << " " << image.size()
+            << " bytes | "
+            << header->sections[SCENE_MESHES].count << " meshes, "
+            << header->sections[SCENE_MATERIALS].count << " materials, "
+            << header->sections[SCENE_TEXTURES].count << " textures, "
+            << header->sections[SCENE_INSTANCES].count << " instances, "
+            << header->sections[SCENE_LODS].count << " LODs, "
+            << header->sections[SCENE_LIGHTS].count << " lights"
+            << std::endl;
+  return 0;
+}
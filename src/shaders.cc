@@ -1,15 +1,18 @@
 #include "Shader.h"
+#include "FrameClock.h"
 #include <ctime>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <ostream>
 
-void processInput(GLFWwindow *window);
+void processInput(GLFWwindow *window, float deltaTime);
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
 float xMove = 0.0f;
 float yMove = 0.0f;
+// Unidades NDC por segundo; equivale a los 0.005 por frame de antes a 60 Hz
+const float MOVE_SPEED = 0.3f;
 
 int main(int argc, char *argv[]) {
   /* Esto inicializa GLFW con sus valores predeterminados, retorna GLFW_TRUE si
@@ -124,10 +127,19 @@ int main(int argc, char *argv[]) {
 
   /* La condicion revisa en cada loop si hay una instruccion que va cerrar la
    * ventana */
+  FrameClock clock;
+  float previousXMove = xMove, previousYMove = yMove;
   while (!glfwWindowShouldClose(window)) {
 
     // --- Input ---
-    processInput(window);
+    // La simulacion avanza a paso fijo, el render a la velocidad que pueda
+    int steps = clock.advance(glfwGetTime());
+    for (int i = 0; i < steps; i++) {
+      previousXMove = xMove;
+      previousYMove = yMove;
+      processInput(window, (float)clock.fixedStep);
+    }
+    double alpha = clock.alpha();
 
     // -- Funciones de render ---
 
@@ -144,11 +156,12 @@ int main(int argc, char *argv[]) {
     // ourShader.use();
     // glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
     
-    float timeValue = glfwGetTime();
+    float timeValue = clock.simulationTime + alpha * clock.fixedStep;
 
     ourShader.use();
-    ourShader.setFloat("xOffset", xMove);
-    ourShader.setFloat("yOffset", yMove);
+    // Interpolamos entre los dos ultimos pasos para que no se vea a saltos
+    ourShader.setFloat("xOffset", interpolate(previousXMove, xMove, alpha));
+    ourShader.setFloat("yOffset", interpolate(previousYMove, yMove, alpha));
     ourShader.setFloat("time", timeValue);
 
     // ourShader.setColorRGB("customColor", colors[0], colors[1], colors[2]);
@@ -172,22 +185,22 @@ int main(int argc, char *argv[]) {
   return 0;
 }
 
-void processInput(GLFWwindow *window) {
+void processInput(GLFWwindow *window, float deltaTime) {
   /* Aqui verificamos si el ultimo estado del teclado ha sido presionado para
-   * una ventana especifica*/
-  if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+   * una ventana especifica. Cada tecla se revisa por separado, asi W+D mueve
+   * en diagonal, y la distancia depende de deltaTime y no del frame rate*/
+  if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
     glfwSetWindowShouldClose(window, true);
-  } else if (glfwGetKey(window, GLFW_KEY_W)) {
-    yMove += 0.005;
-  } else if (glfwGetKey(window, GLFW_KEY_A)) {
-    xMove -= 0.005;
-  } else if (glfwGetKey(window, GLFW_KEY_S)) {
-    yMove -= 0.005;
-  } else if (glfwGetKey(window, GLFW_KEY_D)) {
-    xMove += 0.005;
-  }
-
 
+  float step = MOVE_SPEED * deltaTime;
+  if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    yMove += step;
+  if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    xMove -= step;
+  if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    yMove -= step;
+  if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    xMove += step;
 }
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
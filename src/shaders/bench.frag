@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoord;
+
+uniform sampler2D texture1;
+uniform vec4 tint;
+
+void main() {
+  FragColor = texture(texture1, TexCoord) * tint;
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+// xy: centro en NDC, zw: escala
+uniform vec4 rect;
+
+void main() {
+  gl_Position = vec4(aPos.xy * rect.zw + rect.xy, aPos.z, 1.0);
+  TexCoord = aTexCoord;
+}
@@ -0,0 +1,58 @@
+#version 330 core
+out vec4 FragColor;
+in vec3 worldPosition;
+in float viewDepth;
+in vec2 TexCoord;
+
+uniform sampler2D texture1;
+uniform vec3 ambient;
+
+// Clusters y luces que arma ClusteredLighting (ver ClusteredLighting.h)
+uniform samplerBuffer clusterLights;   // 3 texels per light
+uniform usamplerBuffer clusterGrid;    // offset, count per cluster
+uniform usamplerBuffer clusterIndices;
+uniform ivec3 clusterGridSize;
+uniform vec2 clusterTileScale;      // tiles per pixel
+uniform vec2 clusterDepthScaleBias; // slice = log(depth) * x - y
+
+void main() {
+  // Normal de la cara a partir de las derivadas: sirve para cualquier malla
+  // aunque no tenga normales
+  vec3 normal = normalize(cross(dFdx(worldPosition), dFdy(worldPosition)));
+
+  ivec2 tile = min(ivec2(gl_FragCoord.xy * clusterTileScale),
+                   clusterGridSize.xy - 1);
+  int slice = int(log(viewDepth) * clusterDepthScaleBias.x -
+                  clusterDepthScaleBias.y);
+  slice = clamp(slice, 0, clusterGridSize.z - 1);
+  int cluster = (slice * clusterGridSize.y + tile.y) * clusterGridSize.x +
+                tile.x;
+  uvec2 range = texelFetch(clusterGrid, cluster).xy;
+
+  vec3 lighting = ambient;
+  for (uint i = 0u; i < range.y; i++) {
+    int light = int(texelFetch(clusterIndices, int(range.x + i)).x) * 3;
+    vec4 positionRange = texelFetch(clusterLights, light);
+    vec3 toLight = positionRange.xyz - worldPosition;
+    float lightDistance = length(toLight);
+    if (lightDistance >= positionRange.w)
+      continue;
+    vec4 colorSpotInner = texelFetch(clusterLights, light + 1);
+    vec4 directionSpotOuter = texelFetch(clusterLights, light + 2);
+    vec3 direction = toLight / lightDistance;
+
+    // Cae a cero justo en el alcance de la luz
+    float fade =
+        clamp(1.0 - pow(lightDistance / positionRange.w, 4.0), 0.0, 1.0);
+    float attenuation = fade * fade / (lightDistance * lightDistance + 1.0);
+    float spot = 1.0;
+    if (directionSpotOuter.w > -1.0)
+      spot = smoothstep(directionSpotOuter.w, colorSpotInner.w,
+                        dot(-direction, directionSpotOuter.xyz));
+    lighting += colorSpotInner.rgb * max(dot(normal, direction), 0.0) *
+                attenuation * spot;
+  }
+
+  vec4 albedo = texture(texture1, TexCoord);
+  FragColor = vec4(albedo.rgb * lighting, albedo.a);
+}
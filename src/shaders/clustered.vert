@@ -0,0 +1,25 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 worldPosition;
+out float viewDepth;
+out vec2 TexCoord;
+
+// Transformacion de la instancia, como en texture.vert
+uniform vec4 transformRows[3];
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+  vec4 position = vec4(aPos, 1.0);
+  vec4 world = vec4(dot(transformRows[0], position),
+                    dot(transformRows[1], position),
+                    dot(transformRows[2], position), 1.0);
+  vec4 viewPosition = view * world;
+  worldPosition = world.xyz;
+  // La camara mira hacia -z
+  viewDepth = -viewPosition.z;
+  TexCoord = aTexCoord;
+  gl_Position = projection * viewPosition;
+}
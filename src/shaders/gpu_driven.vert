@@ -0,0 +1,30 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 2) in vec2 aTexCoord;
+
+struct Object {
+  vec4 boundingSphere;
+  uint indexCount;
+  uint firstIndex;
+  int baseVertex;
+  uint padding;
+  mat4 model;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 2) readonly buffer Visible { uint visible[]; };
+
+out vec3 ourColor;
+out vec2 TexCoord;
+
+uniform mat4 viewProjection;
+
+void main() {
+  // Cada comando del multi-draw es un objeto visible distinto
+  Object object = objects[visible[gl_DrawIDARB]];
+  gl_Position = viewProjection * object.model * vec4(aPos, 1.0);
+  ourColor = aColor;
+  TexCoord = aTexCoord;
+}
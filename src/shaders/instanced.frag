@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+in vec3 ourColor;
+in vec2 TexCoord;
+in vec4 Tint;
+flat in float Layer;
+
+uniform sampler2DArray textureArray;
+
+void main() {
+  FragColor = texture(textureArray, vec3(TexCoord, Layer)) * Tint;
+}
@@ -0,0 +1,23 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColor;
+layout(location = 2) in vec2 aTexCoord;
+
+// Atributos por instancia (glVertexAttribDivisor = 1)
+layout(location = 3) in mat4 aTransform;
+layout(location = 7) in vec4 aUvRect;
+layout(location = 8) in vec4 aTint;
+layout(location = 9) in float aLayer;
+
+out vec3 ourColor;
+out vec2 TexCoord;
+out vec4 Tint;
+flat out float Layer;
+
+void main() {
+  gl_Position = aTransform * vec4(aPos, 1.0);
+  ourColor = aColor;
+  TexCoord = aUvRect.xy + aTexCoord * aUvRect.zw;
+  Tint = aTint;
+  Layer = aLayer;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoord;
+in vec4 Tint;
+flat in float Layer;
+
+uniform sampler2DArray spriteTexture;
+
+void main() {
+  FragColor = texture(spriteTexture, vec3(TexCoord, Layer)) * Tint;
+}
@@ -7,9 +7,18 @@ out vec3 ourColor;
 out vec2 TexCoord;
 
 uniform float time;
+// Transformacion de la instancia: filas de una matriz 3x4 (SceneInstance)
+uniform vec4 transformRows[3];
+// Camara de la escena; identidad si las instancias ya terminan en clip space
+uniform mat4 view;
+uniform mat4 projection;
 
 void main() {
-  gl_Position = vec4(aPos, 1.0);
+  vec4 position = vec4(aPos, 1.0);
+  vec4 world = vec4(dot(transformRows[0], position),
+                    dot(transformRows[1], position),
+                    dot(transformRows[2], position), 1.0);
+  gl_Position = projection * view * world;
   // float angle = time;
   // mat3 rotation = mat3(
   //     cos(angle), -sin(angle), 0,
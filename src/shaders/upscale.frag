@@ -0,0 +1,39 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 uv;
+
+uniform sampler2D source;
+// La escena ocupa solo [0, uvScale] de la textura
+uniform vec2 uvScale;
+uniform vec2 uvClamp;
+uniform vec2 texelSize;
+uniform int edgeAware;
+uniform float sharpness;
+
+vec3 fetch(vec2 coord) {
+  return texture(source, clamp(coord, texelSize * 0.5, uvClamp)).rgb;
+}
+
+void main() {
+  vec2 coord = uv * uvScale;
+  vec3 center = fetch(coord);
+  if (edgeAware == 0) {
+    FragColor = vec4(center, 1.0);
+    return;
+  }
+
+  // Realce adaptativo al contraste (estilo CAS): cuanto mas contraste local
+  // hay, menos se afila, asi los bordes fuertes no generan halos
+  vec3 north = fetch(coord + vec2(0.0, texelSize.y));
+  vec3 south = fetch(coord - vec2(0.0, texelSize.y));
+  vec3 east = fetch(coord + vec2(texelSize.x, 0.0));
+  vec3 west = fetch(coord - vec2(texelSize.x, 0.0));
+  vec3 low = min(center, min(min(north, south), min(east, west)));
+  vec3 high = max(center, max(max(north, south), max(east, west)));
+  vec3 amount = sqrt(clamp(min(low, 2.0 - high) / max(high, vec3(1e-4)),
+                           0.0, 1.0));
+  vec3 weight = amount * (-1.0 / mix(8.0, 5.0, clamp(sharpness, 0.0, 1.0)));
+  vec3 color = (center + (north + south + east + west) * weight) /
+               (1.0 + 4.0 * weight);
+  FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
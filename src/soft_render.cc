@@ -0,0 +1,205 @@
+#include "CommandList.h"
+#include "FrameCapture.h"
+#include "JobSystem.h"
+#include "SceneCooker.h"
+#include "SceneImage.h"
+#include "SceneRecorder.h"
+#include "SoftwareRenderer.h"
+#include "SoftwareShaders.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* soft-render: dibuja una escena cocinada con SoftwareRenderer, sin GPU ni
+ * contexto de GL.
+ *
+ *   soft-render [--scene scenes/quad.scene | escena.json] [--size WxH]
+ *               [--frames N] [--threads N]
+ *               [--capture frames/frame_%05d.png | .ppm]
+ *
+ * Cada frame graba las instancias con el mismo SceneRecorder que textures.cc
+ * (un draw por instancia, con sus texturas y uniforms, ordenados igual) y
+ * ejecuta las listas con el backend de software. textures.cc ademas
+ * descarta antes las instancias fuera de pantalla u ocultas, que no cambian
+ * la imagen. Sirve para generar imagenes de referencia en CI, para
+ * comparar contra la captura de GL y en maquinas sin driver. --threads
+ * usa un JobSystem propio con esa cantidad de hilos en total; la imagen es
+ * la misma con cualquier cantidad. */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string scenePath = "scenes/quad.scene";
+  int width = 800, height = 600;
+  int frames = 1;
+  int threads = 0;
+  const char *capturePath = NULL;
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--scene" && hasValue) {
+      scenePath = argv[++i];
+    } else if (argument == "--size" && hasValue) {
+      std::sscanf(argv[++i], "%dx%d", &width, &height);
+    } else if (argument == "--frames" && hasValue) {
+      frames = std::max(1, std::atoi(argv[++i]));
+    } else if (argument == "--threads" && hasValue) {
+      threads = std::max(1, std::atoi(argv[++i]));
+    } else if (argument == "--capture" && hasValue) {
+      capturePath = argv[++i];
+    } else {
+      std::cout << "Unknown argument " << argument << std::endl;
+      return -1;
+    }
+  }
+
+  CaptureFormat format = CaptureFormat::PPM;
+  if (capturePath != NULL &&
+      (!FrameCapture::formatFromPath(capturePath, format) ||
+       format == CaptureFormat::Y4M)) {
+    std::cout << "Unknown capture format, use .png or .ppm" << std::endl;
+    return -1;
+  }
+  // Una imagen por frame; el patron es seguro para snprintf
+  std::string pattern;
+  if (capturePath != NULL && !FrameCapture::framePattern(capturePath, pattern))
+    return -1;
+
+  std::unique_ptr<SceneImage> scene = loadScene(scenePath);
+  if (!scene || !scene->isValid) {
+    std::cout << "ERROR::SOFTWARE::SCENE_NOT_LOADED " << scenePath
+              << std::endl;
+    return -1;
+  }
+
+  // --threads N: N hilos en total, el principal tambien trabaja
+  std::unique_ptr<JobSystem> ownJobs;
+  if (threads > 0)
+    ownJobs = std::make_unique<JobSystem>(threads - 1);
+  JobSystem &jobs = ownJobs ? *ownJobs : JobSystem::shared();
+  SoftwareRenderer renderer(width, height, jobs);
+  if (!renderer.isValid)
+    return -1;
+  std::cout << "SOFTWARE::CONTEXT " << width << "x" << height << " | "
+            << SoftwareRenderer::implementation() << std::endl;
+
+  std::vector<uint32_t> textures(scene->textureCount, 0);
+  for (size_t t = 0; t < scene->textureCount; t++) {
+    const SceneTexture &texture = scene->textures[t];
+    const char *path = scene->string(texture.path);
+    int textureWidth, textureHeight, nrChannels;
+    stbi_set_flip_vertically_on_load(texture.flipY != 0);
+    unsigned char *data =
+        stbi_load(path, &textureWidth, &textureHeight, &nrChannels, 4);
+    if (data) {
+      textures[t] = renderer.createTexture(
+          textureWidth, textureHeight, data, texture.wrapS, texture.wrapT,
+          texture.minFilter, texture.magFilter);
+    } else {
+      std::cout << "Failed to load texture " << path << std::endl;
+    }
+    stbi_image_free(data);
+  }
+
+  /* Una sola malla con todos los vertices, como el VBO compartido de GL, y
+   * los indices ordenados por meshlet. Los sampler uniforms quedan en el
+   * programa, como en GL: se graban una vez en una lista de setup. El resto
+   * de los uniforms los pone SceneRecorder en cada draw */
+  SceneRecorder recorder(*scene, jobs);
+  recorder.mesh = renderer.createMesh(
+      scene->vertices, scene->vertexCount, SCENE_VERTEX_FLOATS,
+      recorder.indices().data(), recorder.indices().size());
+  recorder.textures = textures;
+  CommandList setup;
+  for (size_t m = 0; m < scene->materialCount; m++) {
+    const SceneMaterial &material = scene->materials[m];
+    SoftwareProgram source;
+    if (!findSoftwareProgram(scene->string(material.vertexShader),
+                             scene->string(material.fragmentShader),
+                             source)) {
+      std::cout << "ERROR::SOFTWARE::UNSUPPORTED_SHADER "
+                << scene->string(material.vertexShader) << " "
+                << scene->string(material.fragmentShader) << std::endl;
+      continue;
+    }
+    SceneMaterialBinding &binding = recorder.materials[m];
+    binding.program = renderer.createProgram(source);
+    binding.time = renderer.getUniformLocation(binding.program, "time");
+    binding.mixValue =
+        renderer.getUniformLocation(binding.program, "mixValue");
+    for (int row = 0; row < 3; row++)
+      binding.transformRows[row] = renderer.getUniformLocation(
+          binding.program, "transformRows[" + std::to_string(row) + "]");
+    binding.view = renderer.getUniformLocation(binding.program, "view");
+    binding.projection =
+        renderer.getUniformLocation(binding.program, "projection");
+    setup.setPipeline(binding.program);
+    for (int t = 0; t < SCENE_MATERIAL_TEXTURES; t++) {
+      int sampler = renderer.getUniformLocation(
+          binding.program, "texture" + std::to_string(t + 1));
+      setup.setUniform((uint32_t)sampler, t);
+    }
+  }
+  executeCommandList(setup, renderer);
+
+  std::vector<uint32_t> instances(scene->instanceCount);
+  for (size_t i = 0; i < scene->instanceCount; i++)
+    instances[i] = (uint32_t)i;
+
+  double totalMs = 0.0;
+  for (int frame = 0; frame < frames; frame++) {
+    Clock::time_point start = Clock::now();
+    float timeValue = (float)frame / 60.0f;
+    // El mismo mixValue inicial que textures.cc
+    SceneFrame sceneFrame;
+    sceneFrame.time = timeValue;
+    sceneFrame.mixValue = 0.5f;
+    sceneFrame.viewportWidth = (float)width;
+    sceneFrame.viewportHeight = (float)height;
+    // La misma camara que textures.cc
+    if (const SceneCamera *camera = scene->camera) {
+      sceneFrame.view = Mat4::lookAt(
+          Vec3(camera->position[0], camera->position[1], camera->position[2]),
+          Vec3(camera->target[0], camera->target[1], camera->target[2]),
+          Vec3(camera->up[0], camera->up[1], camera->up[2]));
+      sceneFrame.projection =
+          Mat4::perspective(camera->fovY, (float)width / (float)height,
+                            camera->zNear, camera->zFar);
+    }
+    recorder.record(instances, sceneFrame);
+
+    renderer.clear(0.2f, 0.3f, 0.3f, 1.0f);
+    executeCommandLists(recorder.lists(), renderer);
+    totalMs += std::chrono::duration<double, std::milli>(Clock::now() - start)
+                   .count();
+
+    if (capturePath != NULL) {
+      char path[1024];
+      std::snprintf(path, sizeof(path), pattern.c_str(), frame);
+      bool written =
+          format == CaptureFormat::PNG
+              ? writePNG(path, width, height, renderer.color.data())
+              : writePPM(path, width, height, renderer.color.data());
+      if (!written) {
+        std::cout << "ERROR::SOFTWARE::CAPTURE_FAILED " << path << std::endl;
+        return -1;
+      }
+    }
+  }
+
+  std::cout << "SOFTWARE::SUMMARY " << frames << " frames | "
+            << totalMs / frames << " ms/frame | " << renderer.drawCalls
+            << " draws, " << renderer.triangles << " triangles | "
+            << SoftwareRenderer::implementation() << std::endl;
+  return 0;
+}
@@ -0,0 +1,3 @@
+// Unica implementacion de stb_image para todos los ejecutables
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
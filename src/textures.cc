@@ -1,286 +1,874 @@
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "Shader.h"
+#include "DebugOutput.h"
+#include "ClusteredLighting.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "FrameClock.h"
+#include "FrustumCuller.h"
+#include "GLCommandExecutor.h"
+#include "GLIntercept.h"
+#include "GLTrace.h"
+#include "GltfLoader.h"
+#include "HeadlessContext.h"
+#include "JobSystem.h"
+#include "OcclusionCuller.h"
+#include "Profiler.h"
+#include "RenderThread.h"
+#include "SceneCooker.h"
+#include "SceneImage.h"
+#include "SceneRecorder.h"
+#include "UploadThread.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <memory>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <ostream>
+#include <string>
+#include <vector>
 
-void processInput(GLFWwindow *window);
+void processInput(GLFWwindow *window, float deltaTime);
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
+GLFWwindow *createWindow(bool debugContext);
 
 float xMove = 0.0f;
 float yMove = 0.5f;
+// Unidades por segundo; equivale a los 0.05 por frame de antes a 60 Hz
+const float MIX_SPEED = 3.0f;
+// Luz ambiente de los materiales iluminados, como en gl-bench
+const float SCENE_AMBIENT = 0.05f;
+int framebufferWidth = 800;
+int framebufferHeight = 600;
 
 int main(int argc, char *argv[]) {
-  /* Esto inicializa GLFW con sus valores predeterminados, retorna GLFW_TRUE si
-   * tiene exito
-   * */
-  glfwInit();
-
-  /* Esto define la version de opengl con la que se quiere trabajar en este caso
-   * la version 3.3 */
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-
-  /* EL primer argumento es la opcion para seleccionar, en este caso el perfil,
-   * y el segundo argumento es el valor de esta opcion, core profile va excluir
-   * funciones de compatibilidad antiguas*/
-  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-  // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-
-  glfwWindowHintString(GLFW_WAYLAND_APP_ID, "opengl-project");
-  GLFWwindow *window = glfwCreateWindow(800, 600, "Full OpenGL", NULL, NULL);
-
-  if (window == NULL) {
-    std::cout << "Fail to create GLFW window" << std::endl;
-    glfwTerminate();
-    return -1;
+  /* Argumentos: [modelo.glb] [--headless] [--frames N] [--size WxH]
+   *             [--capture frames/frame_%05d.png | salida.y4m]
+   *             [--trace traza.json] [--gl-stats] [--record gl.gltrace]
+   *             [--gl-debug] [--scene escena.scene]
+   *             [--dynamic-resolution MS] [--upscale bilinear|edge]
+   * Con --headless no se abre ninguna ventana: se dibuja en un FBO con EGL u
+   * OSMesa durante N frames y se imprimen las estadisticas. --capture guarda
+   * cada frame (PNG, PPM o Y4M segun la extension) y --trace escribe los
+   * tiempos de CPU y GPU para chrome://tracing al salir. --gl-stats envuelve
+   * las llamadas GL y al salir imprime cuantas hubo por frame, cuanto
+   * tardaron y cuantas eran redundantes. --record graba todas las llamadas
+   * GL para reproducirlas con gl-replay. --gl-debug pide un contexto de debug
+   * y al salir resume los avisos del driver por zona del codigo. --scene
+   * carga otra escena cocinada con scene-cook (por defecto
+   * scenes/quad.scene). --dynamic-resolution dibuja la escena a la escala
+   * que mantiene su tiempo de GPU bajo MS milisegundos y la escala a la
+   * salida con --upscale (bilinear por defecto, edge afila los bordes) */
+  const char *modelPath = NULL;
+  const char *capturePath = NULL;
+  const char *tracePath = NULL;
+  const char *recordPath = NULL;
+  const char *scenePath = "scenes/quad.scene";
+  bool headless = false;
+  bool glStats = false;
+  bool glDebug = false;
+  double resolutionBudgetMs = 0.0;
+  UpscaleFilter upscaleFilter = UpscaleFilter::Bilinear;
+  int headlessFrames = 300;
+  int headlessWidth = 800, headlessHeight = 600;
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+    if (argument == "--headless") {
+      headless = true;
+    } else if (argument == "--gl-debug") {
+      glDebug = true;
+    } else if (argument == "--gl-stats") {
+      glStats = true;
+    } else if (argument == "--dynamic-resolution" && i + 1 < argc) {
+      resolutionBudgetMs = std::atof(argv[++i]);
+    } else if (argument == "--upscale" && i + 1 < argc) {
+      upscaleFilter = std::string(argv[++i]) == "edge"
+                          ? UpscaleFilter::EdgeAware
+                          : UpscaleFilter::Bilinear;
+    } else if (argument == "--scene" && i + 1 < argc) {
+      scenePath = argv[++i];
+    } else if (argument == "--record" && i + 1 < argc) {
+      recordPath = argv[++i];
+    } else if (argument == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (argument == "--capture" && i + 1 < argc) {
+      capturePath = argv[++i];
+    } else if (argument == "--frames" && i + 1 < argc) {
+      headlessFrames = std::atoi(argv[++i]);
+    } else if (argument == "--size" && i + 1 < argc) {
+      if (std::sscanf(argv[++i], "%dx%d", &headlessWidth, &headlessHeight) !=
+          2)
+        std::cout << "Invalid --size, expected WxH" << std::endl;
+    } else {
+      modelPath = argv[i];
+    }
   }
 
-  /* Indicamos a GLFW que convierta el contexto de nuestra ventana en el
-   * contexto principal del hilo actual*/
-  glfwMakeContextCurrent(window);
-  /* Aqui glfw esta llamando a mi callback por mi cuando se haga un resize de la
-   * ventana, el callback tiene que cumplir el contrato que espera como segundo
-   * argumento de la funcion (puede llamarse como quiera). Un Callback es una
-   * funcion que yo defino pero que otro programa la llama por mi cuando ocurra
-   * cierto evento*/
-  glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-  /* gladLoadGLLoader necesita cargar los punteros de funcion de opengl es por
-   * eso que antes de llamar a cualquier funcion de openGL necesitamos
-   * cargarlos, el parametro que recibe es una funcion proporcionada por GLFW
-   * que carga estos punteros segun el sistem operativo*/
-  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-    std::cout << "Fail to initialize GLAD" << std::endl;
-    return -1;
+  GLFWwindow *window = NULL;
+  std::unique_ptr<HeadlessContext> headlessContext;
+  if (headless) {
+    headlessContext = std::make_unique<HeadlessContext>(
+        headlessWidth, headlessHeight, 3, 3, glDebug);
+    if (!headlessContext->isValid)
+      return -1;
+  } else {
+    window = createWindow(glDebug);
+    if (window == NULL)
+      return -1;
   }
+  // Despues de cargar glad y antes de crear los otros hilos GL
+  if (glDebug)
+    DebugOutput::install();
+  if (glStats)
+    GLIntercept::install();
+  if (recordPath != NULL &&
+      !GLTrace::start(recordPath, headless ? headlessWidth : framebufferWidth,
+                      headless ? headlessHeight : framebufferHeight,
+                      headless ? headlessContext->procAddress
+                               : (void *(*)(const char *))glfwGetProcAddress))
+    recordPath = NULL;
 
   /* ----------- SETUP SHADERS -----------*/
   Shader ourShader("shaders/texture.vert",
                    "shaders/texture.frag");
 
-  /* ------------ SETUP VERTEX DATA ------------*/
-  /* Verices del triangulo pero estas coordenadas estan en NDC (Normalized
-   * Device Corrdinates) que van desde -1.0 hasta 1.0, cualquier valor fuera de
-   * este rango OpenGL no los mostrará*/
-
-  float vertices[] = {
-    // positions          // colors           // texture coords
-     0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,   // top right
-     0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
-    -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,   // bottom left
-    -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f    // top left 
-  };
-  // Podemos cargar solo 4 vertices y con esos 4 vertices podemos dibujar 2
-  // triangulos los indices son las posiciones de los vertices, asi evitamos
-  // sobreposicion de vertices
-  unsigned int indices[] = {
-      0, 1, 3, // first triangle
-      1, 2, 3  // second triangle
-  };
-
-  /* Aqui creamos un Vertex buffer object, generamos ese buffer que viene desde
-   * la la GPU es como si reservaramos memoria*/
-  unsigned int VBO, VAO, EBO;
-  /* Vertex Array Object (VAO)*/
-  /* Una VAO nos sirve para almacenar configuracion de nuestros atributos de vertice y que VBO usar*/
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenBuffers(1, &EBO);
-
-  /*Vinculamos el VAO*/
-  glBindVertexArray(VAO);
-
-  /* Ahora enlazamos ese buffer a su tipo correspondiente en OpenGL que vendria
-   * ser GL_ARRAY_BUFFER, entonces cuando modifiquemos GL_ARRAY_BUFFER vamos a
-   * estar modificando  VBO*/
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-  /* Transfiere los vertices en el rango NDC hacia el buffer de vertexs, el
-   * ultimo parametro es para indicarle como debemos manejar la GPU, en este
-   * caso GL_STATIC_DRAW setea los valores una vez y lo usamos muchas veces */
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-  /*Le decimos a OpenGL como debe interpretar los datos del vertex,
-   * (configurarmos los atributos de vertice)*/
-  // Position attribute
-   // Set the vertex attributes for the position.
-   // attribute location | number of components | type | normalize | stride | offset
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-  glEnableVertexAttribArray(0);
-
-  // Color attribute
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3* sizeof(float)));
-  glEnableVertexAttribArray(1);
-
-  // Texture attribute
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6* sizeof(float)));
-  glEnableVertexAttribArray(2);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  glBindVertexArray(0);
-
-
-  /* ----------- SETUP TEXTURES -----------*/
-  float texCoords[] = {
-      0.0f, 0.0f, // lower-left corner
-      1.0f, 0.0f, // lower-right corner
-      0.5f, 1.0f  // top-center corner
+  /* ------------ SETUP SCENE ------------*/
+  /* Mallas, materiales, texturas e instancias vienen de una escena cocinada
+   * con scene-cook (scenes/quad.json -> <build>/scenes/quad.scene). Se mapea
+   * y se usa en el lugar: cargarla no depende de cuantos objetos tenga. Un
+   * .json se cocina en memoria. La escena por defecto es el quad con dos
+   * texturas de siempre: sus vertices estan en NDC (Normalized Device
+   * Coordinates) que van desde -1.0 hasta 1.0, y con los indices 4 vertices
+   * alcanzan para 2 triangulos */
+  std::chrono::steady_clock::time_point sceneStart =
+      std::chrono::steady_clock::now();
+  std::unique_ptr<SceneImage> scene = loadScene(scenePath);
+  if (!scene || !scene->isValid) {
+    std::cout << "ERROR::SCENE::NOT_LOADED " << scenePath
+              << " (run from the build directory or cook it with scene-cook)"
+              << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  std::cout << "SCENE::LOADED " << scenePath << " " << scene->size()
+            << " bytes | " << scene->meshCount << " meshes, "
+            << scene->materialCount << " materials, " << scene->textureCount
+            << " textures, " << scene->instanceCount << " instances | "
+            << std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - sceneStart)
+                   .count()
+            << " ms" << std::endl;
+
+  /* Un programa por par de shaders distinto. El cocinador deduplica los
+   * strings, asi que mismo offset es mismo archivo */
+  struct SceneProgram {
+    std::unique_ptr<Shader> shader;
+    uint32_t vertexShader, fragmentShader;
+    int time, mixValue, transformRows[3], view, projection;
+    bool lit; // clustered.frag: needs the lights bound every frame
   };
+  std::vector<SceneProgram> scenePrograms;
+  std::vector<uint32_t> materialPrograms(scene->materialCount);
+  for (size_t m = 0; m < scene->materialCount; m++) {
+    const SceneMaterial &material = scene->materials[m];
+    size_t p = 0;
+    while (p < scenePrograms.size() &&
+           (scenePrograms[p].vertexShader != material.vertexShader ||
+            scenePrograms[p].fragmentShader != material.fragmentShader))
+      p++;
+    if (p == scenePrograms.size()) {
+      SceneProgram program;
+      program.shader =
+          std::make_unique<Shader>(scene->string(material.vertexShader),
+                                   scene->string(material.fragmentShader));
+      program.vertexShader = material.vertexShader;
+      program.fragmentShader = material.fragmentShader;
+      Shader &shader = *program.shader;
+      program.time = shader.getUniformLocation("time");
+      program.mixValue = shader.getUniformLocation("mixValue");
+      for (int row = 0; row < 3; row++)
+        program.transformRows[row] = shader.getUniformLocation(
+            "transformRows[" + std::to_string(row) + "]");
+      program.view = shader.getUniformLocation("view");
+      program.projection = shader.getUniformLocation("projection");
+      program.lit = shader.getUniformLocation("clusterGrid") >= 0;
+      shader.use();
+      shader.setInt("texture1", 0);
+      shader.setInt("texture2", 1);
+      if (program.lit)
+        glUniform3f(shader.getUniformLocation("ambient"), SCENE_AMBIENT,
+                    SCENE_AMBIENT, SCENE_AMBIENT);
+      scenePrograms.push_back(std::move(program));
+    }
+    materialPrograms[m] = (uint32_t)p;
+  }
 
-  // Genera y enlaza un objeto de textura. Luego, carga los datos de la imagen en él
-  // y genera mipmaps para un escalado adecuado.
-  unsigned int texture1, texture2;
-  glGenTextures(1, &texture1);
-  glBindTexture(GL_TEXTURE_2D, texture1);
-
-
-  // Set texture wrapping parameters.
-  // GL_TEXTURE_WRAP_S sets the wrap parameter for the S (or X) coordinate.
-  // GL_TEXTURE_WRAP_T sets the wrap parameter for the T (or Y) coordinate.
-  // GL_REPEAT repeats the texture image.
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  // float borderColor[] = {1.0f, 1.0f, 0.0f, 1.0f};
-  // glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-
-  // Set texture filtering parameters.
-  // GL_TEXTURE_MIN_FILTER is used when the texture is smaller than the area it's mapped to (minification).
-  // GL_TEXTURE_MAG_FILTER is used when the texture is larger than the area it's mapped to (magnification).
-  // GL_LINEAR specifies linear interpolation for filtering, which results in smoother textures.
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  // We can read a texture
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(true);
-  unsigned char *data =
-      stbi_load("assets/container.jpg", &width, &height, &nrChannels, 0);
-
-  if (data) {
-    // Load the image data into the currently bound 2D texture object.
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
+  /* Cada frame las instancias visibles se graban en CommandLists en varios
+   * hilos (ver SceneRecorder) y este hilo solo las reproduce en GL. Los
+   * handles de buffers y texturas llegan cuando terminan las subidas */
+  SceneRecorder sceneRecorder(*scene);
+  std::cout << "SCENE::MESHLETS " << sceneRecorder.meshletCount()
+            << " clusters in " << scene->lodCount << " LODs" << std::endl;
+  for (size_t m = 0; m < scene->materialCount; m++) {
+    const SceneProgram &program = scenePrograms[materialPrograms[m]];
+    SceneMaterialBinding &binding = sceneRecorder.materials[m];
+    binding.program = program.shader->isValid ? program.shader->ID : 0;
+    binding.time = program.time;
+    binding.mixValue = program.mixValue;
+    for (int row = 0; row < 3; row++)
+      binding.transformRows[row] = program.transformRows[row];
+    binding.view = program.view;
+    binding.projection = program.projection;
+    // Las luces se asignan a clusters del frustum de la camara
+    if (program.lit && scene->camera == nullptr) {
+      std::cout << "ERROR::SCENE::LIT_MATERIAL_WITHOUT_CAMERA "
+                << scene->string(scene->materials[m].name) << std::endl;
+      binding.program = 0;
+    }
   }
 
-  stbi_image_free(data);
+  /* Materiales iluminados (clustered.vert/clustered.frag): las luces de la
+   * escena se asignan cada frame a los clusters del frustum de la camara,
+   * en compute si hay GL 4.3 y si no en los hilos del JobSystem (ver
+   * ClusteredLighting.h) */
+  std::unique_ptr<ClusteredLighting> lighting;
+  bool litScene = false;
+  for (const SceneProgram &program : scenePrograms)
+    litScene = litScene || (program.lit && program.shader->isValid);
+  if (litScene && scene->camera != nullptr) {
+    static_assert(sizeof(SceneLight) == sizeof(ClusterLight),
+                  "SceneLight mirrors ClusterLight");
+    std::vector<ClusterLight> lights(scene->lightCount);
+    if (!lights.empty())
+      std::memcpy(lights.data(), scene->lights,
+                  lights.size() * sizeof(ClusterLight));
+    lighting = std::make_unique<ClusteredLighting>(
+        std::max<size_t>(lights.size(), 1));
+    if (lighting->isValid) {
+      lighting->setLights(lights.data(), lights.size());
+      std::cout << "SCENE::LIGHTS " << lights.size() << " lights | "
+                << (lighting->useCompute ? "compute" : "cpu") << " binning"
+                << std::endl;
+    } else {
+      lighting.reset();
+    }
+  }
 
-  glGenTextures(1, &texture2);
-  glBindTexture(GL_TEXTURE_2D, texture2);
+  /* Caja de cada instancia despues de su transformacion, para descartar las
+   * que quedan fuera de pantalla. Sin camara la transformacion de la
+   * instancia ya deja el mesh en clip space y el frustum es el cubo
+   * [-1, 1]; con camara es el de projection * view */
+  FrustumCuller culler;
+  culler.reserve(scene->instanceCount);
+  for (size_t i = 0; i < scene->instanceCount; i++) {
+    const SceneInstance &instance = scene->instances[i];
+    Vec3 boundsMin, boundsMax;
+    if (instance.mesh < scene->meshCount) {
+      const SceneMesh &mesh = scene->meshes[instance.mesh];
+      float center[3], extent[3], bounds[2][3];
+      for (int c = 0; c < 3; c++) {
+        center[c] = (mesh.boundsMin[c] + mesh.boundsMax[c]) * 0.5f;
+        extent[c] = (mesh.boundsMax[c] - mesh.boundsMin[c]) * 0.5f;
+      }
+      for (int row = 0; row < 3; row++) {
+        const float *t = instance.transform + row * 4;
+        float c = t[0] * center[0] + t[1] * center[1] + t[2] * center[2] + t[3];
+        float e = std::fabs(t[0]) * extent[0] + std::fabs(t[1]) * extent[1] +
+                  std::fabs(t[2]) * extent[2];
+        bounds[0][row] = c - e;
+        bounds[1][row] = c + e;
+      }
+      boundsMin = Vec3(bounds[0][0], bounds[0][1], bounds[0][2]);
+      boundsMax = Vec3(bounds[1][0], bounds[1][1], bounds[1][2]);
+    }
+    culler.add(boundsMin, boundsMax);
+  }
 
-  // Wrap texture coordinates (s and t) on both axes
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+  /* Las instancias opacas de mallas marcadas "occluder" se rasterizan cada
+   * frame en el buffer de profundidad de CPU, y las instancias que quedan
+   * detras no se envian. Sin oclusores en la escena no hay nada que hacer */
+  std::vector<uint32_t> occluderInstances;
+  for (size_t i = 0; i < scene->instanceCount; i++) {
+    const SceneInstance &instance = scene->instances[i];
+    if (instance.mesh < scene->meshCount &&
+        instance.material < scene->materialCount &&
+        (scene->meshes[instance.mesh].flags & SCENE_MESH_OCCLUDER) &&
+        !scene->materials[instance.material].translucent)
+      occluderInstances.push_back((uint32_t)i);
+  }
+  std::unique_ptr<OcclusionCuller> occlusion;
+  std::vector<uint32_t> unoccluded;
+  if (!occluderInstances.empty()) {
+    occlusion = std::make_unique<OcclusionCuller>();
+    std::cout << "OCCLUSION::OCCLUDERS " << occluderInstances.size()
+              << " instances | " << OcclusionCuller::implementation()
+              << std::endl;
+  }
 
-  //  Filtering parameters for minification and magnification Mipmaps
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  /* Los buffers y texturas se crean y llenan en el hilo de subidas, que tiene
+   * un contexto compartido con esta ventana; asi glBufferData y glTexImage2D
+   * no bloquean el render. En modo headless no hay ventana para compartir y
+   * se suben directo en este hilo, igual que al grabar una traza, que se
+   * reproduce en un solo contexto. */
+  std::unique_ptr<UploadThread> uploader;
+  if (window != NULL && !GLTrace::recording()) {
+    uploader = std::make_unique<UploadThread>(window);
+    if (!uploader->isValid) {
+      glfwTerminate();
+      return -1;
+    }
+  }
+  auto submitUpload = [&](UploadThread::UploadFunction upload,
+                          UploadThread::ReadyFunction ready) {
+    if (uploader) {
+      uploader->submit(std::move(upload), std::move(ready));
+    } else {
+      upload();
+      ready();
+    }
+  };
 
-  // Load second texture
-  data = stbi_load("assets/agnes.png", &width, &height, &nrChannels, 4);
-  if (data) {
-    std::cout << "Texture loaded successfully: " << width << "x" << height
-              << " with " << nrChannels << " channels." << std::endl;
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, data);
-    std::cout << "Texture data loaded into OpenGL successfully." << std::endl;
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
+  /* Aqui creamos un Vertex buffer object, generamos ese buffer que viene desde
+   * la la GPU es como si reservaramos memoria*/
+  unsigned int VBO = 0, VAO = 0, EBO = 0;
+  std::vector<unsigned int> sceneTextures(scene->textureCount, 0);
+  // Lo escribe el callback ready (hilo de render) y lo lee el render
+  bool assetsReady = false;
+
+  /* Las imagenes se decodifican en paralelo en el JobSystem. Cuando terminan
+   * todas, la subida se encola en el hilo principal (el del contexto GL), que
+   * la pasa al hilo de subidas o la hace ahi mismo. assetsQueued llega a cero
+   * recien cuando la subida ya se encolo */
+  struct DecodedTexture {
+    unsigned char *pixels = nullptr;
+    int width = 0, height = 0;
+  };
+  std::vector<DecodedTexture> decodedTextures(scene->textureCount);
+  JobSystem &jobs = JobSystem::shared();
+  JobCounter texturesDecoded, assetsQueued;
+  for (size_t t = 0; t < scene->textureCount; t++) {
+    jobs.run(
+        [&, t]() {
+          const SceneTexture &texture = scene->textures[t];
+          const char *path = scene->string(texture.path);
+          DecodedTexture &decoded = decodedTextures[t];
+          int nrChannels;
+          stbi_set_flip_vertically_on_load_thread(texture.flipY != 0);
+          decoded.pixels = stbi_load(path, &decoded.width, &decoded.height,
+                                     &nrChannels, 4);
+          if (decoded.pixels == nullptr)
+            std::cout << "Failed to load texture " << path << std::endl;
+        },
+        &texturesDecoded);
   }
 
-  stbi_image_free(data);
+  auto uploadAssets = [&]() {
+    GL_DEBUG_SITE("upload");
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    /* Ahora enlazamos ese buffer a su tipo correspondiente en OpenGL que
+     * vendria ser GL_ARRAY_BUFFER, entonces cuando modifiquemos
+     * GL_ARRAY_BUFFER vamos a estar modificando  VBO*/
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    /* Transfiere los vertices de todas las mallas hacia el buffer de
+     * vertexs directo desde la escena mapeada, sin copia. GL_STATIC_DRAW
+     * setea los valores una vez y lo usamos muchas veces */
+    glBufferData(GL_ARRAY_BUFFER,
+                 scene->vertexCount * SCENE_VERTEX_FLOATS * sizeof(float),
+                 scene->vertices, GL_STATIC_DRAW);
+
+    // Sin VAO no hay GL_ELEMENT_ARRAY_BUFFER; los buffers no tienen tipo,
+    // asi que los indices se llenan por GL_ARRAY_BUFFER. Son los de la
+    // escena ordenados por meshlet, ver SceneRecorder
+    const std::vector<uint32_t> &indices = sceneRecorder.indices();
+    glBindBuffer(GL_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(uint32_t),
+                 indices.data(), GL_STATIC_DRAW);
+
+    /* ----------- SETUP TEXTURES -----------*/
+    // Genera y enlaza un objeto de textura por cada textura de la escena,
+    // con el wrapping y filtrado que pide, carga la imagen en él y genera
+    // mipmaps para un escalado adecuado.
+    for (size_t t = 0; t < scene->textureCount; t++) {
+      const SceneTexture &texture = scene->textures[t];
+      glGenTextures(1, &sceneTextures[t]);
+      glBindTexture(GL_TEXTURE_2D, sceneTextures[t]);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture.wrapS);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture.wrapT);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                      texture.minFilter);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                      texture.magFilter);
+
+      DecodedTexture &decoded = decodedTextures[t];
+      if (decoded.pixels) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, decoded.width,
+                     decoded.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     decoded.pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+      }
+      stbi_image_free(decoded.pixels);
+      decoded.pixels = nullptr;
+    }
+  };
+  auto setupAssets = [&]() {
+    GL_DEBUG_SITE("vertex setup");
+    /* Vertex Array Object (VAO)*/
+    /* Una VAO nos sirve para almacenar configuracion de nuestros
+     * atributos de vertice y que VBO usar. Los VAOs no se comparten entre
+     * contextos, por eso se crea aca en el contexto del render*/
+    glGenVertexArrays(1, &VAO);
+
+    /*Vinculamos el VAO*/
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    /*Le decimos a OpenGL como debe interpretar los datos del vertex,
+     * (configurarmos los atributos de vertice)*/
+    // Position attribute
+    // Set the vertex attributes for the position.
+    // attribute location | number of components | type | normalize |
+    // stride | offset
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          (void *)0);
+    glEnableVertexAttribArray(0);
+
+    // Color attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Texture attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(0);
+    sceneRecorder.mesh = VAO;
+    sceneRecorder.textures = sceneTextures;
+    assetsReady = true;
+  };
+  jobs.runAfter(
+      texturesDecoded,
+      [&]() {
+        jobs.runOnMainThread(
+            [&]() { submitUpload(uploadAssets, setupAssets); },
+            &assetsQueued);
+      },
+      &assetsQueued);
+  // Sin hilo de subidas las capturas y las trazas tienen la escena desde el
+  // primer frame; el wait corre la subida en este hilo
+  if (!uploader)
+    jobs.wait(assetsQueued);
 
   ourShader.use();
   glUniform1i(glGetUniformLocation(ourShader.ID, "texture1"), 0);
   ourShader.setInt("texture2", 1);
+  // El modelo se dibuja sin transformacion
+  const float identityRows[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+  glUniform4fv(ourShader.getUniformLocation("transformRows"), 3, identityRows);
+
+  // Si se pasa un .glb por argumento lo dibujamos en lugar de la escena
+  std::unique_ptr<GltfModel> model;
+  if (modelPath != NULL) {
+    model = std::make_unique<GltfModel>(modelPath);
+    if (!model->isValid)
+      model.reset();
+  }
 
-  // To draw in wireframe mode, uncomment the following line.
-  // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-  /* La condicion revisa en cada loop si hay una instruccion que va cerrar la
-   * ventana */
-  while (!glfwWindowShouldClose(window)) {
-
-    // --- Input ---
-    processInput(window);
-
-    // -- Funciones de render ---
+  GLStateCache glState;
+
+  // Siempre activo: cuesta unas pocas queries por frame
+  std::unique_ptr<Profiler> profiler = std::make_unique<Profiler>();
+
+  // La captura lee con PBOs y codifica en otro hilo, no frena el render
+  std::unique_ptr<FrameCapture> capture;
+  if (capturePath != NULL) {
+    CaptureFormat format;
+    if (!FrameCapture::formatFromPath(capturePath, format)) {
+      std::cout << "Unknown capture format, use .png, .ppm or .y4m"
+                << std::endl;
+    } else {
+      capture = std::make_unique<FrameCapture>(
+          headless ? headlessWidth : framebufferWidth,
+          headless ? headlessHeight : framebufferHeight, capturePath, format);
+      if (!capture->isValid)
+        capture.reset();
+    }
+  }
 
-    // Define el color con el que se va limpiar el color buffer, osea cuando
-    // limpie el color buffer del frame anterior lo va llenar con estre color
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    /* Borra el contenido del color buffer osea del frame anterior y lo rellena
-     * con el color definido por glClearColor*/
-    glClear(GL_COLOR_BUFFER_BIT);
+  std::unique_ptr<DynamicResolution> dynamicResolution;
+  if (resolutionBudgetMs > 0.0) {
+    dynamicResolution = std::make_unique<DynamicResolution>(
+        headless ? headlessWidth : framebufferWidth,
+        headless ? headlessHeight : framebufferHeight, resolutionBudgetMs);
+    dynamicResolution->filter = upscaleFilter;
+    if (!dynamicResolution->isValid)
+      dynamicResolution.reset();
+  }
 
+  // To draw in wireframe mode, uncomment the following line.
+  // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    // float timeValue = glfwGetTime();
-    // int vertexColorLocation =  glGetUniformLocation(shaderProgram, "ourColor");
-    // ourShader.use();
-    // glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
-    
-    float timeValue = glfwGetTime();
+  auto drawScene = [&](const FrameSnapshot &frame) {
+    // Jobs encolados para el hilo con el contexto GL
+    JobSystem::shared().runMainThreadJobs();
+    // Recursos que el hilo de subidas ya termino de llenar
+    if (uploader)
+      uploader->collect();
+
+    {
+      ProfileScope scope(profiler.get(), "clear", true);
+      GL_DEBUG_SITE("clear");
+      // Define el color con el que se va limpiar el color buffer, osea cuando
+      // limpie el color buffer del frame anterior lo va llenar con estre color
+      glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+      /* Borra el contenido del color buffer osea del frame anterior y lo
+       * rellena con el color definido por glClearColor*/
+      glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // Mientras las subidas no terminen solo se limpia la pantalla
+    if (!assetsReady)
+      return;
+
+    float timeValue = (float)frame.time;
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture2);
+    // ourShader.setColorRGB("customColor", colors[0], colors[1], colors[2]);
+    if (model) {
+      {
+        ProfileScope scope(profiler.get(), "texture bind", true);
+        GL_DEBUG_SITE("texture bind");
+        for (size_t t = 0; t < sceneTextures.size() && t < 2; t++) {
+          glActiveTexture(GL_TEXTURE0 + (GLenum)t);
+          glBindTexture(GL_TEXTURE_2D, sceneTextures[t]);
+        }
+      }
+
+      ProfileScope scope(profiler.get(), "draw", true);
+      GL_DEBUG_SITE("model draw");
+      ourShader.use();
+      ourShader.setFloat("time", timeValue);
+      ourShader.setFloat("mixValue", frame.mixValue);
+      model->draw();
+      // El modelo toca el estado por fuera de la cache
+      glState.invalidate();
+    } else {
+      /* En vez de dibujar aca mismo se graba un draw por instancia visible
+       * en las listas de comandos, ordenados para evitar binds repetidos.
+       * Solo las instancias que pasan el culling, y de ellas solo los
+       * meshlets que quedan dentro del frustum */
+      SceneFrame sceneFrame;
+      sceneFrame.time = timeValue;
+      sceneFrame.mixValue = frame.mixValue;
+      // Las LODs y los clusters de luces van por los pixeles donde se
+      // dibuja la escena
+      int viewportWidth = dynamicResolution ? dynamicResolution->renderWidth
+                                            : frame.framebufferWidth;
+      int viewportHeight = dynamicResolution ? dynamicResolution->renderHeight
+                                             : frame.framebufferHeight;
+      sceneFrame.viewportWidth = (float)viewportWidth;
+      sceneFrame.viewportHeight = (float)viewportHeight;
+      float aspect = (float)viewportWidth / (float)std::max(viewportHeight, 1);
+      if (const SceneCamera *camera = scene->camera) {
+        sceneFrame.view = Mat4::lookAt(
+            Vec3(camera->position[0], camera->position[1],
+                 camera->position[2]),
+            Vec3(camera->target[0], camera->target[1], camera->target[2]),
+            Vec3(camera->up[0], camera->up[1], camera->up[2]));
+        sceneFrame.projection = Mat4::perspective(camera->fovY, aspect,
+                                                  camera->zNear, camera->zFar);
+      }
+      Mat4 viewProjection = sceneFrame.projection * sceneFrame.view;
+      {
+        ProfileScope scope(profiler.get(), "cull");
+        culler.cull(Frustum::fromMatrix(viewProjection));
+      }
+      const std::vector<uint32_t> *drawList = &culler.visible;
+      if (occlusion) {
+        ProfileScope scope(profiler.get(), "occlusion");
+        occlusion->beginFrame(viewProjection);
+        for (uint32_t i : occluderInstances) {
+          const SceneInstance &instance = scene->instances[i];
+          const SceneMesh &mesh = scene->meshes[instance.mesh];
+          Mat4 model;
+          for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 4; col++)
+              model.at(row, col) = instance.transform[row * 4 + col];
+          occlusion->addOccluder(scene->vertices, SCENE_VERTEX_FLOATS,
+                                 scene->indices + mesh.firstIndex,
+                                 mesh.indexCount, model);
+        }
+        occlusion->rasterize();
+        occlusion->cull(culler, culler.visible, unoccluded);
+        drawList = &unoccluded;
+      }
+      {
+        ProfileScope scope(profiler.get(), "record");
+        sceneRecorder.record(*drawList, sceneFrame);
+      }
+      if (lighting) {
+        ProfileScope scope(profiler.get(), "lights", true);
+        GL_DEBUG_SITE("lights");
+        const SceneCamera &camera = *scene->camera;
+        lighting->update(sceneFrame.view, camera.fovY, aspect, camera.zNear,
+                         camera.zFar);
+        // update() usa su programa de compute por fuera de la cache
+        glState.invalidate();
+        for (const SceneProgram &program : scenePrograms) {
+          if (!program.lit || !program.shader->isValid)
+            continue;
+          glState.useProgram(program.shader->ID);
+          lighting->bind(*program.shader, viewportWidth, viewportHeight);
+        }
+        // bind() cambia la unidad de textura activa por fuera de la cache
+        glState.invalidate();
+      }
+      // Los binds de textura de la escena los hace el executor con la cache
+      // de estado
+      ProfileScope scope(profiler.get(), "draw", true);
+      GL_DEBUG_SITE("command replay");
+      executeCommandLists(sceneRecorder.lists(), glState);
+    }
+    /* Al volver, el hilo de render llama a glfwSwapBuffers: intercambia el
+     * back buffer (donde OpenGL dibuja) con el front buffer (lo que se ve en
+     * pantalla). */
+  };
 
-    ourShader.use();
-    ourShader.setFloat("time", timeValue);
-    ourShader.setFloat("mixValue", yMove) ;
+  /* Con resolucion dinamica la escena se dibuja en el FBO escalado y despues
+   * se escala al framebuffer de salida; el swap y la captura ven la salida */
+  auto renderFrame = [&](const FrameSnapshot &frame) {
+    if (!dynamicResolution) {
+      drawScene(frame);
+      return;
+    }
+    dynamicResolution->resize(frame.framebufferWidth, frame.framebufferHeight);
+    dynamicResolution->beginScene();
+    drawScene(frame);
+    dynamicResolution->endScene();
+
+    ProfileScope scope(profiler.get(), "upscale", true);
+    GL_DEBUG_SITE("upscale");
+    dynamicResolution->present(headlessContext ? headlessContext->framebuffer
+                                               : 0);
+    // present() cambia programa, VAO y textura por fuera de la cache
+    glState.invalidate();
+  };
 
-    // ourShader.setColorRGB("customColor", colors[0], colors[1], colors[2]);
-    glBindVertexArray(VAO);
+  if (headlessContext) {
+    // --- Modo headless ---
+    // Sin ventana ni input: el tiempo avanza 1/60 s por frame, asi cada
+    // corrida dibuja exactamente lo mismo sin importar cuanto tarde
+    FrameClock clock;
+    FrameSnapshot frame;
+    frame.framebufferWidth = headlessWidth;
+    frame.framebufferHeight = headlessHeight;
+    runHeadless(*headlessContext, headlessFrames, [&](int index) {
+      clock.advance(index * clock.fixedStep);
+      frame.frameIndex = index;
+      frame.time = clock.simulationTime + clock.alpha() * clock.fixedStep;
+      frame.mixValue = yMove;
+      profiler->beginFrame();
+      renderFrame(frame);
+      if (capture) {
+        GL_DEBUG_SITE("capture");
+        capture->capture();
+      }
+      profiler->endFrame();
+      GLIntercept::endFrame();
+      DebugOutput::endFrame();
+      GLTrace::endFrame();
+    });
+
+    std::cout << "PROFILER::SUMMARY " << profiler->summary() << std::endl;
+    if (dynamicResolution)
+      std::cout << "DYNAMIC_RES::SUMMARY " << dynamicResolution->summary()
+                << std::endl;
+    if (glStats)
+      std::cout << "GL::INTERCEPT " << GLIntercept::report();
+    if (DebugOutput::installed())
+      std::cout << "GL::DEBUG " << DebugOutput::report();
+    GLTrace::stop();
+    if (tracePath != NULL)
+      profiler->writeChromeTrace(tracePath);
+    profiler.reset();
+    capture.reset();
+    dynamicResolution.reset();
+    model.reset();
+    lighting.reset();
+    headlessContext.reset();
+    return 0;
+  }
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  /* Desde aca el contexto GL es del hilo de render: el hilo principal solo
+   * procesa eventos y la simulacion, y le pasa un snapshot por frame */
+  RenderThread renderThread(window);
+  renderThread.profiler = profiler.get();
+  glfwMakeContextCurrent(NULL);
+  renderThread.start([&](const FrameSnapshot &frame) {
+    renderFrame(frame);
+    // Antes del swap, mientras el frame sigue en el back buffer
+    if (capture) {
+      ProfileScope scope(profiler.get(), "capture", true);
+      GL_DEBUG_SITE("capture");
+      capture->capture();
+    }
+    GLIntercept::endFrame();
+    DebugOutput::endFrame();
+    GLTrace::endFrame();
+  });
 
-    /* glfwSwapBuffers(window) intercambia el back buffer (donde OpenGL dibuja)
-    con el front buffer (lo que se ve en pantalla). Durante cada frame, todo
-    se dibuja primero en el back buffer, que es básicamente una imagen 2D con
-    los colores de cada píxel (color buffer). Una vez que el frame está
-    listo, glfwSwapBuffers lo muestra en la ventana. */
-    glfwSwapBuffers(window);
+  /* La condicion revisa en cada loop si hay una instruccion que va cerrar la
+   * ventana */
+  FrameSnapshot frame;
+  FrameClock clock;
+  float previousYMove = yMove;
+  double lastSummaryTime = glfwGetTime();
+  while (!glfwWindowShouldClose(window)) {
     /* Verifica si un evento se ha activado, en base a ella actualiza el estado
      * de la ventana y llama a las funciones callback que yo haya registrado*/
     glfwPollEvents();
+
+    // --- Simulacion a paso fijo ---
+    // Con cualquier frame rate se simulan los mismos pasos por segundo
+    int steps = clock.advance(glfwGetTime());
+    for (int i = 0; i < steps; i++) {
+      previousYMove = yMove;
+      processInput(window, (float)clock.fixedStep);
+    }
+
+    // --- Snapshot para el render ---
+    // Se dibuja en el otro hilo mientras aca seguimos con el siguiente tick.
+    // El estado se interpola entre los dos ultimos pasos simulados
+    double alpha = clock.alpha();
+    frame.frameIndex++;
+    frame.time = clock.simulationTime + alpha * clock.fixedStep;
+    frame.framebufferWidth = framebufferWidth;
+    frame.framebufferHeight = framebufferHeight;
+    frame.mixValue = interpolate(previousYMove, yMove, alpha);
+    renderThread.publish(frame);
+
+    // Resumen del profiler en el titulo de la ventana, dos veces por segundo
+    double now = glfwGetTime();
+    if (now - lastSummaryTime >= 0.5) {
+      lastSummaryTime = now;
+      std::string title = "Full OpenGL | " + profiler->summary();
+      glfwSetWindowTitle(window, title.c_str());
+    }
   }
 
+  // El render termina su ultimo frame y suelta el contexto
+  renderThread.stop();
+  glfwMakeContextCurrent(window);
+
+  std::cout << "PROFILER::SUMMARY " << profiler->summary() << std::endl;
+  if (dynamicResolution)
+    std::cout << "DYNAMIC_RES::SUMMARY " << dynamicResolution->summary()
+              << std::endl;
+  if (glStats)
+    std::cout << "GL::INTERCEPT " << GLIntercept::report();
+  if (DebugOutput::installed())
+    std::cout << "GL::DEBUG " << DebugOutput::report();
+  GLTrace::stop();
+  if (tracePath != NULL)
+    profiler->writeChromeTrace(tracePath);
+
+  // Los objetos GL del modelo se liberan mientras el contexto sigue vivo
+  profiler.reset();
+  capture.reset();
+  dynamicResolution.reset();
+  model.reset();
+  lighting.reset();
+  // Si la ventana se cerro antes de decodificar, la subida queda encolada
+  // en este hilo; los jobs usan variables locales
+  jobs.wait(assetsQueued);
+  // Cierra el contexto de subidas antes de terminar GLFW
+  uploader.reset();
+
   /*Limpiamos los recursos de GLFW asignados*/
   glfwTerminate();
   return 0;
 }
 
-void processInput(GLFWwindow *window) {
+void processInput(GLFWwindow *window, float deltaTime) {
   /* Aqui verificamos si el ultimo estado del teclado ha sido presionado para
-   * una ventana especifica*/
-  if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+   * una ventana especifica. Cada tecla se revisa por separado para poder
+   * mantener varias a la vez, y el movimiento se escala por deltaTime para
+   * que no dependa del frame rate*/
+  if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
     glfwSetWindowShouldClose(window, true);
-  } else if (glfwGetKey(window, GLFW_KEY_UP)) {
-    yMove += 0.05;
-  } else if (glfwGetKey(window, GLFW_KEY_DOWN)) {
-    yMove -= 0.05;
-  }
-
-
+  if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+    yMove += MIX_SPEED * deltaTime;
+  if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+    yMove -= MIX_SPEED * deltaTime;
 }
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
-  /* Los primeros dos puntos establece la ubicacion de la esquina inferior
-   * izquiera de la ventana, los dos ultimos define el ancho y la altura de la
-   * ventana de renderizado en pixeles*/
-  glViewport(0, 0, width, height);
+  /* Este callback corre en el hilo principal, que no tiene el contexto GL;
+   * guardamos el tamaño y el hilo de render llama a glViewport cuando le
+   * llega en el snapshot */
+  framebufferWidth = width;
+  framebufferHeight = height;
+}
+
+GLFWwindow *createWindow(bool debugContext) {
+  /* Esto inicializa GLFW con sus valores predeterminados, retorna GLFW_TRUE si
+   * tiene exito
+   * */
+  glfwInit();
+
+  /* Esto define la version de opengl con la que se quiere trabajar en este caso
+   * la version 3.3 */
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+  /* EL primer argumento es la opcion para seleccionar, en este caso el perfil,
+   * y el segundo argumento es el valor de esta opcion, core profile va excluir
+   * funciones de compatibilidad antiguas*/
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  // Con un contexto de debug el driver manda sus avisos a DebugOutput
+  if (debugContext)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+
+  glfwWindowHintString(GLFW_WAYLAND_APP_ID, "opengl-project");
+  GLFWwindow *window = glfwCreateWindow(800, 600, "Full OpenGL", NULL, NULL);
+
+  if (window == NULL) {
+    std::cout << "Fail to create GLFW window" << std::endl;
+    glfwTerminate();
+    return NULL;
+  }
+
+  /* Indicamos a GLFW que convierta el contexto de nuestra ventana en el
+   * contexto principal del hilo actual*/
+  glfwMakeContextCurrent(window);
+  /* Aqui glfw esta llamando a mi callback por mi cuando se haga un resize de la
+   * ventana, el callback tiene que cumplir el contrato que espera como segundo
+   * argumento de la funcion (puede llamarse como quiera). Un Callback es una
+   * funcion que yo defino pero que otro programa la llama por mi cuando ocurra
+   * cierto evento*/
+  glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+  glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
+  /* gladLoadGLLoader necesita cargar los punteros de funcion de opengl es por
+   * eso que antes de llamar a cualquier funcion de openGL necesitamos
+   * cargarlos, el parametro que recibe es una funcion proporcionada por GLFW
+   * que carga estos punteros segun el sistem operativo*/
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    std::cout << "Fail to initialize GLAD" << std::endl;
+    return NULL;
+  }
+  return window;
 }